@@ -0,0 +1,192 @@
+/******************************************************************************
+/ Pi 4 Sunrise Clock App Steady State Allocation Check - lopezk38 2025
+/
+/ Runs the main loop's frame and task path through a simulated day with the
+/ counting operator new installed, and fails if any loop iteration after
+/ startup touches the heap. Drives the same pieces the clock does: frame
+/ pacing, the clock face, the day plan, the task heap with its periodic tasks
+/ and power sequences, the light sensor and the state file. The tasks are the
+/ clock's own from clockTasks.cpp, run against a simulated monitor. Drawing is
+/ left out
+/
+/ Usage: alloccheck [--step-ms N] [--state path] [--lux path]
+/
+/*****************************************************************************/
+
+/******************************************************************************
+/ Dependencies, namespacing
+/*****************************************************************************/
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+
+#include "allocTrack.h"
+#include "clockConfig.h"
+#include "clockFace.h"
+#include "clockTasks.h"
+#include "dayPlan.h"
+#include "framePacer.h"
+#include "lightSensor.h"
+#include "metrics.h"
+#include "simulatedDisplay.h"
+#include "stateFile.h"
+#include "taskHeap.h"
+#include "trace.h"
+
+
+/******************************************************************************
+/ Constants
+/*****************************************************************************/
+
+//Everything the clock itself uses comes from clockConfig.h
+constexpr long DEFAULT_STEP_MS = 100; //Same as the loop's idle poll interval
+constexpr long STARTUP_SECONDS = 60; //Allocations before this are startup and allowed
+constexpr long DAY_SECONDS = 24 * 60 * 60;
+constexpr unsigned int MAX_REPORTED_ITERATIONS = 20;
+
+
+/******************************************************************************
+/ Implementation
+/*****************************************************************************/
+
+uint64_t tasksDispatched()
+{
+	uint64_t total = 0;
+	for (const std::atomic<uint64_t>& count : metrics::counters.tasksDispatched) total += count.load(std::memory_order_relaxed);
+	
+	return total;
+}
+
+int main(int argc, char* argv[])
+{
+	long stepMs = DEFAULT_STEP_MS;
+	const char* statePath = "/tmp/alloccheck.state";
+	const char* luxPath = "/tmp/alloccheck.lux";
+	
+	for (int i = 1; i < argc; ++i)
+	{
+		if (!std::strcmp(argv[i], "--step-ms") && i + 1 < argc) stepMs = std::atol(argv[++i]);
+		else if (!std::strcmp(argv[i], "--state") && i + 1 < argc) statePath = argv[++i];
+		else if (!std::strcmp(argv[i], "--lux") && i + 1 < argc) luxPath = argv[++i];
+		else
+		{
+			std::cerr << "Usage: alloccheck [--step-ms N] [--state path] [--lux path]" << std::endl;
+			return 1;
+		}
+	}
+	if (stepMs <= 0) stepMs = DEFAULT_STEP_MS;
+	
+	if (!allocTrack::enabled)
+	{
+		std::cerr << "ERROR: alloccheck was built without TRACK_ALLOCATIONS, there is nothing to count" << std::endl;
+		return 1;
+	}
+	
+	//Startup. Everything here may allocate
+	std::ofstream(luxPath) << "250\n";
+	LightSensor lightSensor(luxPath);
+	StateFile stateFile(statePath);
+	FramePacer pacer(PACING_STEP_THRESHOLD, PACING_MAX_FPS, PACING_MIN_FPS);
+	
+	DayPlan dayPlan(BRIGHTNESS_UPDATE_FREQ, PLAN_POWER_ON_LEAD, POWEROFF_ON_ZERO_BRIGHTNESS);
+	dayPlan.compile();
+	
+	SimulatedDisplay display;
+	clockState state;
+	state.display = &display;
+	state.wake.enabled = false; //Nothing to poll, the simulated monitor is always ready
+	if (lightSensor.isOpen()) state.lightSensor = &lightSensor;
+	state.dayPlan = &dayPlan;
+	
+	tHeap::TaskHeap taskSchedule;
+	taskSchedule.reserve(STATEFILE_MAX_TASKS);
+	taskSchedule.setUniqueKey(tHeap::TASK::CODE::CHECK_SHOULD_TOGGLE_DISPLAY_PWR, true);
+	taskSchedule.setUniqueKey(tHeap::TASK::CODE::SET_BRIGHTNESS_AND_RESCHEDULE, true);
+	taskSchedule.setUniqueKey(tHeap::TASK::CODE::SET_BRIGHTNESS, true);
+	taskSchedule.setUniqueKey(tHeap::TASK::CODE::SAMPLE_LIGHT_SENSOR_AND_RESCHEDULE, true);
+	taskSchedule.setUniqueKey(tHeap::TASK::CODE::VERIFY_DISPLAY_PWR, true);
+	
+	//Schedule clock and wall clock both start at midnight. Same schedule main.cpp sets up, then the same attach
+	long powerCheckPeriod = std::chrono::duration_cast<std::chrono::seconds>(POWERCHECK_UPDATE_FREQ).count();
+	if (POWEROFF_ON_ZERO_BRIGHTNESS) taskSchedule.pushPeriodicTask(powerCheckPeriod, powerCheckPeriod, tHeap::TASK::CODE::CHECK_SHOULD_TOGGLE_DISPLAY_PWR);
+	if (state.lightSensor) taskSchedule.pushPeriodicTask(0, LIGHT_SENSOR_SAMPLE_FREQ.count(), tHeap::TASK::CODE::SAMPLE_LIGHT_SENSOR_AND_RESCHEDULE);
+	
+	timeStruct midnight = {};
+	executeTask(taskSchedule, state, midnight, 0, tHeap::TASK::CODE::SET_BRIGHTNESS);
+	dayPlan.seek(0);
+	taskSchedule.pushTask(0, tHeap::TASK::CODE::CHECK_SHOULD_TOGGLE_DISPLAY_PWR);
+	
+	uint64_t iterations = 0;
+	uint64_t frames = 0;
+	uint64_t dirtyIterations = 0;
+	uint64_t steadyAllocations = 0;
+	uint64_t tasksAtStart = tasksDispatched();
+	uint64_t startupAllocations = allocTrack::allocations();
+	auto start = std::chrono::steady_clock::now();
+	
+	for (long ms = 0; ms < DAY_SECONDS * 1000; ms += stepMs)
+	{
+		long secondOfDay = ms / 1000;
+		timeStruct curTime = { secondOfDay / 3600, (secondOfDay / 60) % 60, secondOfDay % 60, ms % 1000 };
+		std::chrono::steady_clock::time_point now{std::chrono::milliseconds(ms)};
+		uint64_t allocationsBefore = allocTrack::allocations();
+		
+		//Frame
+		if (pacer.frameDue(secondOfDay, now))
+		{
+			trace::begin(trace::EVENT::FRAME);
+			clockFace face = buildClockFace(curTime.hour, curTime.min, curTime.min + curTime.sec / 60.0f, HOUR_LEADING_ZERO);
+			trace::end(trace::EVENT::FRAME);
+			
+			pacer.frameDrawn(secondOfDay, now);
+			metrics::frameRendered();
+			frames += face.timeText[0] != 0;
+		}
+		
+		//Tasks, exactly as the clock runs them
+		runTasks(taskSchedule, state, curTime, secondOfDay);
+		
+		if (state.stateDirty)
+		{
+			savePersistedState(stateFile, taskSchedule, state, secondOfDay, secondOfDay);
+			state.stateDirty = false;
+			++dirtyIterations;
+		}
+		
+		++iterations;
+		
+		uint64_t allocated = allocTrack::allocations() - allocationsBefore;
+		if (secondOfDay < STARTUP_SECONDS)
+		{
+			startupAllocations += allocated;
+			continue;
+		}
+		
+		if (allocated && steadyAllocations < MAX_REPORTED_ITERATIONS)
+		{
+			std::printf("%02ld:%02ld:%02ld.%03ld %llu allocations\n", curTime.hour, curTime.min, curTime.sec, curTime.ms, static_cast<unsigned long long>(allocated));
+		}
+		steadyAllocations += allocated;
+	}
+	
+	double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+	
+	std::cout << iterations << " loop iterations (" << frames << " frames, " << tasksDispatched() - tasksAtStart << " tasks, " << dirtyIterations << " state saves) in "
+			  << seconds << " s" << std::endl;
+	std::cout << "Monitor writes: " << display.getBrightnessWrites() << " brightness, " << display.getOtherWrites() << " power and input" << std::endl;
+	std::cout << "Startup allocations: " << startupAllocations << ", steady state allocations: " << steadyAllocations << std::endl;
+	
+	if (steadyAllocations)
+	{
+		std::cerr << "ERROR: The steady state loop allocated" << std::endl;
+		return 1;
+	}
+	
+	std::cout << "OK" << std::endl;
+	
+	return 0;
+}
@@ -0,0 +1,156 @@
+/******************************************************************************
+/ Pi 4 Sunrise Clock App Allocation Tracking Implementation - lopezk38 2025
+/
+/*****************************************************************************/
+
+/******************************************************************************
+/ Dependencies, namespacing
+/*****************************************************************************/
+
+#include <atomic>
+#include <cstddef>
+#include <cstdlib>
+#include <new>
+
+#include "allocTrack.h"
+
+
+/******************************************************************************
+/ Counters
+/*****************************************************************************/
+
+#ifdef TRACK_ALLOCATIONS
+
+static std::atomic<uint64_t> allocationCount = 0;
+static std::atomic<uint64_t> freeCount = 0;
+static std::atomic<uint64_t> byteCount = 0;
+
+uint64_t allocTrack::allocations()
+{
+	return allocationCount.load(std::memory_order_relaxed);
+}
+
+uint64_t allocTrack::frees()
+{
+	return freeCount.load(std::memory_order_relaxed);
+}
+
+uint64_t allocTrack::bytesAllocated()
+{
+	return byteCount.load(std::memory_order_relaxed);
+}
+
+
+/******************************************************************************
+/ Global operator replacements
+/*****************************************************************************/
+
+//libstdc++ routes the nothrow forms through these, so this covers everything the app and the standard library allocate
+static void* countedAlloc(std::size_t size, std::size_t alignment)
+{
+	allocationCount.fetch_add(1, std::memory_order_relaxed);
+	byteCount.fetch_add(size, std::memory_order_relaxed);
+	
+	if (size == 0) size = 1;
+	
+	void* block;
+	if (alignment > alignof(std::max_align_t))
+	{
+		//aligned_alloc wants the size to be a multiple of the alignment
+		block = std::aligned_alloc(alignment, (size + alignment - 1) / alignment * alignment);
+	}
+	else block = std::malloc(size);
+	
+	if (!block) throw std::bad_alloc();
+	
+	return block;
+}
+
+static void countedFree(void* block)
+{
+	if (!block) return;
+	
+	freeCount.fetch_add(1, std::memory_order_relaxed);
+	std::free(block);
+	
+	return;
+}
+
+void* operator new(std::size_t size)
+{
+	return countedAlloc(size, 0);
+}
+
+void* operator new[](std::size_t size)
+{
+	return countedAlloc(size, 0);
+}
+
+void* operator new(std::size_t size, std::align_val_t alignment)
+{
+	return countedAlloc(size, static_cast<std::size_t>(alignment));
+}
+
+void* operator new[](std::size_t size, std::align_val_t alignment)
+{
+	return countedAlloc(size, static_cast<std::size_t>(alignment));
+}
+
+void operator delete(void* block) noexcept
+{
+	countedFree(block);
+}
+
+void operator delete[](void* block) noexcept
+{
+	countedFree(block);
+}
+
+void operator delete(void* block, std::size_t) noexcept
+{
+	countedFree(block);
+}
+
+void operator delete[](void* block, std::size_t) noexcept
+{
+	countedFree(block);
+}
+
+void operator delete(void* block, std::align_val_t) noexcept
+{
+	countedFree(block);
+}
+
+void operator delete[](void* block, std::align_val_t) noexcept
+{
+	countedFree(block);
+}
+
+void operator delete(void* block, std::size_t, std::align_val_t) noexcept
+{
+	countedFree(block);
+}
+
+void operator delete[](void* block, std::size_t, std::align_val_t) noexcept
+{
+	countedFree(block);
+}
+
+#else
+
+uint64_t allocTrack::allocations()
+{
+	return 0;
+}
+
+uint64_t allocTrack::frees()
+{
+	return 0;
+}
+
+uint64_t allocTrack::bytesAllocated()
+{
+	return 0;
+}
+
+#endif
@@ -0,0 +1,41 @@
+/******************************************************************************
+/ Pi 4 Sunrise Clock App Allocation Tracking Spec - lopezk38 2025
+/
+/ With TRACK_ALLOCATIONS defined, replaces the global operator new and delete
+/ with versions that count every call. The main loop uses it to flag frames
+/ that touch the heap once startup is over, and alloccheck to prove a whole
+/ simulated day gets through without any
+/
+/*****************************************************************************/
+
+#ifndef SUNCLOCK_APP_ALLOCTRACK
+#define SUNCLOCK_APP_ALLOCTRACK
+
+//#define TRACK_ALLOCATIONS
+
+/******************************************************************************
+/ Dependencies, namespacing
+/*****************************************************************************/
+
+#include <cstdint>
+
+
+/******************************************************************************
+/ Counters
+/*****************************************************************************/
+
+namespace allocTrack
+{
+	#ifdef TRACK_ALLOCATIONS
+	constexpr bool enabled = true;
+	#else
+	constexpr bool enabled = false;
+	#endif
+	
+	//Totals since the process started, across all threads. Always 0 when tracking is compiled out
+	uint64_t allocations();
+	uint64_t frees();
+	uint64_t bytesAllocated();
+}
+
+#endif
@@ -0,0 +1,141 @@
+/******************************************************************************
+/ Pi 4 Sunrise Clock App Settings - lopezk38 2025
+/
+/ Everything that tunes what the clock does and when. The clock and the
+/ headless tools that run its scheduler all build from these, so a tool can't
+/ quietly drift from what the clock really does. Debug builds get their own
+/ faster settings, so define DEBUG for every file or none of them
+/
+/*****************************************************************************/
+
+#ifndef SUNCLOCK_APP_CONFIG
+#define SUNCLOCK_APP_CONFIG
+
+//#define DEBUG
+
+/******************************************************************************
+/ Dependencies, namespacing
+/*****************************************************************************/
+
+#include <chrono>
+#include <cstddef>
+
+#include "clockSync.h"
+
+using namespace std::chrono_literals;
+
+
+/******************************************************************************
+/ Constants
+/*****************************************************************************/
+
+//Raylib Drawing Settings
+constexpr unsigned int FRAMEBUFFER_DEV = 0; // /dev/fb0
+constexpr unsigned int TEXT_SIZE = 250;
+
+//DDC (monitor control) settings
+constexpr unsigned char VCP_INPUT_CODE = 0x3; //DVI-D
+
+constexpr bool POWEROFF_ON_ZERO_BRIGHTNESS = true;
+
+#ifndef DEBUG
+constexpr unsigned int FRAME_RATE = 1; //FPS. Used as is when adaptive pacing is off
+
+//Adaptive pacing draws only as often as the colors visibly change, plus once a minute for the clock text
+constexpr bool ADAPTIVE_FRAME_PACING = true;
+constexpr std::chrono::milliseconds IDLE_POLL_INTERVAL = 100ms; //Longest the loop sleeps, keeps ESC responsive
+
+//Layered face with a sky gradient, date, next event and day progress, drawn on the CPU by the tile compositor. Setting SUNCLOCK_LAYERED_FACE also turns it on
+constexpr bool LAYERED_FACE_ENABLED = false;
+constexpr unsigned int COMPOSITOR_THREADS = 4; //One per Pi 4 core, the main thread included
+
+//Sky photos in place of the layered face's gradient, packed by skypack at the screen's resolution. Setting SUNCLOCK_SKY_SET to a path also turns them on, and the layered face with them
+constexpr bool SKY_IMAGES_ENABLED = false;
+constexpr char SKY_SET_PATH[] = "/var/lib/sunclock.sky";
+
+//Several clocks showing the same thing. One publishes its colors, brightness and power over multicast, the rest follow it. Setting SUNCLOCK_SYNC to publish or follow also turns it on
+constexpr bool CLOCK_SYNC_ENABLED = false;
+constexpr SYNC_ROLE::CODE CLOCK_SYNC_ROLE = SYNC_ROLE::CODE::FOLLOWER;
+
+constexpr std::chrono::minutes BRIGHTNESS_UPDATE_FREQ = 30min;
+
+constexpr std::chrono::minutes POWERCHECK_UPDATE_FREQ = 15min; //Power on and off delays are per monitor, see monitorQuirks.h
+
+//The curves are worked out a day at a time into a day plan. Brightness is sampled every BRIGHTNESS_UPDATE_FREQ and only changes are kept
+constexpr bool DAY_PLAN_ENABLED = true;
+
+//Warm restart settings
+constexpr char STATE_FILE_PATH[] = "/var/lib/sunclock.state";
+constexpr char MONITOR_PROFILE_PATH[] = "/var/lib/sunclock.monitors";
+
+//Control socket settings
+constexpr char CONTROL_SOCKET_PATH[] = "/run/sunclock.sock";
+
+//Metrics settings
+constexpr unsigned short METRICS_PORT = 9464; //Loopback only
+
+//Ambient light sensor settings. Setting SUNCLOCK_LIGHT_SENSOR to a path also turns the sensor on, handy for pointing at a plain file
+constexpr bool LIGHT_SENSOR_ENABLED = false;
+constexpr char LIGHT_SENSOR_PATH[] = "/sys/bus/iio/devices/iio:device0/in_illuminance_input";
+constexpr std::chrono::seconds LIGHT_SENSOR_SAMPLE_FREQ = 5s;
+constexpr unsigned int LIGHT_SENSOR_BATCH = 12; //Samples between brightness decisions
+
+//Display power state from the DRM connector, saving DDC reads. Setting SUNCLOCK_POWER_STATE to a directory with dpms and status files overrides the connector
+constexpr bool POWER_STATE_ENABLED = true;
+#else
+//Debug mode runs a quick color sweep, so everything is sped up to match
+constexpr unsigned int FRAME_RATE = 60; //FPS
+
+constexpr std::chrono::seconds BRIGHTNESS_UPDATE_FREQ = 5s;
+
+constexpr std::chrono::seconds POWERCHECK_UPDATE_FREQ = 5s;
+
+//The sweep fakes the time of day, which the plan would only fight with
+constexpr bool DAY_PLAN_ENABLED = false;
+
+//Keep the debug schedule out of the real state file
+constexpr char STATE_FILE_PATH[] = "/tmp/sunclock-debug.state";
+constexpr char MONITOR_PROFILE_PATH[] = "/tmp/sunclock-debug.monitors";
+
+constexpr char CONTROL_SOCKET_PATH[] = "/tmp/sunclock-debug.sock";
+
+constexpr unsigned short METRICS_PORT = 9465;
+
+constexpr bool LIGHT_SENSOR_ENABLED = false;
+constexpr char LIGHT_SENSOR_PATH[] = "/tmp/sunclock-debug.lux";
+constexpr std::chrono::seconds LIGHT_SENSOR_SAMPLE_FREQ = 1s;
+constexpr unsigned int LIGHT_SENSOR_BATCH = 3;
+
+constexpr bool POWER_STATE_ENABLED = false;
+#endif
+
+//Adaptive pacing limits. Debug builds draw at a fixed rate, but alloccheck paces its simulated day with these either way
+constexpr double PACING_STEP_THRESHOLD = 0.5; //Max color levels a channel may move between frames
+constexpr double PACING_MAX_FPS = 60;
+constexpr double PACING_MIN_FPS = 1.0 / 600; //Slower than this counts as static
+
+constexpr std::chrono::hours STATE_MAX_AGE = 24h; //Saved state older than this is thrown away
+
+constexpr std::chrono::seconds PLAN_POWER_ON_LEAD = 5s; //Covers the slowest power sequence, so the display is up for the first brightness of the day
+
+constexpr long SYNC_POWER_STEP_WINDOW = 60; //Seconds past a publisher's announced power step a follower still takes it without waiting to hear
+
+constexpr size_t TASK_INBOX_CAPACITY = 64; //Tasks other threads can queue between two loop iterations. Pushes past this are dropped
+
+//DDC timing calibration. Run with SUNCLOCK_DDC_CALIBRATE set to probe the monitor and store the result
+constexpr float DDC_CALIBRATION_STEPS[] = { 1.0f, 0.75f, 0.5f, 0.35f, 0.25f, 0.15f, 0.1f }; //Sleep multipliers tried, slowest first
+constexpr unsigned int DDC_CALIBRATION_ROUNDS = 8; //Transactions that must all verify at a step
+constexpr unsigned int DDC_CALIBRATION_MARGIN = 1; //Steps backed off from the fastest that passed
+constexpr unsigned char DDC_CALIBRATION_VCP = 0x10; //Brightness. Only this code is measured, so power and input stay on the default timing
+constexpr unsigned int DDC_TIMING_MAX_FAILURES = 3; //Calibrated timing is dropped for the run after this many retries
+
+//Power on readiness polling. Each step goes ahead as soon as the monitor answers, the per monitor delays are only the upper bound
+constexpr bool WAKE_READINESS_POLLING = true; //SUNCLOCK_WAKE_FIXED_DELAYS turns it off, to compare against the fixed delays
+constexpr std::chrono::milliseconds WAKE_PROBE_FIRST_INTERVAL = 100ms;
+constexpr std::chrono::milliseconds WAKE_PROBE_MAX_INTERVAL = 800ms; //Backoff doubles up to this
+
+//Time settings
+constexpr int TIMEZONE_OFFSET = -7; //Pacific time
+static_assert(TIMEZONE_OFFSET > -24 || TIMEZONE_OFFSET < 24, "TIMEZONE_OFFSET must be a valid timezone");
+
+#endif
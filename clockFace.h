@@ -0,0 +1,88 @@
+/******************************************************************************
+/ Pi 4 Sunrise Clock App Clock Face - lopezk38 2025
+/
+/ Everything that decides what a frame looks like, kept apart from the raylib
+/ draw calls so goldencheck can build the same faces without a display
+/
+/*****************************************************************************/
+
+#ifndef SUNCLOCK_APP_CLOCKFACE
+#define SUNCLOCK_APP_CLOCKFACE
+
+/******************************************************************************
+/ Dependencies, namespacing
+/*****************************************************************************/
+
+#include <cstddef>
+#include <cstdint>
+
+#include "raylib.h"
+#include "sunColorCurveLUT.h"
+#include "clockTextColorCurveLUT.h"
+
+
+/******************************************************************************
+/ Constants, structs
+/*****************************************************************************/
+
+constexpr size_t CLOCK_TEXT_MAX = 6; //"12:59" plus the terminator
+constexpr bool HOUR_LEADING_ZERO = true; //Here rather than in main.cpp so the headless tools build the same faces the clock does
+
+struct clockFace
+{
+	Color background;
+	Color text;
+	char timeText[CLOCK_TEXT_MAX];
+};
+
+
+/******************************************************************************
+/ Implementation
+/*****************************************************************************/
+
+inline void formatClockText(char* out, long hour, long minute, bool leadingZero)
+{
+	//Convert from military hour to regular AM/PM hours (0-24 to 0-12)
+	short stdHr = hour % 12;
+	if (stdHr == 0) stdHr = 12;
+	
+	size_t pos = 0;
+	if (stdHr >= 10) out[pos++] = '0' + stdHr / 10;
+	else if (leadingZero) out[pos++] = '0'; //Add a leading 0 to hours if leadingZero is on and hour is a single digit number
+	out[pos++] = '0' + stdHr % 10;
+	out[pos++] = ':';
+	out[pos++] = '0' + minute / 10; //Minutes always get their leading zero
+	out[pos++] = '0' + minute % 10;
+	out[pos] = '\0';
+	
+	return;
+}
+
+//FNV-1a over the curve tables. Two builds with the same number draw the same faces
+inline uint32_t curveChecksum()
+{
+	const unsigned char* tables[] = { reinterpret_cast<const unsigned char*>(SunColor::sunColorLUT), reinterpret_cast<const unsigned char*>(ClockTextColor::TextColorLUT), SunBrightness::sunBrightnessLUT };
+	const size_t sizes[] = { sizeof(SunColor::sunColorLUT), sizeof(ClockTextColor::TextColorLUT), sizeof(SunBrightness::sunBrightnessLUT) };
+	
+	uint32_t hash = 2166136261u;
+	for (size_t table = 0; table < 3; ++table)
+	{
+		for (size_t i = 0; i < sizes[table]; ++i) hash = (hash ^ tables[table][i]) * 16777619u;
+	}
+	
+	//The color model picks which tables are drawn from
+	return (hash ^ ACTIVE_COLOR_MODEL) * 16777619u;
+}
+
+inline clockFace buildClockFace(long hour, long minute, float fractionalMinute, bool leadingZero)
+{
+	clockFace face;
+	
+	face.background = SunColor::interp(hour, fractionalMinute);
+	face.text = ClockTextColor::interp(hour, fractionalMinute);
+	formatClockText(face.timeText, hour, minute, leadingZero);
+	
+	return face;
+}
+
+#endif
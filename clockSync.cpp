@@ -0,0 +1,363 @@
+/******************************************************************************
+/ Pi 4 Sunrise Clock App Clock Sync Implementation - lopezk38 2025
+/
+/*****************************************************************************/
+
+/******************************************************************************
+/ Dependencies, namespacing
+/*****************************************************************************/
+
+#include <unistd.h>
+#include <sys/socket.h>
+#include <arpa/inet.h>
+#include <strings.h>
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <ctime>
+#include <random>
+
+#include "clockSync.h"
+#include "metrics.h"
+#include "logger.h"
+
+
+/******************************************************************************
+/ Helpers
+/*****************************************************************************/
+
+static int64_t realtimeNs()
+{
+	timespec now;
+	clock_gettime(CLOCK_REALTIME, &now);
+	
+	return static_cast<int64_t>(now.tv_sec) * 1000000000 + now.tv_nsec;
+}
+
+const char* SYNC_ROLE::toString(SYNC_ROLE::CODE role)
+{
+	switch (role)
+	{
+		case SYNC_ROLE::CODE::PUBLISHER: return "publish";
+		case SYNC_ROLE::CODE::FOLLOWER: return "follow";
+	}
+	
+	return "unknown";
+}
+
+bool SYNC_ROLE::fromString(const char* name, SYNC_ROLE::CODE& role)
+{
+	if (!strcasecmp(name, "publish")) role = SYNC_ROLE::CODE::PUBLISHER;
+	else if (!strcasecmp(name, "follow")) role = SYNC_ROLE::CODE::FOLLOWER;
+	else return false;
+	
+	return true;
+}
+
+
+/******************************************************************************
+/ Class implementation
+/*****************************************************************************/
+
+ClockSync::ClockSync(SYNC_ROLE::CODE role, const std::string& group, unsigned short port, const std::string& interfaceAddress): role(role)
+{
+	//0 means no publisher to a follower
+	std::random_device random;
+	while (!this->instance) this->instance = random();
+	
+	//Not fatal either way. Every instance can still run off its own curves
+	if (openSocket(group, port, interfaceAddress) != SYNC_ERR::CODE::SUCCESS)
+	{
+		errorState = true;
+		logger::warning("Clock sync is unavailable, running off this clock's own curves");
+	}
+	
+	return;
+}
+
+ClockSync::~ClockSync()
+{
+	if (this->socketDescriptor != -1) close(this->socketDescriptor);
+	
+	return;
+}
+
+SYNC_ERR::CODE ClockSync::openSocket(const std::string& group, unsigned short port, const std::string& interfaceAddress)
+{
+	in_addr interface = { htonl(INADDR_ANY) };
+	if (inet_pton(AF_INET, group.c_str(), &this->groupAddress.sin_addr) != 1 || (!interfaceAddress.empty() && inet_pton(AF_INET, interfaceAddress.c_str(), &interface) != 1))
+	{
+		logger::error("Clock sync group {} or interface {} isn't an IPv4 address", group, interfaceAddress);
+		return SYNC_ERR::CODE::BAD_ADDRESS;
+	}
+	this->groupAddress.sin_family = AF_INET;
+	this->groupAddress.sin_port = htons(port);
+	
+	this->socketDescriptor = socket(AF_INET, SOCK_DGRAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+	if (this->socketDescriptor == -1)
+	{
+		logger::error("Failed to create clock sync socket: {}", std::strerror(errno));
+		return SYNC_ERR::CODE::OPEN_FAIL;
+	}
+	
+	//A unicast address works too, for a single follower
+	bool multicast = IN_MULTICAST(ntohl(this->groupAddress.sin_addr.s_addr));
+	
+	if (this->role == SYNC_ROLE::CODE::PUBLISHER)
+	{
+		//One hop, so it never leaves the LAN. Looped back to followers on the same box, which is also how one Pi tests against itself
+		unsigned char hops = 1;
+		unsigned char loop = 1;
+		setsockopt(this->socketDescriptor, IPPROTO_IP, IP_MULTICAST_TTL, &hops, sizeof(hops));
+		setsockopt(this->socketDescriptor, IPPROTO_IP, IP_MULTICAST_LOOP, &loop, sizeof(loop));
+		if (interface.s_addr != htonl(INADDR_ANY)) setsockopt(this->socketDescriptor, IPPROTO_IP, IP_MULTICAST_IF, &interface, sizeof(interface));
+		
+		return SYNC_ERR::CODE::SUCCESS;
+	}
+	
+	//Any number of followers can share a box and a port. Each gets its own copy
+	int reuse = 1;
+	setsockopt(this->socketDescriptor, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+	
+	//Bound to the group itself, so nothing else sent to the port gets in
+	sockaddr_in local = {};
+	local.sin_family = AF_INET;
+	local.sin_port = htons(port);
+	local.sin_addr.s_addr = multicast ? this->groupAddress.sin_addr.s_addr : htonl(INADDR_ANY);
+	
+	if (bind(this->socketDescriptor, reinterpret_cast<sockaddr*>(&local), sizeof(local)))
+	{
+		logger::error("Failed to bind clock sync socket on port {}: {}", port, std::strerror(errno));
+		return SYNC_ERR::CODE::BIND_FAIL;
+	}
+	
+	if (multicast)
+	{
+		ip_mreq membership = {};
+		membership.imr_multiaddr = this->groupAddress.sin_addr;
+		membership.imr_interface = interface;
+		
+		if (setsockopt(this->socketDescriptor, IPPROTO_IP, IP_ADD_MEMBERSHIP, &membership, sizeof(membership)))
+		{
+			logger::error("Failed to join clock sync group {}: {}", group, std::strerror(errno));
+			return SYNC_ERR::CODE::JOIN_FAIL;
+		}
+	}
+	
+	return SYNC_ERR::CODE::SUCCESS;
+}
+
+bool ClockSync::isOpen()
+{
+	return !this->errorState;
+}
+
+SYNC_ROLE::CODE ClockSync::getRole() const
+{
+	return this->role;
+}
+
+int ClockSync::getDescriptor()
+{
+	return this->socketDescriptor;
+}
+
+bool ClockSync::sendPacket(const syncState& state, uint32_t fieldMask, bool keyframe)
+{
+	uint8_t packet[SYNC_MAX_PACKET];
+	
+	syncHeader header = {};
+	header.magic = SYNC_MAGIC;
+	header.version = SYNC_VERSION;
+	header.keyframe = keyframe;
+	header.instance = this->instance;
+	header.sequence = this->sequence;
+	
+	size_t length = sizeof(header);
+	for (uint8_t field = 0; field < SYNC_FIELD::COUNT; ++field)
+	{
+		if (!(fieldMask & SYNC_FIELD::bit(static_cast<SYNC_FIELD::CODE>(field)))) continue;
+		
+		packet[length] = field;
+		std::memcpy(packet + length + 1, &state.fields[field], sizeof(uint32_t));
+		length += SYNC_RECORD_SIZE;
+		++header.fieldCount;
+	}
+	
+	//Stamped last, so the latency followers see is the network and not the packing
+	header.sentNs = realtimeNs();
+	std::memcpy(packet, &header, sizeof(header));
+	
+	if (sendto(this->socketDescriptor, packet, length, MSG_DONTWAIT, reinterpret_cast<sockaddr*>(&this->groupAddress), sizeof(this->groupAddress)) != static_cast<ssize_t>(length))
+	{
+		//Left to the next call. Followers only notice a gap in the sequence if one was really sent
+		return false;
+	}
+	
+	++this->sequence;
+	++this->packets;
+	this->bytes += length;
+	if (keyframe) ++this->keyframes;
+	metrics::syncSent(length);
+	
+	return true;
+}
+
+bool ClockSync::publish(const syncState& state, std::chrono::steady_clock::time_point now)
+{
+	if (this->errorState || this->role != SYNC_ROLE::CODE::PUBLISHER) return false;
+	
+	uint32_t changed = 0;
+	for (uint8_t field = 0; field < SYNC_FIELD::COUNT; ++field)
+	{
+		if (state.fields[field] != this->sent.fields[field]) changed |= SYNC_FIELD::bit(static_cast<SYNC_FIELD::CODE>(field));
+	}
+	
+	bool keyframe = !this->sentAny || now - this->lastKeyframe >= SYNC_KEYFRAME_INTERVAL;
+	if (keyframe) changed = SYNC_FIELD::ALL;
+	else if (!changed && now - this->lastSend < SYNC_HEARTBEAT_INTERVAL) return false;
+	
+	//A failed send is retried next call at the earliest, a failed heartbeat a whole interval later
+	this->lastSend = now;
+	if (!sendPacket(state, changed, keyframe)) return false;
+	
+	this->sent = state;
+	this->sentAny = true;
+	if (keyframe) this->lastKeyframe = now;
+	
+	return true;
+}
+
+uint32_t ClockSync::applyPacket(const uint8_t* packet, size_t length, std::chrono::steady_clock::time_point now)
+{
+	syncHeader header;
+	if (length < sizeof(header)) return 0;
+	std::memcpy(&header, packet, sizeof(header));
+	
+	if (header.magic != SYNC_MAGIC || header.version != SYNC_VERSION || length < sizeof(header) + header.fieldCount * SYNC_RECORD_SIZE) return 0;
+	
+	if (!this->following)
+	{
+		//Deltas mean nothing without the fields they change. Whoever sends a full copy first is followed
+		if (!header.keyframe) return 0;
+		
+		this->publisher = header.instance;
+		this->expectedSequence = header.sequence;
+	}
+	else if (header.instance != this->publisher) return 0; //Only one publisher is followed at a time
+	
+	//Older than expected is a duplicate or came out of order, and is already out of date
+	uint32_t missed = header.sequence - this->expectedSequence;
+	if (missed >= 0x80000000u) return 0;
+	this->expectedSequence = header.sequence + 1;
+	
+	//Whatever a lost delta changed stays out of date until the field changes again or the next keyframe
+	uint32_t changed = 0;
+	const uint8_t* record = packet + sizeof(header);
+	for (uint8_t i = 0; i < header.fieldCount; ++i, record += SYNC_RECORD_SIZE)
+	{
+		uint8_t field = record[0];
+		if (field >= SYNC_FIELD::COUNT) continue;
+		
+		uint32_t value;
+		std::memcpy(&value, record + 1, sizeof(value));
+		if (this->received.fields[field] == value) continue;
+		
+		this->received.fields[field] = value;
+		changed |= SYNC_FIELD::bit(static_cast<SYNC_FIELD::CODE>(field));
+	}
+	
+	//Clocks a little out of step can make a packet look like it arrived before it was sent
+	int64_t latencyMicros = std::max<int64_t>(0, (realtimeNs() - header.sentNs) / 1000);
+	this->lastLatencyMicros = latencyMicros;
+	this->gaps += missed;
+	++this->packets;
+	this->bytes += length;
+	if (header.keyframe) ++this->keyframes;
+	metrics::syncReceived(length, latencyMicros, missed);
+	
+	this->lastHeard = now;
+	
+	if (!this->following)
+	{
+		this->following = true;
+		logger::info("Following clock sync publisher {}", this->publisher);
+		
+		return SYNC_FIELD::ALL; //Everything moves over from this clock's own curves
+	}
+	
+	return changed;
+}
+
+uint32_t ClockSync::receive(std::chrono::steady_clock::time_point now)
+{
+	if (this->errorState || this->role != SYNC_ROLE::CODE::FOLLOWER) return 0;
+	
+	uint32_t changed = 0;
+	uint8_t packet[SYNC_MAX_PACKET + 1]; //One over, so a packet too long for this version still reads as one
+	
+	for (unsigned int i = 0; i < SYNC_MAX_PACKETS_PER_RECEIVE; ++i)
+	{
+		ssize_t length = recv(this->socketDescriptor, packet, sizeof(packet), MSG_DONTWAIT);
+		if (length < 0) break;
+		
+		changed |= applyPacket(packet, length, now);
+	}
+	
+	if (this->following && now - this->lastHeard > SYNC_PUBLISHER_TIMEOUT)
+	{
+		this->following = false;
+		logger::warning("Clock sync publisher {} went quiet, back on this clock's own curves", this->publisher);
+		
+		return SYNC_FIELD::ALL;
+	}
+	
+	return changed;
+}
+
+void ClockSync::applyAhead(SYNC_FIELD::CODE field, uint32_t value)
+{
+	this->received.set(field, value);
+	
+	return;
+}
+
+bool ClockSync::isFollowing() const
+{
+	return this->following;
+}
+
+const syncState& ClockSync::getState() const
+{
+	return this->received;
+}
+
+uint32_t ClockSync::getPublisher() const
+{
+	return this->publisher;
+}
+
+uint64_t ClockSync::getPackets() const
+{
+	return this->packets;
+}
+
+uint64_t ClockSync::getBytes() const
+{
+	return this->bytes;
+}
+
+uint64_t ClockSync::getKeyframes() const
+{
+	return this->keyframes;
+}
+
+uint64_t ClockSync::getGaps() const
+{
+	return this->gaps;
+}
+
+int64_t ClockSync::getLastLatencyMicros() const
+{
+	return this->lastLatencyMicros;
+}
@@ -0,0 +1,190 @@
+/******************************************************************************
+/ Pi 4 Sunrise Clock App Clock Sync Class Spec - lopezk38 2025
+/
+/ Keeps several clocks showing the same thing. One instance publishes what its
+/ curves say right now over UDP multicast: its colors, brightness, power state
+/ and when its day plan next turns the display on or off. Every other instance
+/ follows it and draws those instead of working them out from its own clock
+/
+/ Only fields that changed are sent. A full copy goes out every so often for
+/ followers that just joined or lost a packet, and a bare heartbeat when
+/ nothing changed, so followers can tell a quiet publisher from a dead one.
+/ Packets are in the Pi's own byte order, every instance is a Pi
+/
+/*****************************************************************************/
+
+#ifndef SUNCLOCK_APP_CLOCKSYNC
+#define SUNCLOCK_APP_CLOCKSYNC
+
+/******************************************************************************
+/ Dependencies, namespacing
+/*****************************************************************************/
+
+#include <chrono>
+#include <cstdint>
+#include <cstddef>
+#include <string>
+#include <netinet/in.h>
+
+#include "errorcodes.h"
+
+using namespace std::chrono_literals;
+
+
+/******************************************************************************
+/ Constants, enums, structs
+/*****************************************************************************/
+
+constexpr uint32_t SYNC_MAGIC = 0x434E5953; //"SYNC"
+constexpr uint16_t SYNC_VERSION = 1;
+
+constexpr char SYNC_DEFAULT_GROUP[] = "239.255.42.99"; //Organization local scope, never leaves the site
+constexpr unsigned short SYNC_DEFAULT_PORT = 45454;
+
+constexpr std::chrono::milliseconds SYNC_HEARTBEAT_INTERVAL = 1000ms; //Longest the publisher stays quiet
+constexpr std::chrono::milliseconds SYNC_KEYFRAME_INTERVAL = 5000ms; //Longest a follower waits to join or recover from a lost packet
+constexpr std::chrono::milliseconds SYNC_PUBLISHER_TIMEOUT = 3500ms; //Followers go back to their own curves after this long without a packet
+constexpr unsigned int SYNC_MAX_PACKETS_PER_RECEIVE = 32; //Bounds the work done per loop iteration
+
+constexpr uint32_t SYNC_NO_STEP = 0xFFFFFFFF; //POWER_STEP when no power change is planned
+
+namespace SYNC_ROLE
+{
+	enum CODE
+	{
+		PUBLISHER,
+		FOLLOWER
+	};
+	
+	const char* toString(SYNC_ROLE::CODE role);
+	bool fromString(const char* name, SYNC_ROLE::CODE& role); //"publish" or "follow". False for anything else
+}
+
+namespace SYNC_FIELD
+{
+	enum CODE : uint8_t
+	{
+		BACKGROUND = 0, //Colors are packed R, G, B, A from the low byte up
+		TEXT = 1,
+		BRIGHTNESS = 2,
+		DISPLAY_ON = 3, //Power state the publisher wants, so followers start a power on at the same time it does
+		POWER_STEP_AT = 4, //Second of the day the publisher's plan next changes the power
+		POWER_STEP = 5, //1 for on, 0 for off
+		CURVE_CHECKSUM = 6, //Followers with different curves can't stand in for a lost publisher
+		COUNT
+	};
+	
+	constexpr uint32_t bit(SYNC_FIELD::CODE field)
+	{
+		return 1u << field;
+	}
+	
+	constexpr uint32_t ALL = (1u << COUNT) - 1;
+}
+
+struct syncState
+{
+	uint32_t fields[SYNC_FIELD::COUNT] = {};
+	
+	uint32_t get(SYNC_FIELD::CODE field) const
+	{
+		return this->fields[field];
+	}
+	
+	void set(SYNC_FIELD::CODE field, uint32_t value)
+	{
+		this->fields[field] = value;
+		
+		return;
+	}
+};
+
+//On the wire. A header, then fieldCount records of a field code and its value
+struct syncHeader
+{
+	uint32_t magic;
+	uint16_t version;
+	uint8_t keyframe; //Every field is in this one
+	uint8_t fieldCount;
+	uint32_t instance; //Picked at random per run, so a restarted publisher is a new one
+	uint32_t sequence;
+	int64_t sentNs; //CLOCK_REALTIME. Only means anything between clocks kept in step by NTP
+};
+static_assert(sizeof(syncHeader) == 24, "syncHeader must pack to 24 bytes");
+
+constexpr size_t SYNC_RECORD_SIZE = 1 + sizeof(uint32_t);
+constexpr size_t SYNC_MAX_PACKET = sizeof(syncHeader) + SYNC_FIELD::COUNT * SYNC_RECORD_SIZE;
+
+
+/******************************************************************************
+/ Class specification
+/*****************************************************************************/
+
+class ClockSync
+{
+
+private:
+
+	const SYNC_ROLE::CODE role;
+	int socketDescriptor = -1;
+	sockaddr_in groupAddress = {};
+	
+	//Publisher
+	uint32_t instance = 0;
+	uint32_t sequence = 0;
+	syncState sent; //What followers were last told
+	bool sentAny = false;
+	std::chrono::steady_clock::time_point lastSend;
+	std::chrono::steady_clock::time_point lastKeyframe;
+	
+	//Follower
+	syncState received;
+	uint32_t publisher = 0; //Instance being followed. 0 before the first keyframe
+	uint32_t expectedSequence = 0;
+	bool following = false;
+	std::chrono::steady_clock::time_point lastHeard;
+	
+	//Packets sent or taken in, and bytes of them
+	uint64_t packets = 0;
+	uint64_t bytes = 0;
+	uint64_t keyframes = 0;
+	uint64_t gaps = 0; //Packets a follower never saw
+	int64_t lastLatencyMicros = -1;
+	
+	bool errorState = false;
+	
+	SYNC_ERR::CODE openSocket(const std::string& group, unsigned short port, const std::string& interfaceAddress);
+	bool sendPacket(const syncState& state, uint32_t fieldMask, bool keyframe);
+	uint32_t applyPacket(const uint8_t* packet, size_t length, std::chrono::steady_clock::time_point now);
+
+public:
+
+	//An empty interface address leaves the choice to the routing table
+	ClockSync(SYNC_ROLE::CODE role, const std::string& group = SYNC_DEFAULT_GROUP, unsigned short port = SYNC_DEFAULT_PORT, const std::string& interfaceAddress = "");
+	~ClockSync();
+	
+	bool isOpen();
+	SYNC_ROLE::CODE getRole() const;
+	int getDescriptor(); //Followers only. Readable when a packet is waiting
+	
+	//Publisher. Call every loop iteration. Sends only what changed since last time, unless a keyframe or heartbeat is due. False if nothing went out
+	bool publish(const syncState& state, std::chrono::steady_clock::time_point now);
+	
+	//Follower. Non blocking, takes in everything waiting. Returns a bit per field that changed
+	uint32_t receive(std::chrono::steady_clock::time_point now);
+	
+	//Follower. Applies a change the publisher announced ahead of time, without waiting for it to say so. The next keyframe puts back anything it didn't do after all
+	void applyAhead(SYNC_FIELD::CODE field, uint32_t value);
+	
+	bool isFollowing() const; //Heard a keyframe, and the publisher hasn't gone quiet since
+	const syncState& getState() const;
+	uint32_t getPublisher() const;
+	
+	uint64_t getPackets() const;
+	uint64_t getBytes() const;
+	uint64_t getKeyframes() const;
+	uint64_t getGaps() const;
+	int64_t getLastLatencyMicros() const; //Send to apply, for the last packet taken in. -1 before the first
+};
+
+#endif
@@ -0,0 +1,452 @@
+/******************************************************************************
+/ Pi 4 Sunrise Clock App Clock Tasks Implementation - lopezk38 2025
+/
+/*****************************************************************************/
+
+/******************************************************************************
+/ Dependencies, namespacing
+/*****************************************************************************/
+
+#include <algorithm>
+#include <chrono>
+
+#include "clockTasks.h"
+#include "sunColorCurveLUT.h"
+#include "metrics.h"
+#include "trace.h"
+#include "logger.h"
+
+
+/******************************************************************************
+/ Globals
+/*****************************************************************************/
+
+powerSequenceSteps activePowerSequence = POWER_SEQUENCES[POWER_SEQUENCE::CODE::UNKNOWN];
+
+
+/******************************************************************************
+/ Implementation
+/*****************************************************************************/
+
+long toSecondOfDay(const timeStruct& curTime)
+{
+	return (curTime.hour * 60 + curTime.min) * 60 + curTime.sec;
+}
+
+void runTasks(tHeap::TaskHeap& taskSchedule, clockState& state, const timeStruct& curTime, long now)
+{
+	//A power on waiting on the monitor may be able to go ahead early
+	pollWakeProbe(taskSchedule, state);
+	
+	//Plan steps first, so a power on they queue runs in the same pass
+	if (state.dayPlan) runDayPlan(taskSchedule, state, curTime);
+	
+	runDueTasks(taskSchedule, state, curTime, now);
+	
+	return;
+}
+
+void runDueTasks(tHeap::TaskHeap& taskSchedule, clockState& state, const timeStruct& curTime, long now)
+{
+	//Periodic tasks come back already rescheduled for their next deadline
+	tHeap::Task taskToExecute;
+	while (taskSchedule.popDueTask(now, taskToExecute))
+	{
+		//Times 0 and 1 mean "as soon as possible", so they are never late
+		long nowMs = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+		long latenessMs = (taskToExecute.scheduledTime > 1) ? nowMs - taskToExecute.scheduledTime * 1000 : 0;
+		metrics::taskDispatched(taskToExecute.task, latenessMs);
+		
+		//Time to execute
+		persistedFields before = persistedFieldsOf(taskSchedule, state);
+		if (tHeap::TASK::isValidTaskCode(taskToExecute.task)) executeTask(taskSchedule, state, curTime, now, taskToExecute.task);
+		else logger::error("Attempted to run invalid task!");
+		
+		//A periodic task coming round again, like a light sensor sample, isn't worth a save unless it changed something. A one shot leaving the schedule is
+		if (!taskToExecute.period || persistedFieldsOf(taskSchedule, state) != before) state.stateDirty = true;
+	}
+	
+	return;
+}
+
+void runDayPlan(tHeap::TaskHeap& taskSchedule, clockState& state, const timeStruct& curTime)
+{
+	long secondOfDay = toSecondOfDay(curTime);
+	
+	planStep step;
+	while (state.dayPlan->nextDue(secondOfDay, step))
+	{
+		//Counted as the task it stands in for, so metrics and tracing see it the same as before. A step left from before midnight is counted on time
+		tHeap::TASK::CODE task = (step.action == PLAN_ACTION::CODE::SET_BRIGHTNESS) ? tHeap::TASK::CODE::SET_BRIGHTNESS : tHeap::TASK::CODE::CHECK_SHOULD_TOGGLE_DISPLAY_PWR;
+		trace::scope taskTrace(trace::EVENT::TASK, task);
+		metrics::taskDispatched(task, std::max(0L, (secondOfDay - step.secondOfDay) * 1000 + curTime.ms));
+		
+		persistedFields before = persistedFieldsOf(taskSchedule, state);
+		
+		//The plan already worked the curve out. Only the sensor, overrides and a publisher get a say on top
+		if (step.action == PLAN_ACTION::CODE::SET_BRIGHTNESS) applyBrightness(state, adjustCurveBrightness(state, step.value));
+		else if (state.powerOverride == -1 && !(state.sync && state.sync->isFollowing())) requestPower(taskSchedule, state, step.action == PLAN_ACTION::CODE::POWER_ON);
+		
+		if (persistedFieldsOf(taskSchedule, state) != before) state.stateDirty = true;
+	}
+	
+	return;
+}
+
+void executeTask(tHeap::TaskHeap& taskSchedule, clockState& state, const timeStruct& curTime, long now, tHeap::TASK::CODE task)
+{
+	trace::scope taskTrace(trace::EVENT::TASK, task);
+	
+	switch (task)
+	{
+		default:
+		case tHeap::TASK::CODE::NONE:
+		{
+			//Do nothing
+			break;
+		}
+		
+		case tHeap::TASK::CODE::SET_INPUT:
+		{
+			if (state.display->setInput(VCP_INPUT_CODE)) state.currentInput = VCP_INPUT_CODE; //Execute
+			
+			break;
+		}
+		
+		case tHeap::TASK::CODE::CHECK_SHOULD_TOGGLE_DISPLAY_PWR:
+		{
+			logger::verbose("Checking if we should toggle the display power. Current brightness is {}%", state.currentBrightness);
+			
+			//A forced power state from the control socket wins over the brightness rule. The plan knows ahead of time when it needs the display back
+			bool curveWantsOn = state.dayPlan ? state.dayPlan->powerOnAt(toSecondOfDay(curTime)) : static_cast<bool>(state.currentBrightness);
+			if (state.sync && state.sync->isFollowing()) curveWantsOn = state.sync->getState().get(SYNC_FIELD::CODE::DISPLAY_ON); //The publisher's wins over this clock's own
+			bool wantOn = (state.powerOverride == -1) ? curveWantsOn : state.powerOverride;
+			
+			requestPower(taskSchedule, state, wantOn);
+			
+			break;
+		}
+		
+		case tHeap::TASK::CODE::DISPLAY_OFF_AND_RESCHEDULE:
+		{
+			//The check that queued this is periodic and already rescheduled itself
+			
+			//Bleed through
+		}
+		case tHeap::TASK::CODE::DISPLAY_OFF:
+		{
+			//Restored state can vouch for the display already being off, saving the DDC read
+			if (state.powerStateTrusted && !state.displayOn)
+			{
+				state.powerStateTrusted = false;
+				break;
+			}
+			state.powerStateTrusted = false;
+			
+			if (state.display->powerOff()) //Execute
+			{
+				state.displayOn = false;
+				metrics::setPowerOn(false);
+				
+				//An unproven sequence gets read back, in case the monitor took the write and ignored it
+				if (activePowerSequence.verifyDelay.count()) taskSchedule.pushTask(now + activePowerSequence.verifyDelay.count(), tHeap::TASK::CODE::VERIFY_DISPLAY_PWR);
+			}
+			
+			break;
+		}
+		
+		case tHeap::TASK::CODE::DISPLAY_ON_STEP1_AND_RESCHEDULE:
+		{
+			//Make sure display is not on. Restored state can stand in for the DDC read once after a warm restart
+			bool displayIsOn = state.powerStateTrusted ? state.displayOn : state.display->isOn();
+			state.powerStateTrusted = false;
+			
+			if (displayIsOn)
+			{
+				//It's on already. Nothing to do until the next check
+				
+				logger::verbose("Requested display to power on but it was already on");
+				
+				break;
+			}
+			
+			//Execute. Some monitors must have their input set to soft wake them before they will accept the power on command
+			if (activePowerSequence.wakeInput) state.display->setInput(VCP_INPUT_CODE);
+			
+			//Schedule next step. Without the input step it's due right away and runs in this same pass
+			state.powerSequence = taskSchedule.pushTask(now + activePowerSequence.wakeDelay.count(), tHeap::TASK::CODE::DISPLAY_ON_STEP2_AND_RESCHEDULE);
+			if (activePowerSequence.wakeInput) startWakeProbe(state, state.powerSequence, WAKE_PROBE::CODE::INPUT_SELECTED);
+			state.wake.started = std::chrono::steady_clock::now();
+			
+			break;
+		}
+		
+		case tHeap::TASK::CODE::DISPLAY_ON_STEP1:
+		{
+			//Execute. Some monitors must have their input set to soft wake them before they will accept the power on command
+			if (activePowerSequence.wakeInput) state.display->setInput(VCP_INPUT_CODE);
+			
+			//Schedule next step. Without the input step it's due right away and runs in this same pass
+			state.powerSequence = taskSchedule.pushTask(now + activePowerSequence.wakeDelay.count(), tHeap::TASK::CODE::DISPLAY_ON_STEP2);
+			if (activePowerSequence.wakeInput) startWakeProbe(state, state.powerSequence, WAKE_PROBE::CODE::INPUT_SELECTED);
+			state.wake.started = std::chrono::steady_clock::now();
+			
+			break;
+		}
+		
+		case tHeap::TASK::CODE::DISPLAY_ON_STEP2_AND_RESCHEDULE:
+		{
+			//The check that started this is periodic and already rescheduled itself
+			
+			//Bleed through
+		}
+		case tHeap::TASK::CODE::DISPLAY_ON_STEP2:
+		{
+			bool poweredOn = state.display->powerOn(); //Execute
+			if (poweredOn)
+			{
+				state.displayOn = true;
+				metrics::setPowerOn(true);
+				
+				if (activePowerSequence.verifyDelay.count()) taskSchedule.pushTask(now + activePowerSequence.verifyDelay.count(), tHeap::TASK::CODE::VERIFY_DISPLAY_PWR);
+			}
+			
+			//Schedule brightness update. Sooner if the monitor says it's up before then
+			tHeap::taskHandle brightnessStep = taskSchedule.pushTask(now + activePowerSequence.settleDelay.count(), tHeap::TASK::CODE::SET_BRIGHTNESS);
+			if (poweredOn) startWakeProbe(state, brightnessStep, WAKE_PROBE::CODE::POWERED_ON);
+			
+			break;
+		}
+		
+		case tHeap::TASK::CODE::DISPLAY_TOGGLE_STEP1:
+		{
+			state.display->setInput(VCP_INPUT_CODE); //Execute. Must set input to soft wake monitor before it will accept powerOn command
+			
+			//Schedule next step. Toggling is the fallback sequence whatever the monitor, so it keeps that sequence's delays
+			taskSchedule.pushTask(now + POWER_SEQUENCES[POWER_SEQUENCE::CODE::INPUT_TOGGLE].wakeDelay.count(), tHeap::TASK::CODE::DISPLAY_TOGGLE_STEP2);
+			break;
+		}
+		
+		case tHeap::TASK::CODE::DISPLAY_TOGGLE_STEP2:
+		{
+			state.display->togglePower(); //Execute
+			
+			//Schedule brightness update
+			taskSchedule.pushTask(now + POWER_SEQUENCES[POWER_SEQUENCE::CODE::INPUT_TOGGLE].settleDelay.count(), tHeap::TASK::CODE::SET_BRIGHTNESS);
+			
+			break;
+		}
+		
+		case tHeap::TASK::CODE::SET_BRIGHTNESS_AND_RESCHEDULE:
+		{
+			//Periodic, the heap already rescheduled it
+			
+			//Bleed through
+		}
+		case tHeap::TASK::CODE::SET_BRIGHTNESS:
+		{
+			applyBrightness(state, brightnessTarget(state, curTime)); //Calc next brightness and tell the monitor
+			
+			break;
+		}
+		
+		case tHeap::TASK::CODE::SAMPLE_LIGHT_SENSOR_AND_RESCHEDULE:
+		{
+			//Periodic, the heap already rescheduled it. A leftover from a run that had a sensor just does nothing
+			if (!state.lightSensor) break;
+			
+			if (state.lightSensor->sample() != SENSOR_ERR::CODE::SUCCESS)
+			{
+				logger::warning("Failed to read the light sensor");
+				break;
+			}
+			metrics::setAmbientLux(state.lightSensor->getLux());
+			
+			//Samples are cheap, brightness decisions are not. Only look at the filtered value once per batch
+			if (++state.lightSamplesSinceCheck < LIGHT_SENSOR_BATCH) break;
+			state.lightSamplesSinceCheck = 0;
+			
+			//The hysteresis in the sensor keeps this from firing on small changes
+			if (brightnessTarget(state, curTime) != state.currentBrightness)
+			{
+				logger::verbose("Ambient light is {} lux, adjusting brightness", state.lightSensor->getLux());
+				
+				taskSchedule.pushTask(0, tHeap::TASK::CODE::SET_BRIGHTNESS);
+			}
+			
+			break;
+		}
+		
+		case tHeap::TASK::CODE::VERIFY_DISPLAY_PWR:
+		{
+			//Only scheduled by a sequence that has something to fall back to. Ask DDC directly, the connector may not know
+			if (!state.display->isConnected() || !activePowerSequence.verifyDelay.count()) break;
+			if (state.display->isOnDDC() == state.displayOn) break;
+			
+			//The monitor took the command and ignored it. Switch to the long way round and redo whatever was asked
+			fallBackPowerSequence(state);
+			taskSchedule.pushTask(0, state.displayOn ? tHeap::TASK::CODE::DISPLAY_ON_STEP1 : tHeap::TASK::CODE::DISPLAY_OFF);
+			
+			break;
+		}
+	}
+	
+	return;
+}
+
+unsigned char brightnessTarget(clockState& state, const timeStruct& curTime)
+{
+	return adjustCurveBrightness(state, SunBrightness::interp(curTime.hour, curTime.min));
+}
+
+unsigned char adjustCurveBrightness(clockState& state, unsigned char curveBrightness)
+{
+	//A manual override wins over everything, then the room light nudges the curve if there is a sensor
+	if (state.brightnessOverride != -1) return state.brightnessOverride;
+	
+	//A follower goes with the publisher, whose sensor has already had its say
+	if (state.sync && state.sync->isFollowing()) return state.sync->getState().get(SYNC_FIELD::CODE::BRIGHTNESS);
+	
+	if (!state.lightSensor) return curveBrightness;
+	
+	return state.lightSensor->adjustBrightness(curveBrightness);
+}
+
+void applyBrightness(clockState& state, unsigned char targetBrightness)
+{
+	state.display->setBrightness(targetBrightness); //Tell monitor to adjust to the requested brightness
+	state.currentBrightness = targetBrightness; //Keep track of current state
+	metrics::setBrightness(targetBrightness);
+	
+	//The first brightness write after a power on is the end of the wake
+	if (state.displayOn && state.wake.started != std::chrono::steady_clock::time_point())
+	{
+		auto latency = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - state.wake.started);
+		metrics::displayWoke(latency.count());
+		state.wake.started = {};
+		
+		logger::info("Display woke to brightness {}% in {} ms ({}{})", targetBrightness, latency.count(), activePowerSequence.name, (state.wake.enabled ? ", polled" : ", fixed delays"));
+	}
+	
+	return;
+}
+
+void requestPower(tHeap::TaskHeap& taskSchedule, clockState& state, bool wantOn)
+{
+	//Don't start a second power on while one is still waiting on its second step. Look again right after it finishes
+	const tHeap::Task* pendingStep = taskSchedule.getTask(state.powerSequence);
+	if (pendingStep)
+	{
+		taskSchedule.pushTask(pendingStep->scheduledTime + 1, tHeap::TASK::CODE::CHECK_SHOULD_TOGGLE_DISPLAY_PWR);
+		
+		return;
+	}
+	
+	//Both ignore redundant calls. Each runs immediately
+	taskSchedule.pushTask(0, wantOn ? tHeap::TASK::CODE::DISPLAY_ON_STEP1_AND_RESCHEDULE : tHeap::TASK::CODE::DISPLAY_OFF_AND_RESCHEDULE);
+	
+	return;
+}
+
+persistedFields persistedFieldsOf(const tHeap::TaskHeap& taskSchedule, const clockState& state)
+{
+	//Periodic tasks are only ever rescheduled in place, so a change in the count means a one shot came or went
+	return { state.currentBrightness, state.displayOn, state.currentInput, taskSchedule.size() };
+}
+
+void fallBackPowerSequence(clockState& state)
+{
+	logger::warning("Monitor ignored the {} power sequence, falling back to {}", activePowerSequence.name, POWER_SEQUENCES[POWER_SEQUENCE::CODE::INPUT_TOGGLE].name);
+	
+	activePowerSequence = POWER_SEQUENCES[POWER_SEQUENCE::CODE::INPUT_TOGGLE];
+	
+	//Remember it, so this monitor goes straight to the fallback from now on
+	if (!state.profile.edidHash) return;
+	
+	state.profile.powerSequence = POWER_SEQUENCE::CODE::INPUT_TOGGLE;
+	state.profile.updatedAt = std::chrono::duration_cast<std::chrono::seconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+	
+	MonitorProfileStore profileStore(MONITOR_PROFILE_PATH);
+	profileStore.update(state.profile);
+	profileStore.save();
+	
+	return;
+}
+
+void startWakeProbe(clockState& state, tHeap::taskHandle step, WAKE_PROBE::CODE probe)
+{
+	if (!state.wake.enabled) return;
+	
+	state.wake.probe = probe;
+	state.wake.step = step;
+	state.wake.interval = WAKE_PROBE_FIRST_INTERVAL;
+	state.wake.nextProbe = std::chrono::steady_clock::now() + WAKE_PROBE_FIRST_INTERVAL;
+	
+	return;
+}
+
+void pollWakeProbe(tHeap::TaskHeap& taskSchedule, clockState& state)
+{
+	if (state.wake.probe == WAKE_PROBE::CODE::NONE) return;
+	
+	//Gone means the step already ran on its upper bound, or was replaced
+	if (!taskSchedule.getTask(state.wake.step))
+	{
+		state.wake.probe = WAKE_PROBE::CODE::NONE;
+		return;
+	}
+	
+	std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+	if (now < state.wake.nextProbe) return;
+	
+	//Each probe is a DDC read. Back off so a slow monitor isn't spending its wake up answering them
+	if (!state.display->isReady(state.wake.probe))
+	{
+		state.wake.nextProbe = now + state.wake.interval;
+		state.wake.interval = std::min(state.wake.interval * 2, WAKE_PROBE_MAX_INTERVAL);
+		return;
+	}
+	
+	logger::verbose("Monitor was ready for the next power on step {} ms into the wake", std::chrono::duration_cast<std::chrono::milliseconds>(now - state.wake.started).count());
+	
+	//Run the step in this same pass
+	taskSchedule.reschedule(state.wake.step, 0);
+	state.wake.probe = WAKE_PROBE::CODE::NONE;
+	
+	return;
+}
+
+void savePersistedState(StateFile& stateFile, const tHeap::TaskHeap& taskSchedule, const clockState& state, long now, long wallNow)
+{
+	if (!stateFile.isOpen()) return;
+	
+	persistedState toSave = {};
+	toSave.savedAt = wallNow;
+	
+	toSave.monitor = state.monitor;
+	toSave.monitorKnown = state.monitorKnown;
+	
+	toSave.brightness = state.currentBrightness;
+	toSave.powerOn = state.displayOn;
+	toSave.input = state.currentInput;
+	
+	//Heap order is fine, restoring pushes them all back in anyway
+	size_t taskCount = taskSchedule.size();
+	if (taskCount > STATEFILE_MAX_TASKS)
+	{
+		logger::warning("Too many pending tasks to persist, dropping {}", taskCount - STATEFILE_MAX_TASKS);
+		taskCount = STATEFILE_MAX_TASKS;
+	}
+	
+	for (size_t i = 0; i < taskCount; ++i)
+	{
+		const tHeap::Task* task = taskSchedule.getTaskAt(i);
+		toSave.tasks[i].scheduledTime = (task->scheduledTime <= 1) ? task->scheduledTime : wallNow + (task->scheduledTime - now); //The steady clock restarts with the Pi, so save wall clock times. 0 and 1 mean "now" on either
+		toSave.tasks[i].task = task->task;
+	}
+	toSave.taskCount = taskCount;
+	
+	stateFile.save(toSave);
+	
+	return;
+}
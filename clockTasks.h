@@ -0,0 +1,169 @@
+/******************************************************************************
+/ Pi 4 Sunrise Clock App Clock Tasks Spec - lopezk38 2025
+/
+/ What the main loop does with its schedule once DDC is up: walks the day
+/ plan, runs due tasks off the task heap and carries each one out against the
+/ display. The monitor is behind DisplayControl, so alloccheck and sensorbench
+/ run this same code through a simulated day with no DDC and no screen
+/
+/*****************************************************************************/
+
+#ifndef SUNCLOCK_APP_CLOCKTASKS
+#define SUNCLOCK_APP_CLOCKTASKS
+
+/******************************************************************************
+/ Dependencies, namespacing
+/*****************************************************************************/
+
+#include <chrono>
+#include <cstdint>
+#include <cstddef>
+
+#include "clockConfig.h"
+#include "taskHeap.h"
+#include "dayPlan.h"
+#include "stateFile.h"
+#include "monitorProfile.h"
+#include "monitorQuirks.h"
+#include "lightSensor.h"
+#include "clockSync.h"
+
+
+/******************************************************************************
+/ Enums, structs
+/*****************************************************************************/
+
+struct timeStruct
+{
+	long hour;
+	long min;
+	long sec;
+	long ms;
+};
+
+//What a power on is waiting for the monitor to do before its next step
+namespace WAKE_PROBE
+{
+	enum CODE
+	{
+		NONE,
+		INPUT_SELECTED, //Input reads back as the one selected
+		POWERED_ON //Power mode reads back as on
+	};
+}
+
+struct wakeProbe
+{
+	bool enabled = WAKE_READINESS_POLLING;
+	WAKE_PROBE::CODE probe = WAKE_PROBE::CODE::NONE;
+	tHeap::taskHandle step = tHeap::INVALID_HANDLE; //Pulled in to run as soon as the probe passes. Runs on its own at the upper bound if it never does
+	std::chrono::steady_clock::time_point nextProbe;
+	std::chrono::milliseconds interval = WAKE_PROBE_FIRST_INTERVAL;
+	
+	std::chrono::steady_clock::time_point started; //Start of the power on being timed. Zero when there isn't one
+};
+
+//Everything a task does to the monitor. The clock puts DDC behind this, the headless tools a simulated monitor
+class DisplayControl
+{
+
+public:
+
+	virtual ~DisplayControl() = default;
+	
+	virtual bool isConnected() = 0; //False when DDC came up without a monitor. Everything below then fails
+	
+	//True on success. Powering on or off a display that is already there succeeds without a write
+	virtual bool setBrightness(unsigned char brightness) = 0;
+	virtual bool setInput(unsigned char vcpInputCode) = 0;
+	virtual bool togglePower() = 0;
+	virtual bool powerOn() = 0;
+	virtual bool powerOff() = 0;
+	
+	virtual bool isOn() = 0; //May be answered without DDC
+	virtual bool isOnDDC() = 0; //Always asks the monitor
+	virtual bool isReady(WAKE_PROBE::CODE probe) = 0; //Whether a power on can go on to its next step
+};
+
+//Everything the task scheduler needs to act on the display
+struct clockState
+{
+	DisplayControl* display = nullptr; //Set before any task runs, whether or not DDC found a monitor
+	bool ddcAttached = false; //Set once background DDC discovery has finished, even if it failed
+	
+	unsigned char currentBrightness = 1; //Will be updated later
+	tHeap::taskHandle powerSequence = tHeap::INVALID_HANDLE; //Pending second step of a power on, if one is underway
+	wakeProbe wake;
+	
+	//Last commanded display state, persisted for warm restarts
+	bool displayOn = true;
+	unsigned char currentInput = 0; //0 is unknown
+	bool powerStateTrusted = false; //Set when restored state can stand in for the next DDC power read
+	
+	monitorIdentity monitor = {};
+	bool monitorKnown = false;
+	monitorProfile profile; //Filled in by ddcInit from the profile store
+	
+	bool stateDirty = false; //Set when something worth persisting changed
+	
+	//Manual overrides from the control socket. -1 follows the curves
+	int brightnessOverride = -1;
+	int powerOverride = -1;
+	
+	//Optional ambient light input. nullptr when there is no sensor
+	LightSensor* lightSensor = nullptr;
+	unsigned int lightSamplesSinceCheck = 0;
+	
+	//What the curves want done today. nullptr drives them off periodic tasks instead
+	DayPlan* dayPlan = nullptr;
+	
+	//Publishes to or follows the other clocks. nullptr runs alone
+	ClockSync* sync = nullptr;
+	
+	//Daily brightness write report
+	long writeReportDay = -1;
+	uint64_t writesAtReport = 0;
+};
+
+//The parts of clockState and the schedule a task can change that savePersistedState writes out. Compared around each task so only real changes cost a save
+struct persistedFields
+{
+	unsigned char brightness;
+	bool displayOn;
+	unsigned char input;
+	size_t pendingTasks;
+	
+	bool operator==(const persistedFields&) const = default;
+};
+
+//How this monitor is powered on and off. Picked once DDC attaches, and falls back for good if the monitor ignores it
+extern powerSequenceSteps activePowerSequence;
+
+
+/******************************************************************************
+/ Function prototypes
+/*****************************************************************************/
+
+//Time. now, wherever it appears below, is the scheduler's clock in seconds. The clock passes steady clock seconds, the tools their simulated ones
+long toSecondOfDay(const timeStruct& curTime);
+
+//Scheduler. runTasks is the main loop's whole task step: wake probes, then the day plan, then the task heap
+void runTasks(tHeap::TaskHeap& taskSchedule, clockState& state, const timeStruct& curTime, long now);
+void runDueTasks(tHeap::TaskHeap& taskSchedule, clockState& state, const timeStruct& curTime, long now);
+void runDayPlan(tHeap::TaskHeap& taskSchedule, clockState& state, const timeStruct& curTime);
+void executeTask(tHeap::TaskHeap& taskSchedule, clockState& state, const timeStruct& curTime, long now, tHeap::TASK::CODE task);
+
+//Brightness and power
+unsigned char brightnessTarget(clockState& state, const timeStruct& curTime);
+unsigned char adjustCurveBrightness(clockState& state, unsigned char curveBrightness);
+void applyBrightness(clockState& state, unsigned char targetBrightness);
+void requestPower(tHeap::TaskHeap& taskSchedule, clockState& state, bool wantOn);
+void fallBackPowerSequence(clockState& state);
+void startWakeProbe(clockState& state, tHeap::taskHandle step, WAKE_PROBE::CODE probe);
+void pollWakeProbe(tHeap::TaskHeap& taskSchedule, clockState& state);
+
+//Warm restart. wallNow is the wall clock at now, task times are saved on it since the steady clock restarts with the Pi
+persistedFields persistedFieldsOf(const tHeap::TaskHeap& taskSchedule, const clockState& state);
+void savePersistedState(StateFile& stateFile, const tHeap::TaskHeap& taskSchedule, const clockState& state, long now, long wallNow);
+
+#endif
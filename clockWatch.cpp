@@ -0,0 +1,83 @@
+/******************************************************************************
+/ Pi 4 Sunrise Clock App Wall Clock Watch Implementation - lopezk38 2025
+/
+/*****************************************************************************/
+
+/******************************************************************************
+/ Dependencies, namespacing
+/*****************************************************************************/
+
+#include <unistd.h>
+#include <sys/timerfd.h>
+#include <cerrno>
+#include <cstdint>
+
+#include "clockWatch.h"
+#include "logger.h"
+
+
+/******************************************************************************
+/ Class implementation
+/*****************************************************************************/
+
+ClockWatch::ClockWatch()
+{
+	//Without it a clock step just goes unnoticed until the next periodic task, so this is not fatal
+	this->timerDescriptor = timerfd_create(CLOCK_REALTIME, TFD_NONBLOCK | TFD_CLOEXEC);
+	
+	if (this->timerDescriptor == -1 || armTimer() != CLOCKWATCH_ERR::CODE::SUCCESS)
+	{
+		errorState = true;
+		logger::warning("Unable to watch for wall clock changes");
+	}
+	
+	return;
+}
+
+ClockWatch::~ClockWatch()
+{
+	if (this->timerDescriptor != -1) close(this->timerDescriptor);
+	
+	return;
+}
+
+CLOCKWATCH_ERR::CODE ClockWatch::armTimer()
+{
+	//An absolute timer that never fires on its own. CANCEL_ON_SET makes the kernel cancel it whenever the clock is set, which is all we want from it
+	itimerspec never = {};
+	never.it_value.tv_sec = INT32_MAX;
+	
+	if (timerfd_settime(this->timerDescriptor, TFD_TIMER_ABSTIME | TFD_TIMER_CANCEL_ON_SET, &never, nullptr) == -1)
+	{
+		return CLOCKWATCH_ERR::CODE::ARM_FAIL;
+	}
+	
+	return CLOCKWATCH_ERR::CODE::SUCCESS;
+}
+
+bool ClockWatch::isOpen()
+{
+	return !this->errorState;
+}
+
+bool ClockWatch::clockJumped()
+{
+	if (this->errorState) return false;
+	
+	uint64_t expirations;
+	if (read(this->timerDescriptor, &expirations, sizeof(expirations)) != -1 || errno != ECANCELED) return false;
+	
+	//The cancel disarms the timer. Put it back for the next one
+	if (armTimer() != CLOCKWATCH_ERR::CODE::SUCCESS)
+	{
+		errorState = true;
+		logger::warning("Lost track of wall clock changes");
+	}
+	
+	return true;
+}
+
+int ClockWatch::getDescriptor()
+{
+	return this->timerDescriptor;
+}
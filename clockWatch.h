@@ -0,0 +1,48 @@
+/******************************************************************************
+/ Pi 4 Sunrise Clock App Wall Clock Watch Class Spec - lopezk38 2025
+/
+/*****************************************************************************/
+
+#ifndef SUNCLOCK_APP_CLOCKWATCH
+#define SUNCLOCK_APP_CLOCKWATCH
+
+/******************************************************************************
+/ Dependencies, namespacing
+/*****************************************************************************/
+
+#include <iostream>
+
+#include "errorcodes.h"
+
+
+/******************************************************************************
+/ Class specification
+/*****************************************************************************/
+
+//Notices when the wall clock is stepped (NTP sync, RTC correction, date -s). The scheduler runs on the steady clock,
+//so only tasks tied to the time of day need to hear about it
+class ClockWatch
+{
+	
+private:
+	
+	int timerDescriptor = -1;
+	
+	bool errorState = false;
+	
+	CLOCKWATCH_ERR::CODE armTimer();
+	
+public:
+
+	ClockWatch();
+	~ClockWatch();
+	
+	bool isOpen();
+	
+	//Non blocking. True once per clock step
+	bool clockJumped();
+	
+	int getDescriptor(); //Turns readable when the clock is stepped
+};
+
+#endif
@@ -0,0 +1,301 @@
+/******************************************************************************
+/ Pi 4 Sunrise Clock App Tile Compositor Implementation - lopezk38 2025
+/
+/*****************************************************************************/
+
+/******************************************************************************
+/ Dependencies, namespacing
+/*****************************************************************************/
+
+#include <algorithm>
+#include <cstring>
+
+#include "compositor.h"
+
+
+/******************************************************************************
+/ Rectangles
+/*****************************************************************************/
+
+pixelRect pixelRect::intersect(const pixelRect& other) const
+{
+	pixelRect result;
+	result.x = std::max(this->x, other.x);
+	result.y = std::max(this->y, other.y);
+	result.width = std::min(this->x + this->width, other.x + other.width) - result.x;
+	result.height = std::min(this->y + this->height, other.y + other.height) - result.y;
+	
+	if (result.isEmpty()) return pixelRect();
+	
+	return result;
+}
+
+pixelRect pixelRect::unite(const pixelRect& other) const
+{
+	if (this->isEmpty()) return other;
+	if (other.isEmpty()) return *this;
+	
+	pixelRect result;
+	result.x = std::min(this->x, other.x);
+	result.y = std::min(this->y, other.y);
+	result.width = std::max(this->x + this->width, other.x + other.width) - result.x;
+	result.height = std::max(this->y + this->height, other.y + other.height) - result.y;
+	
+	return result;
+}
+
+
+/******************************************************************************
+/ Class implementation
+/*****************************************************************************/
+
+Compositor::Compositor(uint32_t width, uint32_t height, unsigned int threads): width(width), height(height),
+	tilesAcross((width + COMPOSITOR_TILE_SIZE - 1) / COMPOSITOR_TILE_SIZE), tilesDown((height + COMPOSITOR_TILE_SIZE - 1) / COMPOSITOR_TILE_SIZE), stride(static_cast<size_t>(width) * 4)
+{
+	this->frame.assign(this->stride * height, 0);
+	
+	size_t tileCount = static_cast<size_t>(this->tilesAcross) * this->tilesDown;
+	this->tileLayers.assign(tileCount, 0);
+	this->tileDirty.assign(tileCount, 0);
+	this->dirtyTiles.reserve(tileCount);
+	
+	//The caller renders too, so it's one less worker than threads
+	threads = std::clamp(threads, 1u, COMPOSITOR_MAX_THREADS);
+	for (unsigned int i = 1; i < threads; ++i) this->workers.emplace_back(&Compositor::workerLoop, this);
+	
+	return;
+}
+
+Compositor::~Compositor()
+{
+	{
+		std::lock_guard<std::mutex> guard(this->poolLock);
+		this->stopping = true;
+	}
+	this->workReady.notify_all();
+	
+	for (std::thread& worker : this->workers) worker.join();
+	
+	return;
+}
+
+pixelRect Compositor::tileRect(uint32_t tile) const
+{
+	pixelRect rect;
+	rect.x = (tile % this->tilesAcross) * COMPOSITOR_TILE_SIZE;
+	rect.y = (tile / this->tilesAcross) * COMPOSITOR_TILE_SIZE;
+	rect.width = std::min<int32_t>(COMPOSITOR_TILE_SIZE, this->width - rect.x); //Edge tiles are cut short
+	rect.height = std::min<int32_t>(COMPOSITOR_TILE_SIZE, this->height - rect.y);
+	
+	return rect;
+}
+
+void Compositor::markTiles(const pixelRect& area, unsigned int layer, bool touches)
+{
+	pixelRect onFrame = area.intersect({ 0, 0, static_cast<int32_t>(this->width), static_cast<int32_t>(this->height) });
+	if (onFrame.isEmpty()) return;
+	
+	uint32_t firstColumn = onFrame.x / COMPOSITOR_TILE_SIZE;
+	uint32_t lastColumn = (onFrame.x + onFrame.width - 1) / COMPOSITOR_TILE_SIZE;
+	uint32_t firstRow = onFrame.y / COMPOSITOR_TILE_SIZE;
+	uint32_t lastRow = (onFrame.y + onFrame.height - 1) / COMPOSITOR_TILE_SIZE;
+	
+	uint8_t bit = 1 << layer;
+	for (uint32_t row = firstRow; row <= lastRow; ++row)
+	{
+		for (uint32_t column = firstColumn; column <= lastColumn; ++column)
+		{
+			uint32_t tile = row * this->tilesAcross + column;
+			
+			if (touches) this->tileLayers[tile] |= bit;
+			else this->tileLayers[tile] &= ~bit;
+			
+			this->tileDirty[tile] = 1;
+		}
+	}
+	
+	return;
+}
+
+int Compositor::addLayer(CompositorLayer* layer)
+{
+	if (!layer || this->layerCount >= COMPOSITOR_MAX_LAYERS) return -1;
+	
+	int index = this->layerCount++;
+	this->layers[index] = layer;
+	this->layerBounds[index] = pixelRect();
+	invalidate(index);
+	
+	return index;
+}
+
+void Compositor::invalidate(int layer)
+{
+	if (layer < 0 || static_cast<unsigned int>(layer) >= this->layerCount) return;
+	
+	//Whatever was under the old bounds has to be drawn without it, then the new bounds with it
+	markTiles(this->layerBounds[layer], layer, false);
+	this->layerBounds[layer] = this->layers[layer]->bounds();
+	markTiles(this->layerBounds[layer], layer, true);
+	
+	return;
+}
+
+void Compositor::invalidateAll()
+{
+	for (unsigned int i = 0; i < this->layerCount; ++i) invalidate(i);
+	
+	//Tiles no layer touches still need clearing the first time round
+	std::fill(this->tileDirty.begin(), this->tileDirty.end(), 1);
+	
+	return;
+}
+
+void Compositor::renderTile(uint32_t tile)
+{
+	pixelRect area = tileRect(tile);
+	uint8_t touching = this->tileLayers[tile];
+	
+	//Anything under an opaque layer covering the whole tile would just be painted over. Start from the top one of those
+	unsigned int first = 0;
+	bool covered = false;
+	for (unsigned int i = this->layerCount; i-- > 0;)
+	{
+		if (!(touching & (1 << i)) || !this->layers[i]->isOpaque()) continue;
+		
+		pixelRect cover = this->layerBounds[i].intersect(area);
+		if (cover.width == area.width && cover.height == area.height)
+		{
+			first = i;
+			covered = true;
+			break;
+		}
+	}
+	
+	if (!covered)
+	{
+		for (int32_t y = area.y; y < area.y + area.height; ++y)
+		{
+			uint32_t* row = reinterpret_cast<uint32_t*>(&this->frame[y * this->stride]) + area.x;
+			std::fill(row, row + area.width, 0xFF000000u); //Opaque black, alpha is the top byte on a little endian Pi
+		}
+	}
+	
+	for (unsigned int i = first; i < this->layerCount; ++i)
+	{
+		if (!(touching & (1 << i))) continue;
+		
+		pixelRect clip = this->layerBounds[i].intersect(area);
+		if (!clip.isEmpty()) this->layers[i]->render(this->frame.data(), this->stride, clip);
+	}
+	
+	return;
+}
+
+void Compositor::renderTiles()
+{
+	size_t tile;
+	while ((tile = this->nextTile.fetch_add(1, std::memory_order_relaxed)) < this->dirtyTiles.size()) renderTile(this->dirtyTiles[tile]);
+	
+	return;
+}
+
+void Compositor::workerLoop()
+{
+	uint64_t seen = 0;
+	
+	while (true)
+	{
+		{
+			std::unique_lock<std::mutex> guard(this->poolLock);
+			this->workReady.wait(guard, [&]() { return this->stopping || this->generation != seen; });
+			if (this->stopping) return;
+			
+			seen = this->generation;
+		}
+		
+		renderTiles();
+		
+		{
+			std::lock_guard<std::mutex> guard(this->poolLock);
+			if (--this->workersBusy) continue;
+		}
+		this->workDone.notify_one();
+	}
+}
+
+size_t Compositor::render()
+{
+	//Row major, so neighbouring tiles go to the same thread more often than not
+	this->dirtyTiles.clear();
+	this->lastDirty = pixelRect();
+	for (uint32_t tile = 0; tile < this->tileDirty.size(); ++tile)
+	{
+		if (!this->tileDirty[tile]) continue;
+		
+		this->tileDirty[tile] = 0;
+		this->dirtyTiles.push_back(tile);
+		this->lastDirty = this->lastDirty.unite(tileRect(tile));
+	}
+	
+	if (this->dirtyTiles.empty()) return 0;
+	
+	this->nextTile.store(0, std::memory_order_relaxed);
+	
+	//Waking the pool costs more than a couple of tiles do
+	if (this->workers.empty() || this->dirtyTiles.size() <= 2)
+	{
+		renderTiles();
+		return this->dirtyTiles.size();
+	}
+	
+	{
+		std::lock_guard<std::mutex> guard(this->poolLock);
+		this->workersBusy = this->workers.size();
+		++this->generation;
+	}
+	this->workReady.notify_all();
+	
+	renderTiles();
+	
+	//The frame isn't done until every worker has finished the tile it was on
+	std::unique_lock<std::mutex> guard(this->poolLock);
+	this->workDone.wait(guard, [&]() { return this->workersBusy == 0; });
+	
+	return this->dirtyTiles.size();
+}
+
+pixelRect Compositor::getDirtyBounds() const
+{
+	return this->lastDirty;
+}
+
+const uint8_t* Compositor::getFrame() const
+{
+	return this->frame.data();
+}
+
+size_t Compositor::getStride() const
+{
+	return this->stride;
+}
+
+uint32_t Compositor::getWidth() const
+{
+	return this->width;
+}
+
+uint32_t Compositor::getHeight() const
+{
+	return this->height;
+}
+
+size_t Compositor::getTileCount() const
+{
+	return this->tileLayers.size();
+}
+
+unsigned int Compositor::getThreadCount() const
+{
+	return this->workers.size() + 1;
+}
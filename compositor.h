@@ -0,0 +1,132 @@
+/******************************************************************************
+/ Pi 4 Sunrise Clock App Tile Compositor Class Spec - lopezk38 2025
+/
+/ Builds a layered face into an RGBA8888 frame on the CPU. The frame is cut
+/ into tiles, each tile remembers which layers touch it, and only tiles a
+/ changed layer touched get drawn again. Dirty tiles are shared out across a
+/ fixed pool of threads, the calling thread included
+/
+/*****************************************************************************/
+
+#ifndef SUNCLOCK_APP_COMPOSITOR
+#define SUNCLOCK_APP_COMPOSITOR
+
+/******************************************************************************
+/ Dependencies, namespacing
+/*****************************************************************************/
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <cstddef>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+
+/******************************************************************************
+/ Constants, structs
+/*****************************************************************************/
+
+constexpr uint32_t COMPOSITOR_TILE_SIZE = 64; //Pixels square. 16KB of RGBA, stays in a Pi 4 core's L1 while its layers stack up
+constexpr unsigned int COMPOSITOR_MAX_LAYERS = 8; //Per tile layer sets are a byte wide
+constexpr unsigned int COMPOSITOR_MAX_THREADS = 8;
+
+struct pixelRect
+{
+	int32_t x = 0;
+	int32_t y = 0;
+	int32_t width = 0; //0 is empty
+	int32_t height = 0;
+	
+	bool isEmpty() const { return this->width <= 0 || this->height <= 0; }
+	pixelRect intersect(const pixelRect& other) const;
+	pixelRect unite(const pixelRect& other) const;
+};
+
+//One thing drawn on the face. Layers are drawn bottom up into a tile, each one only ever asked for the part of it inside its bounds
+class CompositorLayer
+{
+
+public:
+
+	virtual ~CompositorLayer() = default;
+	
+	//Everything the layer may touch this frame. Empty hides it
+	virtual pixelRect bounds() const = 0;
+	
+	//Fully covers its bounds with solid pixels, so whatever is under it there needn't be drawn
+	virtual bool isOpaque() const { return false; }
+	
+	//Draw the part of the layer inside clip over what is already in the frame. Called from several threads at once,
+	//each on its own clip, so it must only read layer state and only write inside clip
+	virtual void render(uint8_t* frame, size_t stride, const pixelRect& clip) const = 0;
+};
+
+class Compositor
+{
+
+private:
+
+	const uint32_t width;
+	const uint32_t height;
+	const uint32_t tilesAcross;
+	const uint32_t tilesDown;
+	const size_t stride;
+	std::vector<uint8_t> frame;
+	
+	CompositorLayer* layers[COMPOSITOR_MAX_LAYERS] = {}; //Not owned. Bottom first
+	pixelRect layerBounds[COMPOSITOR_MAX_LAYERS]; //As of the last invalidate, so a moved layer can clean up where it was
+	unsigned int layerCount = 0;
+	
+	std::vector<uint8_t> tileLayers; //Bit per layer touching the tile
+	std::vector<uint8_t> tileDirty;
+	std::vector<uint32_t> dirtyTiles; //Work list for one render. Reserved for every tile, so rendering never allocates
+	pixelRect lastDirty;
+	
+	//Pool. Workers sleep between frames and take tiles off the work list with one atomic add each
+	std::vector<std::thread> workers;
+	std::mutex poolLock;
+	std::condition_variable workReady;
+	std::condition_variable workDone;
+	uint64_t generation = 0; //Bumped for every render handed to the pool
+	unsigned int workersBusy = 0;
+	bool stopping = false;
+	std::atomic<size_t> nextTile{0};
+	
+	pixelRect tileRect(uint32_t tile) const;
+	void markTiles(const pixelRect& area, unsigned int layer, bool touches);
+	void renderTile(uint32_t tile);
+	void renderTiles();
+	void workerLoop();
+
+public:
+
+	Compositor(uint32_t width, uint32_t height, unsigned int threads); //Threads counts the caller, 1 never starts a worker
+	~Compositor();
+	
+	Compositor(const Compositor&) = delete;
+	Compositor& operator=(const Compositor&) = delete;
+	
+	//Returns the layer's index, or -1 past COMPOSITOR_MAX_LAYERS. Layers must outlive the compositor
+	int addLayer(CompositorLayer* layer);
+	
+	//The layer changed. Its bounds are read again, and the tiles it used to touch and now touches get drawn next render
+	void invalidate(int layer);
+	void invalidateAll();
+	
+	//Draws every dirty tile. Returns how many were drawn
+	size_t render();
+	
+	//Smallest rectangle holding every tile the last render drew. Empty if it drew none
+	pixelRect getDirtyBounds() const;
+	
+	const uint8_t* getFrame() const;
+	size_t getStride() const;
+	uint32_t getWidth() const;
+	uint32_t getHeight() const;
+	size_t getTileCount() const;
+	unsigned int getThreadCount() const;
+};
+
+#endif
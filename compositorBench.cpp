@@ -0,0 +1,163 @@
+/******************************************************************************
+/ Pi 4 Sunrise Clock App Compositor Benchmark - lopezk38 2025
+/
+/ Renders the layered face at 1080p and 4K on 1, 2 and 4 threads. Times a
+/ full redraw (the sky moved), a progress arc step and a next event line
+/ change, and checks every thread count and every partial redraw comes out
+/ identical to one thread drawing the whole frame
+/
+/ Usage: compositorbench [--frames N]
+/
+/*****************************************************************************/
+
+/******************************************************************************
+/ Dependencies, namespacing
+/*****************************************************************************/
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <thread>
+
+#include "faceLayers.h"
+
+
+/******************************************************************************
+/ Constants
+/*****************************************************************************/
+
+struct resolution
+{
+	const char* name;
+	uint32_t width;
+	uint32_t height;
+};
+
+constexpr resolution RESOLUTIONS[] = { { "1080p", 1920, 1080 }, { "4K", 3840, 2160 } };
+constexpr unsigned int THREAD_COUNTS[] = { 1, 2, 4 };
+constexpr unsigned int DEFAULT_FRAMES = 30;
+
+//Dawn, when the sky moves every frame. The arc is timed in the small hours instead, when it's the only thing moving
+constexpr long START_SECOND = 6 * 3600 + 15 * 60;
+constexpr long NIGHT_SECOND = 2 * 3600;
+constexpr char DATE_TEXT[] = "SAT OCT 18";
+constexpr const char* NEXT_EVENT_TEXTS[] = { "NEXT 06:30 BRIGHTNESS 50%", "NEXT 07:00 BRIGHTNESS 75%" };
+
+
+/******************************************************************************
+/ Implementation
+/*****************************************************************************/
+
+namespace SCENARIO
+{
+	enum CODE
+	{
+		FULL, //Sky colors change, so every tile
+		ARC, //Only the progress arc moves a step
+		LINE, //Only the next event line changes
+		COUNT
+	};
+	
+	const char* NAMES[] = { "full", "arc", "line" };
+}
+
+//Where the face is on a frame of a scenario. The arc moves every four minutes
+long frameSecond(SCENARIO::CODE scenario, unsigned int frame)
+{
+	switch (scenario)
+	{
+		case SCENARIO::CODE::FULL: return START_SECOND + frame * 60;
+		case SCENARIO::CODE::ARC: return NIGHT_SECOND + (frame % 2) * 240; //Back and forth across an arc step
+		default: return START_SECOND;
+	}
+}
+
+struct runResult
+{
+	double msPerFrame = 0;
+	double tilesPerFrame = 0;
+};
+
+runResult run(LayeredFace& face, SCENARIO::CODE scenario, unsigned int frames)
+{
+	runResult result;
+	size_t tiles = 0;
+	
+	auto start = std::chrono::steady_clock::now();
+	for (unsigned int frame = 1; frame <= frames; ++frame)
+	{
+		const char* nextEvent = (scenario == SCENARIO::CODE::LINE) ? NEXT_EVENT_TEXTS[frame % 2] : NEXT_EVENT_TEXTS[0];
+		face.update(frameSecond(scenario, frame), DATE_TEXT, nextEvent);
+		tiles += face.render();
+	}
+	double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+	
+	result.msPerFrame = seconds * 1000 / frames;
+	result.tilesPerFrame = static_cast<double>(tiles) / frames;
+	
+	return result;
+}
+
+bool matchesFullRedraw(const LayeredFace& face, long secondOfDay, const char* nextEvent)
+{
+	//A fresh face has every tile dirty. Anything the dirty tracking missed shows up as a difference
+	const Compositor& partial = face.getCompositor();
+	LayeredFace reference(partial.getWidth(), partial.getHeight(), 1);
+	reference.update(secondOfDay, DATE_TEXT, nextEvent);
+	reference.render();
+	
+	return !std::memcmp(partial.getFrame(), reference.getCompositor().getFrame(), partial.getStride() * partial.getHeight());
+}
+
+int main(int argc, char* argv[])
+{
+	unsigned int frames = DEFAULT_FRAMES;
+	
+	for (int i = 1; i < argc; ++i)
+	{
+		if (!std::strcmp(argv[i], "--frames") && i + 1 < argc) frames = std::atoi(argv[++i]);
+		else
+		{
+			std::cerr << "Usage: compositorbench [--frames N]" << std::endl;
+			return 1;
+		}
+	}
+	if (frames == 0) frames = DEFAULT_FRAMES;
+	
+	std::cout << frames << " frames per run, " << COMPOSITOR_TILE_SIZE << " px tiles, " << std::thread::hardware_concurrency() << " hardware threads" << std::endl;
+	std::printf("%-6s %-6s %8s %10s %10s %9s\n", "res", "redraw", "threads", "tiles", "ms/frame", "speedup");
+	
+	bool failed = false;
+	
+	for (const resolution& res : RESOLUTIONS)
+	{
+		for (unsigned int scenario = 0; scenario < SCENARIO::CODE::COUNT; ++scenario)
+		{
+			double singleThreadMs = 0;
+			
+			for (unsigned int threads : THREAD_COUNTS)
+			{
+				LayeredFace face(res.width, res.height, threads);
+				face.update(START_SECOND, DATE_TEXT, NEXT_EVENT_TEXTS[0]);
+				face.render(); //First frame draws everything whatever the scenario
+				
+				runResult result = run(face, static_cast<SCENARIO::CODE>(scenario), frames);
+				if (threads == 1) singleThreadMs = result.msPerFrame;
+				
+				std::printf("%-6s %-6s %8u %10.0f %10.2f %8.2fx\n", res.name, SCENARIO::NAMES[scenario], threads, result.tilesPerFrame, result.msPerFrame,
+							singleThreadMs / result.msPerFrame);
+				
+				const char* lastEvent = (scenario == SCENARIO::CODE::LINE) ? NEXT_EVENT_TEXTS[frames % 2] : NEXT_EVENT_TEXTS[0];
+				if (!matchesFullRedraw(face, frameSecond(static_cast<SCENARIO::CODE>(scenario), frames), lastEvent))
+				{
+					std::cerr << "ERROR: " << res.name << ' ' << SCENARIO::NAMES[scenario] << " on " << threads << " threads doesn't match a full single thread redraw" << std::endl;
+					failed = true;
+				}
+			}
+		}
+	}
+	
+	return failed ? 1 : 0;
+}
@@ -0,0 +1,370 @@
+/******************************************************************************
+/ Pi 4 Sunrise Clock App Control Socket Load Benchmark - lopezk38 2025
+/
+/ Runs a stand in frame loop that serves the control socket once per frame,
+/ first alone and then with many local clients each pipelining batches of
+/ commands at it. Reports command latency, time spent serving per frame and
+/ how far the frame period moved from the idle run. Checks every command got
+/ exactly one response and no frame served more than its budget. Last, a
+/ client sends a burst of commands and hangs up its sending side straight
+/ away, the way piping into socat or nc -N does, and has to get every answer
+/ before the socket closes on it
+/
+/ Usage: controlbench [--clients N] [--depth N] [--batches N] [--fps N]
+/
+/*****************************************************************************/
+
+/******************************************************************************
+/ Dependencies, namespacing
+/*****************************************************************************/
+
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "controlSocket.h"
+
+
+/******************************************************************************
+/ Constants
+/*****************************************************************************/
+
+constexpr unsigned int DEFAULT_CLIENTS = 16;
+constexpr unsigned int DEFAULT_DEPTH = 8; //Commands written before reading any responses
+constexpr unsigned int DEFAULT_BATCHES = 50;
+constexpr unsigned int DEFAULT_FPS = 60;
+constexpr std::chrono::microseconds FRAME_WORK = std::chrono::microseconds(2000); //Stands in for drawing the face
+constexpr unsigned int IDLE_FRAMES = 300;
+constexpr unsigned int HALF_CLOSED_COMMANDS = CONTROL_MAX_COMMANDS_PER_SERVICE * 2 + 1; //More than a frame serves, so the answers span frames after the hang up
+constexpr std::chrono::seconds HALF_CLOSED_TIMEOUT = std::chrono::seconds(5);
+
+//What clients send, in turn. Roughly what a status panel polling the clock would
+const char* const COMMANDS[] = { "stats", "brightness 40", "tasks", "brightness auto", "help" };
+
+
+/******************************************************************************
+/ Implementation
+/*****************************************************************************/
+
+struct loopResult
+{
+	std::vector<double> serviceUs; //Per frame
+	std::vector<double> periodUs; //Start to start
+	unsigned int maxHandled = 0;
+	uint64_t handled = 0;
+};
+
+struct clientResult
+{
+	std::vector<double> latenciesUs;
+	uint64_t responses = 0;
+	bool failed = false;
+};
+
+//Answers in the same shape as the clock does, without a clock behind it
+std::string standInHandler(const std::string& command)
+{
+	if (command == "stats")
+	{
+		return "uptime 3600s\nddc attached\nbrightness 40 auto\npower on auto\nbrightness_writes 120\nambient_lux off\nddc_reads_avoided off\n"
+			   "power_sequence default\nlast_wake_ms none\nsync off\nlog_level info\nlog_dropped 0\npending_tasks 3\nOK\n";
+	}
+	if (command == "tasks") return "12:30:00 (in 12s) SET_BRIGHTNESS_AND_RESCHEDULE every 60s\n12:30:05 (in 17s) CHECK_SHOULD_TOGGLE_DISPLAY_PWR every 5s\nOK 2 tasks\n";
+	if (command == "help") return "brightness <0-100|auto>\npower <on|off|auto>\ntasks\nplan\nstats\nlog <verbose|info|warning|error|off>\nOK\n";
+	if (command.rfind("brightness ", 0) == 0) return "OK\n";
+	
+	return "ERR unknown command, try help\n";
+}
+
+double percentile(std::vector<double>& values, double fraction)
+{
+	if (values.empty()) return 0;
+	
+	std::sort(values.begin(), values.end());
+	return values[std::min(values.size() - 1, static_cast<size_t>(values.size() * fraction))];
+}
+
+loopResult runFrameLoop(ControlSocket& controlSocket, unsigned int fps, const std::atomic<bool>& stop, unsigned int frames)
+{
+	//Same order of work as the real loop: draw, then serve control clients, then sleep out the frame
+	loopResult result;
+	std::chrono::nanoseconds framePeriod = std::chrono::nanoseconds(1000000000 / fps);
+	std::chrono::steady_clock::time_point nextFrame = std::chrono::steady_clock::now();
+	std::chrono::steady_clock::time_point lastStart;
+	
+	for (unsigned int frame = 0; frames ? frame < frames : !stop.load(std::memory_order_acquire); ++frame)
+	{
+		std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+		if (frame) result.periodUs.push_back(std::chrono::duration<double, std::micro>(start - lastStart).count());
+		lastStart = start;
+		
+		while (std::chrono::steady_clock::now() - start < FRAME_WORK) {}
+		
+		std::chrono::steady_clock::time_point serviceStart = std::chrono::steady_clock::now();
+		unsigned int handled = controlSocket.service(standInHandler);
+		result.serviceUs.push_back(std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - serviceStart).count());
+		
+		result.handled += handled;
+		result.maxHandled = std::max(result.maxHandled, handled);
+		
+		nextFrame += framePeriod;
+		std::this_thread::sleep_until(nextFrame);
+	}
+	
+	return result;
+}
+
+int connectClient(const std::string& path)
+{
+	sockaddr_un address = {};
+	address.sun_family = AF_UNIX;
+	std::strncpy(address.sun_path, path.c_str(), sizeof(address.sun_path) - 1);
+	
+	int descriptor = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+	if (descriptor == -1) return -1;
+	
+	if (connect(descriptor, reinterpret_cast<sockaddr*>(&address), sizeof(address)))
+	{
+		close(descriptor);
+		return -1;
+	}
+	
+	return descriptor;
+}
+
+void runClient(const std::string& path, unsigned int index, unsigned int depth, unsigned int batches, clientResult& result)
+{
+	int descriptor = connectClient(path);
+	if (descriptor == -1)
+	{
+		result.failed = true;
+		return;
+	}
+	
+	std::string batch;
+	std::string pending; //Response text not yet split into lines
+	char buf[4096];
+	
+	for (unsigned int b = 0; b < batches && !result.failed; ++b)
+	{
+		batch.clear();
+		for (unsigned int i = 0; i < depth; ++i)
+		{
+			batch += COMMANDS[(index + b * depth + i) % (sizeof(COMMANDS) / sizeof(COMMANDS[0]))];
+			batch += '\n';
+		}
+		
+		std::chrono::steady_clock::time_point sent = std::chrono::steady_clock::now();
+		if (send(descriptor, batch.data(), batch.size(), MSG_NOSIGNAL) != static_cast<ssize_t>(batch.size()))
+		{
+			result.failed = true;
+			break;
+		}
+		
+		//Every response ends with a line starting OK or ERR
+		unsigned int answered = 0;
+		while (answered < depth)
+		{
+			ssize_t got = recv(descriptor, buf, sizeof(buf), 0);
+			if (got <= 0)
+			{
+				result.failed = true;
+				break;
+			}
+			pending.append(buf, got);
+			
+			size_t lineEnd;
+			while ((lineEnd = pending.find('\n')) != std::string::npos)
+			{
+				if (!pending.compare(0, 2, "OK") || !pending.compare(0, 3, "ERR"))
+				{
+					result.latenciesUs.push_back(std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - sent).count());
+					++answered;
+				}
+				pending.erase(0, lineEnd + 1);
+			}
+		}
+		result.responses += answered;
+	}
+	
+	close(descriptor);
+	
+	return;
+}
+
+void runHalfClosedClient(const std::string& path, clientResult& result)
+{
+	int descriptor = connectClient(path);
+	if (descriptor == -1)
+	{
+		result.failed = true;
+		return;
+	}
+	
+	//Don't wait forever on a socket that never answers or never closes
+	timeval timeout = {};
+	timeout.tv_sec = HALF_CLOSED_TIMEOUT.count();
+	setsockopt(descriptor, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+	
+	//Every command then a line with no end, which should be thrown away at the hang up
+	std::string batch;
+	for (unsigned int i = 0; i < HALF_CLOSED_COMMANDS; ++i)
+	{
+		batch += COMMANDS[i % (sizeof(COMMANDS) / sizeof(COMMANDS[0]))];
+		batch += '\n';
+	}
+	batch += "stats";
+	
+	if (send(descriptor, batch.data(), batch.size(), MSG_NOSIGNAL) != static_cast<ssize_t>(batch.size()) || shutdown(descriptor, SHUT_WR))
+	{
+		result.failed = true;
+		close(descriptor);
+		return;
+	}
+	
+	//Read until the socket closes its side too
+	std::string received;
+	char buf[4096];
+	ssize_t got;
+	while ((got = recv(descriptor, buf, sizeof(buf), 0)) > 0) received.append(buf, got);
+	if (got == -1) result.failed = true;
+	
+	size_t lineStart = 0;
+	size_t lineEnd;
+	while ((lineEnd = received.find('\n', lineStart)) != std::string::npos)
+	{
+		if (!received.compare(lineStart, 2, "OK") || !received.compare(lineStart, 3, "ERR")) ++result.responses;
+		lineStart = lineEnd + 1;
+	}
+	
+	close(descriptor);
+	
+	return;
+}
+
+void printLoop(const char* name, loopResult& loop)
+{
+	std::printf("%-8s %10.1f %10.1f %10.1f %12.1f %12.1f %10u\n", name, percentile(loop.serviceUs, 0.5), percentile(loop.serviceUs, 0.99), percentile(loop.serviceUs, 1),
+				percentile(loop.periodUs, 0.99), percentile(loop.periodUs, 1), loop.maxHandled);
+	
+	return;
+}
+
+int main(int argc, char* argv[])
+{
+	unsigned int clients = DEFAULT_CLIENTS;
+	unsigned int depth = DEFAULT_DEPTH;
+	unsigned int batches = DEFAULT_BATCHES;
+	unsigned int fps = DEFAULT_FPS;
+	
+	for (int i = 1; i < argc; ++i)
+	{
+		if (!std::strcmp(argv[i], "--clients") && i + 1 < argc) clients = std::atoi(argv[++i]);
+		else if (!std::strcmp(argv[i], "--depth") && i + 1 < argc) depth = std::atoi(argv[++i]);
+		else if (!std::strcmp(argv[i], "--batches") && i + 1 < argc) batches = std::atoi(argv[++i]);
+		else if (!std::strcmp(argv[i], "--fps") && i + 1 < argc) fps = std::atoi(argv[++i]);
+		else
+		{
+			std::cerr << "Usage: controlbench [--clients N] [--depth N] [--batches N] [--fps N]" << std::endl;
+			return 1;
+		}
+	}
+	clients = std::min(std::max(clients, 1u), CONTROL_MAX_CLIENTS); //Past that the socket turns them away
+	if (depth == 0) depth = DEFAULT_DEPTH;
+	if (batches == 0) batches = DEFAULT_BATCHES;
+	if (fps == 0) fps = DEFAULT_FPS;
+	
+	std::string path = "/tmp/sunclock-controlbench-" + std::to_string(getpid()) + ".sock";
+	ControlSocket controlSocket(path);
+	if (!controlSocket.isOpen()) return 1;
+	
+	std::cout << clients << " clients, " << batches << " batches of " << depth << " pipelined commands each, " << fps << " FPS, " << CONTROL_MAX_COMMANDS_PER_SERVICE
+			  << " commands per frame budget" << std::endl;
+	
+	//Idle run first, for what the frame period looks like without any clients
+	std::atomic<bool> stop{false};
+	loopResult idle = runFrameLoop(controlSocket, fps, stop, IDLE_FRAMES);
+	
+	std::vector<clientResult> results(clients);
+	std::vector<std::thread> threads;
+	std::atomic<unsigned int> finished{0};
+	for (unsigned int c = 0; c < clients; ++c)
+	{
+		threads.emplace_back([&, c]()
+		{
+			runClient(path, c, depth, batches, results[c]);
+			finished.fetch_add(1, std::memory_order_release);
+			if (finished.load(std::memory_order_acquire) == clients) stop.store(true, std::memory_order_release);
+		});
+	}
+	
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+	loopResult loaded = runFrameLoop(controlSocket, fps, stop, 0);
+	double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+	for (std::thread& thread : threads) thread.join();
+	
+	std::vector<double> latenciesUs;
+	uint64_t responses = 0;
+	bool failed = false;
+	for (clientResult& result : results)
+	{
+		latenciesUs.insert(latenciesUs.end(), result.latenciesUs.begin(), result.latenciesUs.end());
+		responses += result.responses;
+		failed |= result.failed;
+	}
+	
+	uint64_t expected = static_cast<uint64_t>(clients) * depth * batches;
+	std::printf("%llu commands in %.2f s over %zu frames, %.0f commands/s\n", static_cast<unsigned long long>(responses), seconds, loaded.serviceUs.size(), responses / seconds);
+	std::printf("Latency, send to response: median %.0f us, p99 %.0f us, max %.0f us\n", percentile(latenciesUs, 0.5), percentile(latenciesUs, 0.99), percentile(latenciesUs, 1));
+	
+	std::printf("\n%-8s %10s %10s %10s %12s %12s %10s\n", "loop", "serve med", "serve p99", "serve max", "period p99", "period max", "max/frame");
+	printLoop("idle", idle);
+	printLoop("loaded", loaded);
+	std::printf("Target period %.1f us. Serving comes out of the sleep, so the period only moves once a frame overruns. The budget caps throughput at %u commands/s\n", 1e6 / fps,
+				CONTROL_MAX_COMMANDS_PER_SERVICE * fps);
+	
+	if (failed || responses != expected || loaded.handled != expected)
+	{
+		std::cerr << "ERROR: Expected " << expected << " responses, clients got " << responses << " and the socket handled " << loaded.handled << std::endl;
+		failed = true;
+	}
+	if (loaded.maxHandled > CONTROL_MAX_COMMANDS_PER_SERVICE)
+	{
+		std::cerr << "ERROR: A frame served " << loaded.maxHandled << " commands, over the budget of " << CONTROL_MAX_COMMANDS_PER_SERVICE << std::endl;
+		failed = true;
+	}
+	
+	//Send and hang up, answers after
+	std::atomic<bool> halfClosedDone{false};
+	clientResult halfClosed;
+	std::thread halfClosedThread([&]()
+	{
+		runHalfClosedClient(path, halfClosed);
+		halfClosedDone.store(true, std::memory_order_release);
+	});
+	loopResult halfClosedLoop = runFrameLoop(controlSocket, fps, halfClosedDone, 0);
+	halfClosedThread.join();
+	
+	std::printf("\nHalf closed client: %llu of %u commands answered over %zu frames, %zu clients left connected\n", static_cast<unsigned long long>(halfClosed.responses),
+				HALF_CLOSED_COMMANDS, halfClosedLoop.serviceUs.size(), controlSocket.getClientCount());
+	
+	if (halfClosed.failed || halfClosed.responses != HALF_CLOSED_COMMANDS || halfClosedLoop.handled != HALF_CLOSED_COMMANDS || controlSocket.getClientCount())
+	{
+		std::cerr << "ERROR: A client that hung up after sending " << HALF_CLOSED_COMMANDS << " commands got " << halfClosed.responses << " answers"
+				  << (halfClosed.failed ? " and the socket never closed on it" : "") << std::endl;
+		failed = true;
+	}
+	
+	return failed ? 1 : 0;
+}
@@ -0,0 +1,326 @@
+/******************************************************************************
+/ Pi 4 Sunrise Clock App Control Socket Implementation - lopezk38 2025
+/
+/*****************************************************************************/
+
+/******************************************************************************
+/ Dependencies, namespacing
+/*****************************************************************************/
+
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <sys/epoll.h>
+#include <fcntl.h>
+#include <cerrno>
+#include <cstring>
+
+#include "controlSocket.h"
+#include "logger.h"
+
+
+/******************************************************************************
+/ Class implementation
+/*****************************************************************************/
+
+ControlSocket::ControlSocket(const std::string& path): path(path)
+{
+	//The clock runs fine without its control socket, so this is not fatal
+	if (openSocket() != CONTROL_ERR::CODE::SUCCESS)
+	{
+		errorState = true;
+		logger::warning("Control socket is unavailable");
+	}
+	
+	return;
+}
+
+ControlSocket::~ControlSocket()
+{
+	for (auto& entry : this->clients) close(entry.first);
+	
+	if (this->listenDescriptor != -1)
+	{
+		close(this->listenDescriptor);
+		unlink(this->path.c_str());
+	}
+	
+	if (this->epollDescriptor != -1) close(this->epollDescriptor);
+	
+	return;
+}
+
+CONTROL_ERR::CODE ControlSocket::openSocket()
+{
+	sockaddr_un address = {};
+	address.sun_family = AF_UNIX;
+	
+	if (this->path.size() >= sizeof(address.sun_path))
+	{
+		logger::error("Control socket path is too long: {}", this->path);
+		return CONTROL_ERR::CODE::OPEN_FAIL;
+	}
+	std::strcpy(address.sun_path, this->path.c_str());
+	
+	this->listenDescriptor = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+	if (this->listenDescriptor == -1)
+	{
+		logger::error("Failed to create control socket");
+		return CONTROL_ERR::CODE::OPEN_FAIL;
+	}
+	
+	//Clear out a socket file left behind by a previous run
+	unlink(this->path.c_str());
+	
+	if (bind(this->listenDescriptor, reinterpret_cast<sockaddr*>(&address), sizeof(address)) || listen(this->listenDescriptor, CONTROL_MAX_CLIENTS))
+	{
+		logger::error("Failed to bind control socket at {}: {}", this->path, std::strerror(errno));
+		return CONTROL_ERR::CODE::BIND_FAIL;
+	}
+	
+	this->epollDescriptor = epoll_create1(EPOLL_CLOEXEC);
+	if (this->epollDescriptor == -1)
+	{
+		logger::error("Failed to create control socket epoll instance");
+		return CONTROL_ERR::CODE::EPOLL_FAIL;
+	}
+	
+	epoll_event event = {};
+	event.events = EPOLLIN;
+	event.data.fd = this->listenDescriptor;
+	if (epoll_ctl(this->epollDescriptor, EPOLL_CTL_ADD, this->listenDescriptor, &event))
+	{
+		logger::error("Failed to watch control socket");
+		return CONTROL_ERR::CODE::EPOLL_FAIL;
+	}
+	
+	logger::verbose("Control socket listening at {}", this->path);
+	
+	return CONTROL_ERR::CODE::SUCCESS;
+}
+
+bool ControlSocket::isOpen()
+{
+	return !this->errorState;
+}
+
+int ControlSocket::getEpollDescriptor()
+{
+	return this->epollDescriptor;
+}
+
+size_t ControlSocket::getClientCount()
+{
+	return this->clients.size();
+}
+
+unsigned int ControlSocket::service(const commandHandler& handler)
+{
+	if (this->errorState) return 0;
+	
+	//Never wait here. This runs once per frame
+	epoll_event events[CONTROL_MAX_EVENTS_PER_SERVICE];
+	int eventCount = epoll_wait(this->epollDescriptor, events, CONTROL_MAX_EVENTS_PER_SERVICE, 0);
+	
+	for (int i = 0; i < eventCount; ++i)
+	{
+		int descriptor = events[i].data.fd;
+		
+		if (descriptor == this->listenDescriptor)
+		{
+			acceptClients();
+			continue;
+		}
+		
+		auto found = this->clients.find(descriptor);
+		if (found == this->clients.end()) continue;
+		client& cl = found->second;
+		
+		if ((events[i].events & EPOLLOUT) && (!flushClient(cl) || isFinished(cl)))
+		{
+			dropClient(descriptor);
+			continue;
+		}
+		
+		if ((events[i].events & (EPOLLIN | EPOLLHUP | EPOLLERR)) && !cl.closing && !readClient(cl))
+		{
+			dropClient(descriptor);
+			continue;
+		}
+	}
+	
+	//Serve buffered commands round robin, one line per client per turn, until the budget runs out. Leftovers wait for the next frame
+	unsigned int handled = 0;
+	while (handled < CONTROL_MAX_COMMANDS_PER_SERVICE && !this->readyClients.empty())
+	{
+		int descriptor = this->readyClients.front();
+		this->readyClients.pop_front();
+		
+		auto found = this->clients.find(descriptor);
+		if (found == this->clients.end()) continue; //Dropped since it was queued
+		client& cl = found->second;
+		cl.queued = false;
+		
+		size_t lineEnd = cl.inBuf.find('\n');
+		if (lineEnd == std::string::npos) continue;
+		
+		std::string command = cl.inBuf.substr(0, lineEnd);
+		cl.inBuf.erase(0, lineEnd + 1);
+		if (!command.empty() && command.back() == '\r') command.pop_back();
+		
+		cl.outBuf += handler(command);
+		++handled;
+		
+		if (!flushClient(cl) || isFinished(cl))
+		{
+			dropClient(descriptor);
+			continue;
+		}
+		
+		//Go to the back of the line if there is more to do
+		if (cl.inBuf.find('\n') != std::string::npos)
+		{
+			cl.queued = true;
+			this->readyClients.push_back(descriptor);
+		}
+		
+		updateInterest(cl);
+	}
+	
+	return handled;
+}
+
+void ControlSocket::acceptClients()
+{
+	for (unsigned int i = 0; i < CONTROL_MAX_ACCEPTS_PER_SERVICE; ++i)
+	{
+		int descriptor = accept4(this->listenDescriptor, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+		if (descriptor == -1) return; //EAGAIN, nothing left to accept
+		
+		if (this->clients.size() >= CONTROL_MAX_CLIENTS)
+		{
+			static constexpr char busyMsg[] = "ERR too many clients\n";
+			send(descriptor, busyMsg, sizeof(busyMsg) - 1, MSG_NOSIGNAL);
+			close(descriptor);
+			continue;
+		}
+		
+		epoll_event event = {};
+		event.events = EPOLLIN;
+		event.data.fd = descriptor;
+		if (epoll_ctl(this->epollDescriptor, EPOLL_CTL_ADD, descriptor, &event))
+		{
+			close(descriptor);
+			continue;
+		}
+		
+		this->clients[descriptor].descriptor = descriptor;
+	}
+	
+	return;
+}
+
+bool ControlSocket::readClient(client& cl)
+{
+	//Returns false if the client should be dropped
+	char buf[1024];
+	
+	while (cl.inBuf.size() < CONTROL_IN_BUF_CAP)
+	{
+		ssize_t got = recv(cl.descriptor, buf, sizeof(buf), 0);
+		
+		if (got > 0)
+		{
+			cl.inBuf.append(buf, got);
+			continue;
+		}
+		
+		if (got == 0)
+		{
+			//Hung up, maybe only its sending side. Lines already in still get answered
+			cl.closing = true;
+			break;
+		}
+		if (errno == EAGAIN || errno == EWOULDBLOCK) break;
+		if (errno == EINTR) continue;
+		
+		return false;
+	}
+	
+	//A line that will never fit is garbage
+	size_t lineEnd = cl.inBuf.find('\n');
+	if ((lineEnd == std::string::npos && cl.inBuf.size() > CONTROL_MAX_LINE) || (lineEnd != std::string::npos && lineEnd > CONTROL_MAX_LINE)) return false;
+	
+	if (lineEnd != std::string::npos && !cl.queued)
+	{
+		cl.queued = true;
+		this->readyClients.push_back(cl.descriptor);
+	}
+	
+	if (isFinished(cl)) return false;
+	
+	updateInterest(cl);
+	
+	return true;
+}
+
+bool ControlSocket::flushClient(client& cl)
+{
+	//Returns false if the client should be dropped
+	while (!cl.outBuf.empty())
+	{
+		ssize_t sent = send(cl.descriptor, cl.outBuf.data(), cl.outBuf.size(), MSG_NOSIGNAL);
+		
+		if (sent > 0)
+		{
+			cl.outBuf.erase(0, sent);
+			continue;
+		}
+		
+		if (sent == -1 && (errno == EAGAIN || errno == EWOULDBLOCK)) break;
+		if (sent == -1 && errno == EINTR) continue;
+		
+		return false;
+	}
+	
+	if (cl.outBuf.size() > CONTROL_OUT_BUF_CAP) return false;
+	
+	updateInterest(cl);
+	
+	return true;
+}
+
+void ControlSocket::updateInterest(client& cl)
+{
+	//Backpressure: stop listening to clients with a full input buffer, and only ask for EPOLLOUT while output is stuck
+	bool pauseRead = cl.inBuf.size() >= CONTROL_IN_BUF_CAP || cl.closing; //Nothing more is coming after a hang up
+	bool waitWrite = !cl.outBuf.empty();
+	
+	if (pauseRead == cl.readPaused && waitWrite == cl.writeWaiting) return;
+	
+	epoll_event event = {};
+	if (!pauseRead) event.events |= EPOLLIN;
+	if (waitWrite) event.events |= EPOLLOUT;
+	event.data.fd = cl.descriptor;
+	epoll_ctl(this->epollDescriptor, EPOLL_CTL_MOD, cl.descriptor, &event);
+	
+	cl.readPaused = pauseRead;
+	cl.writeWaiting = waitWrite;
+	
+	return;
+}
+
+bool ControlSocket::isFinished(const client& cl)
+{
+	//A client that hung up is done once every full line it sent is answered and the answers are out
+	return cl.closing && cl.outBuf.empty() && cl.inBuf.find('\n') == std::string::npos;
+}
+
+void ControlSocket::dropClient(int descriptor)
+{
+	epoll_ctl(this->epollDescriptor, EPOLL_CTL_DEL, descriptor, nullptr);
+	close(descriptor);
+	this->clients.erase(descriptor);
+	
+	return;
+}
@@ -0,0 +1,90 @@
+/******************************************************************************
+/ Pi 4 Sunrise Clock App Control Socket Class Spec - lopezk38 2025
+/
+/*****************************************************************************/
+
+#ifndef SUNCLOCK_APP_CTRLSOCK
+#define SUNCLOCK_APP_CTRLSOCK
+
+/******************************************************************************
+/ Dependencies, namespacing
+/*****************************************************************************/
+
+#include <string>
+#include <deque>
+#include <unordered_map>
+#include <functional>
+
+#include "errorcodes.h"
+
+
+/******************************************************************************
+/ Constants
+/*****************************************************************************/
+
+constexpr unsigned int CONTROL_MAX_CLIENTS = 32;
+constexpr unsigned int CONTROL_MAX_COMMANDS_PER_SERVICE = 8; //Bounds the work done per frame no matter how chatty clients are
+constexpr unsigned int CONTROL_MAX_ACCEPTS_PER_SERVICE = 8;
+constexpr unsigned int CONTROL_MAX_EVENTS_PER_SERVICE = 16;
+constexpr size_t CONTROL_MAX_LINE = 256;
+constexpr size_t CONTROL_IN_BUF_CAP = 4096; //Stop reading from a client until it drains below this
+constexpr size_t CONTROL_OUT_BUF_CAP = 65536; //Drop clients that stop reading their responses
+
+
+/******************************************************************************
+/ Class specification
+/*****************************************************************************/
+
+class ControlSocket
+{
+	
+public:
+
+	//Takes one command line without the newline, returns the full response text
+	typedef std::function<std::string(const std::string& command)> commandHandler;
+	
+private:
+	
+	struct client
+	{
+		int descriptor = -1;
+		std::string inBuf;
+		std::string outBuf;
+		bool readPaused = false;
+		bool writeWaiting = false;
+		bool queued = false; //Already waiting in readyClients
+		bool closing = false; //Hung up its side. Still answered for the full lines it sent, then dropped
+	};
+	
+	const std::string path;
+	int listenDescriptor = -1;
+	int epollDescriptor = -1;
+	
+	std::unordered_map<int, client> clients;
+	std::deque<int> readyClients; //Clients with at least one full command line buffered, served round robin
+	
+	bool errorState = false;
+	
+	CONTROL_ERR::CODE openSocket();
+	
+	void acceptClients();
+	bool readClient(client& cl);
+	bool flushClient(client& cl);
+	void updateInterest(client& cl);
+	bool isFinished(const client& cl);
+	void dropClient(int descriptor);
+	
+public:
+
+	ControlSocket(const std::string& path);
+	~ControlSocket();
+	
+	bool isOpen();
+	int getEpollDescriptor(); //Readable whenever there is socket work to do, so it can be waited on
+	
+	unsigned int service(const commandHandler& handler);
+	
+	size_t getClientCount();
+};
+
+#endif
@@ -0,0 +1,184 @@
+/******************************************************************************
+/ Pi 4 Sunrise Clock App Day Plan Implementation - lopezk38 2025
+/
+/*****************************************************************************/
+
+/******************************************************************************
+/ Dependencies, namespacing
+/*****************************************************************************/
+
+#include <algorithm>
+
+#include "dayPlan.h"
+#include "sunColorCurveLUT.h"
+
+
+/******************************************************************************
+/ Helpers
+/*****************************************************************************/
+
+constexpr long SECONDS_PER_DAY = 24 * 60 * 60;
+
+static unsigned char curveAt(long secondOfDay)
+{
+	return SunBrightness::interp(secondOfDay / 3600, (secondOfDay / 60) % 60);
+}
+
+const char* PLAN_ACTION::toString(PLAN_ACTION::CODE action)
+{
+	switch (action)
+	{
+		case PLAN_ACTION::CODE::SET_BRIGHTNESS: return "SET_BRIGHTNESS";
+		case PLAN_ACTION::CODE::POWER_ON: return "POWER_ON";
+		case PLAN_ACTION::CODE::POWER_OFF: return "POWER_OFF";
+	}
+	
+	return "UNKNOWN";
+}
+
+
+/******************************************************************************
+/ Class implementation
+/*****************************************************************************/
+
+DayPlan::DayPlan(std::chrono::seconds sampleInterval, std::chrono::seconds powerOnLead, bool powerByBrightness):
+	sampleSeconds(std::max(1L, static_cast<long>(sampleInterval.count()))), powerOnLead(powerOnLead.count()), powerByBrightness(powerByBrightness)
+{
+	//At most one brightness step and one power step per sample
+	this->steps.reserve(2 * ((SECONDS_PER_DAY + this->sampleSeconds - 1) / this->sampleSeconds));
+	
+	return;
+}
+
+void DayPlan::compile()
+{
+	this->steps.clear();
+	
+	//The curves wrap at midnight, so the day starts from wherever the last sample of it left things
+	unsigned char previous = curveAt(((SECONDS_PER_DAY - 1) / this->sampleSeconds) * this->sampleSeconds);
+	bool poweredOn = !this->powerByBrightness || previous;
+	this->startsPoweredOn = poweredOn;
+	
+	for (long sample = 0; sample < SECONDS_PER_DAY; sample += this->sampleSeconds)
+	{
+		unsigned char brightness = curveAt(sample);
+		
+		if (this->powerByBrightness && static_cast<bool>(brightness) != poweredOn)
+		{
+			poweredOn = brightness;
+			if (!poweredOn)
+			{
+				//Writing a zero to a display about to go off is wasted
+				this->steps.push_back({ sample, PLAN_ACTION::CODE::POWER_OFF, 0 });
+				previous = 0;
+				
+				continue;
+			}
+			
+			//Early enough that the display is up when its first brightness lands. Can't start before midnight, it just runs a little late then
+			this->steps.push_back({ std::max(0L, sample - this->powerOnLead), PLAN_ACTION::CODE::POWER_ON, brightness });
+		}
+		
+		//The monitor is already there
+		if (brightness == previous) continue;
+		
+		this->steps.push_back({ sample, PLAN_ACTION::CODE::SET_BRIGHTNESS, brightness });
+		previous = brightness;
+	}
+	
+	//Only a power on lead longer than the sample interval can land out of order. Power goes first on a tie
+	std::sort(this->steps.begin(), this->steps.end(), [](const planStep& lhs, const planStep& rhs)
+	{
+		if (lhs.secondOfDay != rhs.secondOfDay) return lhs.secondOfDay < rhs.secondOfDay;
+		return lhs.action > rhs.action;
+	});
+	
+	this->cursor = 0;
+	
+	return;
+}
+
+void DayPlan::seek(long secondOfDay)
+{
+	auto next = std::upper_bound(this->steps.begin(), this->steps.end(), secondOfDay, [](long second, const planStep& step) { return second < step.secondOfDay; });
+	this->cursor = next - this->steps.begin();
+	this->lastSecond = secondOfDay;
+	
+	return;
+}
+
+bool DayPlan::nextDue(long secondOfDay, planStep& step)
+{
+	//Clock jumps are seeked past before getting here, so going backwards means midnight
+	if (secondOfDay < this->lastSecond)
+	{
+		//Finish yesterday first. They're all late by now
+		if (this->cursor < this->steps.size())
+		{
+			step = this->steps[this->cursor++];
+			return true;
+		}
+		
+		compile();
+	}
+	this->lastSecond = secondOfDay;
+	
+	if (this->cursor >= this->steps.size() || this->steps[this->cursor].secondOfDay > secondOfDay) return false;
+	
+	step = this->steps[this->cursor++];
+	
+	return true;
+}
+
+bool DayPlan::powerOnAt(long secondOfDay) const
+{
+	bool poweredOn = this->startsPoweredOn;
+	
+	//Only a handful of power steps a day, a walk is fine
+	for (const planStep& step : this->steps)
+	{
+		if (step.secondOfDay > secondOfDay) break;
+		
+		if (step.action == PLAN_ACTION::CODE::POWER_ON) poweredOn = true;
+		else if (step.action == PLAN_ACTION::CODE::POWER_OFF) poweredOn = false;
+	}
+	
+	return poweredOn;
+}
+
+bool DayPlan::nextPowerStep(long secondOfDay, planStep& step) const
+{
+	const planStep* first = nullptr;
+	
+	for (const planStep& candidate : this->steps)
+	{
+		if (candidate.action == PLAN_ACTION::CODE::SET_BRIGHTNESS) continue;
+		if (!first) first = &candidate;
+		
+		if (candidate.secondOfDay > secondOfDay)
+		{
+			step = candidate;
+			return true;
+		}
+	}
+	
+	if (!first) return false;
+	
+	step = *first;
+	return true;
+}
+
+size_t DayPlan::size() const
+{
+	return this->steps.size();
+}
+
+size_t DayPlan::getCursor() const
+{
+	return this->cursor;
+}
+
+const planStep& DayPlan::getStepAt(size_t index) const
+{
+	return this->steps[index];
+}
@@ -0,0 +1,91 @@
+/******************************************************************************
+/ Pi 4 Sunrise Clock App Day Plan Class Spec - lopezk38 2025
+/
+/ Everything the curves make the clock do is known a day ahead. The plan
+/ works it all out once, into a sorted list of what to do when, and the main
+/ loop just walks a cursor along it. Anything not on the curves, like control
+/ socket requests, power sequence steps and the light sensor, still goes
+/ through the task heap
+/
+/*****************************************************************************/
+
+#ifndef SUNCLOCK_APP_DAYPLAN
+#define SUNCLOCK_APP_DAYPLAN
+
+/******************************************************************************
+/ Dependencies, namespacing
+/*****************************************************************************/
+
+#include <chrono>
+#include <cstddef>
+#include <vector>
+
+
+/******************************************************************************
+/ PLAN_ACTION enum
+/*****************************************************************************/
+
+namespace PLAN_ACTION
+{
+	enum CODE
+	{
+		SET_BRIGHTNESS, //Value is the curve brightness
+		POWER_ON,
+		POWER_OFF
+	};
+	
+	const char* toString(PLAN_ACTION::CODE action);
+}
+
+struct planStep
+{
+	long secondOfDay;
+	PLAN_ACTION::CODE action;
+	unsigned char value;
+};
+
+
+/******************************************************************************
+/ Class specification
+/*****************************************************************************/
+
+class DayPlan
+{
+
+private:
+
+	const long sampleSeconds; //How often the curve is looked at
+	const long powerOnLead; //Power on goes this far ahead of the first non zero brightness
+	const bool powerByBrightness; //Off at zero brightness and back on after
+	
+	std::vector<planStep> steps; //Sorted by time. Room for the worst case is reserved up front, so compiling never allocates
+	size_t cursor = 0; //Next step to run
+	long lastSecond = -1; //Time of day the cursor was last advanced to. Going backwards means midnight passed
+	
+	bool startsPoweredOn = true; //Power state carried over from the end of the day before
+
+public:
+
+	DayPlan(std::chrono::seconds sampleInterval, std::chrono::seconds powerOnLead, bool powerByBrightness);
+	
+	//Works the day out from the curves. Run at startup and at midnight, or whenever the curves change
+	void compile();
+	
+	//Points the cursor at the first step after a time of day without running anything. For startup and clock jumps
+	void seek(long secondOfDay);
+	
+	//Hands back the next step that is due, one per call. Steps left over from before midnight come out first
+	bool nextDue(long secondOfDay, planStep& step);
+	
+	//What the plan wants the display power to be at a time of day
+	bool powerOnAt(long secondOfDay) const;
+	
+	//The first power on or off after a time of day, tomorrow's first if today has none left. False if the plan never changes the power
+	bool nextPowerStep(long secondOfDay, planStep& step) const;
+	
+	size_t size() const;
+	size_t getCursor() const;
+	const planStep& getStepAt(size_t index) const;
+};
+
+#endif
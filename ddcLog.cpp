@@ -0,0 +1,199 @@
+/******************************************************************************
+/ Pi 4 Sunrise Clock App DDC Record/Replay Log Implementation - lopezk38 2025
+/
+/*****************************************************************************/
+
+/******************************************************************************
+/ Dependencies, namespacing
+/*****************************************************************************/
+
+#include <unistd.h>
+#include <fcntl.h>
+#include <chrono>
+#include <thread>
+#include <vector>
+#include <cstddef>
+#include <algorithm>
+
+#include "ddcLog.h"
+#include "logger.h"
+
+bool ddcLog::recording = false;
+bool ddcLog::replaying = false;
+
+static int logDescriptor = -1;
+static uint64_t logStartNs = 0;
+
+static std::vector<ddcLog::logRecord> replayRecords;
+static size_t replayCursor = 0;
+static ddcLog::logHeader replayHeader = {};
+
+//Summary counters
+static uint64_t transactionCount = 0;
+static uint64_t busTimeUs = 0;
+static uint64_t replayMisses = 0;
+
+
+/******************************************************************************
+/ Implementation
+/*****************************************************************************/
+
+uint64_t ddcLog::nowNs()
+{
+	return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+bool ddcLog::startRecording(const char* path)
+{
+	logDescriptor = open(path, O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+	if (logDescriptor == -1)
+	{
+		logger::error("Failed to create DDC log {}", path);
+		return false;
+	}
+	
+	logHeader header = {};
+	header.magic = DDCLOG_MAGIC;
+	header.version = DDCLOG_VERSION;
+	header.startedAt = std::chrono::duration_cast<std::chrono::seconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+	
+	if (write(logDescriptor, &header, sizeof(header)) != sizeof(header))
+	{
+		logger::error("Failed to write DDC log header");
+		close(logDescriptor);
+		logDescriptor = -1;
+		return false;
+	}
+	
+	logStartNs = nowNs();
+	recording = true;
+	
+	logger::info("Recording DDC transactions to {}", path);
+	
+	return true;
+}
+
+bool ddcLog::startReplay(const char* path)
+{
+	int descriptor = open(path, O_RDONLY | O_CLOEXEC);
+	if (descriptor == -1)
+	{
+		logger::error("Failed to open DDC log {}", path);
+		return false;
+	}
+	
+	if (read(descriptor, &replayHeader, sizeof(replayHeader)) != sizeof(replayHeader) || replayHeader.magic != DDCLOG_MAGIC || replayHeader.version != DDCLOG_VERSION)
+	{
+		logger::error("{} is not a DDC log this version can replay", path);
+		close(descriptor);
+		return false;
+	}
+	
+	//Logs are small, a night is a few hundred records. Load the lot
+	logRecord loaded;
+	while (read(descriptor, &loaded, sizeof(loaded)) == sizeof(loaded)) replayRecords.push_back(loaded);
+	close(descriptor);
+	
+	replaying = true;
+	
+	logger::info("Replaying {} DDC transactions from {}", replayRecords.size(), path);
+	
+	return true;
+}
+
+void ddcLog::stop()
+{
+	if (!recording && !replaying) return;
+	
+	if (replaying) logger::info("DDC replay: {} transactions, {} ms on the bus, {} not found in the log", transactionCount, busTimeUs / 1000, replayMisses);
+	else logger::info("DDC recording: {} transactions, {} ms on the bus", transactionCount, busTimeUs / 1000);
+	
+	if (logDescriptor != -1) close(logDescriptor);
+	logDescriptor = -1;
+	
+	recording = false;
+	replaying = false;
+	
+	transactionCount = 0;
+	busTimeUs = 0;
+	replayMisses = 0;
+	
+	return;
+}
+
+void ddcLog::setMonitor(const monitorIdentity& monitor)
+{
+	if (!recording) return;
+	
+	//The header went out before DDC attached. Patch the identity in place
+	uint8_t known = 1;
+	pwrite(logDescriptor, &monitor, sizeof(monitor), offsetof(logHeader, monitor));
+	pwrite(logDescriptor, &known, sizeof(known), offsetof(logHeader, monitorKnown));
+	
+	return;
+}
+
+bool ddcLog::getMonitor(monitorIdentity& monitor)
+{
+	if (!replaying || !replayHeader.monitorKnown) return false;
+	
+	monitor = replayHeader.monitor;
+	
+	return true;
+}
+
+void ddcLog::record(DIRECTION::CODE direction, uint8_t vcpCode, uint16_t value, uint16_t maxValue, int32_t status, uint64_t startNs, uint64_t endNs)
+{
+	if (!recording) return;
+	
+	logRecord entry = {};
+	entry.startNs = startNs - logStartNs;
+	entry.durationUs = (endNs - startNs) / 1000;
+	entry.status = status;
+	entry.value = value;
+	entry.maxValue = maxValue;
+	entry.vcpCode = vcpCode;
+	entry.direction = direction;
+	
+	//One small append per transaction. The transaction itself took tens of milliseconds, so this is noise
+	if (write(logDescriptor, &entry, sizeof(entry)) != sizeof(entry))
+	{
+		logger::error("Failed to append to DDC log, recording stopped");
+		stop();
+		return;
+	}
+	
+	++transactionCount;
+	busTimeUs += entry.durationUs;
+	
+	return;
+}
+
+bool ddcLog::replay(DIRECTION::CODE direction, uint8_t vcpCode, uint16_t* value, uint16_t* maxValue, int32_t* status)
+{
+	//Code changes can add or drop a transaction here and there. Skip ahead a little to stay in step rather than failing everything after
+	size_t end = std::min(replayCursor + REPLAY_LOOKAHEAD, replayRecords.size());
+	for (size_t i = replayCursor; i < end; ++i)
+	{
+		const logRecord& entry = replayRecords[i];
+		if (entry.direction != direction || entry.vcpCode != vcpCode) continue;
+		
+		replayCursor = i + 1;
+		
+		//Same latency the monitor had, so timing downstream behaves the same
+		std::this_thread::sleep_for(std::chrono::microseconds(entry.durationUs));
+		
+		if (value && direction == DIRECTION::CODE::READ) *value = entry.value;
+		if (maxValue) *maxValue = entry.maxValue;
+		*status = entry.status;
+		
+		++transactionCount;
+		busTimeUs += entry.durationUs;
+		
+		return true;
+	}
+	
+	++replayMisses;
+	
+	return false;
+}
@@ -0,0 +1,85 @@
+/******************************************************************************
+/ Pi 4 Sunrise Clock App DDC Record/Replay Log Spec - lopezk38 2025
+/
+/*****************************************************************************/
+
+#ifndef SUNCLOCK_APP_DDCLOG
+#define SUNCLOCK_APP_DDCLOG
+
+/******************************************************************************
+/ Dependencies, namespacing
+/*****************************************************************************/
+
+#include <cstdint>
+
+#include "stateFile.h"
+
+namespace ddcLog {
+
+
+/******************************************************************************
+/ File layout. Written straight to disk, so bump DDCLOG_VERSION on any change
+/*****************************************************************************/
+
+constexpr uint32_t DDCLOG_MAGIC = 0x474C4344; //"DCLG"
+constexpr uint32_t DDCLOG_VERSION = 1;
+constexpr unsigned int REPLAY_LOOKAHEAD = 64; //Records replay may skip over looking for a match
+
+namespace DIRECTION
+{
+	enum CODE : uint8_t
+	{
+		READ,
+		WRITE
+	};
+}
+
+struct logHeader
+{
+	uint32_t magic;
+	uint32_t version;
+	int64_t startedAt; //Wall clock seconds since epoch
+	
+	monitorIdentity monitor; //Filled in once DDC attaches
+	uint8_t monitorKnown;
+	uint8_t reserved[3];
+};
+
+struct logRecord
+{
+	uint64_t startNs; //Since the log was started
+	uint32_t durationUs;
+	int32_t status; //DDCA_Status
+	uint16_t value; //Written value, or current value read back
+	uint16_t maxValue; //Reads only
+	uint8_t vcpCode;
+	uint8_t direction;
+	uint8_t reserved[2];
+};
+
+static_assert(sizeof(logRecord) == 24, "DDC log records must stay compact");
+
+
+/******************************************************************************
+/ Recording and replay
+/*****************************************************************************/
+
+extern bool recording; //Only written by the start functions, before DDC init begins
+extern bool replaying;
+
+bool startRecording(const char* path);
+bool startReplay(const char* path);
+void stop(); //Prints a summary of bus use
+
+void setMonitor(const monitorIdentity& monitor); //Recording. Stored in the header
+bool getMonitor(monitorIdentity& monitor); //Replay. False if the recording never saw one
+
+uint64_t nowNs(); //Log clock, for timing transactions
+
+void record(DIRECTION::CODE direction, uint8_t vcpCode, uint16_t value, uint16_t maxValue, int32_t status, uint64_t startNs, uint64_t endNs);
+
+//Finds the next recorded transaction like this one and plays it back, latency included. False if there was none
+bool replay(DIRECTION::CODE direction, uint8_t vcpCode, uint16_t* value, uint16_t* maxValue, int32_t* status);
+}
+
+#endif
@@ -1,29 +1,130 @@
-/******************************************************************************
-/ Pi 4 Sunrise Clock App Error Code Enums - lopezk38 2025
-/ Version 0.1
-/
-/*****************************************************************************/
-
-#ifndef SUNCLOCK_APP_ERRCODES
-#define SUNCLOCK_APP_ERRCODES
-
-namespace RESDATA_ERR
-{
-	enum CODE
-	{
-		SUCCESS = 0,
-		RD_FAIL = 1
-	};
-}
-
-namespace FBDESC_ERR
-{
-	enum CODE
-	{
-		SUCCESS = 0,
-		OPEN_FAIL = 1,
-		RD_ERROR = 2
-	};
-}
-
+/******************************************************************************
+/ Pi 4 Sunrise Clock App Error Code Enums - lopezk38 2025
+/ Version 0.1
+/
+/*****************************************************************************/
+
+#ifndef SUNCLOCK_APP_ERRCODES
+#define SUNCLOCK_APP_ERRCODES
+
+namespace RESDATA_ERR
+{
+	enum CODE
+	{
+		SUCCESS = 0,
+		RD_FAIL = 1
+	};
+}
+
+namespace FBDESC_ERR
+{
+	enum CODE
+	{
+		SUCCESS = 0,
+		OPEN_FAIL = 1,
+		RD_ERROR = 2
+	};
+}
+
+namespace STATEFILE_ERR
+{
+	enum CODE
+	{
+		SUCCESS = 0,
+		OPEN_FAIL = 1,
+		MAP_FAIL = 2,
+		SYNC_FAIL = 3,
+		NO_VALID_STATE = 4
+	};
+}
+
+namespace CONTROL_ERR
+{
+	enum CODE
+	{
+		SUCCESS = 0,
+		OPEN_FAIL = 1,
+		BIND_FAIL = 2,
+		EPOLL_FAIL = 3
+	};
+}
+
+namespace METRICS_ERR
+{
+	enum CODE
+	{
+		SUCCESS = 0,
+		OPEN_FAIL = 1,
+		BIND_FAIL = 2
+	};
+}
+
+namespace SENSOR_ERR
+{
+	enum CODE
+	{
+		SUCCESS = 0,
+		OPEN_FAIL = 1,
+		RD_FAIL = 2,
+		PARSE_FAIL = 3
+	};
+}
+
+namespace CLOCKWATCH_ERR
+{
+	enum CODE
+	{
+		SUCCESS = 0,
+		ARM_FAIL = 1
+	};
+}
+
+namespace MONPROFILE_ERR
+{
+	enum CODE
+	{
+		SUCCESS = 0,
+		NOT_FOUND = 1,
+		OPEN_FAIL = 2,
+		RD_FAIL = 3,
+		WR_FAIL = 4,
+		BAD_FILE = 5
+	};
+}
+
+namespace POWERSTATE_ERR
+{
+	enum CODE
+	{
+		SUCCESS = 0,
+		NOT_FOUND = 1,
+		OPEN_FAIL = 2
+	};
+}
+
+namespace SKYSET_ERR
+{
+	enum CODE
+	{
+		SUCCESS = 0,
+		OPEN_FAIL = 1,
+		RD_FAIL = 2,
+		WR_FAIL = 3,
+		BAD_FILE = 4,
+		MAP_FAIL = 5
+	};
+}
+
+namespace SYNC_ERR
+{
+	enum CODE
+	{
+		SUCCESS = 0,
+		OPEN_FAIL = 1,
+		BAD_ADDRESS = 2,
+		BIND_FAIL = 3,
+		JOIN_FAIL = 4
+	};
+}
+
 #endif
\ No newline at end of file
@@ -0,0 +1,427 @@
+/******************************************************************************
+/ Pi 4 Sunrise Clock App Face Layers Implementation - lopezk38 2025
+/
+/*****************************************************************************/
+
+/******************************************************************************
+/ Dependencies, namespacing
+/*****************************************************************************/
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+
+#include "faceLayers.h"
+#include "sunColorCurveLUT.h"
+#include "clockTextColorCurveLUT.h"
+
+
+/******************************************************************************
+/ Helpers
+/*****************************************************************************/
+
+constexpr long SECONDS_PER_DAY = 24 * 60 * 60;
+constexpr int32_t GLYPH_WIDTH = 5;
+constexpr int32_t GLYPH_HEIGHT = 7;
+constexpr int32_t GLYPH_ADVANCE = GLYPH_WIDTH + 1; //One blank column between characters
+constexpr uint8_t ARC_TRACK_ALPHA = 64; //The unfilled part of the ring, over the sky
+
+struct glyph
+{
+	char character;
+	uint8_t rows[GLYPH_HEIGHT]; //Top down. Bit 4 is the leftmost column
+};
+
+constexpr glyph FONT[] =
+{
+	{ '0', { 0x0E, 0x11, 0x13, 0x15, 0x19, 0x11, 0x0E } },
+	{ '1', { 0x04, 0x0C, 0x04, 0x04, 0x04, 0x04, 0x0E } },
+	{ '2', { 0x0E, 0x11, 0x01, 0x02, 0x04, 0x08, 0x1F } },
+	{ '3', { 0x1F, 0x02, 0x04, 0x02, 0x01, 0x11, 0x0E } },
+	{ '4', { 0x02, 0x06, 0x0A, 0x12, 0x1F, 0x02, 0x02 } },
+	{ '5', { 0x1F, 0x10, 0x1E, 0x01, 0x01, 0x11, 0x0E } },
+	{ '6', { 0x06, 0x08, 0x10, 0x1E, 0x11, 0x11, 0x0E } },
+	{ '7', { 0x1F, 0x01, 0x02, 0x04, 0x08, 0x08, 0x08 } },
+	{ '8', { 0x0E, 0x11, 0x11, 0x0E, 0x11, 0x11, 0x0E } },
+	{ '9', { 0x0E, 0x11, 0x11, 0x0F, 0x01, 0x02, 0x0C } },
+	{ ':', { 0x00, 0x0C, 0x0C, 0x00, 0x0C, 0x0C, 0x00 } },
+	{ '%', { 0x18, 0x19, 0x02, 0x04, 0x08, 0x13, 0x03 } },
+	{ '-', { 0x00, 0x00, 0x00, 0x1F, 0x00, 0x00, 0x00 } },
+	{ '.', { 0x00, 0x00, 0x00, 0x00, 0x00, 0x0C, 0x0C } },
+	{ '/', { 0x00, 0x01, 0x02, 0x04, 0x08, 0x10, 0x00 } },
+	{ 'A', { 0x0E, 0x11, 0x11, 0x11, 0x1F, 0x11, 0x11 } },
+	{ 'B', { 0x1E, 0x11, 0x11, 0x1E, 0x11, 0x11, 0x1E } },
+	{ 'C', { 0x0E, 0x11, 0x10, 0x10, 0x10, 0x11, 0x0E } },
+	{ 'D', { 0x1C, 0x12, 0x11, 0x11, 0x11, 0x12, 0x1C } },
+	{ 'E', { 0x1F, 0x10, 0x10, 0x1E, 0x10, 0x10, 0x1F } },
+	{ 'F', { 0x1F, 0x10, 0x10, 0x1E, 0x10, 0x10, 0x10 } },
+	{ 'G', { 0x0E, 0x11, 0x10, 0x17, 0x11, 0x11, 0x0F } },
+	{ 'H', { 0x11, 0x11, 0x11, 0x1F, 0x11, 0x11, 0x11 } },
+	{ 'I', { 0x0E, 0x04, 0x04, 0x04, 0x04, 0x04, 0x0E } },
+	{ 'J', { 0x07, 0x02, 0x02, 0x02, 0x02, 0x12, 0x0C } },
+	{ 'K', { 0x11, 0x12, 0x14, 0x18, 0x14, 0x12, 0x11 } },
+	{ 'L', { 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x1F } },
+	{ 'M', { 0x11, 0x1B, 0x15, 0x15, 0x11, 0x11, 0x11 } },
+	{ 'N', { 0x11, 0x11, 0x19, 0x15, 0x13, 0x11, 0x11 } },
+	{ 'O', { 0x0E, 0x11, 0x11, 0x11, 0x11, 0x11, 0x0E } },
+	{ 'P', { 0x1E, 0x11, 0x11, 0x1E, 0x10, 0x10, 0x10 } },
+	{ 'Q', { 0x0E, 0x11, 0x11, 0x11, 0x15, 0x12, 0x0D } },
+	{ 'R', { 0x1E, 0x11, 0x11, 0x1E, 0x14, 0x12, 0x11 } },
+	{ 'S', { 0x0F, 0x10, 0x10, 0x0E, 0x01, 0x01, 0x1E } },
+	{ 'T', { 0x1F, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04 } },
+	{ 'U', { 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x0E } },
+	{ 'V', { 0x11, 0x11, 0x11, 0x11, 0x11, 0x0A, 0x04 } },
+	{ 'W', { 0x11, 0x11, 0x11, 0x15, 0x15, 0x15, 0x0A } },
+	{ 'X', { 0x11, 0x11, 0x0A, 0x04, 0x0A, 0x11, 0x11 } },
+	{ 'Y', { 0x11, 0x11, 0x11, 0x0A, 0x04, 0x04, 0x04 } },
+	{ 'Z', { 0x1F, 0x01, 0x02, 0x04, 0x08, 0x10, 0x1F } }
+};
+
+constexpr uint8_t BLANK_GLYPH[GLYPH_HEIGHT] = {};
+
+static const uint8_t* findGlyph(char character)
+{
+	if (character >= 'a' && character <= 'z') character -= 'a' - 'A';
+	
+	for (const glyph& entry : FONT)
+	{
+		if (entry.character == character) return entry.rows;
+	}
+	
+	return BLANK_GLYPH; //Spaces and anything the font doesn't have
+}
+
+static uint32_t packPixel(Color color)
+{
+	//RGBA8888 in memory byte order, read as a little endian word
+	return color.r | (color.g << 8) | (color.b << 16) | (0xFFu << 24);
+}
+
+static bool sameColor(Color lhs, Color rhs)
+{
+	return lhs.r == rhs.r && lhs.g == rhs.g && lhs.b == rhs.b && lhs.a == rhs.a;
+}
+
+static uint32_t* pixelAt(uint8_t* frame, size_t stride, int32_t x, int32_t y)
+{
+	return reinterpret_cast<uint32_t*>(frame + y * stride) + x;
+}
+
+
+/******************************************************************************
+/ Sky gradient
+/*****************************************************************************/
+
+SkyGradientLayer::SkyGradientLayer(uint32_t width, uint32_t height): area({ 0, 0, static_cast<int32_t>(width), static_cast<int32_t>(height) })
+{
+	return;
+}
+
+bool SkyGradientLayer::setColors(Color top, Color bottom)
+{
+	if (sameColor(top, this->top) && sameColor(bottom, this->bottom)) return false;
+	
+	this->top = top;
+	this->bottom = bottom;
+	
+	return true;
+}
+
+pixelRect SkyGradientLayer::bounds() const
+{
+	return this->area;
+}
+
+bool SkyGradientLayer::isOpaque() const
+{
+	return true;
+}
+
+void SkyGradientLayer::render(uint8_t* frame, size_t stride, const pixelRect& clip) const
+{
+	//One color per row, so a row is a plain fill
+	int32_t span = std::max(1, this->area.height - 1);
+	for (int32_t y = clip.y; y < clip.y + clip.height; ++y)
+	{
+		int32_t weight = (y * 256) / span;
+		Color row = { static_cast<unsigned char>((this->top.r * (256 - weight) + this->bottom.r * weight) >> 8),
+					  static_cast<unsigned char>((this->top.g * (256 - weight) + this->bottom.g * weight) >> 8),
+					  static_cast<unsigned char>((this->top.b * (256 - weight) + this->bottom.b * weight) >> 8), 255 };
+		
+		uint32_t* out = pixelAt(frame, stride, clip.x, y);
+		std::fill(out, out + clip.width, packPixel(row));
+	}
+	
+	return;
+}
+
+SkyImageLayer::SkyImageLayer(SkySet* set): set(set),
+	area((set && set->isOpen()) ? pixelRect{ 0, 0, static_cast<int32_t>(set->getWidth()), static_cast<int32_t>(set->getHeight()) } : pixelRect())
+{
+	return;
+}
+
+bool SkyImageLayer::setTime(long secondOfDay)
+{
+	if (this->area.isEmpty()) return false;
+	
+	uint32_t from;
+	uint32_t to;
+	uint32_t weight;
+	this->set->select(secondOfDay, from, to, weight);
+	
+	if (from == this->from && to == this->to && weight == this->weight) return false;
+	
+	this->from = from;
+	this->to = to;
+	this->weight = weight;
+	
+	return true;
+}
+
+pixelRect SkyImageLayer::bounds() const
+{
+	return (this->from == SkySet::NO_FRAME) ? pixelRect() : this->area;
+}
+
+bool SkyImageLayer::isOpaque() const
+{
+	return true;
+}
+
+void SkyImageLayer::render(uint8_t* frame, size_t stride, const pixelRect& clip) const
+{
+	const uint8_t* fromFrame = this->set->getFrame(this->from);
+	const uint8_t* toFrame = this->set->getFrame(this->to);
+	size_t setStride = this->set->getStride();
+	size_t pixelBytes = this->set->getFormat().bitsPerPixel / 8;
+	
+	//Only this clip's part of the two frames is read, so the threads fault a frame in a tile at a time between them
+	for (int32_t y = clip.y; y < clip.y + clip.height; ++y)
+	{
+		size_t offset = y * setStride + clip.x * pixelBytes;
+		uint8_t* out = reinterpret_cast<uint8_t*>(pixelAt(frame, stride, clip.x, y));
+		pixel::crossfade(fromFrame + offset, toFrame + offset, this->set->getFormat(), out, clip.width, this->weight);
+	}
+	
+	return;
+}
+
+
+/******************************************************************************
+/ Text line
+/*****************************************************************************/
+
+TextLineLayer::TextLineLayer(int32_t x, int32_t y, int32_t scale): x(x), y(y), scale(std::max(1, scale))
+{
+	return;
+}
+
+bool TextLineLayer::setText(const char* text)
+{
+	if (!std::strncmp(text, this->text, FACE_LINE_MAX - 1)) return false;
+	
+	std::strncpy(this->text, text, FACE_LINE_MAX - 1);
+	this->text[FACE_LINE_MAX - 1] = '\0';
+	
+	return true;
+}
+
+bool TextLineLayer::setColor(Color color)
+{
+	if (sameColor(color, this->color)) return false;
+	
+	this->color = color;
+	
+	return true;
+}
+
+pixelRect TextLineLayer::bounds() const
+{
+	int32_t length = std::strlen(this->text);
+	if (!length) return pixelRect();
+	
+	return { this->x, this->y, (length * GLYPH_ADVANCE - 1) * this->scale, GLYPH_HEIGHT * this->scale };
+}
+
+void TextLineLayer::render(uint8_t* frame, size_t stride, const pixelRect& clip) const
+{
+	//Look every character up once, not once per pixel
+	const uint8_t* glyphs[FACE_LINE_MAX];
+	size_t length = std::strlen(this->text);
+	for (size_t i = 0; i < length; ++i) glyphs[i] = findGlyph(this->text[i]);
+	
+	uint32_t ink = packPixel(this->color);
+	
+	for (int32_t py = clip.y; py < clip.y + clip.height; ++py)
+	{
+		int32_t glyphRow = (py - this->y) / this->scale;
+		uint32_t* out = pixelAt(frame, stride, clip.x, py);
+		
+		for (int32_t px = clip.x; px < clip.x + clip.width; ++px, ++out)
+		{
+			int32_t column = (px - this->x) / this->scale;
+			int32_t glyphColumn = column % GLYPH_ADVANCE;
+			if (glyphColumn == GLYPH_WIDTH) continue; //The gap
+			
+			if (glyphs[column / GLYPH_ADVANCE][glyphRow] & (0x10 >> glyphColumn)) *out = ink;
+		}
+	}
+	
+	return;
+}
+
+
+/******************************************************************************
+/ Progress arc
+/*****************************************************************************/
+
+ProgressArcLayer::ProgressArcLayer(int32_t centerX, int32_t centerY, int32_t outerRadius, int32_t innerRadius):
+	centerX(centerX), centerY(centerY), outerRadius(outerRadius), innerRadius(std::min(innerRadius, outerRadius))
+{
+	return;
+}
+
+bool ProgressArcLayer::setProgress(double fraction)
+{
+	int32_t steps = std::clamp(static_cast<int32_t>(fraction * ARC_STEPS), 0, ARC_STEPS);
+	if (steps == this->sweepSteps) return false;
+	
+	this->sweepSteps = steps;
+	
+	return true;
+}
+
+bool ProgressArcLayer::setColor(Color color)
+{
+	if (sameColor(color, this->color)) return false;
+	
+	this->color = color;
+	
+	return true;
+}
+
+pixelRect ProgressArcLayer::bounds() const
+{
+	return { this->centerX - this->outerRadius, this->centerY - this->outerRadius, this->outerRadius * 2, this->outerRadius * 2 };
+}
+
+void ProgressArcLayer::render(uint8_t* frame, size_t stride, const pixelRect& clip) const
+{
+	const int64_t outerSquared = static_cast<int64_t>(this->outerRadius) * this->outerRadius;
+	const int64_t innerSquared = static_cast<int64_t>(this->innerRadius) * this->innerRadius;
+	const double sweep = 2 * M_PI * this->sweepSteps / ARC_STEPS;
+	uint32_t ink = packPixel(this->color);
+	
+	for (int32_t py = clip.y; py < clip.y + clip.height; ++py)
+	{
+		int32_t dy = py - this->centerY;
+		uint8_t* out = frame + py * stride + clip.x * 4;
+		
+		for (int32_t px = clip.x; px < clip.x + clip.width; ++px, out += 4)
+		{
+			int32_t dx = px - this->centerX;
+			int64_t distanceSquared = static_cast<int64_t>(dx) * dx + static_cast<int64_t>(dy) * dy;
+			if (distanceSquared >= outerSquared || distanceSquared < innerSquared) continue;
+			
+			//Clockwise from twelve o'clock
+			double angle = std::atan2(dx, -dy);
+			if (angle < 0) angle += 2 * M_PI;
+			
+			if (angle < sweep)
+			{
+				*reinterpret_cast<uint32_t*>(out) = ink;
+				continue;
+			}
+			
+			//Faint track for the rest of the day
+			out[0] = (this->color.r * ARC_TRACK_ALPHA + out[0] * (255 - ARC_TRACK_ALPHA)) / 255;
+			out[1] = (this->color.g * ARC_TRACK_ALPHA + out[1] * (255 - ARC_TRACK_ALPHA)) / 255;
+			out[2] = (this->color.b * ARC_TRACK_ALPHA + out[2] * (255 - ARC_TRACK_ALPHA)) / 255;
+		}
+	}
+	
+	return;
+}
+
+
+/******************************************************************************
+/ Face
+/*****************************************************************************/
+
+//Lines are a 200th of the screen high per font pixel, so they stay the same size on the screen at any resolution
+LayeredFace::LayeredFace(uint32_t width, uint32_t height, unsigned int threads, SkySet* skySet): compositor(width, height, threads), sky(width, height), skyImage(skySet),
+	dateLine(height / 24, height / 24, height / 200),
+	nextEventLine(height / 24, height - height / 24 - GLYPH_HEIGHT * static_cast<int32_t>(height / 200), height / 200),
+	dayArc(width - height / 24 - height / 10, height / 24 + height / 10, height / 10, height / 10 * 17 / 20),
+	skyImages(skySet && skySet->isOpen() && skySet->getWidth() == width && skySet->getHeight() == height)
+{
+	if (this->skyImages) this->skyLayer = this->compositor.addLayer(&this->skyImage);
+	else this->skyLayer = this->compositor.addLayer(&this->sky);
+	this->dateLayer = this->compositor.addLayer(&this->dateLine);
+	this->nextEventLayer = this->compositor.addLayer(&this->nextEventLine);
+	this->arcLayer = this->compositor.addLayer(&this->dayArc);
+	this->compositor.invalidateAll();
+	
+	return;
+}
+
+void LayeredFace::update(long secondOfDay, const char* dateText, const char* nextEventText)
+{
+	secondOfDay %= SECONDS_PER_DAY;
+	long horizon = (secondOfDay + FACE_HORIZON_LEAD) % SECONDS_PER_DAY;
+	
+	//Same curves as the flat face. The horizon runs ahead, so the bottom of the screen lightens first at sunrise
+	Color top = SunColor::interp(secondOfDay / 3600, (secondOfDay % 3600) / 60.0f);
+	Color bottom = SunColor::interp(horizon / 3600, (horizon % 3600) / 60.0f);
+	Color ink = ClockTextColor::interp(secondOfDay / 3600, (secondOfDay % 3600) / 60.0f);
+	
+	if (this->skyImages)
+	{
+		if (this->skyImage.setTime(secondOfDay))
+		{
+			this->compositor.invalidate(this->skyLayer);
+			this->skyImageChanged = true;
+		}
+	}
+	else if (this->sky.setColors(top, bottom)) this->compositor.invalidate(this->skyLayer);
+	
+	//Plain | so both setters run
+	if (this->dateLine.setText(dateText) | this->dateLine.setColor(ink)) this->compositor.invalidate(this->dateLayer);
+	if (this->nextEventLine.setText(nextEventText) | this->nextEventLine.setColor(ink)) this->compositor.invalidate(this->nextEventLayer);
+	if (this->dayArc.setProgress(static_cast<double>(secondOfDay) / SECONDS_PER_DAY) | this->dayArc.setColor(ink)) this->compositor.invalidate(this->arcLayer);
+	
+	return;
+}
+
+size_t LayeredFace::render()
+{
+	if (!this->skyImageChanged)
+	{
+		this->skyBlendMicros = -1;
+		return this->compositor.render();
+	}
+	
+	auto start = std::chrono::steady_clock::now();
+	size_t tiles = this->compositor.render();
+	this->skyBlendMicros = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count();
+	this->skyImageChanged = false;
+	
+	return tiles;
+}
+
+const Compositor& LayeredFace::getCompositor() const
+{
+	return this->compositor;
+}
+
+bool LayeredFace::hasSkyImages() const
+{
+	return this->skyImages;
+}
+
+int64_t LayeredFace::getSkyBlendMicros() const
+{
+	return this->skyBlendMicros;
+}
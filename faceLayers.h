@@ -0,0 +1,175 @@
+/******************************************************************************
+/ Pi 4 Sunrise Clock App Face Layers Spec - lopezk38 2025
+/
+/ The layers a full face is built from: a sky gradient or sky photos, a date
+/ line, a next event line and a progress arc around the day. LayeredFace
+/ stacks them on a compositor and only invalidates a layer when what it shows
+/ really changed
+/
+/*****************************************************************************/
+
+#ifndef SUNCLOCK_APP_FACELAYERS
+#define SUNCLOCK_APP_FACELAYERS
+
+/******************************************************************************
+/ Dependencies, namespacing
+/*****************************************************************************/
+
+#include <cstdint>
+#include <cstddef>
+
+#include "raylib.h"
+#include "compositor.h"
+#include "skySet.h"
+
+
+/******************************************************************************
+/ Constants
+/*****************************************************************************/
+
+constexpr size_t FACE_LINE_MAX = 32; //Characters per text line, terminator included
+constexpr long FACE_HORIZON_LEAD = 90 * 60; //The bottom of the sky runs this many seconds ahead of the top
+
+
+/******************************************************************************
+/ Layers
+/*****************************************************************************/
+
+//Full frame vertical blend between two colors. Solid, so the compositor never draws under it
+class SkyGradientLayer : public CompositorLayer
+{
+
+private:
+
+	const pixelRect area;
+	Color top = { 0, 0, 0, 255 };
+	Color bottom = { 0, 0, 0, 255 };
+
+public:
+
+	SkyGradientLayer(uint32_t width, uint32_t height);
+	
+	bool setColors(Color top, Color bottom); //False if nothing changed
+	
+	pixelRect bounds() const override;
+	bool isOpaque() const override;
+	void render(uint8_t* frame, size_t stride, const pixelRect& clip) const override;
+};
+
+//Sky photos from a mapped sky set, crossfading between the frames either side of the time. Solid
+class SkyImageLayer : public CompositorLayer
+{
+
+private:
+
+	SkySet* const set; //Not owned
+	const pixelRect area;
+	uint32_t from = SkySet::NO_FRAME;
+	uint32_t to = SkySet::NO_FRAME;
+	uint32_t weight = 0; //0-256. A step is the smallest change the blend can show
+
+public:
+
+	SkyImageLayer(SkySet* set); //Bounds are the set's frame size. Empty for nullptr or a set that didn't open
+	
+	bool setTime(long secondOfDay); //False if the blend didn't change
+	
+	pixelRect bounds() const override;
+	bool isOpaque() const override;
+	void render(uint8_t* frame, size_t stride, const pixelRect& clip) const override;
+};
+
+//One line of text in a built in 5x7 block font, scaled up by a whole number. Upper case, digits and a little punctuation
+class TextLineLayer : public CompositorLayer
+{
+
+private:
+
+	const int32_t x;
+	const int32_t y;
+	const int32_t scale;
+	char text[FACE_LINE_MAX] = {};
+	Color color = { 255, 255, 255, 255 };
+
+public:
+
+	TextLineLayer(int32_t x, int32_t y, int32_t scale);
+	
+	bool setText(const char* text); //False if nothing changed
+	bool setColor(Color color);
+	
+	pixelRect bounds() const override;
+	void render(uint8_t* frame, size_t stride, const pixelRect& clip) const override;
+};
+
+//Ring that fills clockwise from the top as the day goes on
+class ProgressArcLayer : public CompositorLayer
+{
+
+private:
+
+	const int32_t centerX;
+	const int32_t centerY;
+	const int32_t outerRadius;
+	const int32_t innerRadius;
+	int32_t sweepSteps = 0; //Filled part, in ARC_STEPS of a full turn
+	Color color = { 255, 255, 255, 255 };
+
+public:
+
+	static constexpr int32_t ARC_STEPS = 360; //A step is four minutes of the day. Smaller ones wouldn't show
+	
+	ProgressArcLayer(int32_t centerX, int32_t centerY, int32_t outerRadius, int32_t innerRadius);
+	
+	bool setProgress(double fraction); //0-1. False if the arc didn't visibly move
+	bool setColor(Color color);
+	
+	pixelRect bounds() const override;
+	void render(uint8_t* frame, size_t stride, const pixelRect& clip) const override;
+};
+
+
+/******************************************************************************
+/ Face
+/*****************************************************************************/
+
+class LayeredFace
+{
+
+private:
+
+	Compositor compositor;
+	SkyGradientLayer sky;
+	SkyImageLayer skyImage;
+	TextLineLayer dateLine;
+	TextLineLayer nextEventLine;
+	ProgressArcLayer dayArc;
+	
+	int skyLayer;
+	int dateLayer;
+	int nextEventLayer;
+	int arcLayer;
+	
+	const bool skyImages; //Photos in place of the gradient
+	bool skyImageChanged = false;
+	int64_t skyBlendMicros = -1;
+
+public:
+
+	//Sky photos replace the gradient when given an open set the same size as the face
+	LayeredFace(uint32_t width, uint32_t height, unsigned int threads, SkySet* skySet = nullptr);
+	
+	//Moves every layer to a time of day. Text lines are whatever the caller wants shown, empty hides one
+	void update(long secondOfDay, const char* dateText, const char* nextEventText);
+	
+	//Draws whatever update changed. Returns how many tiles were drawn
+	size_t render();
+	
+	const Compositor& getCompositor() const;
+	bool hasSkyImages() const;
+	
+	//How long the last render took, in microseconds, if it crossfaded the sky photos. Nearly all of it is the blend. -1 if it didn't
+	int64_t getSkyBlendMicros() const;
+};
+
+#endif
@@ -0,0 +1,148 @@
+/******************************************************************************
+/ Pi 4 Sunrise Clock App Adaptive Frame Pacer Implementation - lopezk38 2025
+/
+/*****************************************************************************/
+
+/******************************************************************************
+/ Dependencies, namespacing
+/*****************************************************************************/
+
+#include <cmath>
+#include <algorithm>
+
+#include "framePacer.h"
+#include "sunColorCurveLUT.h"
+#include "clockTextColorCurveLUT.h"
+
+
+/******************************************************************************
+/ Helpers
+/*****************************************************************************/
+
+constexpr long SECONDS_PER_DAY = 24 * 60 * 60;
+
+//Half width of the window used to differentiate the curves. Wide enough that 8 bit rounding in the curves doesn't swamp the slope
+constexpr long DERIVATIVE_HALF_WINDOW = 150;
+
+struct displayedLevels
+{
+	float bg[3];
+	float text[3];
+};
+
+static displayedLevels levelsAt(long secondOfDay)
+{
+	//Wrap around midnight
+	secondOfDay %= SECONDS_PER_DAY;
+	if (secondOfDay < 0) secondOfDay += SECONDS_PER_DAY;
+	
+	int hour = secondOfDay / 3600;
+	float minute = (secondOfDay % 3600) / 60.0f;
+	
+	Color bg = SunColor::interp(hour, minute);
+	Color text = ClockTextColor::interp(hour, minute);
+	float brightness = SunBrightness::interp(hour, static_cast<int>(minute)) / 100.0f;
+	
+	//What actually leaves the panel is color scaled by backlight, so both curves feed in
+	return { { bg.r * brightness, bg.g * brightness, bg.b * brightness }, { text.r * brightness, text.g * brightness, text.b * brightness } };
+}
+
+
+/******************************************************************************
+/ Class implementation
+/*****************************************************************************/
+
+FramePacer::FramePacer(double stepThreshold, double maxFps, double minFps): stepThreshold(stepThreshold), maxFps(maxFps), minFps(minFps)
+{
+	return;
+}
+
+double FramePacer::visibleChangeRate(long secondOfDay)
+{
+	displayedLevels before = levelsAt(secondOfDay - DERIVATIVE_HALF_WINDOW);
+	displayedLevels after = levelsAt(secondOfDay + DERIVATIVE_HALF_WINDOW);
+	
+	//Fastest moving channel sets the pace
+	float maxDelta = 0;
+	for (int i = 0; i < 3; ++i)
+	{
+		maxDelta = std::max(maxDelta, std::fabs(after.bg[i] - before.bg[i]));
+		maxDelta = std::max(maxDelta, std::fabs(after.text[i] - before.text[i]));
+	}
+	
+	return maxDelta / (2.0 * DERIVATIVE_HALF_WINDOW);
+}
+
+double FramePacer::targetFps(long secondOfDay) const
+{
+	double fps = visibleChangeRate(secondOfDay) / this->stepThreshold;
+	
+	if (fps < this->minFps) return 0; //Static. Only the minute tick redraws
+	
+	return std::min(fps, this->maxFps);
+}
+
+bool FramePacer::frameDue(long secondOfDay, std::chrono::steady_clock::time_point now)
+{
+	this->currentFps = targetFps(secondOfDay);
+	
+	if (this->redrawRequested) return true;
+	
+	//Clock text changes every minute no matter what the colors are doing
+	if (secondOfDay / 60 != this->lastDrawMinute) return true;
+	
+	if (this->currentFps <= 0) return false;
+	
+	return now - this->lastDraw >= std::chrono::duration<double>(1.0 / this->currentFps);
+}
+
+void FramePacer::frameDrawn(long secondOfDay, std::chrono::steady_clock::time_point now)
+{
+	this->lastDraw = now;
+	this->lastDrawMinute = secondOfDay / 60;
+	this->redrawRequested = false;
+	
+	return;
+}
+
+void FramePacer::requestRedraw()
+{
+	this->redrawRequested = true;
+	
+	return;
+}
+
+std::chrono::milliseconds FramePacer::timeUntilDue(long secondOfDay, long millisecond, std::chrono::steady_clock::time_point now) const
+{
+	if (this->redrawRequested) return std::chrono::milliseconds(0);
+	
+	//Next minute tick
+	long untilMinuteMs = (60 - secondOfDay % 60) * 1000 - millisecond;
+	std::chrono::milliseconds wait(std::max(0L, untilMinuteMs));
+	
+	//Next paced frame, if the colors are moving
+	if (this->currentFps > 0)
+	{
+		auto untilFrame = std::chrono::duration_cast<std::chrono::milliseconds>(this->lastDraw + std::chrono::duration<double>(1.0 / this->currentFps) - now);
+		wait = std::min(wait, std::max(untilFrame, std::chrono::milliseconds(0)));
+	}
+	
+	return wait;
+}
+
+double FramePacer::getCurrentFps() const
+{
+	return this->currentFps;
+}
+
+double FramePacer::estimateFramesPerDay() const
+{
+	//Fps is steady within a minute, so integrate a minute at a time. Every minute draws at least its tick frame
+	double frames = 0;
+	for (long minute = 0; minute < 24 * 60; ++minute)
+	{
+		frames += std::max(1.0, targetFps(minute * 60 + 30) * 60);
+	}
+	
+	return frames;
+}
@@ -0,0 +1,58 @@
+/******************************************************************************
+/ Pi 4 Sunrise Clock App Adaptive Frame Pacer Class Spec - lopezk38 2025
+/
+/*****************************************************************************/
+
+#ifndef SUNCLOCK_APP_FRAMEPACER
+#define SUNCLOCK_APP_FRAMEPACER
+
+/******************************************************************************
+/ Dependencies, namespacing
+/*****************************************************************************/
+
+#include <chrono>
+
+
+/******************************************************************************
+/ Class specification
+/*****************************************************************************/
+
+//Picks the lowest frame rate that keeps every frame to frame color step under a perceptual threshold.
+//Frames are also forced whenever the minute changes, since that changes the clock text
+class FramePacer
+{
+	
+private:
+	
+	const double stepThreshold; //Largest acceptable per frame change, in 8 bit color levels
+	const double maxFps;
+	const double minFps; //Anything slower than this is treated as static
+	
+	std::chrono::steady_clock::time_point lastDraw;
+	long lastDrawMinute = -1; //Minutes since midnight
+	bool redrawRequested = true;
+	
+	double currentFps = 0;
+	
+public:
+
+	FramePacer(double stepThreshold, double maxFps, double minFps);
+	
+	//Rate of visible change at a time of day, in color levels per second
+	static double visibleChangeRate(long secondOfDay);
+	double targetFps(long secondOfDay) const;
+	
+	bool frameDue(long secondOfDay, std::chrono::steady_clock::time_point now);
+	void frameDrawn(long secondOfDay, std::chrono::steady_clock::time_point now);
+	void requestRedraw();
+	
+	//How long the loop can sleep before the next frame is due
+	std::chrono::milliseconds timeUntilDue(long secondOfDay, long millisecond, std::chrono::steady_clock::time_point now) const;
+	
+	double getCurrentFps() const;
+	
+	//Frames a full day would take with this pacer, for comparing against a fixed frame rate
+	double estimateFramesPerDay() const;
+};
+
+#endif
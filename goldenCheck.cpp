@@ -0,0 +1,181 @@
+/******************************************************************************
+/ Pi 4 Sunrise Clock App Golden Frame Check Tool - lopezk38 2025
+/
+/ Builds the clock face for every minute of the day (or every second) headlessly
+/ and compares them against a golden file recorded earlier. Catches anything
+/ that changes what the clock shows: the color LUTs, the color math or the text
+/
+/ Usage: goldencheck [--record] [--seconds] [--threads N] golden.txt
+/
+/*****************************************************************************/
+
+/******************************************************************************
+/ Dependencies, namespacing
+/*****************************************************************************/
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "clockFace.h"
+
+
+/******************************************************************************
+/ Constants
+/*****************************************************************************/
+
+constexpr size_t CHUNK_SIZE = 64; //Frames a worker claims at a time
+constexpr unsigned int MAX_REPORTED_MISMATCHES = 20;
+
+
+/******************************************************************************
+/ Implementation
+/*****************************************************************************/
+
+struct workerTiming
+{
+	size_t frames = 0;
+	double seconds = 0; //Spent building frames, not waiting to be scheduled
+};
+
+std::string describeFrame(long secondOfDay)
+{
+	long hour = secondOfDay / 3600;
+	long minute = (secondOfDay / 60) % 60;
+	long second = secondOfDay % 60;
+	
+	//Same call the render loop makes, at the same fractional minute
+	clockFace face = buildClockFace(hour, minute, minute + second / 60.0f, HOUR_LEADING_ZERO);
+	
+	char line[96];
+	std::snprintf(line, sizeof(line), "%02ld:%02ld:%02ld bg %3d %3d %3d %3d text %3d %3d %3d %3d \"%s\"", hour, minute, second,
+				  face.background.r, face.background.g, face.background.b, face.background.a,
+				  face.text.r, face.text.g, face.text.b, face.text.a, face.timeText);
+	
+	return line;
+}
+
+int main(int argc, char* argv[])
+{
+	bool record = false;
+	long step = 60;
+	unsigned int threadCount = std::thread::hardware_concurrency();
+	const char* goldenPath = nullptr;
+	
+	for (int i = 1; i < argc; ++i)
+	{
+		if (!std::strcmp(argv[i], "--record")) record = true;
+		else if (!std::strcmp(argv[i], "--seconds")) step = 1;
+		else if (!std::strcmp(argv[i], "--threads") && i + 1 < argc) threadCount = std::atoi(argv[++i]);
+		else goldenPath = argv[i];
+	}
+	
+	if (!goldenPath)
+	{
+		std::cerr << "Usage: goldencheck [--record] [--seconds] [--threads N] golden.txt" << std::endl;
+		return 1;
+	}
+	if (threadCount == 0) threadCount = 1;
+	
+	//Every frame is independent, so workers just claim chunks off a shared counter until the day is done
+	size_t frameCount = 24 * 60 * 60 / step;
+	std::vector<std::string> frames(frameCount);
+	std::atomic<size_t> nextChunk{0};
+	
+	//Each worker times only its own chunks, so a thread left waiting for a core doesn't count against the rest
+	std::vector<workerTiming> timings(threadCount);
+	
+	auto worker = [&](workerTiming& timing)
+	{
+		size_t start;
+		while ((start = nextChunk.fetch_add(CHUNK_SIZE, std::memory_order_relaxed)) < frameCount)
+		{
+			std::chrono::steady_clock::time_point chunkStart = std::chrono::steady_clock::now();
+			
+			size_t end = std::min(start + CHUNK_SIZE, frameCount);
+			for (size_t i = start; i < end; ++i) frames[i] = describeFrame(i * step);
+			
+			timing.seconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - chunkStart).count();
+			timing.frames += end - start;
+		}
+	};
+	
+	std::chrono::steady_clock::time_point renderStart = std::chrono::steady_clock::now();
+	
+	std::vector<std::thread> pool;
+	for (unsigned int i = 0; i < threadCount; ++i) pool.emplace_back(worker, std::ref(timings[i]));
+	for (std::thread& thread : pool) thread.join();
+	
+	double renderSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - renderStart).count();
+	
+	std::cout << "Built " << frameCount << " frames on " << threadCount << " threads in " << renderSeconds * 1000 << " ms ("
+			  << static_cast<long>(frameCount / renderSeconds) << " frames/s)" << std::endl;
+	
+	for (unsigned int i = 0; i < threadCount; ++i)
+	{
+		if (!timings[i].frames) std::printf("  thread %u: no frames, the others finished first\n", i);
+		else std::printf("  thread %u: %zu frames in %.2f ms, %ld frames/s\n", i, timings[i].frames, timings[i].seconds * 1000, static_cast<long>(timings[i].frames / timings[i].seconds));
+	}
+	
+	if (record)
+	{
+		std::ofstream out(goldenPath);
+		for (const std::string& frame : frames) out << frame << "\n";
+		
+		if (!out)
+		{
+			std::cerr << "ERROR: Failed to write " << goldenPath << std::endl;
+			return 1;
+		}
+		
+		std::cout << "Recorded " << frameCount << " golden frames to " << goldenPath << std::endl;
+		return 0;
+	}
+	
+	std::ifstream in(goldenPath);
+	if (!in)
+	{
+		std::cerr << "ERROR: Failed to open " << goldenPath << std::endl;
+		return 1;
+	}
+	
+	//Compare line by line. A golden file recorded at a different step just shows up as mismatches
+	size_t mismatches = 0;
+	size_t compared = 0;
+	std::string golden;
+	while (compared < frameCount && std::getline(in, golden))
+	{
+		if (golden != frames[compared])
+		{
+			if (mismatches < MAX_REPORTED_MISMATCHES)
+			{
+				std::cout << "MISMATCH" << std::endl << "  golden: " << golden << std::endl << "  now:    " << frames[compared] << std::endl;
+			}
+			++mismatches;
+		}
+		++compared;
+	}
+	
+	if (compared != frameCount || std::getline(in, golden))
+	{
+		std::cout << "FAIL: golden file has a different number of frames than " << frameCount << std::endl;
+		return 1;
+	}
+	
+	if (mismatches)
+	{
+		std::cout << "FAIL: " << mismatches << " of " << frameCount << " frames differ from the golden file" << std::endl;
+		return 1;
+	}
+	
+	std::cout << "PASS: all " << frameCount << " frames match" << std::endl;
+	
+	return 0;
+}
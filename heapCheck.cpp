@@ -0,0 +1,401 @@
+/******************************************************************************
+/ Pi 4 Sunrise Clock App Task Heap Check - lopezk38 2025
+/
+/ Drives the task heap with random pushes, periodic pushes, pops, cancels,
+/ reschedules and re-anchors, and checks it after every step against a plain
+/ model of what should be pending. Covers stale handles and their
+/ generations, the heap order and position index, unique key merging,
+/ periodic rearming and wall clock re-anchoring. Built with the address and
+/ undefined behavior sanitizers, so a bad index or a use after recycle fails
+/ the run too. Each round is its own seed, printed on failure to rerun with
+/
+/ Usage: heapcheck [--seed N] [--rounds N] [--steps N]
+/
+/*****************************************************************************/
+
+/******************************************************************************
+/ Dependencies, namespacing
+/*****************************************************************************/
+
+#include <algorithm>
+#include <climits>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <map>
+#include <random>
+#include <vector>
+
+#include "taskHeap.h"
+
+
+/******************************************************************************
+/ Constants
+/*****************************************************************************/
+
+constexpr unsigned int DEFAULT_SEED = 1;
+constexpr unsigned int DEFAULT_ROUNDS = 100;
+constexpr unsigned int DEFAULT_STEPS = 5000; //Per round
+constexpr long MAX_DELAY = 600; //Furthest ahead a task is pushed, seconds
+constexpr long MAX_PERIOD = 120;
+constexpr size_t MAX_STALE = 256; //Retired handles kept around to try again
+
+
+/******************************************************************************
+/ Implementation
+/*****************************************************************************/
+
+//What the heap should hold for one handle
+struct modelTask
+{
+	long scheduledTime;
+	tHeap::TASK::CODE task;
+	long period;
+	bool wallAligned;
+};
+
+class HeapModel
+{
+
+private:
+
+	std::map<tHeap::taskHandle, modelTask> pending;
+	std::vector<tHeap::taskHandle> stale;
+	bool unique[tHeap::TASK::CODE_COUNT] = {};
+	
+	std::mt19937 rng;
+	tHeap::TaskHeap heap;
+	long now = 0;
+	long wallOffset = 0; //Wall clock minus schedule clock
+	
+	unsigned int seed;
+	unsigned int step = 0;
+	bool failed = false;
+	
+	long randomIn(long low, long high)
+	{
+		return std::uniform_int_distribution<long>(low, high)(this->rng);
+	}
+	
+	tHeap::TASK::CODE randomCode()
+	{
+		return static_cast<tHeap::TASK::CODE>(this->randomIn(0, tHeap::TASK::CODE_COUNT - 1));
+	}
+	
+	//Any pending handle, or a stale one, or one never issued
+	tHeap::taskHandle randomHandle()
+	{
+		long pick = this->randomIn(0, 9);
+		if (pick < 7 && !this->pending.empty())
+		{
+			auto it = this->pending.begin();
+			std::advance(it, this->randomIn(0, this->pending.size() - 1));
+			return it->first;
+		}
+		if (pick < 9 && !this->stale.empty()) return this->stale[this->randomIn(0, this->stale.size() - 1)];
+		
+		return static_cast<tHeap::taskHandle>(this->rng()) << 32 | this->rng();
+	}
+	
+	void retire(tHeap::taskHandle handle)
+	{
+		this->pending.erase(handle);
+		if (this->stale.size() < MAX_STALE) this->stale.push_back(handle);
+		else this->stale[this->randomIn(0, MAX_STALE - 1)] = handle;
+		
+		return;
+	}
+	
+	tHeap::taskHandle pendingUnique(tHeap::TASK::CODE task)
+	{
+		for (const auto& [handle, entry] : this->pending)
+		{
+			if (entry.task == task) return handle;
+		}
+		
+		return tHeap::INVALID_HANDLE;
+	}
+	
+	void fail(const char* what)
+	{
+		if (!this->failed) std::cerr << "ERROR: Seed " << this->seed << ", step " << this->step << ": " << what << std::endl;
+		this->failed = true;
+		
+		return;
+	}
+	
+	//LONG_MAX when nothing is pending. Times can go negative, a task pushed a little in the past at startup
+	long earliest()
+	{
+		long time = LONG_MAX;
+		for (const auto& [handle, entry] : this->pending) time = std::min(time, entry.scheduledTime);
+		
+		return time;
+	}
+	
+	//What the heap does to a periodic task it just handed out. popTime is the time it was popped at, popTask uses the task's own
+	void rearm(modelTask& entry, long popTime)
+	{
+		entry.scheduledTime += entry.period;
+		if (entry.scheduledTime <= popTime) entry.scheduledTime += ((popTime - entry.scheduledTime) / entry.period + 1) * entry.period;
+		
+		return;
+	}
+	
+	void checkPopped(const tHeap::Task& popped, long popTime)
+	{
+		auto it = this->pending.find(popped.handle);
+		if (it == this->pending.end()) return this->fail("Popped a task the model doesn't have");
+		if (popped.scheduledTime != this->earliest()) return this->fail("Popped a task that wasn't the earliest");
+		if (popped.scheduledTime != it->second.scheduledTime || popped.task != it->second.task || popped.period != it->second.period)
+		{
+			return this->fail("Popped task doesn't match what was pushed");
+		}
+		
+		if (it->second.period) this->rearm(it->second, popTime);
+		else this->retire(popped.handle);
+		
+		return;
+	}
+	
+	void doPush()
+	{
+		long time = this->now + this->randomIn(-5, MAX_DELAY);
+		tHeap::TASK::CODE task = this->randomCode();
+		
+		tHeap::taskHandle merged = this->unique[task] ? this->pendingUnique(task) : tHeap::INVALID_HANDLE;
+		tHeap::taskHandle handle = this->heap.pushTask(time, task);
+		
+		if (merged)
+		{
+			if (handle != merged) return this->fail("Unique push didn't fold into the pending task");
+			this->pending[merged].scheduledTime = std::min(this->pending[merged].scheduledTime, time);
+			return;
+		}
+		if (this->pending.count(handle)) return this->fail("Push returned a handle that is already pending");
+		
+		this->pending[handle] = { time, task, 0, false };
+		
+		return;
+	}
+	
+	void doPushPeriodic()
+	{
+		long period = this->randomIn(1, MAX_PERIOD);
+		bool wallAligned = this->randomIn(0, 1);
+		long firstRun = wallAligned ? tHeap::TaskHeap::nextWallBoundary(this->now, this->now + this->wallOffset, period) : this->now + this->randomIn(0, period);
+		tHeap::TASK::CODE task = this->randomCode();
+		
+		tHeap::taskHandle merged = this->unique[task] ? this->pendingUnique(task) : tHeap::INVALID_HANDLE;
+		tHeap::taskHandle handle = this->heap.pushPeriodicTask(firstRun, period, task, wallAligned);
+		
+		//A unique code takes on the period whatever it was pending as
+		if (merged)
+		{
+			if (handle != merged) return this->fail("Unique periodic push didn't fold into the pending task");
+			modelTask& entry = this->pending[merged];
+			entry.scheduledTime = std::min(entry.scheduledTime, firstRun);
+			entry.period = period;
+			entry.wallAligned = wallAligned;
+			return;
+		}
+		if (this->pending.count(handle)) return this->fail("Periodic push returned a handle that is already pending");
+		
+		this->pending[handle] = { firstRun, task, period, wallAligned };
+		
+		return;
+	}
+	
+	void doCancel()
+	{
+		tHeap::taskHandle handle = this->randomHandle();
+		bool expected = this->pending.count(handle);
+		
+		if (this->heap.cancel(handle) != expected) return this->fail(expected ? "Cancel missed a pending task" : "Cancel took a stale handle");
+		if (expected) this->retire(handle);
+		
+		return;
+	}
+	
+	void doCancelFront()
+	{
+		tHeap::taskHandle handle = this->pending.begin()->first;
+		if (!this->heap.cancel(handle)) return this->fail("Cancel missed a pending task");
+		this->retire(handle);
+		
+		return;
+	}
+	
+	void doReschedule()
+	{
+		tHeap::taskHandle handle = this->randomHandle();
+		bool expected = this->pending.count(handle);
+		long time = this->now + this->randomIn(-5, MAX_DELAY);
+		
+		if (this->heap.reschedule(handle, time) != expected) return this->fail(expected ? "Reschedule missed a pending task" : "Reschedule took a stale handle");
+		if (expected) this->pending[handle].scheduledTime = time;
+		
+		return;
+	}
+	
+	void doPopDue()
+	{
+		//Time only ever moves forward on the schedule clock. Sometimes a lot, like a stalled loop
+		this->now += (this->randomIn(0, 19) == 0) ? this->randomIn(0, 5 * MAX_PERIOD) : this->randomIn(0, 3);
+		
+		tHeap::Task popped;
+		while (this->heap.popDueTask(this->now, popped) && !this->failed)
+		{
+			if (popped.scheduledTime > this->now) return this->fail("Popped a task that wasn't due");
+			this->checkPopped(popped, this->now);
+		}
+		
+		if (this->earliest() <= this->now) this->fail("A due task was left behind");
+		
+		return;
+	}
+	
+	void doPop()
+	{
+		if (this->pending.empty())
+		{
+			if (!this->heap.isEmpty()) this->fail("Heap has tasks the model doesn't");
+			return;
+		}
+		
+		tHeap::Task popped = this->heap.popTask();
+		this->checkPopped(popped, popped.scheduledTime);
+		
+		return;
+	}
+	
+	void doReanchor()
+	{
+		//The wall clock steps either way. Only the schedule clock keeps going
+		this->wallOffset += this->randomIn(-3 * 3600, 3 * 3600);
+		this->heap.reanchorWallAligned(this->now, this->now + this->wallOffset);
+		
+		for (auto& [handle, entry] : this->pending)
+		{
+			if (entry.wallAligned) entry.scheduledTime = tHeap::TaskHeap::nextWallBoundary(this->now, this->now + this->wallOffset, entry.period);
+		}
+		
+		return;
+	}
+	
+	void verify()
+	{
+		if (this->heap.size() != this->pending.size()) return this->fail("Heap size doesn't match the model");
+		
+		for (size_t i = 0; i < this->heap.size(); ++i)
+		{
+			const tHeap::Task* task = this->heap.getTaskAt(i);
+			if (task->heapIndex != i) return this->fail("Position index is out of date");
+			if (i && this->heap.getTaskAt((i - 1) / 2)->scheduledTime > task->scheduledTime) return this->fail("Heap order is broken");
+			if (this->heap.getTask(task->handle) != task) return this->fail("Handle doesn't lead back to its task");
+		}
+		
+		for (const auto& [handle, entry] : this->pending)
+		{
+			const tHeap::Task* task = this->heap.getTask(handle);
+			if (!task) return this->fail("Pending handle went stale");
+			if (task->scheduledTime != entry.scheduledTime || task->task != entry.task || task->period != entry.period || task->wallAligned != entry.wallAligned)
+			{
+				return this->fail("Pending task doesn't match the model");
+			}
+		}
+		
+		for (tHeap::taskHandle handle : this->stale)
+		{
+			if (this->heap.isPending(handle) || this->heap.getTask(handle)) return this->fail("Stale handle answered");
+		}
+		
+		//Unique codes never have more than one pending
+		unsigned int counts[tHeap::TASK::CODE_COUNT] = {};
+		for (const auto& [handle, entry] : this->pending) ++counts[entry.task];
+		for (unsigned int code = 0; code < tHeap::TASK::CODE_COUNT; ++code)
+		{
+			if (this->unique[code] && counts[code] > 1) return this->fail("Unique code is pending twice");
+		}
+		
+		return;
+	}
+
+public:
+
+	HeapModel(unsigned int seed): rng(seed), seed(seed)
+	{
+		//A few codes in unique key mode, the way the clock runs it
+		for (unsigned int code = 0; code < tHeap::TASK::CODE_COUNT; ++code)
+		{
+			this->unique[code] = this->randomIn(0, 2) == 0;
+			this->heap.setUniqueKey(static_cast<tHeap::TASK::CODE>(code), this->unique[code]);
+		}
+		if (this->randomIn(0, 1)) this->heap.reserve(this->randomIn(1, 64));
+		
+		return;
+	}
+	
+	bool run(unsigned int steps)
+	{
+		for (this->step = 0; this->step < steps && !this->failed; ++this->step)
+		{
+			//Pushes outweigh removals a little, so the heap grows and shrinks around a few dozen tasks
+			long pick = this->randomIn(0, 99);
+			if (pick < 30) this->doPush();
+			else if (pick < 38) this->doPushPeriodic();
+			else if (pick < 53) this->doCancel();
+			else if (pick < 70) this->doReschedule();
+			else if (pick < 90) this->doPopDue();
+			else if (pick < 98) this->doPop();
+			else this->doReanchor();
+			
+			if (!this->failed) this->verify();
+			
+			//Periodic tasks never leave on their own. Clear the heap out now and then so one-shot paths keep getting exercised
+			if (this->pending.size() > 200)
+			{
+				while (!this->pending.empty() && !this->failed) this->doCancelFront();
+			}
+		}
+		
+		return !this->failed;
+	}
+};
+
+int main(int argc, char* argv[])
+{
+	unsigned int seed = DEFAULT_SEED;
+	unsigned int rounds = DEFAULT_ROUNDS;
+	unsigned int steps = DEFAULT_STEPS;
+	
+	for (int i = 1; i < argc; ++i)
+	{
+		if (!std::strcmp(argv[i], "--seed") && i + 1 < argc) seed = std::strtoul(argv[++i], nullptr, 10);
+		else if (!std::strcmp(argv[i], "--rounds") && i + 1 < argc) rounds = std::strtoul(argv[++i], nullptr, 10);
+		else if (!std::strcmp(argv[i], "--steps") && i + 1 < argc) steps = std::strtoul(argv[++i], nullptr, 10);
+		else
+		{
+			std::cerr << "Usage: heapcheck [--seed N] [--rounds N] [--steps N]" << std::endl;
+			return 1;
+		}
+	}
+	if (rounds == 0) rounds = DEFAULT_ROUNDS;
+	if (steps == 0) steps = DEFAULT_STEPS;
+	
+	//Rerunning a failure is just --seed with the seed it printed and --rounds 1
+	unsigned int failures = 0;
+	for (unsigned int round = 0; round < rounds; ++round)
+	{
+		HeapModel model(seed + round);
+		if (!model.run(steps)) ++failures;
+	}
+	
+	std::printf("%u rounds of %u steps from seed %u, %u failed\n", rounds, steps, seed, failures);
+	if (failures) return 1;
+	
+	std::printf("OK\n");
+	
+	return 0;
+}
@@ -0,0 +1,262 @@
+/******************************************************************************
+/ Pi 4 Sunrise Clock App Task Inbox Contention Benchmark - lopezk38 2025
+/
+/ Runs 1 to 8 producer threads flat out against one consumer draining the task
+/ inbox, then the same against a mutex guarded vector for comparison. Checks
+/ that every task arrives exactly once and in order per producer
+/
+/ Usage: inboxbench [--tasks N] [--capacity N]
+/
+/*****************************************************************************/
+
+/******************************************************************************
+/ Dependencies, namespacing
+/*****************************************************************************/
+
+#include <poll.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "taskInbox.h"
+
+
+/******************************************************************************
+/ Constants
+/*****************************************************************************/
+
+constexpr unsigned int MAX_PRODUCERS = 8;
+constexpr long DEFAULT_TASKS = 1000000; //Per producer
+constexpr size_t DEFAULT_CAPACITY = 256;
+constexpr long PRODUCER_SHIFT = 40; //Producer number goes above the sequence number in scheduledTime
+constexpr unsigned int WAKEUP_ROUNDS = 2000;
+
+
+/******************************************************************************
+/ Implementation
+/*****************************************************************************/
+
+struct runResult
+{
+	double seconds = 0;
+	uint64_t fullRetries = 0;
+	bool ordered = true;
+};
+
+//Stand in with the same interface, to show what the lock free version buys
+class LockedInbox
+{
+
+private:
+
+	std::mutex lock;
+	std::vector<tHeap::Task> pending;
+	std::vector<tHeap::Task> swapped;
+	const size_t capacity;
+
+public:
+
+	LockedInbox(size_t capacity): capacity(capacity)
+	{
+		pending.reserve(capacity);
+		swapped.reserve(capacity);
+	}
+	
+	bool push(long scheduledTime, tHeap::TASK::CODE task)
+	{
+		std::lock_guard<std::mutex> guard(lock);
+		if (pending.size() >= capacity) return false;
+		
+		pending.emplace_back(scheduledTime, task);
+		return true;
+	}
+	
+	template <typename Consume> void drain(Consume consume)
+	{
+		{
+			std::lock_guard<std::mutex> guard(lock);
+			pending.swap(swapped);
+		}
+		
+		for (const tHeap::Task& task : swapped) consume(task);
+		swapped.clear();
+	}
+};
+
+template <typename Inbox, typename Drain> runResult run(Inbox& inbox, Drain drain, unsigned int producers, long tasks)
+{
+	runResult result;
+	std::atomic<uint64_t> fullRetries{0};
+	std::atomic<unsigned int> ready{0};
+	std::atomic<bool> go{false};
+	std::vector<long> nextExpected(producers, 0);
+	
+	std::vector<std::thread> threads;
+	for (unsigned int p = 0; p < producers; ++p)
+	{
+		threads.emplace_back([&, p]()
+		{
+			uint64_t retries = 0;
+			ready.fetch_add(1);
+			while (!go.load(std::memory_order_acquire)) std::this_thread::yield();
+			
+			for (long i = 0; i < tasks; ++i)
+			{
+				while (!inbox.push((static_cast<long>(p) << PRODUCER_SHIFT) | i, tHeap::TASK::CODE::SET_BRIGHTNESS))
+				{
+					++retries;
+					std::this_thread::yield();
+				}
+			}
+			
+			fullRetries.fetch_add(retries);
+		});
+	}
+	
+	while (ready.load() < producers) std::this_thread::yield();
+	
+	long expectedTotal = static_cast<long>(producers) * tasks;
+	long received = 0;
+	auto consume = [&](const tHeap::Task& task)
+	{
+		unsigned int producer = task.scheduledTime >> PRODUCER_SHIFT;
+		long sequence = task.scheduledTime & ((1L << PRODUCER_SHIFT) - 1);
+		
+		if (producer >= producers || sequence != nextExpected[producer]) result.ordered = false;
+		else ++nextExpected[producer];
+		
+		++received;
+	};
+	
+	auto start = std::chrono::steady_clock::now();
+	go.store(true, std::memory_order_release);
+	
+	//Yield when there was nothing to take, or a box with fewer cores than threads spends whole time slices spinning here
+	while (received < expectedTotal)
+	{
+		long before = received;
+		drain(inbox, consume);
+		if (received == before) std::this_thread::yield();
+	}
+	
+	result.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+	
+	for (std::thread& thread : threads) thread.join();
+	result.fullRetries = fullRetries.load();
+	
+	return result;
+}
+
+bool measureWakeup(tHeap::TaskInbox& inbox)
+{
+	//How long a push takes to get a sleeping consumer back, through the same calls the main loop makes
+	std::atomic<unsigned int> round{0};
+	std::atomic<int64_t> pushedAtNs{0};
+	std::vector<double> latenciesUs;
+	latenciesUs.reserve(WAKEUP_ROUNDS);
+	tHeap::TaskHeap taskSchedule;
+	
+	std::thread producer([&]()
+	{
+		for (unsigned int i = 1; i <= WAKEUP_ROUNDS; ++i)
+		{
+			while (round.load(std::memory_order_acquire) != i) std::this_thread::yield();
+			std::this_thread::sleep_for(std::chrono::microseconds(50)); //Let the consumer get properly asleep
+			
+			pushedAtNs.store(std::chrono::steady_clock::now().time_since_epoch().count(), std::memory_order_relaxed);
+			inbox.push(0, tHeap::TASK::CODE::SET_BRIGHTNESS);
+		}
+	});
+	
+	for (unsigned int i = 1; i <= WAKEUP_ROUNDS; ++i)
+	{
+		inbox.prepareToWait();
+		round.store(i, std::memory_order_release);
+		
+		pollfd wait = { inbox.getDescriptor(), POLLIN, 0 };
+		poll(&wait, 1, 1000);
+		int64_t wokeNs = std::chrono::steady_clock::now().time_since_epoch().count();
+		
+		//The task can be published a moment after the wakeup. Give it that moment
+		while (!inbox.drainInto(taskSchedule)) std::this_thread::yield();
+		taskSchedule.popTask();
+		
+		latenciesUs.push_back((wokeNs - pushedAtNs.load(std::memory_order_relaxed)) / 1000.0);
+	}
+	producer.join();
+	
+	std::sort(latenciesUs.begin(), latenciesUs.end());
+	std::printf("Wakeup from a sleeping consumer over %u rounds: median %.1f us, p99 %.1f us, max %.1f us\n", WAKEUP_ROUNDS, latenciesUs[WAKEUP_ROUNDS / 2],
+				latenciesUs[WAKEUP_ROUNDS * 99 / 100], latenciesUs.back());
+	
+	return latenciesUs.back() < 1000 * 1000;
+}
+
+int main(int argc, char* argv[])
+{
+	long tasks = DEFAULT_TASKS;
+	size_t capacity = DEFAULT_CAPACITY;
+	
+	for (int i = 1; i < argc; ++i)
+	{
+		if (!std::strcmp(argv[i], "--tasks") && i + 1 < argc) tasks = std::atol(argv[++i]);
+		else if (!std::strcmp(argv[i], "--capacity") && i + 1 < argc) capacity = std::atol(argv[++i]);
+		else
+		{
+			std::cerr << "Usage: inboxbench [--tasks N] [--capacity N]" << std::endl;
+			return 1;
+		}
+	}
+	if (tasks <= 0) tasks = DEFAULT_TASKS;
+	if (capacity == 0) capacity = DEFAULT_CAPACITY;
+	
+	tHeap::TaskInbox lockFree(capacity);
+	LockedInbox locked(lockFree.capacity());
+	
+	std::cout << tasks << " tasks per producer, capacity " << lockFree.capacity() << ", " << std::thread::hardware_concurrency() << " hardware threads" << std::endl;
+	std::printf("%-9s %-10s %12s %12s %14s\n", "producers", "inbox", "Mtasks/s", "ns/task", "full retries");
+	
+	bool failed = false;
+	
+	for (unsigned int producers = 1; producers <= MAX_PRODUCERS; ++producers)
+	{
+		runResult lockFreeResult = run(lockFree, [](tHeap::TaskInbox& inbox, auto& consume)
+		{
+			tHeap::Task task;
+			while (inbox.pop(task)) consume(task);
+		}, producers, tasks);
+		
+		runResult lockedResult = run(locked, [](LockedInbox& inbox, auto& consume) { inbox.drain(consume); }, producers, tasks);
+		
+		const char* names[] = { "lock free", "mutex" };
+		const runResult* results[] = { &lockFreeResult, &lockedResult };
+		for (unsigned int i = 0; i < 2; ++i)
+		{
+			double total = static_cast<double>(producers) * tasks;
+			std::printf("%-9u %-10s %12.2f %12.1f %14llu\n", producers, names[i], total / results[i]->seconds / 1e6, results[i]->seconds * 1e9 / total,
+						static_cast<unsigned long long>(results[i]->fullRetries));
+			
+			if (!results[i]->ordered)
+			{
+				std::cerr << "ERROR: " << names[i] << " inbox lost or reordered tasks with " << producers << " producers" << std::endl;
+				failed = true;
+			}
+		}
+	}
+	
+	if (lockFree.isOpen() && !measureWakeup(lockFree))
+	{
+		std::cerr << "ERROR: A push didn't wake the sleeping consumer" << std::endl;
+		failed = true;
+	}
+	
+	return failed ? 1 : 0;
+}
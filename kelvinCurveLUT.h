@@ -0,0 +1,230 @@
+/******************************************************************************
+/ Pi 4 Sunrise Clock App Color Temperature Curve LUT - lopezk38 2025
+/
+/*****************************************************************************/
+
+#ifndef SUNCLOCK_APP_KELVIN_LUT
+#define SUNCLOCK_APP_KELVIN_LUT
+
+#include "raylib.h"
+#include "logger.h"
+
+
+/******************************************************************************
+/ Model selection
+/*****************************************************************************/
+
+namespace COLOR_MODEL
+{
+	enum CODE
+	{
+		RGB_LUT, //Hand tuned RGB triples in sunColorCurveLUT.h and clockTextColorCurveLUT.h
+		KELVIN //Color temperature and intensity curves below
+	};
+}
+
+//SunColor::interp and ClockTextColor::interp follow this, so callers never need to change
+constexpr COLOR_MODEL::CODE ACTIVE_COLOR_MODEL = COLOR_MODEL::CODE::RGB_LUT;
+
+
+/******************************************************************************
+/ Compile time math. std::log and std::pow aren't constexpr, and the table below is built at compile time
+/*****************************************************************************/
+
+namespace kelvinMath
+{
+	constexpr double LN2 = 0.69314718055994530942;
+	
+	constexpr double ln(double x)
+	{
+		//Reduce to m * 2^k with m in [1, 2), then ln(m) = 2 * atanh((m - 1) / (m + 1))
+		int k = 0;
+		while (x >= 2.0) { x /= 2.0; ++k; }
+		while (x < 1.0) { x *= 2.0; --k; }
+		
+		double z = (x - 1.0) / (x + 1.0);
+		double zSquared = z * z;
+		double term = z;
+		double sum = 0;
+		for (int n = 1; n < 60; n += 2)
+		{
+			sum += term / n;
+			term *= zSquared;
+		}
+		
+		return 2.0 * sum + k * LN2;
+	}
+	
+	constexpr double exp(double x)
+	{
+		//Reduce to r + k * ln2 with |r| <= ln2 / 2, Taylor series for e^r, then scale by 2^k
+		int k = static_cast<int>(x / LN2 + (x < 0 ? -0.5 : 0.5));
+		double r = x - k * LN2;
+		
+		double term = 1.0;
+		double sum = 1.0;
+		for (int n = 1; n < 25; ++n)
+		{
+			term *= r / n;
+			sum += term;
+		}
+		
+		while (k > 0) { sum *= 2.0; --k; }
+		while (k < 0) { sum /= 2.0; ++k; }
+		
+		return sum;
+	}
+	
+	constexpr double pow(double base, double exponent)
+	{
+		return exp(exponent * ln(base));
+	}
+	
+	constexpr unsigned char clampChannel(double value)
+	{
+		if (value < 0) return 0;
+		if (value > 255) return 255;
+		return static_cast<unsigned char>(value + 0.5);
+	}
+	
+	constexpr Color blackbody(double kelvin)
+	{
+		//Tanner Helland's fit of the CIE blackbody locus, good from 1000K to 40000K
+		double temp = kelvin / 100.0;
+		
+		double r = (temp <= 66) ? 255 : 329.698727446 * pow(temp - 60, -0.1332047592);
+		double g = (temp <= 66) ? 99.4708025861 * ln(temp) - 161.1195681661 : 288.1221695283 * pow(temp - 60, -0.0755148492);
+		double b = (temp >= 66) ? 255 : (temp <= 19) ? 0 : 138.5177312231 * ln(temp - 10) - 305.0447927307;
+		
+		return { clampChannel(r), clampChannel(g), clampChannel(b), 255 };
+	}
+}
+
+
+/******************************************************************************
+/ Blackbody table, filled in at compile time
+/*****************************************************************************/
+
+constexpr unsigned short BLACKBODY_MIN_KELVIN = 1000;
+constexpr unsigned short BLACKBODY_MAX_KELVIN = 12000;
+constexpr unsigned short BLACKBODY_KELVIN_STEP = 10;
+constexpr unsigned int BLACKBODY_TABLE_SIZE = (BLACKBODY_MAX_KELVIN - BLACKBODY_MIN_KELVIN) / BLACKBODY_KELVIN_STEP + 1;
+
+struct blackbodyTable
+{
+	Color entries[BLACKBODY_TABLE_SIZE];
+	
+	constexpr blackbodyTable() : entries()
+	{
+		for (unsigned int i = 0; i < BLACKBODY_TABLE_SIZE; ++i) entries[i] = kelvinMath::blackbody(BLACKBODY_MIN_KELVIN + i * BLACKBODY_KELVIN_STEP);
+	}
+};
+
+
+/******************************************************************************
+/ Curves
+/*****************************************************************************/
+
+struct kelvinPoint
+{
+	unsigned short kelvin;
+	unsigned char intensity; //0-255, scales the blackbody color
+};
+
+class KelvinColor
+{
+public:
+
+	static constexpr blackbodyTable blackbodyLUT = blackbodyTable();
+	
+	static constexpr kelvinPoint sunKelvinLUT[24] =
+	{
+		{1000, 0},		//0 hrs
+		{1000, 0},		//1 hr
+		{1000, 0},		//2 hrs
+		{1000, 0},		//3 hrs
+		{1000, 0},		//4
+		{1900, 45},		//5
+		{2600, 150},	//6
+		{3500, 210},	//7
+		{5500, 255},	//8
+		{6000, 255},	//9
+		{6300, 255},	//10
+		{6500, 255},	//11
+		{6500, 255},	//12
+		{6300, 240},	//13
+		{5500, 225},	//14
+		{4800, 215},	//15
+		{4200, 210},	//16
+		{3800, 205},	//17
+		{2200, 175},	//18
+		{1800, 150},	//19
+		{1500, 100},	//20
+		{1200, 50},		//21
+		{1000, 15},		//22
+		{1000, 0}		//23 hrs
+	};
+	
+	static constexpr kelvinPoint textKelvinLUT[24] =
+	{
+		{1000, 100},	//0 hrs
+		{1000, 100},	//1 hr
+		{1000, 100},	//2 hrs
+		{1000, 100},	//3 hrs
+		{1000, 100},	//4
+		{1000, 100},	//5
+		{1000, 50},		//6
+		{1000, 25},		//7
+		{1000, 0},		//8
+		{1000, 0},		//9
+		{1000, 0},		//10
+		{1000, 0},		//11
+		{1000, 0},		//12
+		{1000, 0},		//13
+		{1000, 0},		//14
+		{2000, 10},		//15
+		{2500, 35},		//16
+		{3000, 60},		//17
+		{1600, 125},	//18
+		{1700, 150},	//19
+		{1600, 125},	//20
+		{1200, 100},	//21
+		{1000, 100},	//22
+		{1000, 100}		//23 hrs
+	};
+	
+	static Color interp(const kelvinPoint (&curve)[24], int hour, float minute)
+	{
+		//Bound inputs
+		if (hour < 0 || hour > 23) { hour = 0; }
+		if (minute < 0 || minute > 60) { minute = 0; }
+		
+		const kelvinPoint& thisHr = curve[hour];
+		const kelvinPoint& nextHr = curve[(hour + 1) % 24];
+		
+		//Q8 fixed point blend ratio, 0-256 across the hour
+		int blendRatio = static_cast<int>(minute * 256 / 60);
+		int kelvin = thisHr.kelvin + (((nextHr.kelvin - thisHr.kelvin) * blendRatio) >> 8);
+		int intensity = thisHr.intensity + (((nextHr.intensity - thisHr.intensity) * blendRatio) >> 8);
+		
+		//Nearest table entry, then scale by intensity
+		int index = (kelvin - BLACKBODY_MIN_KELVIN + BLACKBODY_KELVIN_STEP / 2) / BLACKBODY_KELVIN_STEP;
+		if (index < 0) index = 0;
+		if (index >= static_cast<int>(BLACKBODY_TABLE_SIZE)) index = BLACKBODY_TABLE_SIZE - 1;
+		
+		const Color& base = blackbodyLUT.entries[index];
+		Color blendedColor =
+		{
+			static_cast<unsigned char>((base.r * (intensity + 1)) >> 8),
+			static_cast<unsigned char>((base.g * (intensity + 1)) >> 8),
+			static_cast<unsigned char>((base.b * (intensity + 1)) >> 8),
+			255
+		};
+		
+		logger::verbose("Time is {}:{}. Calculated {}K at intensity {} is {{}, {}, {}}", hour, minute, kelvin, intensity, blendedColor.r, blendedColor.g, blendedColor.b);
+		
+		return blendedColor;
+	}
+};
+
+#endif
@@ -0,0 +1,112 @@
+/******************************************************************************
+/ Pi 4 Sunrise Clock App Ambient Light Sensor Implementation - lopezk38 2025
+/
+/*****************************************************************************/
+
+/******************************************************************************
+/ Dependencies, namespacing
+/*****************************************************************************/
+
+#include <unistd.h>
+#include <fcntl.h>
+#include <cmath>
+#include <cstdlib>
+#include <algorithm>
+
+#include "lightSensor.h"
+#include "logger.h"
+
+
+/******************************************************************************
+/ Class implementation
+/*****************************************************************************/
+
+LightSensor::LightSensor(const std::string& path): path(path)
+{
+	//The sensor is optional. Without it brightness just follows the curve
+	if (openSensor() != SENSOR_ERR::CODE::SUCCESS) errorState = true;
+	
+	return;
+}
+
+LightSensor::~LightSensor()
+{
+	if (this->descriptor != -1) close(this->descriptor);
+	
+	return;
+}
+
+SENSOR_ERR::CODE LightSensor::openSensor()
+{
+	//Kept open for the life of the clock. Each sample is a single pread
+	this->descriptor = open(this->path.c_str(), O_RDONLY | O_CLOEXEC);
+	
+	if (this->descriptor == -1)
+	{
+		logger::error("Failed to open light sensor at {}", this->path);
+		return SENSOR_ERR::CODE::OPEN_FAIL;
+	}
+	
+	logger::verbose("Opened light sensor at {} with descriptor {}", this->path, this->descriptor);
+	
+	return SENSOR_ERR::CODE::SUCCESS;
+}
+
+bool LightSensor::isOpen()
+{
+	return !this->errorState;
+}
+
+SENSOR_ERR::CODE LightSensor::sample()
+{
+	if (this->errorState) return SENSOR_ERR::CODE::OPEN_FAIL;
+	
+	//sysfs attributes regenerate on every read from offset 0, plain files just reread
+	char buf[32];
+	ssize_t got = pread(this->descriptor, buf, sizeof(buf) - 1, 0);
+	if (got <= 0) return SENSOR_ERR::CODE::RD_FAIL;
+	buf[got] = '\0';
+	
+	char* parseEnd = nullptr;
+	double lux = std::strtod(buf, &parseEnd);
+	if (parseEnd == buf || lux < 0) return SENSOR_ERR::CODE::PARSE_FAIL;
+	
+	//Median of the last few samples first, then exponential smoothing on top
+	this->window[this->windowNext] = lux;
+	this->windowNext = (this->windowNext + 1) % LIGHT_SENSOR_MEDIAN_WINDOW;
+	if (this->windowFill < LIGHT_SENSOR_MEDIAN_WINDOW) ++this->windowFill;
+	
+	double sorted[LIGHT_SENSOR_MEDIAN_WINDOW];
+	std::copy(this->window, this->window + this->windowFill, sorted);
+	std::nth_element(sorted, sorted + this->windowFill / 2, sorted + this->windowFill);
+	double median = sorted[this->windowFill / 2];
+	
+	if (this->smoothedLux < 0) this->smoothedLux = median;
+	else this->smoothedLux += LIGHT_SENSOR_SMOOTHING * (median - this->smoothedLux);
+	
+	return SENSOR_ERR::CODE::SUCCESS;
+}
+
+double LightSensor::getLux()
+{
+	return this->smoothedLux;
+}
+
+unsigned char LightSensor::adjustBrightness(unsigned char curveBrightness)
+{
+	if (this->errorState || this->smoothedLux < 0) return curveBrightness;
+	
+	//Eyes see light roughly logarithmically, so map lux onto 0-100 on a log scale
+	double roomLevel = std::log10(this->smoothedLux + 1) / std::log10(LIGHT_SENSOR_FULL_LUX + 1) * 100;
+	roomLevel = std::clamp(roomLevel, 0.0, 100.0);
+	
+	int target = std::lround(curveBrightness * (1 - LIGHT_SENSOR_WEIGHT) + roomLevel * LIGHT_SENSOR_WEIGHT);
+	
+	//Zero means the display is going off for the night. Never let the room override that
+	if (curveBrightness == 0) target = 0;
+	
+	//Hold the last output until the target clears the band, so a flickering room doesn't flood the DDC bus
+	if (this->lastOutput == -1 || target == 0 || std::abs(target - this->lastOutput) >= LIGHT_SENSOR_HYSTERESIS) this->lastOutput = target;
+	
+	return this->lastOutput;
+}
@@ -0,0 +1,67 @@
+/******************************************************************************
+/ Pi 4 Sunrise Clock App Ambient Light Sensor Class Spec - lopezk38 2025
+/
+/*****************************************************************************/
+
+#ifndef SUNCLOCK_APP_LIGHTSENSOR
+#define SUNCLOCK_APP_LIGHTSENSOR
+
+/******************************************************************************
+/ Dependencies, namespacing
+/*****************************************************************************/
+
+#include <string>
+
+#include "errorcodes.h"
+
+
+/******************************************************************************
+/ Constants
+/*****************************************************************************/
+
+constexpr unsigned int LIGHT_SENSOR_MEDIAN_WINDOW = 5; //Odd, knocks out single sample spikes
+constexpr double LIGHT_SENSOR_SMOOTHING = 0.2; //Exponential smoothing factor applied after the median
+constexpr double LIGHT_SENSOR_FULL_LUX = 1000; //Lux that counts as a fully bright room
+constexpr double LIGHT_SENSOR_WEIGHT = 0.5; //How much the sensor pulls the curve brightness, 0-1
+constexpr unsigned char LIGHT_SENSOR_HYSTERESIS = 5; //Brightness points the target must move before it changes
+
+
+/******************************************************************************
+/ Class specification
+/*****************************************************************************/
+
+//Reads an IIO in_illuminance attribute (or any file holding a lux number) through one persistent descriptor
+class LightSensor
+{
+	
+private:
+	
+	const std::string path;
+	int descriptor = -1;
+	
+	double window[LIGHT_SENSOR_MEDIAN_WINDOW] = {};
+	unsigned int windowFill = 0;
+	unsigned int windowNext = 0;
+	
+	double smoothedLux = -1; //-1 until the first sample
+	int lastOutput = -1; //Last brightness handed out, for hysteresis
+	
+	bool errorState = false;
+	
+	SENSOR_ERR::CODE openSensor();
+	
+public:
+
+	LightSensor(const std::string& path);
+	~LightSensor();
+	
+	bool isOpen();
+	
+	SENSOR_ERR::CODE sample();
+	double getLux();
+	
+	//Blends the sensor reading into the curve brightness. Only moves once the target clears the hysteresis band
+	unsigned char adjustBrightness(unsigned char curveBrightness);
+};
+
+#endif
@@ -0,0 +1,320 @@
+/******************************************************************************
+/ Pi 4 Sunrise Clock App Logger Implementation - lopezk38 2025
+/
+/*****************************************************************************/
+
+/******************************************************************************
+/ Dependencies, namespacing
+/*****************************************************************************/
+
+#include <unistd.h>
+#include <cstdio>
+#include <cstdlib>
+#include <strings.h>
+#include <thread>
+
+#include "logger.h"
+
+std::atomic<uint8_t> logger::runtimeLevel{logger::COMPILED_LEVEL};
+
+//Same bounded multi producer, single consumer scheme as the task inbox. Producers claim a slot with one compare and swap
+static logger::record slots[logger::LOG_CAPACITY];
+alignas(64) static std::atomic<uint64_t> tail{0};
+alignas(64) static uint64_t head = 0; //Formatter thread only
+alignas(64) static std::atomic<uint64_t> dropped{0};
+static std::atomic<bool> running{false};
+static std::thread formatter;
+
+//Filled by the formatter thread and written out once per drain. Fixed, so logging never allocates
+constexpr size_t OUTPUT_BUFFER_BYTES = 16384;
+
+struct outputBuffer
+{
+	int descriptor;
+	size_t used;
+	char bytes[OUTPUT_BUFFER_BYTES];
+};
+
+static outputBuffer standardOut = { STDOUT_FILENO, 0, {} };
+static outputBuffer standardError = { STDERR_FILENO, 0, {} };
+
+
+/******************************************************************************
+/ Levels
+/*****************************************************************************/
+
+const char* logger::LEVEL::toString(CODE level)
+{
+	switch (level)
+	{
+		case CODE::VERBOSE: return "verbose";
+		case CODE::INFO: return "info";
+		case CODE::WARNING: return "warning";
+		case CODE::ERROR: return "error";
+		case CODE::OFF: return "off";
+		default: return "unknown";
+	}
+}
+
+bool logger::LEVEL::fromString(const char* name, CODE& level)
+{
+	for (uint8_t i = 0; i < CODE::COUNT; ++i)
+	{
+		if (strcasecmp(name, toString(static_cast<CODE>(i)))) continue;
+		
+		level = static_cast<CODE>(i);
+		return true;
+	}
+	
+	return false;
+}
+
+
+/******************************************************************************
+/ Formatting
+/*****************************************************************************/
+
+static size_t formatArgument(const logger::record& message, const logger::argument& arg, char* out, size_t room)
+{
+	int written = 0;
+	switch (arg.type)
+	{
+		case logger::ARG::CODE::INT: written = std::snprintf(out, room, "%lld", static_cast<long long>(arg.i)); break;
+		case logger::ARG::CODE::UINT: written = std::snprintf(out, room, "%llu", static_cast<unsigned long long>(arg.u)); break;
+		case logger::ARG::CODE::DOUBLE: written = std::snprintf(out, room, "%g", arg.d); break; //Same as an ostream's default
+		case logger::ARG::CODE::CHAR: written = std::snprintf(out, room, "%c", arg.c); break;
+		case logger::ARG::CODE::TEXT: written = std::snprintf(out, room, "%s", message.text + arg.text); break;
+	}
+	
+	if (written < 0) return 0;
+	
+	return (static_cast<size_t>(written) < room) ? written : room - 1;
+}
+
+//One line, newline included. Warnings and errors get the same prefixes the console has always shown
+static size_t formatRecord(const logger::record& message, char* line)
+{
+	size_t used = 0;
+	const size_t room = logger::LOG_LINE_MAX - 1; //Always space left for the newline
+	
+	if (message.level == logger::LEVEL::CODE::WARNING) used = std::snprintf(line, room, "WARNING: ");
+	else if (message.level == logger::LEVEL::CODE::ERROR) used = std::snprintf(line, room, "ERROR: ");
+	
+	unsigned int nextArg = 0;
+	for (const char* at = message.format; *at && used < room - 1; ++at)
+	{
+		//{} is the next argument. Anything else, lone braces included, goes out as it is
+		if (at[0] == '{' && at[1] == '}' && nextArg < message.argCount)
+		{
+			used += formatArgument(message, message.args[nextArg++], line + used, room - used);
+			++at;
+			continue;
+		}
+		
+		line[used++] = *at;
+	}
+	
+	line[used++] = '\n';
+	
+	return used;
+}
+
+static void flushOutput(outputBuffer& buffer)
+{
+	//Anything the console won't take is lost. Retrying would only stall the next drain
+	size_t sent = 0;
+	while (sent < buffer.used)
+	{
+		ssize_t written = ::write(buffer.descriptor, buffer.bytes + sent, buffer.used - sent);
+		if (written <= 0) break;
+		sent += written;
+	}
+	buffer.used = 0;
+	
+	return;
+}
+
+static void appendLine(outputBuffer& buffer, const char* line, size_t length)
+{
+	if (buffer.used + length > OUTPUT_BUFFER_BYTES) flushOutput(buffer);
+	
+	std::memcpy(buffer.bytes + buffer.used, line, length);
+	buffer.used += length;
+	
+	return;
+}
+
+static outputBuffer& bufferFor(logger::LEVEL::CODE level)
+{
+	return (level >= logger::LEVEL::CODE::WARNING) ? standardError : standardOut;
+}
+
+void logger::writeNow(const record& message)
+{
+	char line[LOG_LINE_MAX];
+	size_t length = formatRecord(message, line);
+	
+	//Unbuffered, straight to the descriptor. Only used while there's no formatter thread
+	outputBuffer& buffer = bufferFor(message.level);
+	int descriptor = buffer.descriptor;
+	size_t sent = 0;
+	while (sent < length)
+	{
+		ssize_t written = ::write(descriptor, line + sent, length - sent);
+		if (written <= 0) break;
+		sent += written;
+	}
+	
+	return;
+}
+
+
+/******************************************************************************
+/ Ring
+/*****************************************************************************/
+
+bool logger::isRunning()
+{
+	return running.load(std::memory_order_acquire);
+}
+
+logger::record* logger::claim()
+{
+	uint64_t position = tail.load(std::memory_order_relaxed);
+	
+	while (true)
+	{
+		record* claimed = &slots[position & (LOG_CAPACITY - 1)];
+		int64_t lag = static_cast<int64_t>(claimed->sequence.load(std::memory_order_acquire) - position);
+		
+		if (lag == 0)
+		{
+			if (tail.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) return claimed;
+		}
+		else if (lag < 0)
+		{
+			//Still holds a message from a lap ago the formatter hasn't written. Full, drop rather than wait
+			dropped.fetch_add(1, std::memory_order_relaxed);
+			return nullptr;
+		}
+		else position = tail.load(std::memory_order_relaxed); //Another producer got here first
+	}
+}
+
+void logger::publish(record* message)
+{
+	uint64_t position = message->sequence.load(std::memory_order_relaxed);
+	message->sequence.store(position + 1, std::memory_order_release);
+	
+	return;
+}
+
+//Formatter thread only. Stops at the first slot a producer claimed but hasn't finished, and picks it up next drain
+static size_t drain()
+{
+	char line[logger::LOG_LINE_MAX];
+	size_t written = 0;
+	
+	while (true)
+	{
+		logger::record& next = slots[head & (logger::LOG_CAPACITY - 1)];
+		if (next.sequence.load(std::memory_order_acquire) != head + 1) break;
+		
+		size_t length = formatRecord(next, line);
+		appendLine(bufferFor(next.level), line, length);
+		
+		next.sequence.store(head + logger::LOG_CAPACITY, std::memory_order_release); //Ready for the producer one lap on
+		++head;
+		++written;
+	}
+	
+	flushOutput(standardOut);
+	flushOutput(standardError);
+	
+	return written;
+}
+
+static void formatterLoop()
+{
+	uint64_t reportedDrops = 0;
+	
+	while (true)
+	{
+		bool stopping = !running.load(std::memory_order_acquire);
+		drain();
+		
+		//Said once per drain, not per lost message. Written directly, the ring is the thing that's full
+		uint64_t drops = dropped.load(std::memory_order_relaxed);
+		if (drops != reportedDrops)
+		{
+			char line[128];
+			int length = std::snprintf(line, sizeof(line), "WARNING: Dropped %llu log messages, the log ring was full\n", static_cast<unsigned long long>(drops - reportedDrops));
+			if (length > 0) appendLine(standardError, line, length);
+			flushOutput(standardError);
+			reportedDrops = drops;
+		}
+		
+		if (stopping) return;
+		
+		std::this_thread::sleep_for(logger::LOG_DRAIN_INTERVAL);
+	}
+}
+
+
+/******************************************************************************
+/ Control
+/*****************************************************************************/
+
+void logger::start()
+{
+	if (running.load(std::memory_order_relaxed)) return;
+	
+	//Every slot starts out ready to be written at its own index
+	for (size_t i = 0; i < LOG_CAPACITY; ++i) slots[i].sequence.store(i, std::memory_order_relaxed);
+	tail.store(0, std::memory_order_relaxed);
+	head = 0;
+	
+	if (const char* levelName = std::getenv("SUNCLOCK_LOG_LEVEL"))
+	{
+		LEVEL::CODE level;
+		if (LEVEL::fromString(levelName, level)) setLevel(level);
+		else warning("Unknown SUNCLOCK_LOG_LEVEL {}, keeping {}", levelName, LEVEL::toString(getLevel()));
+	}
+	
+	running.store(true, std::memory_order_release);
+	formatter = std::thread(formatterLoop);
+	
+	static bool registered = false;
+	if (!registered) registered = !std::atexit(stop);
+	
+	return;
+}
+
+void logger::stop()
+{
+	if (!running.exchange(false, std::memory_order_acq_rel)) return;
+	
+	//The formatter sees the flag, drains what is left and returns
+	if (formatter.joinable()) formatter.join();
+	
+	return;
+}
+
+void logger::setLevel(LEVEL::CODE level)
+{
+	//Below the compiled level there's nothing left to turn on
+	if (level < COMPILED_LEVEL) level = COMPILED_LEVEL;
+	runtimeLevel.store(level, std::memory_order_relaxed);
+	
+	return;
+}
+
+logger::LEVEL::CODE logger::getLevel()
+{
+	return static_cast<LEVEL::CODE>(runtimeLevel.load(std::memory_order_relaxed));
+}
+
+uint64_t logger::getDropped()
+{
+	return dropped.load(std::memory_order_relaxed);
+}
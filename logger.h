@@ -0,0 +1,260 @@
+/******************************************************************************
+/ Pi 4 Sunrise Clock App Logger Spec - lopezk38 2025
+/
+/ Console logging that never waits on the console. A call copies its format
+/ pointer and arguments into a slot of a lock free ring and returns, and a
+/ background thread formats and writes whatever has queued up. A stalled SD
+/ card or journald only ever stalls that thread. When the ring is full the
+/ message is dropped and counted instead
+/
+/ Format strings are literals with {} for each argument, in order
+/
+/*****************************************************************************/
+
+#ifndef SUNCLOCK_APP_LOGGER
+#define SUNCLOCK_APP_LOGGER
+
+/******************************************************************************
+/ Dependencies, namespacing
+/*****************************************************************************/
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstddef>
+#include <cstring>
+#include <string_view>
+#include <type_traits>
+
+namespace logger {
+
+using namespace std::chrono_literals;
+
+
+/******************************************************************************
+/ Levels, constants
+/*****************************************************************************/
+
+namespace LEVEL
+{
+	enum CODE : uint8_t
+	{
+		VERBOSE = 0, //Per frame and per task chatter
+		INFO = 1,
+		WARNING = 2,
+		ERROR = 3,
+		OFF = 4,
+		COUNT
+	};
+	
+	const char* toString(CODE level);
+	bool fromString(const char* name, CODE& level); //False if the name isn't a level
+}
+
+//Calls below this aren't compiled in at all. The runtime level can only raise it
+#ifdef DEBUG
+constexpr LEVEL::CODE COMPILED_LEVEL = LEVEL::CODE::VERBOSE;
+#else
+constexpr LEVEL::CODE COMPILED_LEVEL = LEVEL::CODE::INFO;
+#endif
+
+constexpr size_t LOG_CAPACITY = 1024; //Messages waiting to be written. Must be a power of two
+constexpr unsigned int LOG_MAX_ARGS = 8;
+constexpr size_t LOG_TEXT_BYTES = 192; //Shared by a message's string arguments. Longer ones are cut short
+constexpr size_t LOG_LINE_MAX = 512; //Formatted, prefix and newline included
+constexpr std::chrono::milliseconds LOG_DRAIN_INTERVAL = 20ms; //Longest a message sits in the ring
+
+
+/******************************************************************************
+/ Ring layout
+/*****************************************************************************/
+
+namespace ARG
+{
+	enum CODE : uint8_t
+	{
+		INT,
+		UINT,
+		DOUBLE,
+		CHAR,
+		TEXT //Copied into the message's text area, the value is the offset
+	};
+}
+
+struct argument
+{
+	ARG::CODE type;
+	union
+	{
+		int64_t i;
+		uint64_t u;
+		double d;
+		char c;
+		uint16_t text;
+	};
+};
+
+struct record
+{
+	std::atomic<uint64_t> sequence; //Same scheme as the task inbox. Ready to write at its position, that plus one once written
+	const char* format; //Only the pointer is kept, so it has to outlive the message. Literals always do
+	LEVEL::CODE level;
+	uint8_t argCount;
+	uint16_t textUsed;
+	argument args[LOG_MAX_ARGS];
+	char text[LOG_TEXT_BYTES];
+};
+
+
+/******************************************************************************
+/ Control
+/*****************************************************************************/
+
+extern std::atomic<uint8_t> runtimeLevel;
+
+//Starts the formatter thread. SUNCLOCK_LOG_LEVEL picks the runtime level. Before this and after stop, messages are written on the calling thread
+void start();
+void stop(); //Writes out whatever is still queued. Also run at exit
+
+void setLevel(LEVEL::CODE level);
+LEVEL::CODE getLevel();
+uint64_t getDropped();
+
+//Used by the templates below
+bool isRunning();
+record* claim(); //Nullptr when the ring is full, and the message is counted as dropped
+void publish(record* message);
+void writeNow(const record& message);
+
+
+/******************************************************************************
+/ Argument capture. Numbers are copied as they are, strings into the message, formatting waits for the formatter thread
+/*****************************************************************************/
+
+inline void captureText(record& message, argument& arg, std::string_view value)
+{
+	if (message.textUsed >= LOG_TEXT_BYTES) message.textUsed = LOG_TEXT_BYTES - 1; //Full. Later strings come out empty
+	
+	arg.type = ARG::CODE::TEXT;
+	arg.text = message.textUsed;
+	
+	size_t room = LOG_TEXT_BYTES - message.textUsed - 1;
+	size_t length = value.size() < room ? value.size() : room;
+	std::memcpy(message.text + message.textUsed, value.data(), length);
+	message.text[message.textUsed + length] = '\0';
+	message.textUsed += length + 1;
+	
+	return;
+}
+
+template <typename T>
+inline void capture(record& message, const T& value)
+{
+	argument& arg = message.args[message.argCount++];
+	
+	if constexpr (std::is_same_v<T, char>)
+	{
+		arg.type = ARG::CODE::CHAR;
+		arg.c = value;
+	}
+	else if constexpr (std::is_enum_v<T>)
+	{
+		arg.type = ARG::CODE::INT;
+		arg.i = static_cast<int64_t>(value);
+	}
+	else if constexpr (std::is_integral_v<T> && std::is_signed_v<T>)
+	{
+		arg.type = ARG::CODE::INT;
+		arg.i = value;
+	}
+	else if constexpr (std::is_integral_v<T>)
+	{
+		//Unsigned char and bool come out as numbers, not characters
+		arg.type = ARG::CODE::UINT;
+		arg.u = value;
+	}
+	else if constexpr (std::is_floating_point_v<T>)
+	{
+		arg.type = ARG::CODE::DOUBLE;
+		arg.d = value;
+	}
+	else if constexpr (std::is_pointer_v<T>)
+	{
+		static_assert(std::is_same_v<std::remove_cv_t<std::remove_pointer_t<T>>, char>, "Log arguments must be numbers, enums or strings");
+		captureText(message, arg, value ? std::string_view(value) : std::string_view("(null)"));
+	}
+	else
+	{
+		static_assert(std::is_convertible_v<const T&, std::string_view>, "Log arguments must be numbers, enums or strings");
+		captureText(message, arg, std::string_view(value));
+	}
+	
+	return;
+}
+
+template <LEVEL::CODE level, typename... Args>
+inline void fill(record& message, const char* format, const Args&... args)
+{
+	message.format = format;
+	message.level = level;
+	message.argCount = 0;
+	message.textUsed = 0;
+	(capture(message, args), ...);
+	
+	return;
+}
+
+template <LEVEL::CODE level, typename... Args>
+inline void write(const char* format, const Args&... args)
+{
+	static_assert(sizeof...(Args) <= LOG_MAX_ARGS, "Too many log arguments");
+	
+	if constexpr (level >= COMPILED_LEVEL)
+	{
+		if (level < runtimeLevel.load(std::memory_order_relaxed)) return;
+		
+		//No formatter thread yet, or any more. Straight out, the way it always used to
+		if (!isRunning())
+		{
+			record message;
+			fill<level>(message, format, args...);
+			writeNow(message);
+			return;
+		}
+		
+		record* message = claim();
+		if (!message) return;
+		
+		fill<level>(*message, format, args...);
+		publish(message);
+	}
+	
+	return;
+}
+
+template <typename... Args>
+inline void verbose(const char* format, const Args&... args)
+{
+	write<LEVEL::CODE::VERBOSE>(format, args...);
+}
+
+template <typename... Args>
+inline void info(const char* format, const Args&... args)
+{
+	write<LEVEL::CODE::INFO>(format, args...);
+}
+
+template <typename... Args>
+inline void warning(const char* format, const Args&... args)
+{
+	write<LEVEL::CODE::WARNING>(format, args...);
+}
+
+template <typename... Args>
+inline void error(const char* format, const Args&... args)
+{
+	write<LEVEL::CODE::ERROR>(format, args...);
+}
+}
+
+#endif
@@ -1,843 +1,1867 @@
-/******************************************************************************
-/ Pi 4 Sunrise Clock App - lopezk38 2025
-/ Version 1.0
-/
-/*****************************************************************************/
-
-#ifndef SUNCLOCK_APP_MAIN
-#define SUNCLOCK_APP_MAIN
-
-//#define DEBUG
-
-
-/******************************************************************************
-/ Dependencies, namespacing
-/*****************************************************************************/
-
-#include <unistd.h>
-#include <chrono>
-#include <sstream>
-
-#include "raylib.h"
-#include "ddcutil_c_api.h"
-#include "ddcutil_status_codes.h"
-
-#include "errorcodes.h"
-#include "framebuffercontainer.h"
-#include "sunColorCurveLUT.h"
-#include "clockTextColorCurveLUT.h"
-
-#include "taskHeap.h"
-
-using namespace std::chrono_literals;
-
-
-/******************************************************************************
-/ Constants, enums, structs
-/*****************************************************************************/
-
-//Raylib Drawing Settings
-constexpr unsigned int FRAMEBUFFER_DEV = 0; // /dev/fb0
-constexpr unsigned int FRAME_RATE = 1; //FPS
-constexpr unsigned int TEXT_SIZE = 250;
-constexpr bool HOUR_LEADING_ZERO = true;
-
-//DDC (monitor control) settings
-constexpr unsigned char VCP_INPUT_CODE = 0x3; //DVI-D
-
-constexpr std::chrono::minutes BRIGHTNESS_UPDATE_FREQ = 30min;
-
-constexpr bool POWEROFF_ON_ZERO_BRIGHTNESS = true;
-constexpr std::chrono::minutes POWERCHECK_UPDATE_FREQ = 15min;
-constexpr std::chrono::seconds POWERON_STEP_DELAY = 2s;
-constexpr std::chrono::seconds POWERON_BRIGHTNESS_UPD_DELAY = 2s;
-
-//Time settings
-constexpr int TIMEZONE_OFFSET = -7; //Pacific time
-static_assert(TIMEZONE_OFFSET > -24 || TIMEZONE_OFFSET < 24, "TIMEZONE_OFFSET must be a valid timezone");
-
-struct timeStruct
-{
-	long hour;
-	long min;
-	long sec;
-};
-
-
-/******************************************************************************
-/ Function prototypes
-/*****************************************************************************/
-
-//Time
-timeStruct getTime();
-void drawClockText(const timeStruct& curTime, const int xRes, const int yRes);
-
-//Brightness and DDC
-DDCA_Display_Handle ddcInit();
-DDCA_Status setDDCBrightness(DDCA_Display_Handle displayHandle, unsigned char brightness);
-DDCA_Status setDisplayInput(DDCA_Display_Handle displayHandle, unsigned char vcpInputCode);
-DDCA_Status toggleDisplayPower(DDCA_Display_Handle displayHandle);
-DDCA_Status displayPowerOff(DDCA_Display_Handle displayHandle);
-DDCA_Status displayPowerOn(DDCA_Display_Handle displayHandle);
-bool isDisplayOn(DDCA_Display_Handle displayHandle);
-void ddcDeinit(DDCA_Display_Handle displayHandle);
-
-
-/******************************************************************************
-/ Function implementations
-/*****************************************************************************/
-
-int main(int argc, char* argv[])
-{
-	unsigned char currentBrightness = 1; //Will be updated later
-	bool powerCheckInProgress = false; //Used to lock powerchecks
-	tHeap::TaskHeap taskSchedule;
-	
-	//Init DDC
-	DDCA_Display_Handle displayHandle = ddcInit();
-	
-	//Init framebuffer
-	FrameBufferContainer fBuf(FRAMEBUFFER_DEV);
-	
-	//Cache resolution
-	int xRes = fBuf.getXRes();
-	int yRes = fBuf.getYRes();
-	
-	//Init window
-	InitWindow(xRes, yRes, "Clock Window");
-	
-	//Draw color
-	#ifndef DEBUG
-	SetTargetFPS(FRAME_RATE); //1 FPS by default
-	std::cout << "Sun Clock is now running. Press ESC to quit." << std::endl;
-	
-	//Setup time
-	timeStruct curTime = getTime();
-	
-	//Setup initial brightness
-	setDDCBrightness(displayHandle, SunBrightness::interp(curTime.hour, curTime.min));
-
-	long schTime = std::chrono::duration_cast<std::chrono::seconds>((std::chrono::system_clock::now() + BRIGHTNESS_UPDATE_FREQ).time_since_epoch()).count();
-	taskSchedule.pushTask(schTime, tHeap::TASK::CODE::SET_BRIGHTNESS_AND_RESCHEDULE); //Schedule another brightness update
-	
-	//Setup power update schedule if the feature is enabled
-	if (POWEROFF_ON_ZERO_BRIGHTNESS)
-	{
-		schTime = std::chrono::duration_cast<std::chrono::seconds>((std::chrono::system_clock::now() + POWERCHECK_UPDATE_FREQ).time_since_epoch()).count();
-		taskSchedule.pushTask(schTime, tHeap::TASK::CODE::CHECK_SHOULD_TOGGLE_DISPLAY_PWR); //Schedule a power update
-	}
-	
-	//Main loop
-	while (!WindowShouldClose())
-	{
-		BeginDrawing();
-
-		//Set color
-		curTime = getTime();
-		Color color = SunColor::interp(curTime.hour, curTime.min);
-		ClearBackground(color);
-		
-		//Draw clock
-		drawClockText(curTime, xRes, yRes);
-		
-		//Get current time for scheduler
-		long curTimeSeconds = std::chrono::duration_cast<std::chrono::seconds>(std::chrono::system_clock::now().time_since_epoch()).count();
-		
-		//Check for commands to execute
-		while (!taskSchedule.isEmpty() && taskSchedule.peekTask()->scheduledTime <= curTimeSeconds)
-		{
-			//Time to execute
-			tHeap::Task* taskToExecute = taskSchedule.popTask();
-			if (taskToExecute)
-			{
-				if (tHeap::TASK::isValidTaskCode(taskToExecute->task))
-				{
-					switch (taskToExecute->task)
-					{
-						default:
-						case tHeap::TASK::CODE::NONE:
-						{
-							//Do nothing
-							break;
-						}
-						
-						case tHeap::TASK::CODE::SET_INPUT:
-						{
-							setDisplayInput(displayHandle, VCP_INPUT_CODE); //Execute
-							
-							break;
-						}
-						
-						case tHeap::TASK::CODE::CHECK_SHOULD_TOGGLE_DISPLAY_PWR:
-						{
-							//Lock power check to prevent bouncing
-							if (powerCheckInProgress)
-							{
-								//Reschedule the blocked task
-								taskSchedule.pushTask(1, tHeap::TASK::CODE::CHECK_SHOULD_TOGGLE_DISPLAY_PWR);
-								
-								break;
-							}
-							
-							if (currentBrightness)
-							{
-								//Brightness is non zero, turn on the display. Function will ignore redundant calls
-								taskSchedule.pushTask(0, tHeap::TASK::CODE::DISPLAY_ON_STEP1_AND_RESCHEDULE); //Schedule next step to run immediately
-							}
-							else
-							{
-								//Brightness is zero, turn off the display. Function will ignore redundant calls
-								taskSchedule.pushTask(0, tHeap::TASK::CODE::DISPLAY_OFF_AND_RESCHEDULE); //Schedule next step to run immediately
-							}
-							
-							break;
-						}
-
-						case tHeap::TASK::CODE::DISPLAY_OFF_AND_RESCHEDULE:
-						{
-							//Schedule next check
-							schTime = std::chrono::duration_cast<std::chrono::seconds>((std::chrono::system_clock::now() + POWERCHECK_UPDATE_FREQ).time_since_epoch()).count();
-							taskSchedule.pushTask(schTime, tHeap::TASK::CODE::CHECK_SHOULD_TOGGLE_DISPLAY_PWR);
-									
-							//Unlock
-							powerCheckInProgress = false;
-							
-							//Bleed through
-						}
-						case tHeap::TASK::CODE::DISPLAY_OFF:
-						{
-							displayPowerOff(displayHandle); //Execute
-								
-							break;
-						}
-						
-						case tHeap::TASK::CODE::DISPLAY_ON_STEP1_AND_RESCHEDULE:
-						{
-							//Make sure display is not on
-							if (isDisplayOn(displayHandle))
-							{
-								//It's on already. Just reschedule the check
-									
-								//Schedule next check
-								long schTime = std::chrono::duration_cast<std::chrono::seconds>((std::chrono::system_clock::now() + POWERCHECK_UPDATE_FREQ).time_since_epoch()).count();
-								taskSchedule.pushTask(schTime, tHeap::TASK::CODE::CHECK_SHOULD_TOGGLE_DISPLAY_PWR);
-									
-								//Unlock
-								powerCheckInProgress = false;
-									
-								break;
-							}
-							
-							setDisplayInput(displayHandle, VCP_INPUT_CODE); //Execute. Must set input to soft wake monitor before it will accept powerOn command
-							
-							//Schedule next step
-							long schTime = std::chrono::duration_cast<std::chrono::seconds>((std::chrono::system_clock::now() + POWERON_STEP_DELAY).time_since_epoch()).count();
-							taskSchedule.pushTask(schTime, tHeap::TASK::CODE::DISPLAY_ON_STEP2_AND_RESCHEDULE);
-							
-							break;
-						}
-						
-						case tHeap::TASK::CODE::DISPLAY_ON_STEP1:
-						{
-							setDisplayInput(displayHandle, VCP_INPUT_CODE); //Execute. Must set input to soft wake monitor before it will accept powerOn command
-							
-							//Schedule next step
-							long schTime = std::chrono::duration_cast<std::chrono::seconds>((std::chrono::system_clock::now() + POWERON_STEP_DELAY).time_since_epoch()).count();
-							taskSchedule.pushTask(schTime, tHeap::TASK::CODE::DISPLAY_ON_STEP2);
-							
-							break;
-						}
-						
-						case tHeap::TASK::CODE::DISPLAY_ON_STEP2_AND_RESCHEDULE:
-						{
-							//Schedule next check
-							long schTime = std::chrono::duration_cast<std::chrono::seconds>((std::chrono::system_clock::now() + POWERCHECK_UPDATE_FREQ).time_since_epoch()).count();
-							taskSchedule.pushTask(schTime, tHeap::TASK::CODE::CHECK_SHOULD_TOGGLE_DISPLAY_PWR);
-								
-							//Unlock
-							powerCheckInProgress = false;
-								
-							//Bleed through
-						}
-						case tHeap::TASK::CODE::DISPLAY_ON_STEP2:
-						{
-							displayPowerOn(displayHandle); //Execute
-							
-							//Schedule brightness update
-							schTime = std::chrono::duration_cast<std::chrono::seconds>((std::chrono::system_clock::now() + POWERON_BRIGHTNESS_UPD_DELAY).time_since_epoch()).count();
-							taskSchedule.pushTask(schTime, tHeap::TASK::CODE::SET_BRIGHTNESS);
-							
-							break;
-						}
-			
-						case tHeap::TASK::CODE::DISPLAY_TOGGLE_STEP1:
-						{
-							setDisplayInput(displayHandle, VCP_INPUT_CODE); //Execute. Must set input to soft wake monitor before it will accept powerOn command
-							
-							//Schedule next step
-							long schTime = std::chrono::duration_cast<std::chrono::seconds>((std::chrono::system_clock::now() + POWERON_BRIGHTNESS_UPD_DELAY).time_since_epoch()).count();
-							taskSchedule.pushTask(schTime, tHeap::TASK::CODE::DISPLAY_TOGGLE_STEP2);
-							break;
-						}
-						
-						case tHeap::TASK::CODE::DISPLAY_TOGGLE_STEP2:
-						{
-							toggleDisplayPower(displayHandle); //Execute
-							
-							//Schedule brightness update
-							schTime = std::chrono::duration_cast<std::chrono::seconds>((std::chrono::system_clock::now() + POWERON_BRIGHTNESS_UPD_DELAY).time_since_epoch()).count();
-							taskSchedule.pushTask(schTime, tHeap::TASK::CODE::SET_BRIGHTNESS);
-							
-							break;
-						}
-						
-						case tHeap::TASK::CODE::SET_BRIGHTNESS_AND_RESCHEDULE:
-						{
-							//Reschedule
-							long schTime = std::chrono::duration_cast<std::chrono::seconds>((std::chrono::system_clock::now() + BRIGHTNESS_UPDATE_FREQ).time_since_epoch()).count();
-							taskSchedule.pushTask(schTime, tHeap::TASK::CODE::SET_BRIGHTNESS_AND_RESCHEDULE);
-							
-							//Bleed through
-						}
-						case tHeap::TASK::CODE::SET_BRIGHTNESS:
-						{
-							unsigned char targetBrightness = SunBrightness::interp(curTime.hour, curTime.min); //Calc next brightness
-							setDDCBrightness(displayHandle, targetBrightness); //Tell monitor to adjust to the requested brightness
-							currentBrightness = targetBrightness; //Keep track of current state
-							
-							break;
-						}
-					}
-				}
-				else std::cerr << "ERROR: Attempted to run invalid task!" << std::endl;
-				
-				//Executed. Clean up
-				delete taskToExecute;
-			}
-			else std::cerr << "ERROR: Attempted to run task which was nullptr!" << std::endl;
-		}
-		
-		EndDrawing();
-	}
-	#endif
-	#ifdef DEBUG
-	//Debug mode, does a quick color sweep through the day in a few seconds
-	SetTargetFPS(60);
-	std::cout << "Sun Clock is running in debug mode. Press ESC to quit." << std::endl;
-	
-	//Setup brightness update schedule
-	long schTime = std::chrono::duration_cast<std::chrono::seconds>((std::chrono::system_clock::now() + 2s).time_since_epoch()).count();
-	taskSchedule.pushTask(schTime, tHeap::TASK::CODE::SET_BRIGHTNESS_AND_RESCHEDULE); //Schedule a brightness update 2 sec from now
-	
-	//Setup power update schedule if the feature is enabled
-	if (POWEROFF_ON_ZERO_BRIGHTNESS)
-	{
-		schTime = std::chrono::duration_cast<std::chrono::seconds>((std::chrono::system_clock::now() + 1s).time_since_epoch()).count();
-		taskSchedule.pushTask(schTime, tHeap::TASK::CODE::CHECK_SHOULD_TOGGLE_DISPLAY_PWR); //Schedule a power update 1 sec from now
-	}
-	
-	//Do day cycle sim
-	for (int i = 0; i < 24; ++i)
-	{
-		for (int j = 0; j < 60; ++j)
-		{
-			BeginDrawing();
-			
-			DrawText("DEBUG MODE", 20, 20, 40, YELLOW);
-			
-			//Set color
-			timeStruct curTime = getTime();
-			Color color = SunColor::interp(i, j);
-			ClearBackground(color);
-			
-			//Draw clock
-			drawClockText({i, j, 0}, xRes, yRes);
-			
-			//Get current time for scheduler
-			long curTimeSeconds = std::chrono::duration_cast<std::chrono::seconds>(std::chrono::system_clock::now().time_since_epoch()).count();
-			
-			//Check for commands to execute
-			while (!taskSchedule.isEmpty() && taskSchedule.peekTask()->scheduledTime <= curTimeSeconds)
-			{
-				//Time to execute
-				tHeap::Task* taskToExecute = taskSchedule.popTask();
-				if (taskToExecute)
-				{
-					if (tHeap::TASK::isValidTaskCode(taskToExecute->task))
-					{
-						switch (taskToExecute->task)
-						{
-							default:
-							case tHeap::TASK::CODE::NONE:
-							{
-								//Do nothing
-								break;
-							}
-							
-							case tHeap::TASK::CODE::SET_INPUT:
-							{
-								setDisplayInput(displayHandle, VCP_INPUT_CODE); //Execute
-								break;
-							}
-							
-							case tHeap::TASK::CODE::CHECK_SHOULD_TOGGLE_DISPLAY_PWR:
-							{
-								//Lock power check to prevent bouncing
-								if (powerCheckInProgress)
-								{
-									//Reschedule the blocked task
-									taskSchedule.pushTask(1, tHeap::TASK::CODE::CHECK_SHOULD_TOGGLE_DISPLAY_PWR);
-									
-									break;
-								}
-								
-								std::cout << "Checking if we should toggle the display power. Current brightness is " << static_cast<short>(currentBrightness) << '%' << std::endl;
-								
-								if (currentBrightness)
-								{
-									//Brightness is non zero, turn on the display. Function will ignore redundant calls
-									taskSchedule.pushTask(0, tHeap::TASK::CODE::DISPLAY_ON_STEP1_AND_RESCHEDULE); //Schedule next step to run immediately
-								}
-								else
-								{
-									//Brightness is zero, turn off the display. Function will ignore redundant calls
-									taskSchedule.pushTask(0, tHeap::TASK::CODE::DISPLAY_OFF_AND_RESCHEDULE); //Schedule next step to run immediately
-								}
-								
-								break;
-							}
-							case tHeap::TASK::CODE::DISPLAY_OFF_AND_RESCHEDULE:
-							{
-								//Schedule next check for 5sec from now
-								schTime = std::chrono::duration_cast<std::chrono::seconds>((std::chrono::system_clock::now() + 5s).time_since_epoch()).count();
-								taskSchedule.pushTask(schTime, tHeap::TASK::CODE::CHECK_SHOULD_TOGGLE_DISPLAY_PWR);
-										
-								//Unlock
-								powerCheckInProgress = false;
-								
-								//Bleed through
-							}
-							case tHeap::TASK::CODE::DISPLAY_OFF:
-							{
-								displayPowerOff(displayHandle); //Execute
-								
-								break;
-							}
-							
-							case tHeap::TASK::CODE::DISPLAY_ON_STEP1_AND_RESCHEDULE:
-							{
-								//Make sure display is not on
-								if (isDisplayOn(displayHandle))
-								{
-									//It's on already. Just reschedule the check
-									
-									//Schedule next check for 5sec from now
-									long schTime = std::chrono::duration_cast<std::chrono::seconds>((std::chrono::system_clock::now() + 5s).time_since_epoch()).count();
-									taskSchedule.pushTask(schTime, tHeap::TASK::CODE::CHECK_SHOULD_TOGGLE_DISPLAY_PWR);
-									
-									//Unlock
-									powerCheckInProgress = false;
-									
-									std::cout << "Requested display to power on but it was already on" << std::endl;
-									
-									break;
-								}
-								
-								setDisplayInput(displayHandle, VCP_INPUT_CODE); //Execute. Must set input to soft wake monitor before it will accept powerOn command
-								
-								//Schedule next step for 2 seconds from now
-								long schTime = std::chrono::duration_cast<std::chrono::seconds>((std::chrono::system_clock::now() + 2s).time_since_epoch()).count();
-								taskSchedule.pushTask(schTime, tHeap::TASK::CODE::DISPLAY_ON_STEP2_AND_RESCHEDULE);
-								
-								break;
-							}
-				
-							case tHeap::TASK::CODE::DISPLAY_ON_STEP1:
-							{
-								setDisplayInput(displayHandle, VCP_INPUT_CODE); //Execute. Must set input to soft wake monitor before it will accept powerOn command
-								
-								//Schedule next step for 2 second from now
-								long schTime = std::chrono::duration_cast<std::chrono::seconds>((std::chrono::system_clock::now() + 2s).time_since_epoch()).count();
-								taskSchedule.pushTask(schTime, tHeap::TASK::CODE::DISPLAY_ON_STEP2);
-								
-								break;
-							}
-							
-							case tHeap::TASK::CODE::DISPLAY_ON_STEP2_AND_RESCHEDULE:
-							{
-								//Schedule next check for 5sec from now
-								long schTime = std::chrono::duration_cast<std::chrono::seconds>((std::chrono::system_clock::now() + 5s).time_since_epoch()).count();
-								taskSchedule.pushTask(schTime, tHeap::TASK::CODE::CHECK_SHOULD_TOGGLE_DISPLAY_PWR);
-									
-								//Unlock
-								powerCheckInProgress = false;
-									
-								//Bleed through
-							}
-							case tHeap::TASK::CODE::DISPLAY_ON_STEP2:
-							{
-								displayPowerOn(displayHandle); //Execute
-								
-								//Schedule brightness update
-								schTime = std::chrono::duration_cast<std::chrono::seconds>((std::chrono::system_clock::now() + POWERON_BRIGHTNESS_UPD_DELAY).time_since_epoch()).count();
-								taskSchedule.pushTask(schTime, tHeap::TASK::CODE::SET_BRIGHTNESS);
-								
-								break;
-							}
-				
-							case tHeap::TASK::CODE::DISPLAY_TOGGLE_STEP1:
-							{
-								setDisplayInput(displayHandle, VCP_INPUT_CODE); //Execute. Must set input to soft wake monitor before it will accept powerOn command
-								
-								//Schedule next step for 2 seconds from now
-								long schTime = std::chrono::duration_cast<std::chrono::seconds>((std::chrono::system_clock::now() + 2s).time_since_epoch()).count();
-								taskSchedule.pushTask(schTime, tHeap::TASK::CODE::DISPLAY_TOGGLE_STEP2);
-								break;
-							}
-							
-							case tHeap::TASK::CODE::DISPLAY_TOGGLE_STEP2:
-							{
-								toggleDisplayPower(displayHandle); //Execute
-								
-								//Schedule brightness update for 2 seconds from now
-								schTime = std::chrono::duration_cast<std::chrono::seconds>((std::chrono::system_clock::now() + 2s).time_since_epoch()).count();
-								taskSchedule.pushTask(schTime, tHeap::TASK::CODE::SET_BRIGHTNESS);
-								
-								break;
-							}
-							
-							case tHeap::TASK::CODE::SET_BRIGHTNESS_AND_RESCHEDULE:
-							{
-								//Reschedule for 5 sec from now
-								long schTime = std::chrono::duration_cast<std::chrono::seconds>((std::chrono::system_clock::now() + 5s).time_since_epoch()).count();
-								taskSchedule.pushTask(schTime, tHeap::TASK::CODE::SET_BRIGHTNESS_AND_RESCHEDULE);
-								
-								//Bleed through
-							}
-							case tHeap::TASK::CODE::SET_BRIGHTNESS:
-							{
-								unsigned char targetBrightness = SunBrightness::interp(i, j); //Calc next brightness
-								setDDCBrightness(displayHandle, targetBrightness); //Tell monitor to adjust to the requested brightness
-								currentBrightness = targetBrightness; //Keep track of current state
-								
-								break;
-							}
-						}
-					}
-					else std::cerr << "ERROR: Attempted to run invalid task!" << std::endl;
-					
-					//Executed. Clean up
-					delete taskToExecute;
-				}
-				else std::cerr << "ERROR: Attempted to run task which was nullptr!" << std::endl;		
-			}
-			if (!taskSchedule.isEmpty()) std::cout << "Next task due in " << taskSchedule.peekTask()->scheduledTime - curTimeSeconds << " seconds" << std::endl;
-		
-			EndDrawing();
-		}
-	}
-	#endif
-	
-	//Deinit
-	CloseWindow(); 
-	
-	return 0;
-}
-
-timeStruct getTime()
-{
-	//Get time snapshot in seconds
-	std::chrono::system_clock::time_point timeSnap = std::chrono::system_clock::now();
-
-	//Convert to days (lossy)
-	auto timeSnapInDays = std::chrono::time_point_cast<std::chrono::days>(timeSnap);
-
-	//Find amount of seconds from the start of the day by taking advantage of the lossy day conversion
-	auto secondsSinceMidnight = timeSnap - timeSnapInDays;
-
-	//Repeat lossy conversion to extract hour, then minute, then second
-	auto hour = std::chrono::duration_cast<std::chrono::hours>(secondsSinceMidnight);
-	secondsSinceMidnight -= hour;
-	auto minute = std::chrono::duration_cast<std::chrono::minutes>(secondsSinceMidnight);
-	secondsSinceMidnight -= minute;
-	auto second = std::chrono::duration_cast<std::chrono::seconds>(secondsSinceMidnight);
-	
-	timeStruct curTime = { hour.count(), minute.count(), second.count() };
-	
-	//Apply timezone offset
-	curTime.hour += TIMEZONE_OFFSET;
-	if (curTime.hour < 0) curTime.hour += 24;
-	if (curTime.hour > 23 ) curTime.hour -= 24;
-	
-	#ifdef DEBUG
-	std::cout << "Time: " << curTime.hour << ":" << curTime.min << ":" << curTime.sec << std::endl;
-	#endif
-	
-	return curTime;
-}
-
-void drawClockText(const timeStruct& curTime, const int xRes, const int yRes)
-{
-	static std::stringstream clockTextBuf; //static because there is no need to constantly construct and deconstruct it
-	
-	//Build time string
-	//Convert from military hour to regular AM/PM hours (0-24 to 0-12)
-	short stdHr = curTime.hour % 12;
-	if (stdHr == 0) stdHr = 12;
-	
-	if (stdHr < 10 && HOUR_LEADING_ZERO) clockTextBuf << '0'; //Add a leading 0 to hours if HOUR_LEADING_ZERO is on and hour is a single digit number
-	clockTextBuf << stdHr << ':';
-	if (curTime.min < 10) clockTextBuf << '0'; //Add a leading zero to minute if minute is a single digit number
-	clockTextBuf << curTime.min;
-	const char* timeStr = clockTextBuf.str().c_str(); //Raylib requires a C string
-	
-	//Calculate correct offsets to center the clock text
-	int xOffset = (xRes - MeasureText(timeStr, TEXT_SIZE)) / 2;
-	int yOffset = (yRes - TEXT_SIZE) / 2;
-	
-	//Print the clock on the center of the screen
-	DrawText(timeStr, xOffset, yOffset, TEXT_SIZE, ClockTextColor::interp(curTime.hour, curTime.min));
-	
-	//Flush stringstream
-	clockTextBuf.str("");
-}
-
-DDCA_Display_Handle ddcInit()
-{
-	DDCA_Display_Identifier displayID;
-	DDCA_Display_Ref displayRef;
-	DDCA_Display_Handle displayHandle = nullptr;
-	
-	//Identify and enumerate display
-	ddca_create_dispno_display_identifier(FRAMEBUFFER_DEV + 1, &displayID); //DDC starts at 1, not 0 like device number. Add 1 to compensate
-	DDCA_Status result = ddca_get_display_ref(displayID, &displayRef);
-	
-	if (result) 
-	{
-		//Non 0 result is an error
-		std::cerr << "ERROR: Unable to find DDC display. DDCA Status: " << ddca_rc_name(result) << ": " << ddca_rc_desc(result) << std::endl;
-		throw result;
-	}
-	
-	ddca_free_display_identifier(displayID); //Cleanup
-	
-	//Connect to display
-	result = ddca_open_display2(displayRef, false, &displayHandle);
-	
-	if (result) 
-	{
-		//Non 0 result is an error
-		std::cerr << "ERROR: Unable to connect to DDC display. DDCA Status: " << ddca_rc_name(result) << ": " << ddca_rc_desc(result) << std::endl;
-		throw result;
-	}
-	
-	return displayHandle;
-}
-
-DDCA_Status setDDCBrightness(DDCA_Display_Handle displayHandle, unsigned char brightness)
-{
-	//Check if we are connected to a display
-	if (!displayHandle) return DDCRC_INVALID_DISPLAY;
-	
-	//Enforce bounds on brightness
-	if (brightness > 100) brightness = 100;
-	
-	//Use DDC to command brightness level. 0x10 code is brightness.	
-	DDCA_Status result = ddca_set_non_table_vcp_value(displayHandle, 0x10, 0x0, brightness);
-	
-	#ifdef DEBUG
-	std::cout << "Set brightness to " << static_cast<short>(brightness) << " with status code " << result << ": " << ddca_rc_name(result) << ": " << ddca_rc_desc(result) << std::endl;
-	#endif
-	
-	return result;
-}
-
-DDCA_Status setDisplayInput(DDCA_Display_Handle displayHandle, unsigned char vcpInputCode)
-{
-	if (!displayHandle) return DDCRC_INVALID_DISPLAY;
-	
-	//Use DDC to command display input
-	DDCA_Status inputCmdResult = ddca_set_non_table_vcp_value(displayHandle, 0x60, 0x0, vcpInputCode); //Input command
-	
-	#ifdef DEBUG
-	std::cout << "Attempted to set display input to " << static_cast<short>(VCP_INPUT_CODE) 
-			  << ". Got status code " << inputCmdResult << ": " << ddca_rc_name(inputCmdResult) << ": " << ddca_rc_desc(inputCmdResult) << std::endl;
-	#endif
-	
-	return inputCmdResult;
-}
-
-DDCA_Status toggleDisplayPower(DDCA_Display_Handle displayHandle)
-{
-	//Check if we are connected to a display
-	if (!displayHandle) return DDCRC_INVALID_DISPLAY;
-	
-	//Use DDC to command power toggle
-	DDCA_Status powerCmdResult = ddca_set_non_table_vcp_value(displayHandle, 0xD6, 0x0, 0x5); //Power command
-	
-	#ifdef DEBUG		  
-	std::cout << "Attempted to toggle display power. Got status code " << powerCmdResult << ": " << ddca_rc_name(powerCmdResult) << ": "
-			  << ddca_rc_desc(powerCmdResult) << std::endl;
-	#endif
-	
-	return powerCmdResult;
-}
-
-DDCA_Status displayPowerOff(DDCA_Display_Handle displayHandle)
-{
-	//Check if we are connected to a display
-	if (!displayHandle) return DDCRC_INVALID_DISPLAY;
-	
-	//Check if display is already off
-	if (!isDisplayOn(displayHandle))
-	{
-		//It's off. Just return OK
-		
-		#ifdef DEBUG		  
-		std::cout << "Requested display to power off but it was already off" << std::endl;
-		#endif
-		
-		return DDCRC_OK;
-	}
-	
-	//Send DDC command to turn off the display
-	DDCA_Status result = ddca_set_non_table_vcp_value(displayHandle, 0xD6, 0x0, 0x5); //Power command
-	
-	#ifdef DEBUG		  
-	std::cout << "Requested display to power off. Got status code: " << ddca_rc_name(result) << ": "
-			  << ddca_rc_desc(result) << std::endl;
-	#endif
-	
-	return result;
-	
-}
-
-DDCA_Status displayPowerOn(DDCA_Display_Handle displayHandle)
-{
-	//Check if we are connected to a display
-	if (!displayHandle) return DDCRC_INVALID_DISPLAY;
-	
-	//Check if display is already on
-	if (isDisplayOn(displayHandle))
-	{
-		//It's on. Just return OK
-		
-		#ifdef DEBUG		  
-		std::cout << "Requested display to power on but it was already on" << std::endl;
-		#endif
-		
-		return DDCRC_OK;
-	}
-	
-	//Send DDC command to turn on the display
-	DDCA_Status result = ddca_set_non_table_vcp_value(displayHandle, 0xD6, 0x0, 0x5); //Power command
-	
-	#ifdef DEBUG		  
-	std::cout << "Requested display to power on. Got status code: " << ddca_rc_name(result) << ": "
-			  << ddca_rc_desc(result) << std::endl;
-	#endif
-	
-	return result;
-}
-
-bool isDisplayOn(DDCA_Display_Handle displayHandle)
-{
-	//Check if we are connected to a display
-	if (!displayHandle) return true; //Assume display is on if we cannot talk to it
-	
-	//Use DDC command to request power mode (code 0xD6)
-	DDCA_Non_Table_Vcp_Value readPowerValueStruct;
-	DDCA_Status powerStatusResult = ddca_get_non_table_vcp_value(displayHandle, 0xD6, &readPowerValueStruct);
-	unsigned char readPowerValue = readPowerValueStruct.sl; //Only need the low byte
-	
-	#ifdef DEBUG		  
-	std::cout << "Requested display power status. Got state code " << static_cast<short>(readPowerValue) << " with status code: " << ddca_rc_name(powerStatusResult) << ": "
-			  << ddca_rc_desc(powerStatusResult) << std::endl;
-	#endif
-	
-	//Use DDC command to request the current monitor input if the monitor is on. This is because it allows us to determine if the monitor is soft on or fully on
-	if (readPowerValue != 0x5)
-	{
-		DDCA_Non_Table_Vcp_Value readInputValueStruct;
-		DDCA_Status inputStatusResult = ddca_get_non_table_vcp_value(displayHandle, 0x60, &readInputValueStruct);
-		unsigned char readInputValue = readInputValueStruct.sl; //Only need the low byte
-		
-		#ifdef DEBUG		  
-		std::cout << "Requested display input status. Got input code " << static_cast<short>(readInputValue) << " with status code: " << ddca_rc_name(inputStatusResult) << ": "
-				  << ddca_rc_desc(inputStatusResult) << std::endl;
-		#endif
-		
-		if (inputStatusResult) return true; //If we got an error, assume the monitor is on to prevent unstable state
-		
-		return readInputValue; //Any non-zero number is a valid input. Monitor gives 0 when soft-on, which we are considering off.
-	}
-	
-	return false; //Monitor must be off if we got here
-}
-
-void ddcDeinit(DDCA_Display_Handle displayHandle)
-{
-	ddca_close_display(displayHandle);
-	
-	return;
-}
-
-#endif
-
-
-
-
-
-
-
-
-
-
-
-
-
-
-
-
-
-
-
-
-
-
-
-
-
-
-
-
-
-
-
-
-
-
-
-
-
-
-
-
-
-
-
-
-
-
-
-
-
-
-
-
-
-
-
-
-
-
+/******************************************************************************
+/ Pi 4 Sunrise Clock App - lopezk38 2025
+/ Version 1.0
+/
+/*****************************************************************************/
+
+#ifndef SUNCLOCK_APP_MAIN
+#define SUNCLOCK_APP_MAIN
+
+
+/******************************************************************************
+/ Dependencies, namespacing
+/*****************************************************************************/
+
+#include <unistd.h>
+#include <cstdlib>
+#include <chrono>
+#include <cstring>
+#include <cstdio>
+#include <ctime>
+#include <future>
+#include <sstream>
+#include <vector>
+#include <algorithm>
+#include <thread>
+#include <memory>
+#include <poll.h>
+
+#include "raylib.h"
+#include "ddcutil_c_api.h"
+#include "ddcutil_status_codes.h"
+
+#include "errorcodes.h"
+#include "framebuffercontainer.h"
+#include "sunColorCurveLUT.h"
+#include "clockTextColorCurveLUT.h"
+#include "clockFace.h"
+#include "faceLayers.h"
+
+#include "taskHeap.h"
+#include "taskInbox.h"
+#include "dayPlan.h"
+#include "stateFile.h"
+#include "controlSocket.h"
+#include "metrics.h"
+#include "trace.h"
+#include "framePacer.h"
+#include "lightSensor.h"
+#include "clockWatch.h"
+#include "ddcLog.h"
+#include "monitorProfile.h"
+#include "allocTrack.h"
+#include "powerState.h"
+#include "monitorQuirks.h"
+#include "logger.h"
+#include "clockSync.h"
+#include "clockConfig.h" //DEBUG lives here now, the tools read it too
+#include "clockTasks.h"
+
+
+/******************************************************************************
+/ Constants, enums, structs
+/*****************************************************************************/
+
+//Timestamps of each init phase, used for the startup timing report
+struct startupTimes
+{
+	std::chrono::steady_clock::time_point processStart;
+	std::chrono::steady_clock::time_point fBufReady;
+	std::chrono::steady_clock::time_point windowReady;
+	std::chrono::steady_clock::time_point firstFrame;
+	
+	//Written by the DDC init thread. Only safe to read once its future is ready
+	std::chrono::steady_clock::time_point ddcStart;
+	std::chrono::steady_clock::time_point ddcEnumerated;
+	std::chrono::steady_clock::time_point ddcOpened;
+	
+	std::chrono::steady_clock::time_point ddcAttached;
+};
+
+//The monitor over DDC, as the tasks see it. handle stays nullptr until discovery finds one
+class DDCDisplay : public DisplayControl
+{
+
+public:
+
+	DDCA_Display_Handle handle = nullptr;
+	
+	bool isConnected() override;
+	bool setBrightness(unsigned char brightness) override;
+	bool setInput(unsigned char vcpInputCode) override;
+	bool togglePower() override;
+	bool powerOn() override;
+	bool powerOff() override;
+	bool isOn() override;
+	bool isOnDDC() override;
+	bool isReady(WAKE_PROBE::CODE probe) override;
+};
+
+//VCP traffic the capabilities string left out that the monitor then refused itself. Input and power values are held back one by one, the monitor may still take another
+struct refusedVcp
+{
+	uint8_t reads[32] = {}; //Bitmap by code
+	uint8_t writes[32] = {}; //Bitmap by code, everything but 0x60 and 0xD6
+	uint8_t inputValues[32] = {}; //Bitmap by value written to 0x60
+	uint8_t powerValues[32] = {}; //Bitmap by value written to 0xD6
+	
+	//value is -1 for a read
+	bool has(uint8_t vcpCode, int value) const
+	{
+		if (value < 0) return testBit(this->reads, vcpCode);
+		if (vcpCode == 0x60) return testBit(this->inputValues, value);
+		if (vcpCode == 0xD6) return testBit(this->powerValues, value);
+		
+		return testBit(this->writes, vcpCode);
+	}
+	
+	void add(uint8_t vcpCode, int value)
+	{
+		if (value < 0) setBit(this->reads, vcpCode);
+		else if (vcpCode == 0x60) setBit(this->inputValues, value);
+		else if (vcpCode == 0xD6) setBit(this->powerValues, value);
+		else setBit(this->writes, vcpCode);
+		
+		return;
+	}
+	
+	static bool testBit(const uint8_t (&bitmap)[32], uint8_t bit)
+	{
+		return bitmap[bit >> 3] & (1 << (bit & 0x7));
+	}
+	
+	static void setBit(uint8_t (&bitmap)[32], uint8_t bit)
+	{
+		bitmap[bit >> 3] |= 1 << (bit & 0x7);
+		return;
+	}
+};
+
+//DDC timing in effect. Only the thread doing VCP I/O touches these, and only once DDC has attached
+static ddcTiming activeDDCTiming;
+static unsigned int ddcTimingFailures = 0;
+static monitorCapabilities activeCapabilities; //VCP traffic the monitor never advertised is tried once, and stopped before reaching the bus once refused
+static bool capabilitiesActive = false;
+static refusedVcp refusedTraffic;
+static PowerStateSource* powerStateSource = nullptr; //Answers isDisplayOn without DDC once it has proven itself
+static DDCDisplay ddcDisplay;
+
+
+/******************************************************************************
+/ Function prototypes
+/*****************************************************************************/
+
+//Time
+timeStruct getTime();
+long scheduleNow();
+long secondsFromNow(std::chrono::seconds delay);
+long wallNow();
+long scheduleToWall(long scheduledTime);
+long wallToSchedule(long wallTime);
+float fractionalMinute(const timeStruct& curTime);
+void drawClockText(const clockFace& face, const int xRes, const int yRes);
+
+//Layered face
+void formatDateLine(char* out, size_t size);
+void formatNextEvent(const clockState& state, char* out, size_t size);
+
+//Clock sync
+uint32_t packSyncColor(Color color);
+Color unpackSyncColor(uint32_t packed);
+void fillSyncState(clockState& state, const timeStruct& curTime, syncState& out);
+bool serviceSync(tHeap::TaskHeap& taskSchedule, clockState& state, const timeStruct& curTime);
+
+//Frame accounting
+void recordFrame(std::chrono::steady_clock::time_point& lastFrame, double targetFps);
+void idleWait(ControlSocket& controlSocket, ClockWatch& clockWatch, tHeap::TaskInbox& taskInbox, ClockSync* clockSync, std::chrono::milliseconds timeout);
+
+//Scheduler. The tasks themselves are in clockTasks.cpp
+void reportBrightnessWrites(clockState& state);
+void reanchorSchedule(tHeap::TaskHeap& taskSchedule, clockState& state);
+
+//Startup
+bool pollDDCAttach(std::future<DDCA_Display_Handle>& ddcFuture, clockState& state, startupTimes& times);
+void attachDisplay(tHeap::TaskHeap& taskSchedule, clockState& state, const timeStruct& curTime, const persistedState* restored);
+void printStartupReport(const startupTimes& times);
+
+//Control socket
+std::string handleControlCommand(const std::string& command, tHeap::TaskHeap& taskSchedule, clockState& state, const startupTimes& times);
+
+//Warm restart
+bool loadPersistedState(StateFile& stateFile, persistedState& restored);
+void restoreTasks(tHeap::TaskHeap& taskSchedule, const persistedState& restored);
+
+//Brightness and DDC
+DDCA_Display_Handle ddcInit(startupTimes* times, monitorIdentity* monitor, monitorProfile* profile);
+bool queryCapabilities(DDCA_Display_Handle displayHandle, monitorCapabilities& capabilities);
+ddcTiming calibrateDDCTiming(DDCA_Display_Handle displayHandle);
+void setSleepMultiplier(float multiplier);
+template <typename Operation> DDCA_Status runWithDDCTiming(float multiplier, Operation operation);
+DDCA_Status ddcSetVcp(DDCA_Display_Handle displayHandle, unsigned char vcpCode, unsigned char value);
+DDCA_Status ddcGetVcp(DDCA_Display_Handle displayHandle, unsigned char vcpCode, DDCA_Non_Table_Vcp_Value* value);
+DDCA_Status setDDCBrightness(DDCA_Display_Handle displayHandle, unsigned char brightness);
+DDCA_Status setDisplayInput(DDCA_Display_Handle displayHandle, unsigned char vcpInputCode);
+DDCA_Status toggleDisplayPower(DDCA_Display_Handle displayHandle);
+DDCA_Status displayPowerOff(DDCA_Display_Handle displayHandle);
+DDCA_Status displayPowerOn(DDCA_Display_Handle displayHandle);
+bool isDisplayOn(DDCA_Display_Handle displayHandle);
+bool isDisplayOnDDC(DDCA_Display_Handle displayHandle);
+bool isMonitorReady(DDCA_Display_Handle displayHandle, WAKE_PROBE::CODE probe);
+void ddcDeinit(DDCA_Display_Handle displayHandle);
+
+
+/******************************************************************************
+/ Function implementations
+/*****************************************************************************/
+
+int main(int argc, char* argv[])
+{
+	startupTimes times;
+	times.processStart = std::chrono::steady_clock::now();
+	
+	//Console output goes through a ring and a formatter thread from here on, so a stalled console never stalls the loop
+	logger::start();
+	
+	//Tracing is opt in. With it off every trace point is a single predicted branch
+	if (std::getenv("SUNCLOCK_TRACE")) trace::init();
+	
+	clockState state;
+	tHeap::TaskHeap taskSchedule;
+	if (std::getenv("SUNCLOCK_WAKE_FIXED_DELAYS")) state.wake.enabled = false;
+	
+	//Periodic and "apply now" tasks only ever need one pending copy. Extra pushes just pull the pending one earlier
+	taskSchedule.reserve(STATEFILE_MAX_TASKS); //Nothing past this many is persisted anyway
+	taskSchedule.setUniqueKey(tHeap::TASK::CODE::CHECK_SHOULD_TOGGLE_DISPLAY_PWR, true);
+	taskSchedule.setUniqueKey(tHeap::TASK::CODE::SET_BRIGHTNESS_AND_RESCHEDULE, true);
+	taskSchedule.setUniqueKey(tHeap::TASK::CODE::SET_BRIGHTNESS, true);
+	taskSchedule.setUniqueKey(tHeap::TASK::CODE::SAMPLE_LIGHT_SENSOR_AND_RESCHEDULE, true);
+	taskSchedule.setUniqueKey(tHeap::TASK::CODE::VERIFY_DISPLAY_PWR, true);
+	
+	//The heap belongs to this thread. Anything scheduled from another one goes through here
+	tHeap::TaskInbox taskInbox(TASK_INBOX_CAPACITY);
+	
+	//DDC record/replay is opt in. Replay stands in for the monitor entirely, so a recorded night can drive the scheduler on a dev box
+	if (const char* replayPath = std::getenv("SUNCLOCK_DDC_REPLAY")) ddcLog::startReplay(replayPath);
+	else if (const char* recordPath = std::getenv("SUNCLOCK_DDC_RECORD")) ddcLog::startRecording(recordPath);
+	
+	//A replay has no monitor to ask. It keeps the fixed delays so the recorded transactions line up
+	if (ddcLog::replaying) state.wake.enabled = false;
+	state.display = &ddcDisplay;
+	
+	//Start DDC discovery in the background. Enumeration and opening the display can take several seconds, so don't hold up the first frame for it
+	std::future<DDCA_Display_Handle> ddcFuture = std::async(std::launch::async, ddcInit, &times, &state.monitor, &state.profile);
+	
+	//Look for state left behind by a previous run
+	StateFile stateFile(STATE_FILE_PATH);
+	persistedState restored;
+	bool haveRestored = loadPersistedState(stateFile, restored);
+	
+	//Open the control socket. It is served from the main loop, a bounded amount per frame
+	ControlSocket controlSocket(CONTROL_SOCKET_PATH);
+	ControlSocket::commandHandler controlHandler = [&](const std::string& command)
+	{
+		return handleControlCommand(command, taskSchedule, state, times);
+	};
+	
+	//Start the metrics endpoint. It scrapes from its own thread and only ever reads atomics
+	metrics::Server metricsServer(METRICS_PORT);
+	std::chrono::steady_clock::time_point lastFrame;
+	
+	//The scheduler runs on the steady clock. This is what tells it the time of day moved
+	ClockWatch clockWatch;
+	
+	//Open the light sensor if there is one. Brightness just follows the curve without it
+	std::unique_ptr<LightSensor> lightSensor;
+	const char* lightSensorPath = std::getenv("SUNCLOCK_LIGHT_SENSOR");
+	if (LIGHT_SENSOR_ENABLED || lightSensorPath)
+	{
+		lightSensor = std::make_unique<LightSensor>(lightSensorPath ? lightSensorPath : LIGHT_SENSOR_PATH);
+		if (lightSensor->isOpen()) state.lightSensor = lightSensor.get();
+	}
+	
+	//Same for the display power state. DDC answers whatever this can't
+	std::unique_ptr<PowerStateSource> powerState;
+	const char* powerStatePath = std::getenv("SUNCLOCK_POWER_STATE");
+	if (POWER_STATE_ENABLED || powerStatePath)
+	{
+		std::string connector = powerStatePath ? powerStatePath : PowerStateSource::findConnector();
+		if (!connector.empty())
+		{
+			powerState = std::make_unique<PowerStateSource>(connector);
+			if (powerState->isOpen()) powerStateSource = powerState.get();
+		}
+	}
+	
+	//Init framebuffer
+	FrameBufferContainer fBuf(FRAMEBUFFER_DEV);
+	times.fBufReady = std::chrono::steady_clock::now();
+	
+	//Cache resolution
+	int xRes = fBuf.getXRes();
+	int yRes = fBuf.getYRes();
+	
+	#ifdef DEBUG
+	pixel::format nativeFormat = fBuf.getPixelFormat();
+	logger::info("Framebuffer format: {} at {} bpp, {} conversion{}", pixel::toString(nativeFormat.code), nativeFormat.bitsPerPixel, (pixel::isConvertible(nativeFormat) ? pixel::kernelName() : "no"), (pixel::wantsDither(nativeFormat) ? " with dithering" : ""));
+	#endif
+	
+	//Init window
+	InitWindow(xRes, yRes, "Clock Window");
+	times.windowReady = std::chrono::steady_clock::now();
+	
+	#ifndef DEBUG
+	//With adaptive pacing the loop does its own waiting, so raylib must not add any
+	SetTargetFPS(ADAPTIVE_FRAME_PACING ? 0 : FRAME_RATE);
+	
+	FramePacer pacer(PACING_STEP_THRESHOLD, PACING_MAX_FPS, PACING_MIN_FPS);
+	if (ADAPTIVE_FRAME_PACING)
+	{
+		logger::info("Adaptive frame pacing: about {} frames per day, vs {} at a fixed {} FPS", static_cast<long>(pacer.estimateFramesPerDay()), FRAME_RATE * 24 * 60 * 60, FRAME_RATE);
+	}
+	
+	//The layered face is built on the CPU and handed to raylib as one texture. Only the rows that changed are uploaded again
+	std::unique_ptr<SkySet> skySet; //Outlives the face drawing from it
+	std::unique_ptr<LayeredFace> layeredFace;
+	Texture2D faceTexture = {};
+	char dateText[FACE_LINE_MAX];
+	char nextEventText[FACE_LINE_MAX];
+	
+	const char* skySetPath = std::getenv("SUNCLOCK_SKY_SET");
+	if (SKY_IMAGES_ENABLED || skySetPath)
+	{
+		//Mapped, not loaded. Only the two frames around the time are ever resident
+		skySet = std::make_unique<SkySet>(skySetPath ? skySetPath : SKY_SET_PATH);
+		if (skySet->isOpen() && (skySet->getWidth() != static_cast<uint32_t>(xRes) || skySet->getHeight() != static_cast<uint32_t>(yRes)))
+		{
+			logger::warning("Sky set is {}x{} but the screen is {}x{}. Repack it with skypack. Using the gradient", skySet->getWidth(), skySet->getHeight(), xRes, yRes);
+		}
+	}
+	
+	if (LAYERED_FACE_ENABLED || std::getenv("SUNCLOCK_LAYERED_FACE") || skySet)
+	{
+		layeredFace = std::make_unique<LayeredFace>(xRes, yRes, COMPOSITOR_THREADS, skySet.get());
+		
+		const Compositor& compositor = layeredFace->getCompositor();
+		Image faceImage = { const_cast<uint8_t*>(compositor.getFrame()), xRes, yRes, 1, PIXELFORMAT_UNCOMPRESSED_R8G8B8A8 };
+		faceTexture = LoadTextureFromImage(faceImage);
+		
+		logger::info("Layered face: {} tiles on {} threads", compositor.getTileCount(), compositor.getThreadCount());
+		if (layeredFace->hasSkyImages()) logger::info("Sky photos: {} {} frames, {} blend", skySet->getFrameCount(), pixel::toString(skySet->getFormat().code), pixel::kernelName());
+	}
+	
+	//A follower keeps working out its own curves and day plan. They're what it falls back on if the publisher goes quiet
+	std::unique_ptr<ClockSync> clockSync;
+	const char* syncRoleName = std::getenv("SUNCLOCK_SYNC");
+	SYNC_ROLE::CODE syncRole = CLOCK_SYNC_ROLE;
+	if (syncRoleName && !SYNC_ROLE::fromString(syncRoleName, syncRole)) logger::warning("Unknown SUNCLOCK_SYNC {}, expected publish or follow. Running alone", syncRoleName);
+	else if (CLOCK_SYNC_ENABLED || syncRoleName)
+	{
+		const char* syncGroup = std::getenv("SUNCLOCK_SYNC_GROUP");
+		const char* syncInterface = std::getenv("SUNCLOCK_SYNC_INTERFACE");
+		
+		clockSync = std::make_unique<ClockSync>(syncRole, syncGroup ? syncGroup : SYNC_DEFAULT_GROUP, SYNC_DEFAULT_PORT, syncInterface ? syncInterface : "");
+		if (clockSync->isOpen())
+		{
+			state.sync = clockSync.get();
+			logger::info("Clock sync: {} on {}:{}", SYNC_ROLE::toString(syncRole), (syncGroup ? syncGroup : SYNC_DEFAULT_GROUP), SYNC_DEFAULT_PORT);
+		}
+	}
+	#else
+	SetTargetFPS(FRAME_RATE);
+	#endif
+	
+	//Work out today's brightness and power steps. The cursor starts moving once DDC is attached
+	long brightnessPeriod = std::chrono::duration_cast<std::chrono::seconds>(BRIGHTNESS_UPDATE_FREQ).count();
+	DayPlan dayPlan(BRIGHTNESS_UPDATE_FREQ, PLAN_POWER_ON_LEAD, POWEROFF_ON_ZERO_BRIGHTNESS);
+	if (DAY_PLAN_ENABLED)
+	{
+		dayPlan.compile();
+		state.dayPlan = &dayPlan;
+		
+		logger::info("Day plan: {} steps a day, vs {} periodic brightness updates", dayPlan.size(), 24 * 60 * 60 / brightnessPeriod);
+	}
+	else
+	{
+		//Setup brightness update schedule. Lands on wall clock multiples of the period, since the curves follow the time of day. Tasks stay queued until DDC is attached
+		taskSchedule.pushPeriodicTask(tHeap::TaskHeap::nextWallBoundary(scheduleNow(), wallNow(), brightnessPeriod), brightnessPeriod, tHeap::TASK::CODE::SET_BRIGHTNESS_AND_RESCHEDULE, true);
+	}
+	
+	//Setup power update schedule if the feature is enabled. With a day plan this only puts back a power state something else changed
+	if (POWEROFF_ON_ZERO_BRIGHTNESS)
+	{
+		taskSchedule.pushPeriodicTask(secondsFromNow(POWERCHECK_UPDATE_FREQ), std::chrono::duration_cast<std::chrono::seconds>(POWERCHECK_UPDATE_FREQ).count(), tHeap::TASK::CODE::CHECK_SHOULD_TOGGLE_DISPLAY_PWR);
+	}
+	
+	//Start sampling right away
+	if (state.lightSensor) taskSchedule.pushPeriodicTask(0, LIGHT_SENSOR_SAMPLE_FREQ.count(), tHeap::TASK::CODE::SAMPLE_LIGHT_SENSOR_AND_RESCHEDULE);
+	
+	if (haveRestored && restored.taskCount)
+	{
+		//Pick the schedule back up where the last run left it. Saved periodic tasks fold into the ones above and pull them earlier if they were due sooner
+		restoreTasks(taskSchedule, restored);
+	}
+	
+	#ifndef DEBUG
+	logger::info("Sun Clock is now running. Press ESC to quit.");
+	
+	//Once the first frame is out and DDC is attached, a loop iteration should never touch the heap. Only checked with TRACK_ALLOCATIONS
+	bool steadyState = false;
+	
+	//Main loop
+	while (!WindowShouldClose())
+	{
+		uint64_t allocationsAtStart = allocTrack::allocations();
+		timeStruct curTime = getTime();
+		long secondOfDay = toSecondOfDay(curTime);
+		std::chrono::steady_clock::time_point loopStart = std::chrono::steady_clock::now();
+		
+		//Only draw when something on screen would visibly change
+		bool drawFrame = !ADAPTIVE_FRAME_PACING || pacer.frameDue(secondOfDay, loopStart);
+		
+		if (drawFrame)
+		{
+			trace::begin(trace::EVENT::FRAME);
+			BeginDrawing();
+			
+			clockFace face = buildClockFace(curTime.hour, curTime.min, fractionalMinute(curTime), HOUR_LEADING_ZERO);
+			
+			//A follower draws the publisher's colors. Its own are only the fallback
+			if (state.sync && state.sync->isFollowing())
+			{
+				face.background = unpackSyncColor(state.sync->getState().get(SYNC_FIELD::CODE::BACKGROUND));
+				face.text = unpackSyncColor(state.sync->getState().get(SYNC_FIELD::CODE::TEXT));
+			}
+			
+			if (layeredFace)
+			{
+				//Only tiles a layer changed on are drawn again
+				formatDateLine(dateText, sizeof(dateText));
+				formatNextEvent(state, nextEventText, sizeof(nextEventText));
+				layeredFace->update(secondOfDay, dateText, nextEventText);
+				
+				if (layeredFace->render())
+				{
+					int64_t blendMicros = layeredFace->getSkyBlendMicros();
+					if (blendMicros >= 0) metrics::skyBlended(blendMicros);
+					
+					const Compositor& compositor = layeredFace->getCompositor();
+					pixelRect dirty = compositor.getDirtyBounds();
+					Rectangle rows = { 0, static_cast<float>(dirty.y), static_cast<float>(xRes), static_cast<float>(dirty.height) };
+					UpdateTextureRec(faceTexture, rows, compositor.getFrame() + dirty.y * compositor.getStride());
+				}
+				
+				DrawTexture(faceTexture, 0, 0, WHITE);
+			}
+			else ClearBackground(face.background); //Set color
+			
+			//Draw clock
+			drawClockText(face, xRes, yRes);
+			
+			trace::end(trace::EVENT::FRAME); //Before EndDrawing so the frame rate wait does not count as work
+			EndDrawing();
+			
+			pacer.frameDrawn(secondOfDay, loopStart);
+			recordFrame(lastFrame, ADAPTIVE_FRAME_PACING ? pacer.getCurrentFps() : FRAME_RATE);
+			
+			if (times.firstFrame == std::chrono::steady_clock::time_point())
+			{
+				times.firstFrame = std::chrono::steady_clock::now();
+				printStartupReport(times);
+			}
+		}
+		else PollInputEvents(); //EndDrawing normally does this. Still need it to catch ESC
+		
+		//Attach DDC once discovery finishes, then setup initial brightness
+		if (pollDDCAttach(ddcFuture, state, times))
+		{
+			attachDisplay(taskSchedule, state, curTime, haveRestored ? &restored : nullptr);
+			printStartupReport(times);
+		}
+		
+		//Take requests from control clients. Anything they schedule runs below
+		unsigned int controlCommands = controlSocket.service(controlHandler);
+		
+		//A stepped wall clock moves the time of day out from under the curves. Catch up once instead of waiting out the period
+		if (clockWatch.clockJumped())
+		{
+			reanchorSchedule(taskSchedule, state);
+			pacer.requestRedraw();
+		}
+		
+		//Pick up anything other threads scheduled since the last pass
+		taskInbox.drainInto(taskSchedule);
+		
+		//Check for commands to execute
+		if (state.ddcAttached)
+		{
+			runTasks(taskSchedule, state, curTime, scheduleNow());
+			reportBrightnessWrites(state);
+		}
+		
+		//Publish what the tasks above just did, or take in what the publisher did. New colors are drawn on the very next pass
+		if (state.sync && serviceSync(taskSchedule, state, curTime)) pacer.requestRedraw();
+		
+		//Persist anything that changed for the next warm restart
+		if (state.stateDirty)
+		{
+			savePersistedState(stateFile, taskSchedule, state, scheduleNow(), wallNow());
+			state.stateDirty = false;
+		}
+		
+		//Control clients are allowed to cost an allocation or two. Nothing else is
+		if (allocTrack::enabled && steadyState && !controlCommands)
+		{
+			uint64_t allocated = allocTrack::allocations() - allocationsAtStart;
+			if (allocated) logger::warning("{} heap allocations in a steady state loop iteration", allocated);
+		}
+		steadyState = state.ddcAttached && times.firstFrame != std::chrono::steady_clock::time_point();
+		
+		//Sleep until the next frame, the next task or a control client, whichever is first
+		if (ADAPTIVE_FRAME_PACING)
+		{
+			std::chrono::milliseconds wait = std::min(pacer.timeUntilDue(secondOfDay, curTime.ms, std::chrono::steady_clock::now()), std::chrono::milliseconds(IDLE_POLL_INTERVAL));
+			
+			if (state.ddcAttached && !taskSchedule.isEmpty())
+			{
+				long nowMs = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+				wait = std::min(wait, std::chrono::milliseconds(std::max(0L, taskSchedule.peekTask()->scheduledTime * 1000 - nowMs)));
+			}
+			
+			if (state.wake.probe != WAKE_PROBE::CODE::NONE)
+			{
+				wait = std::min(wait, std::chrono::duration_cast<std::chrono::milliseconds>(state.wake.nextProbe - std::chrono::steady_clock::now()));
+			}
+			
+			idleWait(controlSocket, clockWatch, taskInbox, state.sync, wait);
+		}
+	}
+	
+	//Compare against what the fixed rate would have drawn over the same run
+	double uptime = std::chrono::duration<double>(std::chrono::steady_clock::now() - times.processStart).count();
+	logger::info("Rendered {} frames in {} seconds. A fixed {} FPS would have rendered {}", metrics::counters.framesRendered.load(), static_cast<long>(uptime), FRAME_RATE, static_cast<long>(uptime * FRAME_RATE));
+	
+	if (layeredFace) UnloadTexture(faceTexture);
+	#endif
+	#ifdef DEBUG
+	//Debug mode, does a quick color sweep through the day in a few seconds
+	logger::info("Sun Clock is running in debug mode. Press ESC to quit.");
+	
+	//Do day cycle sim
+	for (int i = 0; i < 24; ++i)
+	{
+		for (int j = 0; j < 60; ++j)
+		{
+			trace::begin(trace::EVENT::FRAME);
+			BeginDrawing();
+			
+			DrawText("DEBUG MODE", 20, 20, 40, YELLOW);
+			
+			timeStruct curTime = { i, j, 0, 0 };
+			clockFace face = buildClockFace(i, j, j, HOUR_LEADING_ZERO);
+			
+			//Set color
+			ClearBackground(face.background);
+			
+			//Draw clock
+			drawClockText(face, xRes, yRes);
+			
+			//Attach DDC once discovery finishes, then setup initial brightness
+			if (pollDDCAttach(ddcFuture, state, times))
+			{
+				attachDisplay(taskSchedule, state, curTime, haveRestored ? &restored : nullptr);
+				printStartupReport(times);
+			}
+			
+			//Take requests from control clients. Anything they schedule runs below
+			controlSocket.service(controlHandler);
+			
+			//The sweep fakes the time of day anyway, but keep the schedule honest if the real clock moves
+			if (clockWatch.clockJumped()) reanchorSchedule(taskSchedule, state);
+			
+			//Get current time for scheduler
+			long curTimeSeconds = scheduleNow();
+			
+			//Pick up anything other threads scheduled since the last pass
+			taskInbox.drainInto(taskSchedule);
+			
+			//Check for commands to execute
+			if (state.ddcAttached)
+			{
+				pollWakeProbe(taskSchedule, state);
+				runDueTasks(taskSchedule, state, curTime, curTimeSeconds);
+			}
+			
+			//Persist anything that changed for the next warm restart
+			if (state.stateDirty)
+			{
+				savePersistedState(stateFile, taskSchedule, state, scheduleNow(), wallNow());
+				state.stateDirty = false;
+			}
+			if (!taskSchedule.isEmpty()) logger::info("Next task due in {} seconds", taskSchedule.peekTask()->scheduledTime - curTimeSeconds);
+			
+			trace::end(trace::EVENT::FRAME);
+			EndDrawing();
+			recordFrame(lastFrame, FRAME_RATE);
+			
+			if (times.firstFrame == std::chrono::steady_clock::time_point())
+			{
+				times.firstFrame = std::chrono::steady_clock::now();
+				printStartupReport(times);
+			}
+		}
+	}
+	#endif
+	
+	//Deinit
+	CloseWindow();
+	
+	//Don't leave the DDC thread running. This only blocks if we quit before discovery finished
+	if (!state.ddcAttached && ddcFuture.valid())
+	{
+		try
+		{
+			ddcDisplay.handle = ddcFuture.get();
+		}
+		catch (DDCA_Status)
+		{
+			ddcDisplay.handle = nullptr;
+		}
+	}
+	if (ddcDisplay.handle) ddcDeinit(ddcDisplay.handle);
+	
+	ddcLog::stop();
+	trace::shutdown();
+	
+	return 0;
+}
+
+void recordFrame(std::chrono::steady_clock::time_point& lastFrame, double targetFps)
+{
+	std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+	
+	metrics::frameRendered();
+	
+	//Any whole frame periods beyond the first since the last frame were missed. Static output has no period to miss
+	if (lastFrame != std::chrono::steady_clock::time_point() && targetFps > 0)
+	{
+		auto framePeriod = std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double>(1.0 / targetFps));
+		auto periodsElapsed = (now - lastFrame) / framePeriod;
+		
+		if (periodsElapsed > 1) metrics::framesSkipped(periodsElapsed - 1);
+	}
+	
+	lastFrame = now;
+	
+	return;
+}
+
+void idleWait(ControlSocket& controlSocket, ClockWatch& clockWatch, tHeap::TaskInbox& taskInbox, ClockSync* clockSync, std::chrono::milliseconds timeout)
+{
+	if (timeout <= 0ms) return;
+	
+	//The control socket's epoll instance turns readable when a client needs attention, the clock watch when the wall clock is stepped,
+	//the task inbox when another thread schedules something, and a follower's sync socket when the publisher sends. A publisher's heartbeat is well inside the idle poll
+	pollfd waitPolls[4];
+	nfds_t pollCount = 0;
+	if (controlSocket.isOpen()) waitPolls[pollCount++] = { controlSocket.getEpollDescriptor(), POLLIN, 0 };
+	if (clockWatch.isOpen()) waitPolls[pollCount++] = { clockWatch.getDescriptor(), POLLIN, 0 };
+	if (taskInbox.isOpen())
+	{
+		taskInbox.prepareToWait();
+		waitPolls[pollCount++] = { taskInbox.getDescriptor(), POLLIN, 0 };
+	}
+	if (clockSync && clockSync->getRole() == SYNC_ROLE::CODE::FOLLOWER) waitPolls[pollCount++] = { clockSync->getDescriptor(), POLLIN, 0 };
+	
+	if (pollCount) poll(waitPolls, pollCount, timeout.count());
+	else std::this_thread::sleep_for(timeout);
+	
+	return;
+}
+
+void reportBrightnessWrites(clockState& state)
+{
+	//Print how many brightness writes the monitor took each day, to keep an eye on the sensor hysteresis
+	long day = wallNow() / (24 * 60 * 60);
+	uint64_t writes = metrics::counters.brightnessWrites.load(std::memory_order_relaxed);
+	
+	if (state.writeReportDay == -1)
+	{
+		state.writeReportDay = day;
+		state.writesAtReport = writes;
+		return;
+	}
+	if (day == state.writeReportDay) return;
+	
+	logger::info("Sent {} brightness writes over DDC in the last day (light sensor {})", writes - state.writesAtReport, (state.lightSensor ? "on" : "off"));
+	
+	state.writeReportDay = day;
+	state.writesAtReport = writes;
+	
+	return;
+}
+
+void reanchorSchedule(tHeap::TaskHeap& taskSchedule, clockState& state)
+{
+	logger::info("Wall clock was changed, re-anchoring the schedule");
+	
+	//Time of day tasks move to their next boundary on the new clock. Everything else is on the steady clock and never noticed
+	taskSchedule.reanchorWallAligned(scheduleNow(), wallNow());
+	
+	//Same for the plan. Whatever it skipped over is covered by the catch up below
+	if (state.dayPlan) state.dayPlan->seek(toSecondOfDay(getTime()));
+	
+	//The right brightness and power state may have changed with the clock. One catch up of each, unique keys keep it to one
+	taskSchedule.pushTask(0, tHeap::TASK::CODE::SET_BRIGHTNESS);
+	if (POWEROFF_ON_ZERO_BRIGHTNESS) taskSchedule.pushTask(0, tHeap::TASK::CODE::CHECK_SHOULD_TOGGLE_DISPLAY_PWR);
+	
+	return;
+}
+
+bool pollDDCAttach(std::future<DDCA_Display_Handle>& ddcFuture, clockState& state, startupTimes& times)
+{
+	//Returns true only on the iteration where DDC becomes attached
+	if (state.ddcAttached || !ddcFuture.valid()) return false;
+	
+	//Never block the frame waiting on discovery
+	if (ddcFuture.wait_for(0s) != std::future_status::ready) return false;
+	
+	try
+	{
+		ddcDisplay.handle = ddcFuture.get();
+	}
+	catch (DDCA_Status)
+	{
+		//ddcInit already reported the error. Keep the clock running without monitor control
+		logger::error("DDC is unavailable. Continuing without brightness or power control");
+		ddcDisplay.handle = nullptr;
+	}
+	
+	state.ddcAttached = true;
+	state.monitorKnown = ddcDisplay.handle && state.monitor.mfgId[0]; //ddcInit only fills this in if the display info was available
+	times.ddcAttached = std::chrono::steady_clock::now();
+	
+	if (state.monitorKnown) ddcLog::setMonitor(state.monitor);
+	
+	//From here on every VCP transaction runs on this thread, so this is where the calibrated timing takes over
+	if (ddcDisplay.handle && state.profile.timingCalibrated)
+	{
+		activeDDCTiming = state.profile.timing;
+		logger::info("Using calibrated DDC timing for brightness: read x{}, write x{}", activeDDCTiming.readMultiplier, activeDDCTiming.writeMultiplier);
+	}
+	
+	if (ddcDisplay.handle && state.profile.capabilitiesKnown)
+	{
+		activeCapabilities = state.profile.capabilities;
+		capabilitiesActive = true;
+	}
+	
+	if (ddcDisplay.handle)
+	{
+		activePowerSequence = choosePowerSequence(state.monitorKnown ? &state.monitor : nullptr, state.profile);
+		logger::info("Using the {} power sequence", activePowerSequence.name);
+	}
+	
+	return true;
+}
+
+void attachDisplay(tHeap::TaskHeap& taskSchedule, clockState& state, const timeStruct& curTime, const persistedState* restored)
+{
+	//Only trust restored display state if it was saved while talking to this same monitor
+	if (restored && restored->monitorKnown && state.monitorKnown && restored->monitor == state.monitor)
+	{
+		state.currentBrightness = restored->brightness;
+		state.displayOn = restored->powerOn;
+		state.currentInput = restored->input;
+		state.powerStateTrusted = true;
+		
+		//Skip the brightness write entirely if the monitor is already where we want it
+		if (brightnessTarget(state, curTime) != state.currentBrightness)
+		{
+			executeTask(taskSchedule, state, curTime, scheduleNow(), tHeap::TASK::CODE::SET_BRIGHTNESS);
+		}
+		
+		logger::verbose("Restored display state: brightness {}%, power {}", state.currentBrightness, (state.displayOn ? "on" : "off"));
+	}
+	else
+	{
+		if (restored) logger::info("Saved display state does not match the attached monitor, resyncing");
+		
+		executeTask(taskSchedule, state, curTime, scheduleNow(), tHeap::TASK::CODE::SET_BRIGHTNESS);
+	}
+	
+	//Brightness was just set from the curve, so the plan only needs to pick up from here
+	if (state.dayPlan) state.dayPlan->seek(toSecondOfDay(curTime));
+	
+	state.stateDirty = true;
+	
+	return;
+}
+
+std::string handleControlCommand(const std::string& command, tHeap::TaskHeap& taskSchedule, clockState& state, const startupTimes& times)
+{
+	std::istringstream commandStream(command);
+	std::string verb;
+	std::string arg;
+	commandStream >> verb >> arg;
+	
+	std::ostringstream response;
+	
+	if (verb == "brightness")
+	{
+		if (arg == "auto")
+		{
+			//Back to the curve
+			state.brightnessOverride = -1;
+		}
+		else
+		{
+			int requested = -1;
+			std::istringstream(arg) >> requested;
+			if (requested < 0 || requested > 100) return "ERR brightness must be 0-100 or auto\n";
+			
+			state.brightnessOverride = requested;
+		}
+		
+		taskSchedule.pushTask(0, tHeap::TASK::CODE::SET_BRIGHTNESS); //Apply immediately
+		state.stateDirty = true;
+		response << "OK\n";
+	}
+	else if (verb == "power")
+	{
+		if (arg != "on" && arg != "off" && arg != "auto") return "ERR power must be on, off or auto\n";
+		
+		//Whatever was mid power on is superseded. The regular check is periodic, so it carries on regardless
+		taskSchedule.cancel(state.powerSequence);
+		
+		if (arg == "on")
+		{
+			state.powerOverride = 1;
+			taskSchedule.pushTask(0, tHeap::TASK::CODE::DISPLAY_ON_STEP1);
+		}
+		else if (arg == "off")
+		{
+			state.powerOverride = 0;
+			taskSchedule.pushTask(0, tHeap::TASK::CODE::DISPLAY_OFF);
+		}
+		else
+		{
+			//Let the regular power check decide again. Pulls the pending check forward instead of starting a second chain
+			state.powerOverride = -1;
+			taskSchedule.pushTask(0, tHeap::TASK::CODE::CHECK_SHOULD_TOGGLE_DISPLAY_PWR);
+		}
+		
+		state.stateDirty = true;
+		response << "OK\n";
+	}
+	else if (verb == "tasks")
+	{
+		//Heap order is meaningless to a person, so sort a copy
+		std::vector<tHeap::Task> pending;
+		for (size_t i = 0; i < taskSchedule.size(); ++i) pending.push_back(*taskSchedule.getTaskAt(i));
+		std::sort(pending.begin(), pending.end(), [](const tHeap::Task& lhs, const tHeap::Task& rhs) { return lhs.scheduledTime < rhs.scheduledTime; });
+		
+		long now = scheduleNow();
+		for (const tHeap::Task& task : pending)
+		{
+			response << scheduleToWall(task.scheduledTime) << " (in " << std::max(0L, task.scheduledTime - now) << "s) " << tHeap::TASK::toString(task.task);
+			if (task.period) response << " every " << task.period << "s";
+			response << "\n";
+		}
+		response << "OK " << pending.size() << " tasks\n";
+	}
+	else if (verb == "plan")
+	{
+		if (!state.dayPlan) return "ERR no day plan, the curves run off periodic tasks\n";
+		
+		for (size_t i = 0; i < state.dayPlan->size(); ++i)
+		{
+			const planStep& step = state.dayPlan->getStepAt(i);
+			unsigned int second = static_cast<unsigned int>(step.secondOfDay); //Bounded, so the formatted time provably fits
+			char stepTime[16];
+			std::snprintf(stepTime, sizeof(stepTime), "%02u:%02u:%02u", (second / 3600) % 24, (second / 60) % 60, second % 60);
+			
+			response << (i == state.dayPlan->getCursor() ? "> " : "  ") << stepTime << ' ' << PLAN_ACTION::toString(step.action);
+			if (step.action == PLAN_ACTION::CODE::SET_BRIGHTNESS) response << ' ' << static_cast<short>(step.value) << '%';
+			response << "\n";
+		}
+		response << "OK " << state.dayPlan->size() << " steps\n";
+	}
+	else if (verb == "stats")
+	{
+		auto uptime = std::chrono::duration_cast<std::chrono::seconds>(std::chrono::steady_clock::now() - times.processStart).count();
+		
+		response << "uptime " << uptime << "s\n"
+				 << "ddc " << (state.ddcAttached ? (state.display->isConnected() ? "attached" : "unavailable") : "pending") << "\n"
+				 << "brightness " << static_cast<short>(state.currentBrightness) << (state.brightnessOverride == -1 ? " auto" : " override") << "\n"
+				 << "power " << (state.displayOn ? "on" : "off") << (state.powerOverride == -1 ? " auto" : " override") << "\n"
+				 << "brightness_writes " << metrics::counters.brightnessWrites.load(std::memory_order_relaxed) << "\n";
+		
+		if (state.lightSensor) response << "ambient_lux " << state.lightSensor->getLux() << "\n";
+		else response << "ambient_lux off\n";
+		
+		if (powerStateSource) response << "ddc_reads_avoided " << powerStateSource->getAvoidedReads() << "\n";
+		else response << "ddc_reads_avoided off\n";
+		
+		response << "power_sequence " << activePowerSequence.name << "\n";
+		
+		int64_t lastWakeMs = metrics::counters.wakeLatencyLastMs.load(std::memory_order_relaxed);
+		if (lastWakeMs >= 0) response << "last_wake_ms " << lastWakeMs << (state.wake.enabled ? " polled" : " fixed") << "\n";
+		else response << "last_wake_ms none\n";
+		
+		if (state.sync)
+		{
+			response << "sync " << SYNC_ROLE::toString(state.sync->getRole());
+			if (state.sync->getRole() == SYNC_ROLE::CODE::FOLLOWER) response << (state.sync->isFollowing() ? " following " : " waiting ") << state.sync->getPublisher();
+			response << "\n"
+					 << "sync_packets " << state.sync->getPackets() << "\n"
+					 << "sync_gaps " << state.sync->getGaps() << "\n";
+			
+			int64_t lastSyncUs = state.sync->getLastLatencyMicros();
+			if (lastSyncUs >= 0) response << "last_sync_latency_us " << lastSyncUs << "\n";
+			else response << "last_sync_latency_us none\n";
+		}
+		else response << "sync off\n";
+		
+		response << "log_level " << logger::LEVEL::toString(logger::getLevel()) << "\n"
+				 << "log_dropped " << logger::getDropped() << "\n"
+				 << "pending_tasks " << taskSchedule.size() << "\n"
+				 << "OK\n";
+	}
+	else if (verb == "log")
+	{
+		logger::LEVEL::CODE level;
+		if (!logger::LEVEL::fromString(arg.c_str(), level)) return "ERR log level must be verbose, info, warning, error or off\n";
+		
+		//Debug only chatter isn't in a release build to turn on
+		logger::setLevel(level);
+		response << "OK " << logger::LEVEL::toString(logger::getLevel()) << "\n";
+	}
+	else if (verb == "help")
+	{
+		response << "brightness <0-100|auto>\n"
+				 << "power <on|off|auto>\n"
+				 << "tasks\n"
+				 << "plan\n"
+				 << "stats\n"
+				 << "log <verbose|info|warning|error|off>\n"
+				 << "OK\n";
+	}
+	else return "ERR unknown command, try help\n";
+	
+	return response.str();
+}
+
+bool loadPersistedState(StateFile& stateFile, persistedState& restored)
+{
+	if (!stateFile.isOpen() || stateFile.load(restored) != STATEFILE_ERR::CODE::SUCCESS) return false;
+	
+	//Validate against the clock. A save from the future means the clock went backwards (no RTC, NTP not synced yet), so nothing in it can be trusted
+	long now = std::chrono::duration_cast<std::chrono::seconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+	if (restored.savedAt > now)
+	{
+		logger::warning("Saved state is newer than the system clock, ignoring it");
+		return false;
+	}
+	
+	if (now - restored.savedAt > std::chrono::duration_cast<std::chrono::seconds>(STATE_MAX_AGE).count())
+	{
+		logger::info("Saved state is too old to reuse, starting fresh");
+		return false;
+	}
+	
+	logger::info("Restored state saved {} seconds ago with {} pending tasks", now - restored.savedAt, restored.taskCount);
+	
+	return true;
+}
+
+void restoreTasks(tHeap::TaskHeap& taskSchedule, const persistedState& restored)
+{
+	for (unsigned int i = 0; i < restored.taskCount; ++i)
+	{
+		tHeap::TASK::CODE task = static_cast<tHeap::TASK::CODE>(restored.tasks[i].task);
+		
+		//Came off the disk, so check it before it hits the heap. Overdue tasks just run as soon as DDC attaches
+		if (!tHeap::TASK::isValidTaskCode(task)) continue;
+		
+		taskSchedule.pushTask(wallToSchedule(restored.tasks[i].scheduledTime), task);
+	}
+	
+	return;
+}
+
+void printStartupReport(const startupTimes& times)
+{
+	//Only report once both the first frame is out and DDC is attached
+	if (times.firstFrame == std::chrono::steady_clock::time_point() || times.ddcAttached == std::chrono::steady_clock::time_point()) return;
+	
+	auto msSince = [](std::chrono::steady_clock::time_point from, std::chrono::steady_clock::time_point to)
+	{
+		return std::chrono::duration_cast<std::chrono::milliseconds>(to - from).count();
+	};
+	
+	logger::info("Startup timing:");
+	logger::info("  Framebuffer init:   {} ms", msSince(times.processStart, times.fBufReady));
+	logger::info("  Window init:        {} ms", msSince(times.fBufReady, times.windowReady));
+	logger::info("  First frame:        {} ms ({} ms after start)", msSince(times.windowReady, times.firstFrame), msSince(times.processStart, times.firstFrame));
+	
+	if (times.ddcEnumerated != std::chrono::steady_clock::time_point())
+	{
+		logger::info("  DDC enumerate:      {} ms", msSince(times.ddcStart, times.ddcEnumerated));
+	}
+	if (times.ddcOpened != std::chrono::steady_clock::time_point())
+	{
+		logger::info("  DDC open:           {} ms", msSince(times.ddcEnumerated, times.ddcOpened));
+	}
+	
+	logger::info("  DDC attached:       {} ms after start", msSince(times.processStart, times.ddcAttached));
+	
+	return;
+}
+
+timeStruct getTime()
+{
+	//Get time snapshot in seconds
+	std::chrono::system_clock::time_point timeSnap = std::chrono::system_clock::now();
+	
+	//Convert to days (lossy)
+	auto timeSnapInDays = std::chrono::time_point_cast<std::chrono::days>(timeSnap);
+	
+	//Find amount of seconds from the start of the day by taking advantage of the lossy day conversion
+	auto secondsSinceMidnight = timeSnap - timeSnapInDays;
+	
+	//Repeat lossy conversion to extract hour, then minute, then second
+	auto hour = std::chrono::duration_cast<std::chrono::hours>(secondsSinceMidnight);
+	secondsSinceMidnight -= hour;
+	auto minute = std::chrono::duration_cast<std::chrono::minutes>(secondsSinceMidnight);
+	secondsSinceMidnight -= minute;
+	auto second = std::chrono::duration_cast<std::chrono::seconds>(secondsSinceMidnight);
+	secondsSinceMidnight -= second;
+	auto millisecond = std::chrono::duration_cast<std::chrono::milliseconds>(secondsSinceMidnight);
+	
+	timeStruct curTime = { hour.count(), minute.count(), second.count(), millisecond.count() };
+	
+	//Apply timezone offset
+	curTime.hour += TIMEZONE_OFFSET;
+	if (curTime.hour < 0) curTime.hour += 24;
+	if (curTime.hour > 23 ) curTime.hour -= 24;
+	
+	logger::verbose("Time: {}:{}:{}", curTime.hour, curTime.min, curTime.sec);
+	
+	return curTime;
+}
+
+float fractionalMinute(const timeStruct& curTime)
+{
+	return curTime.min + (curTime.sec + curTime.ms / 1000.0f) / 60.0f;
+}
+
+long scheduleNow()
+{
+	//Scheduler runs on steady clock seconds, so NTP steps and RTC corrections can't bunch tasks up or stall them
+	return std::chrono::duration_cast<std::chrono::seconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+long secondsFromNow(std::chrono::seconds delay)
+{
+	return scheduleNow() + delay.count();
+}
+
+long wallNow()
+{
+	return std::chrono::duration_cast<std::chrono::seconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+}
+
+long scheduleToWall(long scheduledTime)
+{
+	//Times 0 and 1 mean "now" on either clock
+	if (scheduledTime <= 1) return scheduledTime;
+	
+	return wallNow() + (scheduledTime - scheduleNow());
+}
+
+long wallToSchedule(long wallTime)
+{
+	//Anything already overdue just runs as soon as possible
+	if (wallTime <= 1) return wallTime;
+	
+	return std::max(0L, scheduleNow() + (wallTime - wallNow()));
+}
+
+void drawClockText(const clockFace& face, const int xRes, const int yRes)
+{
+	//Calculate correct offsets to center the clock text
+	int xOffset = (xRes - MeasureText(face.timeText, TEXT_SIZE)) / 2;
+	int yOffset = (yRes - TEXT_SIZE) / 2;
+	
+	//Print the clock on the center of the screen
+	DrawText(face.timeText, xOffset, yOffset, TEXT_SIZE, face.text);
+}
+
+void formatDateLine(char* out, size_t size)
+{
+	//Same fixed offset as getTime
+	std::time_t local = std::chrono::system_clock::to_time_t(std::chrono::system_clock::now()) + TIMEZONE_OFFSET * 60 * 60;
+	std::tm date;
+	gmtime_r(&local, &date);
+	
+	if (!std::strftime(out, size, "%a %b %d", &date)) out[0] = '\0';
+	
+	return;
+}
+
+void formatNextEvent(const clockState& state, char* out, size_t size)
+{
+	out[0] = '\0';
+	if (!state.dayPlan || !state.dayPlan->size()) return;
+	
+	//Past the last step of the day, the next one is tomorrow's first
+	size_t next = state.dayPlan->getCursor();
+	if (next >= state.dayPlan->size()) next = 0;
+	
+	const planStep& step = state.dayPlan->getStepAt(next);
+	long hour = step.secondOfDay / 3600;
+	long minute = (step.secondOfDay / 60) % 60;
+	
+	switch (step.action)
+	{
+		case PLAN_ACTION::CODE::SET_BRIGHTNESS:
+			std::snprintf(out, size, "NEXT %02ld:%02ld BRIGHTNESS %u%%", hour, minute, static_cast<unsigned int>(step.value));
+			break;
+		
+		case PLAN_ACTION::CODE::POWER_ON:
+			std::snprintf(out, size, "NEXT %02ld:%02ld DISPLAY ON", hour, minute);
+			break;
+		
+		case PLAN_ACTION::CODE::POWER_OFF:
+			std::snprintf(out, size, "NEXT %02ld:%02ld DISPLAY OFF", hour, minute);
+			break;
+	}
+	
+	return;
+}
+
+uint32_t packSyncColor(Color color)
+{
+	return color.r | (color.g << 8) | (color.b << 16) | (static_cast<uint32_t>(color.a) << 24);
+}
+
+Color unpackSyncColor(uint32_t packed)
+{
+	return { static_cast<unsigned char>(packed), static_cast<unsigned char>(packed >> 8), static_cast<unsigned char>(packed >> 16), static_cast<unsigned char>(packed >> 24) };
+}
+
+void fillSyncState(clockState& state, const timeStruct& curTime, syncState& out)
+{
+	long secondOfDay = toSecondOfDay(curTime);
+	clockFace face = buildClockFace(curTime.hour, curTime.min, fractionalMinute(curTime), HOUR_LEADING_ZERO);
+	out.set(SYNC_FIELD::CODE::BACKGROUND, packSyncColor(face.background));
+	out.set(SYNC_FIELD::CODE::TEXT, packSyncColor(face.text));
+	
+	//Whatever was last written, so followers write as rarely as this clock does. Until DDC attaches that's only a placeholder, so the curve stands in
+	out.set(SYNC_FIELD::CODE::BRIGHTNESS, state.ddcAttached ? state.currentBrightness : brightnessTarget(state, curTime));
+	
+	//Where the power is headed rather than where the monitor has got to, so followers start a power on when this clock does
+	bool wantOn = state.dayPlan ? state.dayPlan->powerOnAt(secondOfDay) : state.displayOn;
+	if (state.powerOverride != -1) wantOn = state.powerOverride;
+	out.set(SYNC_FIELD::CODE::DISPLAY_ON, wantOn);
+	
+	//A forced power state means the plan's steps won't happen
+	planStep step;
+	bool planned = state.dayPlan && state.powerOverride == -1 && state.dayPlan->nextPowerStep(secondOfDay, step);
+	out.set(SYNC_FIELD::CODE::POWER_STEP_AT, planned ? step.secondOfDay : 0);
+	out.set(SYNC_FIELD::CODE::POWER_STEP, planned ? (step.action == PLAN_ACTION::CODE::POWER_ON) : SYNC_NO_STEP);
+	
+	static const uint32_t checksum = curveChecksum();
+	out.set(SYNC_FIELD::CODE::CURVE_CHECKSUM, checksum);
+	
+	return;
+}
+
+bool serviceSync(tHeap::TaskHeap& taskSchedule, clockState& state, const timeStruct& curTime)
+{
+	std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+	
+	if (state.sync->getRole() == SYNC_ROLE::CODE::PUBLISHER)
+	{
+		syncState published;
+		fillSyncState(state, curTime, published);
+		state.sync->publish(published, now);
+		
+		return false;
+	}
+	
+	uint32_t changed = state.sync->receive(now);
+	
+	//Either nothing to follow yet, or the publisher just went quiet and this clock's own curves take back over
+	if (!state.sync->isFollowing())
+	{
+		if (changed)
+		{
+			taskSchedule.pushTask(0, tHeap::TASK::CODE::SET_BRIGHTNESS);
+			if (POWEROFF_ON_ZERO_BRIGHTNESS) taskSchedule.pushTask(0, tHeap::TASK::CODE::CHECK_SHOULD_TOGGLE_DISPLAY_PWR);
+		}
+		
+		return changed;
+	}
+	
+	const syncState& synced = state.sync->getState();
+	
+	//The publisher said when its plan next changes the power. Take the step on this clock's own time rather than a packet later, or never if that packet is lost
+	long secondOfDay = toSecondOfDay(curTime);
+	long powerStepAt = synced.get(SYNC_FIELD::CODE::POWER_STEP_AT);
+	uint32_t powerStep = synced.get(SYNC_FIELD::CODE::POWER_STEP);
+	if (powerStep != SYNC_NO_STEP && secondOfDay >= powerStepAt && secondOfDay - powerStepAt < SYNC_POWER_STEP_WINDOW)
+	{
+		state.sync->applyAhead(SYNC_FIELD::CODE::POWER_STEP, SYNC_NO_STEP);
+		if (synced.get(SYNC_FIELD::CODE::DISPLAY_ON) != powerStep)
+		{
+			state.sync->applyAhead(SYNC_FIELD::CODE::DISPLAY_ON, powerStep);
+			changed |= SYNC_FIELD::bit(SYNC_FIELD::CODE::DISPLAY_ON);
+		}
+	}
+	
+	static const uint32_t checksum = curveChecksum();
+	if ((changed & SYNC_FIELD::bit(SYNC_FIELD::CODE::CURVE_CHECKSUM)) && synced.get(SYNC_FIELD::CODE::CURVE_CHECKSUM) != checksum)
+	{
+		logger::warning("Clock sync publisher has different curves. Following it anyway, this clock's own only show if it goes quiet");
+	}
+	
+	//Through the usual tasks, so overrides, power sequences and wake probes all still apply. Unique keys keep it to one of each
+	if (changed & SYNC_FIELD::bit(SYNC_FIELD::CODE::BRIGHTNESS)) taskSchedule.pushTask(0, tHeap::TASK::CODE::SET_BRIGHTNESS);
+	if (POWEROFF_ON_ZERO_BRIGHTNESS && (changed & SYNC_FIELD::bit(SYNC_FIELD::CODE::DISPLAY_ON))) taskSchedule.pushTask(0, tHeap::TASK::CODE::CHECK_SHOULD_TOGGLE_DISPLAY_PWR);
+	
+	return changed & (SYNC_FIELD::bit(SYNC_FIELD::CODE::BACKGROUND) | SYNC_FIELD::bit(SYNC_FIELD::CODE::TEXT));
+}
+
+DDCA_Display_Handle ddcInit(startupTimes* times, monitorIdentity* monitor, monitorProfile* profile)
+{
+	//Runs on its own thread at startup. Everything written to times must happen before returning
+	trace::scope initTrace(trace::EVENT::DDC_INIT);
+	
+	DDCA_Display_Identifier displayID;
+	DDCA_Display_Ref displayRef;
+	DDCA_Display_Handle displayHandle = nullptr;
+	
+	if (times) times->ddcStart = std::chrono::steady_clock::now();
+	
+	//Replaying there is no monitor to find. Any non null handle will do, ddcSetVcp and ddcGetVcp never hand it to ddcutil
+	if (ddcLog::replaying)
+	{
+		static char replayDisplay;
+		if (monitor) ddcLog::getMonitor(*monitor);
+		
+		return &replayDisplay;
+	}
+	
+	//Go straight to the bus the last monitor was found on. The EDID check below catches a different monitor on it
+	DDCA_Status result = DDCRC_NOT_FOUND;
+	monitorProfile cached;
+	if (profile && MonitorProfileStore(MONITOR_PROFILE_PATH).findLast(cached) && cached.capabilitiesKnown && cached.capabilities.i2cBus >= 0)
+	{
+		if (ddca_create_busno_display_identifier(cached.capabilities.i2cBus, &displayID) == DDCRC_OK)
+		{
+			result = ddca_get_display_ref(displayID, &displayRef);
+			ddca_free_display_identifier(displayID);
+		}
+		
+		logger::verbose("Opening cached display on I2C bus {}: {}", cached.capabilities.i2cBus, ddca_rc_name(result));
+	}
+	
+	//Identify and enumerate display
+	if (result)
+	{
+		ddca_create_dispno_display_identifier(FRAMEBUFFER_DEV + 1, &displayID); //DDC starts at 1, not 0 like device number. Add 1 to compensate
+		result = ddca_get_display_ref(displayID, &displayRef);
+		
+		if (result) 
+		{
+			//Non 0 result is an error
+			logger::error("Unable to find DDC display. DDCA Status: {}: {}", ddca_rc_name(result), ddca_rc_desc(result));
+			throw result;
+		}
+		
+		ddca_free_display_identifier(displayID); //Cleanup
+	}
+	
+	if (times) times->ddcEnumerated = std::chrono::steady_clock::now();
+	
+	//Grab the monitor identity from the enumeration data so warm restarts can check it without another DDC round trip
+	DDCA_Display_Info* displayInfo = nullptr;
+	bool profileChanged = false;
+	if (monitor && ddca_get_display_info(displayRef, &displayInfo) == DDCRC_OK)
+	{
+		std::memcpy(monitor->mfgId, displayInfo->mfg_id, sizeof(monitor->mfgId));
+		std::memcpy(monitor->modelName, displayInfo->model_name, sizeof(monitor->modelName));
+		std::memcpy(monitor->serial, displayInfo->sn, sizeof(monitor->serial));
+		monitor->productCode = displayInfo->product_code;
+		
+		//Look up anything learned about this monitor on an earlier run
+		uint64_t edid = edidHash(displayInfo->edid_bytes, sizeof(displayInfo->edid_bytes));
+		if (profile)
+		{
+			MonitorProfileStore profileStore(MONITOR_PROFILE_PATH);
+			if (!profileStore.find(edid, *profile)) *profile = monitorProfile();
+			profile->edidHash = edid;
+			
+			//Buses can be renumbered between boots. Refreshing this doesn't need a new capabilities query
+			int32_t bus = (displayInfo->path.io_mode == DDCA_IO_I2C) ? displayInfo->path.path.i2c_busno : -1;
+			profileChanged = profile->capabilitiesKnown && profile->capabilities.i2cBus != bus;
+			profile->capabilities.i2cBus = bus;
+		}
+		
+		ddca_free_display_info(displayInfo);
+	}
+	
+	//Connect to display
+	result = ddca_open_display2(displayRef, false, &displayHandle);
+	
+	if (result) 
+	{
+		//Non 0 result is an error
+		logger::error("Unable to connect to DDC display. DDCA Status: {}: {}", ddca_rc_name(result), ddca_rc_desc(result));
+		throw result;
+	}
+	
+	if (times) times->ddcOpened = std::chrono::steady_clock::now();
+	
+	//Everything below needs the EDID to file its results under
+	if (profile && profile->edidHash)
+	{
+		//First contact with this monitor. Ask what it supports once and remember the answer
+		if (!profile->capabilitiesKnown && queryCapabilities(displayHandle, profile->capabilities))
+		{
+			profile->capabilitiesKnown = 1;
+			profileChanged = true;
+		}
+		
+		//Calibration is opt in
+		if (std::getenv("SUNCLOCK_DDC_CALIBRATE"))
+		{
+			profile->timing = calibrateDDCTiming(displayHandle);
+			profile->timingCalibrated = 1;
+			profileChanged = true;
+		}
+		
+		if (profileChanged)
+		{
+			profile->updatedAt = std::chrono::duration_cast<std::chrono::seconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+			
+			MonitorProfileStore profileStore(MONITOR_PROFILE_PATH);
+			profileStore.update(*profile);
+			profileStore.save();
+		}
+	}
+	
+	return displayHandle;
+}
+
+bool queryCapabilities(DDCA_Display_Handle displayHandle, monitorCapabilities& capabilities)
+{
+	trace::scope capabilitiesTrace(trace::EVENT::DDC_READ, 0xF3); //0xF3 is the capabilities request opcode
+	
+	char* capabilityString = nullptr;
+	DDCA_Status result = ddca_get_capabilities_string(displayHandle, &capabilityString);
+	if (result)
+	{
+		logger::warning("Unable to read monitor capabilities, all VCP commands will be tried. DDCA Status: {}: {}", ddca_rc_name(result), ddca_rc_desc(result));
+		return false;
+	}
+	
+	DDCA_Capabilities* parsed = nullptr;
+	result = ddca_parse_capabilities_string(capabilityString, &parsed);
+	free(capabilityString);
+	
+	if (result)
+	{
+		logger::warning("Unable to parse monitor capabilities, all VCP commands will be tried. DDCA Status: {}: {}", ddca_rc_name(result), ddca_rc_desc(result));
+		return false;
+	}
+	
+	int32_t bus = capabilities.i2cBus;
+	capabilities = monitorCapabilities();
+	capabilities.i2cBus = bus;
+	int featureCount = parsed->vcp_code_ct;
+	
+	for (int i = 0; i < parsed->vcp_code_ct; ++i)
+	{
+		const DDCA_Cap_Vcp& feature = parsed->vcp_codes[i];
+		capabilities.vcpCodes[feature.feature_code >> 3] |= 1 << (feature.feature_code & 0x7);
+		
+		for (int j = 0; j < feature.value_ct; ++j)
+		{
+			uint8_t value = feature.values[j].value_code;
+			if (feature.feature_code == 0x60) capabilities.inputValues[value >> 3] |= 1 << (value & 0x7);
+			else if (feature.feature_code == 0xD6 && value < 8) capabilities.powerValues |= 1 << value;
+		}
+	}
+	
+	ddca_free_parsed_capabilities(parsed);
+	
+	//Brightness is the one thing the clock can't work without. A string missing it is more likely wrong than the monitor
+	if (!capabilities.supports(0x10))
+	{
+		logger::warning("Monitor capabilities don't list brightness, ignoring them");
+		return false;
+	}
+	
+	logger::info("Cached monitor capabilities: {} VCP codes", featureCount);
+	
+	return true;
+}
+
+ddcTiming calibrateDDCTiming(DDCA_Display_Handle displayHandle)
+{
+	//Runs on the DDC init thread. ddcutil sleep multipliers are per thread, so none of this leaks into normal operation
+	ddcTiming calibrated;
+	
+	logger::info("Calibrating DDC timing. Brightness may flicker by one step");
+	
+	//Baseline read at the default timing. Everything is verified against it
+	DDCA_Non_Table_Vcp_Value original;
+	ddca_set_sleep_multiplier(1.0);
+	if (ddca_get_non_table_vcp_value(displayHandle, DDC_CALIBRATION_VCP, &original) != DDCRC_OK)
+	{
+		logger::error("Unable to read brightness for DDC calibration, keeping default timing");
+		return calibrated;
+	}
+	unsigned char brightness = original.sl;
+	unsigned char alternate = (brightness > 0) ? brightness - 1 : brightness + 1;
+	
+	constexpr unsigned int stepCount = sizeof(DDC_CALIBRATION_STEPS) / sizeof(DDC_CALIBRATION_STEPS[0]);
+	unsigned int fastestRead = 0;
+	unsigned int fastestWrite = 0;
+	
+	//Reads. Every one must succeed and agree with the baseline
+	for (unsigned int step = 0; step < stepCount; ++step)
+	{
+		bool passed = true;
+		ddca_set_sleep_multiplier(DDC_CALIBRATION_STEPS[step]);
+		
+		for (unsigned int round = 0; round < DDC_CALIBRATION_ROUNDS && passed; ++round)
+		{
+			DDCA_Non_Table_Vcp_Value readBack;
+			passed = ddca_get_non_table_vcp_value(displayHandle, DDC_CALIBRATION_VCP, &readBack) == DDCRC_OK && readBack.sl == brightness;
+		}
+		
+		if (!passed) break;
+		fastestRead = step;
+	}
+	
+	//Writes. Alternate between two values and read each back at the default timing to prove it landed
+	for (unsigned int step = 0; step < stepCount; ++step)
+	{
+		bool passed = true;
+		
+		for (unsigned int round = 0; round < DDC_CALIBRATION_ROUNDS && passed; ++round)
+		{
+			unsigned char target = (round % 2) ? brightness : alternate;
+			
+			ddca_set_sleep_multiplier(DDC_CALIBRATION_STEPS[step]);
+			passed = ddca_set_non_table_vcp_value(displayHandle, DDC_CALIBRATION_VCP, 0x0, target) == DDCRC_OK;
+			
+			DDCA_Non_Table_Vcp_Value readBack;
+			ddca_set_sleep_multiplier(1.0);
+			passed = passed && ddca_get_non_table_vcp_value(displayHandle, DDC_CALIBRATION_VCP, &readBack) == DDCRC_OK && readBack.sl == target;
+		}
+		
+		if (!passed) break;
+		fastestWrite = step;
+	}
+	
+	//Put the brightness back however the last round ended
+	ddca_set_sleep_multiplier(1.0);
+	ddca_set_non_table_vcp_value(displayHandle, DDC_CALIBRATION_VCP, 0x0, brightness);
+	
+	//Back off a little from the edge. A step that passed a handful of times can still fail one night in a hundred
+	calibrated.readMultiplier = DDC_CALIBRATION_STEPS[fastestRead - std::min(fastestRead, DDC_CALIBRATION_MARGIN)];
+	calibrated.writeMultiplier = DDC_CALIBRATION_STEPS[fastestWrite - std::min(fastestWrite, DDC_CALIBRATION_MARGIN)];
+	
+	logger::info("DDC calibration done: read x{}, write x{}", calibrated.readMultiplier, calibrated.writeMultiplier);
+	
+	return calibrated;
+}
+
+void setSleepMultiplier(float multiplier)
+{
+	//Per thread in ddcutil. Only call into it when the multiplier actually changes
+	thread_local float current = 1;
+	if (multiplier == current) return;
+	
+	ddca_set_sleep_multiplier(multiplier);
+	current = multiplier;
+	
+	return;
+}
+
+template <typename Operation> DDCA_Status runWithDDCTiming(float multiplier, Operation operation)
+{
+	setSleepMultiplier(multiplier);
+	DDCA_Status result = operation();
+	if (result == DDCRC_OK || multiplier >= 1) return result;
+	
+	//Calibrated timing may have let us down. Retry once at the default, and give calibration up for this run if it keeps happening
+	setSleepMultiplier(1);
+	result = operation();
+	
+	//Failing at the default too means it wasn't the timing. Usually the monitor is asleep or still waking, which says nothing about the calibration
+	if (result != DDCRC_OK) return result;
+	
+	if (++ddcTimingFailures >= DDC_TIMING_MAX_FAILURES)
+	{
+		logger::warning("Calibrated DDC timing keeps failing, falling back to the defaults. Consider recalibrating");
+		activeDDCTiming = ddcTiming();
+	}
+	
+	return result;
+}
+
+DDCA_Status ddcSetVcp(DDCA_Display_Handle displayHandle, unsigned char vcpCode, unsigned char value)
+{
+	//Every VCP write goes through here so it can be counted
+	trace::scope ddcTrace(trace::EVENT::DDC_WRITE, vcpCode);
+	DDCA_Status result;
+	
+	//Capabilities strings are often incomplete, so something they left out is still tried. Only a refusal from the monitor itself stops it going out again
+	bool advertised = !capabilitiesActive || activeCapabilities.accepts(vcpCode, value);
+	if (!advertised && refusedTraffic.has(vcpCode, value)) return DDCRC_REPORTED_UNSUPPORTED;
+	
+	if (ddcLog::replaying)
+	{
+		int32_t status;
+		if (!ddcLog::replay(ddcLog::DIRECTION::CODE::WRITE, vcpCode, nullptr, nullptr, &status)) status = DDCRC_NOT_FOUND;
+		result = status;
+	}
+	else
+	{
+		//Calibration only measured brightness. The power and input paths in a monitor can be slower, so they keep the default timing
+		float multiplier = (vcpCode == DDC_CALIBRATION_VCP) ? activeDDCTiming.writeMultiplier : 1;
+		
+		uint64_t startNs = ddcLog::recording ? ddcLog::nowNs() : 0;
+		result = runWithDDCTiming(multiplier, [&]() { return ddca_set_non_table_vcp_value(displayHandle, vcpCode, 0x0, value); });
+		if (ddcLog::recording) ddcLog::record(ddcLog::DIRECTION::CODE::WRITE, vcpCode, value, 0, result, startNs, ddcLog::nowNs());
+	}
+	
+	if (!advertised && (result == DDCRC_REPORTED_UNSUPPORTED || result == DDCRC_DETERMINED_UNSUPPORTED))
+	{
+		logger::warning("Monitor refused writing {} to VCP code {}, which its capabilities left out. Not sending it again", value, vcpCode);
+		refusedTraffic.add(vcpCode, value);
+	}
+	
+	metrics::ddcTransaction(metrics::DDC_OP::WRITE, result != DDCRC_OK);
+	
+	return result;
+}
+
+DDCA_Status ddcGetVcp(DDCA_Display_Handle displayHandle, unsigned char vcpCode, DDCA_Non_Table_Vcp_Value* value)
+{
+	//Every VCP read goes through here so it can be counted
+	trace::scope ddcTrace(trace::EVENT::DDC_READ, vcpCode);
+	DDCA_Status result;
+	
+	//Same as writes. Tried until the monitor itself refuses it
+	bool advertised = !capabilitiesActive || activeCapabilities.supports(vcpCode);
+	if (!advertised && refusedTraffic.has(vcpCode, -1))
+	{
+		*value = {};
+		return DDCRC_REPORTED_UNSUPPORTED;
+	}
+	
+	if (ddcLog::replaying)
+	{
+		uint16_t current = 0;
+		uint16_t max = 0;
+		int32_t status;
+		if (!ddcLog::replay(ddcLog::DIRECTION::CODE::READ, vcpCode, &current, &max, &status)) status = DDCRC_NOT_FOUND;
+		
+		value->mh = max >> 8;
+		value->ml = max & 0xFF;
+		value->sh = current >> 8;
+		value->sl = current & 0xFF;
+		result = status;
+	}
+	else
+	{
+		float multiplier = (vcpCode == DDC_CALIBRATION_VCP) ? activeDDCTiming.readMultiplier : 1; //Same as writes
+		
+		uint64_t startNs = ddcLog::recording ? ddcLog::nowNs() : 0;
+		result = runWithDDCTiming(multiplier, [&]() { return ddca_get_non_table_vcp_value(displayHandle, vcpCode, value); });
+		if (ddcLog::recording) ddcLog::record(ddcLog::DIRECTION::CODE::READ, vcpCode, (value->sh << 8) | value->sl, (value->mh << 8) | value->ml, result, startNs, ddcLog::nowNs());
+	}
+	
+	if (!advertised && (result == DDCRC_REPORTED_UNSUPPORTED || result == DDCRC_DETERMINED_UNSUPPORTED))
+	{
+		logger::warning("Monitor refused reading VCP code {}, which its capabilities left out. Not asking again", vcpCode);
+		refusedTraffic.add(vcpCode, -1);
+	}
+	
+	metrics::ddcTransaction(metrics::DDC_OP::READ, result != DDCRC_OK);
+	
+	return result;
+}
+
+DDCA_Status setDDCBrightness(DDCA_Display_Handle displayHandle, unsigned char brightness)
+{
+	//Check if we are connected to a display
+	if (!displayHandle) return DDCRC_INVALID_DISPLAY;
+	
+	//Enforce bounds on brightness
+	if (brightness > 100) brightness = 100;
+	
+	//Use DDC to command brightness level. 0x10 code is brightness.	
+	DDCA_Status result = ddcSetVcp(displayHandle, 0x10, brightness);
+	
+	logger::verbose("Set brightness to {} with status code {}: {}: {}", brightness, result, ddca_rc_name(result), ddca_rc_desc(result));
+	
+	return result;
+}
+
+DDCA_Status setDisplayInput(DDCA_Display_Handle displayHandle, unsigned char vcpInputCode)
+{
+	if (!displayHandle) return DDCRC_INVALID_DISPLAY;
+	
+	//Use DDC to command display input
+	DDCA_Status inputCmdResult = ddcSetVcp(displayHandle, 0x60, vcpInputCode); //Input command
+	
+	logger::verbose("Attempted to set display input to {}. Got status code {}: {}: {}", VCP_INPUT_CODE, inputCmdResult, ddca_rc_name(inputCmdResult), ddca_rc_desc(inputCmdResult));
+	
+	return inputCmdResult;
+}
+
+DDCA_Status toggleDisplayPower(DDCA_Display_Handle displayHandle)
+{
+	//Check if we are connected to a display
+	if (!displayHandle) return DDCRC_INVALID_DISPLAY;
+	
+	//Use DDC to command power toggle
+	DDCA_Status powerCmdResult = ddcSetVcp(displayHandle, 0xD6, 0x5); //Power command
+	
+	logger::verbose("Attempted to toggle display power. Got status code {}: {}: {}", powerCmdResult, ddca_rc_name(powerCmdResult), ddca_rc_desc(powerCmdResult));
+	
+	return powerCmdResult;
+}
+
+DDCA_Status displayPowerOff(DDCA_Display_Handle displayHandle)
+{
+	//Check if we are connected to a display
+	if (!displayHandle) return DDCRC_INVALID_DISPLAY;
+	
+	//Check if display is already off
+	if (!isDisplayOn(displayHandle))
+	{
+		//It's off. Just return OK
+		
+		logger::verbose("Requested display to power off but it was already off");
+		
+		return DDCRC_OK;
+	}
+	
+	//Send DDC command to turn off the display
+	DDCA_Status result = ddcSetVcp(displayHandle, 0xD6, activePowerSequence.offValue); //Power command
+	
+	logger::verbose("Requested display to power off. Got status code: {}: {}", ddca_rc_name(result), ddca_rc_desc(result));
+	
+	return result;
+
+}
+
+DDCA_Status displayPowerOn(DDCA_Display_Handle displayHandle)
+{
+	//Check if we are connected to a display
+	if (!displayHandle) return DDCRC_INVALID_DISPLAY;
+	
+	//Check if display is already on
+	if (isDisplayOn(displayHandle))
+	{
+		//It's on. Just return OK
+		
+		logger::verbose("Requested display to power on but it was already on");
+		
+		return DDCRC_OK;
+	}
+	
+	//Send DDC command to turn on the display
+	DDCA_Status result = ddcSetVcp(displayHandle, 0xD6, activePowerSequence.onValue); //Power command
+	
+	logger::verbose("Requested display to power on. Got status code: {}: {}", ddca_rc_name(result), ddca_rc_desc(result));
+	
+	return result;
+}
+
+bool isDisplayOn(DDCA_Display_Handle displayHandle)
+{
+	//Check if we are connected to a display
+	if (!displayHandle) return true; //Assume display is on if we cannot talk to it
+	
+	if (!powerStateSource) return isDisplayOnDDC(displayHandle);
+	
+	//The connector is a pread or two. DDC is one or two I2C reads at around 50 ms each
+	POWER_STATE::CODE connectorState = powerStateSource->read();
+	if (connectorState != POWER_STATE::CODE::UNKNOWN && powerStateSource->canSkipDDC())
+	{
+		powerStateSource->countAvoided(connectorState == POWER_STATE::CODE::ON ? 2 : 1); //What isDisplayOnDDC would have read
+		return connectorState == POWER_STATE::CODE::ON;
+	}
+	
+	//Not trusted yet, or due for a cross check
+	bool displayOn = isDisplayOnDDC(displayHandle);
+	powerStateSource->crossCheck(connectorState, displayOn);
+	
+	return displayOn;
+}
+
+bool isDisplayOnDDC(DDCA_Display_Handle displayHandle)
+{
+	//Use DDC command to request power mode (code 0xD6)
+	DDCA_Non_Table_Vcp_Value readPowerValueStruct;
+	DDCA_Status powerStatusResult = ddcGetVcp(displayHandle, 0xD6, &readPowerValueStruct);
+	unsigned char readPowerValue = readPowerValueStruct.sl; //Only need the low byte
+	
+	logger::verbose("Requested display power status. Got state code {} with status code: {}: {}", readPowerValue, ddca_rc_name(powerStatusResult), ddca_rc_desc(powerStatusResult));
+	
+	//0x5 is off however the monitor was powered down. A monitor on the direct sequence reports anything other than its on value as some kind of off
+	bool poweredDown = readPowerValue == 0x5;
+	if (!powerStatusResult && !activePowerSequence.wakeInput) poweredDown = readPowerValue != activePowerSequence.onValue;
+	
+	//Use DDC command to request the current monitor input if the monitor is on. This is because it allows us to determine if the monitor is soft on or fully on
+	if (!poweredDown)
+	{
+		DDCA_Non_Table_Vcp_Value readInputValueStruct;
+		DDCA_Status inputStatusResult = ddcGetVcp(displayHandle, 0x60, &readInputValueStruct);
+		unsigned char readInputValue = readInputValueStruct.sl; //Only need the low byte
+		
+		logger::verbose("Requested display input status. Got input code {} with status code: {}: {}", readInputValue, ddca_rc_name(inputStatusResult), ddca_rc_desc(inputStatusResult));
+		
+		if (inputStatusResult) return true; //If we got an error, assume the monitor is on to prevent unstable state
+		
+		return readInputValue; //Any non-zero number is a valid input. Monitor gives 0 when soft-on, which we are considering off.
+	}
+	
+	return false; //Monitor must be off if we got here
+}
+
+bool isMonitorReady(DDCA_Display_Handle displayHandle, WAKE_PROBE::CODE probe)
+{
+	if (!displayHandle) return false;
+	
+	//An error just means not yet. Monitors busy waking up often don't answer at all
+	DDCA_Non_Table_Vcp_Value readValue;
+	if (probe == WAKE_PROBE::CODE::INPUT_SELECTED) return ddcGetVcp(displayHandle, 0x60, &readValue) == DDCRC_OK && readValue.sl == VCP_INPUT_CODE;
+	if (probe == WAKE_PROBE::CODE::POWERED_ON) return ddcGetVcp(displayHandle, 0xD6, &readValue) == DDCRC_OK && readValue.sl == 0x01;
+	
+	return false;
+}
+
+void ddcDeinit(DDCA_Display_Handle displayHandle)
+{
+	//A replay handle never came from ddcutil
+	if (ddcLog::replaying) return;
+	
+	ddca_close_display(displayHandle);
+	
+	return;
+}
+
+bool DDCDisplay::isConnected()
+{
+	return this->handle;
+}
+
+bool DDCDisplay::setBrightness(unsigned char brightness)
+{
+	return setDDCBrightness(this->handle, brightness) == DDCRC_OK;
+}
+
+bool DDCDisplay::setInput(unsigned char vcpInputCode)
+{
+	return setDisplayInput(this->handle, vcpInputCode) == DDCRC_OK;
+}
+
+bool DDCDisplay::togglePower()
+{
+	return toggleDisplayPower(this->handle) == DDCRC_OK;
+}
+
+bool DDCDisplay::powerOn()
+{
+	return displayPowerOn(this->handle) == DDCRC_OK;
+}
+
+bool DDCDisplay::powerOff()
+{
+	return displayPowerOff(this->handle) == DDCRC_OK;
+}
+
+bool DDCDisplay::isOn()
+{
+	return isDisplayOn(this->handle);
+}
+
+bool DDCDisplay::isOnDDC()
+{
+	return isDisplayOnDDC(this->handle);
+}
+
+bool DDCDisplay::isReady(WAKE_PROBE::CODE probe)
+{
+	return isMonitorReady(this->handle, probe);
+}
+
+#endif
+
+
+
+
+
+
+
+
+
+
+
+
+
+
+
+
+
+
+
+
+
+
+
+
+
+
+
+
+
+
+
+
+
+
+
+
+
+
+
+
+
+
+
+
+
+
+
+
+
+
+
+
+
+
+
+
+
+
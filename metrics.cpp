@@ -0,0 +1,272 @@
+/******************************************************************************
+/ Pi 4 Sunrise Clock App Metrics Implementation - lopezk38 2025
+/
+/*****************************************************************************/
+
+/******************************************************************************
+/ Dependencies, namespacing
+/*****************************************************************************/
+
+#include <unistd.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <poll.h>
+#include <cerrno>
+#include <cstring>
+#include <cstdio>
+#include <sstream>
+
+#include "metrics.h"
+#include "logger.h"
+
+metrics::registry metrics::counters;
+
+
+/******************************************************************************
+/ Exposition
+/*****************************************************************************/
+
+static long readResidentBytes()
+{
+	//Second field of statm is resident pages
+	FILE* statm = std::fopen("/proc/self/statm", "r");
+	if (!statm) return -1;
+	
+	long totalPages = 0;
+	long residentPages = 0;
+	int matched = std::fscanf(statm, "%ld %ld", &totalPages, &residentPages);
+	std::fclose(statm);
+	
+	if (matched != 2) return -1;
+	
+	return residentPages * sysconf(_SC_PAGESIZE);
+}
+
+std::string metrics::exposition()
+{
+	std::ostringstream out;
+	
+	out << "# HELP sunclock_frames_rendered_total Frames drawn by the render loop.\n"
+		<< "# TYPE sunclock_frames_rendered_total counter\n"
+		<< "sunclock_frames_rendered_total " << counters.framesRendered.load(std::memory_order_relaxed) << "\n";
+	
+	out << "# HELP sunclock_frames_skipped_total Frame slots missed because a frame overran its budget.\n"
+		<< "# TYPE sunclock_frames_skipped_total counter\n"
+		<< "sunclock_frames_skipped_total " << counters.framesSkipped.load(std::memory_order_relaxed) << "\n";
+	
+	out << "# HELP sunclock_tasks_dispatched_total Scheduler tasks executed, by task code.\n"
+		<< "# TYPE sunclock_tasks_dispatched_total counter\n";
+	for (unsigned int i = 0; i < tHeap::TASK::CODE_COUNT; ++i)
+	{
+		//Drop the TASK::CODE:: prefix for the label
+		std::string name = tHeap::TASK::toString(static_cast<tHeap::TASK::CODE>(i));
+		name.erase(0, name.rfind(':') + 1);
+		
+		out << "sunclock_tasks_dispatched_total{task=\"" << name << "\"} " << counters.tasksDispatched[i].load(std::memory_order_relaxed) << "\n";
+	}
+	
+	out << "# HELP sunclock_task_lateness_seconds How long after its scheduled time each task actually ran.\n"
+		<< "# TYPE sunclock_task_lateness_seconds histogram\n";
+	uint64_t cumulative = 0;
+	for (unsigned int i = 0; i < LATENESS_BUCKET_COUNT; ++i)
+	{
+		cumulative += counters.latenessBuckets[i].load(std::memory_order_relaxed);
+		
+		out << "sunclock_task_lateness_seconds_bucket{le=\"";
+		if (i < LATENESS_BUCKET_COUNT - 1) out << LATENESS_BUCKETS_MS[i] / 1000.0;
+		else out << "+Inf";
+		out << "\"} " << cumulative << "\n";
+	}
+	out << "sunclock_task_lateness_seconds_sum " << counters.latenessSumMs.load(std::memory_order_relaxed) / 1000.0 << "\n"
+		<< "sunclock_task_lateness_seconds_count " << cumulative << "\n";
+	
+	static constexpr const char* opNames[DDC_OP::COUNT] = { "read", "write" };
+	
+	out << "# HELP sunclock_ddc_transactions_total DDC/CI VCP transactions attempted.\n"
+		<< "# TYPE sunclock_ddc_transactions_total counter\n";
+	for (unsigned int i = 0; i < DDC_OP::COUNT; ++i)
+	{
+		out << "sunclock_ddc_transactions_total{op=\"" << opNames[i] << "\"} " << counters.ddcTransactions[i].load(std::memory_order_relaxed) << "\n";
+	}
+	
+	out << "# HELP sunclock_ddc_failures_total DDC/CI VCP transactions that returned an error.\n"
+		<< "# TYPE sunclock_ddc_failures_total counter\n";
+	for (unsigned int i = 0; i < DDC_OP::COUNT; ++i)
+	{
+		out << "sunclock_ddc_failures_total{op=\"" << opNames[i] << "\"} " << counters.ddcFailures[i].load(std::memory_order_relaxed) << "\n";
+	}
+	
+	out << "# HELP sunclock_brightness_percent Last brightness commanded over DDC. -1 until the first write.\n"
+		<< "# TYPE sunclock_brightness_percent gauge\n"
+		<< "sunclock_brightness_percent " << counters.brightness.load(std::memory_order_relaxed) << "\n";
+	
+	out << "# HELP sunclock_brightness_writes_total Brightness writes sent over DDC.\n"
+		<< "# TYPE sunclock_brightness_writes_total counter\n"
+		<< "sunclock_brightness_writes_total " << counters.brightnessWrites.load(std::memory_order_relaxed) << "\n";
+	
+	out << "# HELP sunclock_ddc_reads_avoided_total Power state DDC reads answered by the DRM connector instead.\n"
+		<< "# TYPE sunclock_ddc_reads_avoided_total counter\n"
+		<< "sunclock_ddc_reads_avoided_total " << counters.ddcReadsAvoided.load(std::memory_order_relaxed) << "\n";
+	
+	out << "# HELP sunclock_wake_latency_seconds Time from starting a display power on to its first brightness write.\n"
+		<< "# TYPE sunclock_wake_latency_seconds summary\n"
+		<< "sunclock_wake_latency_seconds_sum " << counters.wakeLatencySumMs.load(std::memory_order_relaxed) / 1000.0 << "\n"
+		<< "sunclock_wake_latency_seconds_count " << counters.wakes.load(std::memory_order_relaxed) << "\n";
+	
+	int64_t lastWakeMs = counters.wakeLatencyLastMs.load(std::memory_order_relaxed);
+	out << "# HELP sunclock_last_wake_latency_seconds Latency of the most recent display power on. -1 until the first one.\n"
+		<< "# TYPE sunclock_last_wake_latency_seconds gauge\n"
+		<< "sunclock_last_wake_latency_seconds " << (lastWakeMs < 0 ? -1.0 : lastWakeMs / 1000.0) << "\n";
+	
+	out << "# HELP sunclock_ambient_lux Filtered ambient light sensor reading. -1 without a sensor.\n"
+		<< "# TYPE sunclock_ambient_lux gauge\n"
+		<< "sunclock_ambient_lux " << counters.ambientLux.load(std::memory_order_relaxed) << "\n";
+	
+	out << "# HELP sunclock_display_power_on 1 if the display was last commanded on, 0 if off, -1 if unknown.\n"
+		<< "# TYPE sunclock_display_power_on gauge\n"
+		<< "sunclock_display_power_on " << counters.powerOn.load(std::memory_order_relaxed) << "\n";
+	
+	out << "# HELP sunclock_sky_blend_seconds Frames that crossfaded the sky photos, and the time spent drawing them.\n"
+		<< "# TYPE sunclock_sky_blend_seconds summary\n"
+		<< "sunclock_sky_blend_seconds_sum " << counters.skyBlendSumUs.load(std::memory_order_relaxed) / 1000000.0 << "\n"
+		<< "sunclock_sky_blend_seconds_count " << counters.skyBlends.load(std::memory_order_relaxed) << "\n";
+	
+	int64_t lastBlendUs = counters.skyBlendLastUs.load(std::memory_order_relaxed);
+	out << "# HELP sunclock_last_sky_blend_seconds Time to draw the most recent sky crossfade. -1 until the first one.\n"
+		<< "# TYPE sunclock_last_sky_blend_seconds gauge\n"
+		<< "sunclock_last_sky_blend_seconds " << (lastBlendUs < 0 ? -1.0 : lastBlendUs / 1000000.0) << "\n";
+	
+	out << "# HELP sunclock_sync_packets_total Clock sync packets sent by a publisher or taken in by a follower.\n"
+		<< "# TYPE sunclock_sync_packets_total counter\n"
+		<< "sunclock_sync_packets_total " << counters.syncPackets.load(std::memory_order_relaxed) << "\n";
+	
+	out << "# HELP sunclock_sync_bytes_total Bytes of those packets.\n"
+		<< "# TYPE sunclock_sync_bytes_total counter\n"
+		<< "sunclock_sync_bytes_total " << counters.syncBytes.load(std::memory_order_relaxed) << "\n";
+	
+	out << "# HELP sunclock_sync_gaps_total Clock sync packets a follower never saw.\n"
+		<< "# TYPE sunclock_sync_gaps_total counter\n"
+		<< "sunclock_sync_gaps_total " << counters.syncGaps.load(std::memory_order_relaxed) << "\n";
+	
+	out << "# HELP sunclock_sync_latency_seconds Time from a publisher sending a packet to a follower applying it.\n"
+		<< "# TYPE sunclock_sync_latency_seconds summary\n"
+		<< "sunclock_sync_latency_seconds_sum " << counters.syncLatencySumUs.load(std::memory_order_relaxed) / 1000000.0 << "\n"
+		<< "sunclock_sync_latency_seconds_count " << counters.syncLatencies.load(std::memory_order_relaxed) << "\n";
+	
+	int64_t lastSyncUs = counters.syncLatencyLastUs.load(std::memory_order_relaxed);
+	out << "# HELP sunclock_last_sync_latency_seconds Latency of the most recent clock sync packet. -1 until the first one.\n"
+		<< "# TYPE sunclock_last_sync_latency_seconds gauge\n"
+		<< "sunclock_last_sync_latency_seconds " << (lastSyncUs < 0 ? -1.0 : lastSyncUs / 1000000.0) << "\n";
+	
+	out << "# HELP sunclock_log_dropped_total Log messages dropped because the log ring was full.\n"
+		<< "# TYPE sunclock_log_dropped_total counter\n"
+		<< "sunclock_log_dropped_total " << logger::getDropped() << "\n";
+	
+	out << "# HELP process_resident_memory_bytes Resident memory size in bytes.\n"
+		<< "# TYPE process_resident_memory_bytes gauge\n"
+		<< "process_resident_memory_bytes " << readResidentBytes() << "\n";
+	
+	return out.str();
+}
+
+
+/******************************************************************************
+/ Server implementation
+/*****************************************************************************/
+
+metrics::Server::Server(unsigned short port): port(port)
+{
+	//Metrics are optional. The clock keeps running without them
+	if (openSocket() != METRICS_ERR::CODE::SUCCESS)
+	{
+		errorState = true;
+		logger::warning("Metrics endpoint is unavailable");
+		return;
+	}
+	
+	serverThread = std::thread(&Server::serve, this);
+	
+	return;
+}
+
+metrics::Server::~Server()
+{
+	this->stopRequested = true;
+	if (this->serverThread.joinable()) this->serverThread.join();
+	
+	if (this->listenDescriptor != -1) close(this->listenDescriptor);
+	
+	return;
+}
+
+bool metrics::Server::isOpen()
+{
+	return !this->errorState;
+}
+
+METRICS_ERR::CODE metrics::Server::openSocket()
+{
+	this->listenDescriptor = socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+	if (this->listenDescriptor == -1)
+	{
+		logger::error("Failed to create metrics socket");
+		return METRICS_ERR::CODE::OPEN_FAIL;
+	}
+	
+	int reuse = 1;
+	setsockopt(this->listenDescriptor, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+	
+	//Loopback only. Scrapers on the box (or an ssh tunnel) can reach it, nothing else can
+	sockaddr_in address = {};
+	address.sin_family = AF_INET;
+	address.sin_port = htons(this->port);
+	address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+	
+	if (bind(this->listenDescriptor, reinterpret_cast<sockaddr*>(&address), sizeof(address)) || listen(this->listenDescriptor, 4))
+	{
+		logger::error("Failed to bind metrics socket on port {}: {}", this->port, std::strerror(errno));
+		return METRICS_ERR::CODE::BIND_FAIL;
+	}
+	
+	logger::verbose("Serving metrics on http://127.0.0.1:{}/metrics", this->port);
+	
+	return METRICS_ERR::CODE::SUCCESS;
+}
+
+void metrics::Server::serve()
+{
+	while (!this->stopRequested)
+	{
+		//Wake up regularly to notice shutdown
+		pollfd listenPoll = { this->listenDescriptor, POLLIN, 0 };
+		if (poll(&listenPoll, 1, 250) <= 0) continue;
+		
+		int descriptor = accept4(this->listenDescriptor, nullptr, nullptr, SOCK_CLOEXEC);
+		if (descriptor == -1) continue;
+		
+		//Don't let a stuck scraper wedge this thread
+		timeval timeout = { 1, 0 };
+		setsockopt(descriptor, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+		setsockopt(descriptor, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout));
+		
+		//Every path serves the metrics, so the request itself only needs draining
+		char request[1024];
+		recv(descriptor, request, sizeof(request), 0);
+		
+		std::string body = exposition();
+		std::string response = "HTTP/1.0 200 OK\r\nContent-Type: text/plain; version=0.0.4\r\nContent-Length: " + std::to_string(body.size()) + "\r\nConnection: close\r\n\r\n" + body;
+		
+		size_t sentTotal = 0;
+		while (sentTotal < response.size())
+		{
+			ssize_t sent = send(descriptor, response.data() + sentTotal, response.size() - sentTotal, MSG_NOSIGNAL);
+			if (sent <= 0) break;
+			sentTotal += sent;
+		}
+		
+		close(descriptor);
+	}
+	
+	return;
+}
@@ -0,0 +1,199 @@
+/******************************************************************************
+/ Pi 4 Sunrise Clock App Metrics Spec - lopezk38 2025
+/
+/*****************************************************************************/
+
+#ifndef SUNCLOCK_APP_METRICS
+#define SUNCLOCK_APP_METRICS
+
+/******************************************************************************
+/ Dependencies, namespacing
+/*****************************************************************************/
+
+#include <atomic>
+#include <thread>
+#include <string>
+#include <cstdint>
+
+#include "taskHeap.h"
+#include "errorcodes.h"
+
+namespace metrics {
+
+
+/******************************************************************************
+/ Counters
+/*****************************************************************************/
+
+//Upper bounds of the scheduling lateness histogram, in milliseconds. The last bucket is +Inf
+constexpr uint64_t LATENESS_BUCKETS_MS[] = { 10, 100, 500, 1000, 2000, 5000, 30000, 60000 };
+constexpr unsigned int LATENESS_BUCKET_COUNT = sizeof(LATENESS_BUCKETS_MS) / sizeof(LATENESS_BUCKETS_MS[0]) + 1;
+
+namespace DDC_OP
+{
+	enum CODE
+	{
+		READ,
+		WRITE,
+		COUNT
+	};
+}
+
+//Everything here is only ever touched with relaxed atomics. The render thread never waits on a scrape
+struct registry
+{
+	std::atomic<uint64_t> framesRendered{0};
+	std::atomic<uint64_t> framesSkipped{0};
+	
+	std::atomic<uint64_t> tasksDispatched[tHeap::TASK::CODE_COUNT] = {};
+	std::atomic<uint64_t> latenessBuckets[LATENESS_BUCKET_COUNT] = {};
+	std::atomic<uint64_t> latenessSumMs{0};
+	
+	std::atomic<uint64_t> ddcTransactions[DDC_OP::COUNT] = {};
+	std::atomic<uint64_t> ddcFailures[DDC_OP::COUNT] = {};
+	
+	std::atomic<int> brightness{-1};
+	std::atomic<uint64_t> brightnessWrites{0};
+	std::atomic<uint64_t> ddcReadsAvoided{0};
+	std::atomic<int> powerOn{-1};
+	
+	std::atomic<uint64_t> wakes{0};
+	std::atomic<uint64_t> wakeLatencySumMs{0};
+	std::atomic<int64_t> wakeLatencyLastMs{-1};
+	
+	std::atomic<double> ambientLux{-1};
+	
+	std::atomic<uint64_t> skyBlends{0};
+	std::atomic<uint64_t> skyBlendSumUs{0};
+	std::atomic<int64_t> skyBlendLastUs{-1};
+	
+	std::atomic<uint64_t> syncPackets{0}; //Sent by a publisher, taken in by a follower
+	std::atomic<uint64_t> syncBytes{0};
+	std::atomic<uint64_t> syncGaps{0};
+	std::atomic<uint64_t> syncLatencies{0}; //Followers only
+	std::atomic<uint64_t> syncLatencySumUs{0};
+	std::atomic<int64_t> syncLatencyLastUs{-1};
+};
+
+extern registry counters;
+
+
+/******************************************************************************
+/ Hot path helpers
+/*****************************************************************************/
+
+inline void frameRendered()
+{
+	counters.framesRendered.fetch_add(1, std::memory_order_relaxed);
+}
+
+inline void framesSkipped(uint64_t count)
+{
+	counters.framesSkipped.fetch_add(count, std::memory_order_relaxed);
+}
+
+inline void taskDispatched(tHeap::TASK::CODE task, long latenessMs)
+{
+	if (tHeap::TASK::isValidTaskCode(task)) counters.tasksDispatched[task].fetch_add(1, std::memory_order_relaxed);
+	
+	//Tasks scheduled for time 0 are "run now", and early tasks are not late
+	if (latenessMs < 0) latenessMs = 0;
+	
+	unsigned int bucket = 0;
+	while (bucket < LATENESS_BUCKET_COUNT - 1 && static_cast<uint64_t>(latenessMs) > LATENESS_BUCKETS_MS[bucket]) ++bucket;
+	
+	counters.latenessBuckets[bucket].fetch_add(1, std::memory_order_relaxed);
+	counters.latenessSumMs.fetch_add(latenessMs, std::memory_order_relaxed);
+}
+
+inline void ddcTransaction(DDC_OP::CODE op, bool failed)
+{
+	counters.ddcTransactions[op].fetch_add(1, std::memory_order_relaxed);
+	if (failed) counters.ddcFailures[op].fetch_add(1, std::memory_order_relaxed);
+}
+
+inline void setBrightness(int brightness)
+{
+	counters.brightness.store(brightness, std::memory_order_relaxed);
+	counters.brightnessWrites.fetch_add(1, std::memory_order_relaxed);
+}
+
+inline void ddcReadsAvoided(uint64_t count)
+{
+	counters.ddcReadsAvoided.fetch_add(count, std::memory_order_relaxed);
+}
+
+inline void setPowerOn(bool powerOn)
+{
+	counters.powerOn.store(powerOn, std::memory_order_relaxed);
+}
+
+inline void displayWoke(uint64_t latencyMs)
+{
+	counters.wakes.fetch_add(1, std::memory_order_relaxed);
+	counters.wakeLatencySumMs.fetch_add(latencyMs, std::memory_order_relaxed);
+	counters.wakeLatencyLastMs.store(latencyMs, std::memory_order_relaxed);
+}
+
+inline void setAmbientLux(double lux)
+{
+	counters.ambientLux.store(lux, std::memory_order_relaxed);
+}
+
+inline void skyBlended(uint64_t micros)
+{
+	counters.skyBlends.fetch_add(1, std::memory_order_relaxed);
+	counters.skyBlendSumUs.fetch_add(micros, std::memory_order_relaxed);
+	counters.skyBlendLastUs.store(micros, std::memory_order_relaxed);
+}
+
+inline void syncSent(uint64_t bytes)
+{
+	counters.syncPackets.fetch_add(1, std::memory_order_relaxed);
+	counters.syncBytes.fetch_add(bytes, std::memory_order_relaxed);
+}
+
+inline void syncReceived(uint64_t bytes, uint64_t latencyMicros, uint64_t missed)
+{
+	counters.syncPackets.fetch_add(1, std::memory_order_relaxed);
+	counters.syncBytes.fetch_add(bytes, std::memory_order_relaxed);
+	counters.syncGaps.fetch_add(missed, std::memory_order_relaxed);
+	counters.syncLatencies.fetch_add(1, std::memory_order_relaxed);
+	counters.syncLatencySumUs.fetch_add(latencyMicros, std::memory_order_relaxed);
+	counters.syncLatencyLastUs.store(latencyMicros, std::memory_order_relaxed);
+}
+
+std::string exposition(); //Prometheus text format
+
+
+/******************************************************************************
+/ Scrape server
+/*****************************************************************************/
+
+//Serves exposition() over plain HTTP on loopback from its own thread, so building a scrape can never hold up a frame
+class Server
+{
+
+private:
+
+	const unsigned short port;
+	int listenDescriptor = -1;
+	
+	std::thread serverThread;
+	std::atomic<bool> stopRequested{false};
+	
+	bool errorState = false;
+	
+	METRICS_ERR::CODE openSocket();
+	void serve();
+	
+public:
+
+	Server(unsigned short port);
+	~Server();
+	
+	bool isOpen();
+};
+}
+
+#endif
@@ -0,0 +1,168 @@
+/******************************************************************************
+/ Pi 4 Sunrise Clock App Monitor Profile Store Implementation - lopezk38 2025
+/
+/*****************************************************************************/
+
+/******************************************************************************
+/ Dependencies, namespacing
+/*****************************************************************************/
+
+#include <unistd.h>
+#include <fcntl.h>
+#include <cerrno>
+#include <cstdio>
+#include <cstddef>
+
+#include "monitorProfile.h"
+#include "logger.h"
+
+
+/******************************************************************************
+/ Helpers
+/*****************************************************************************/
+
+//write can stop short, so keep going until it's all out or it fails. Same as skySet's
+static bool writeAll(int descriptor, const uint8_t* data, size_t bytes)
+{
+	while (bytes)
+	{
+		ssize_t written = write(descriptor, data, bytes);
+		if (written <= 0) return false;
+		
+		data += written;
+		bytes -= written;
+	}
+	
+	return true;
+}
+
+
+/******************************************************************************
+/ Class implementation
+/*****************************************************************************/
+
+MonitorProfileStore::MonitorProfileStore(const std::string& path): path(path)
+{
+	//A missing or bad store just means nothing has been learned yet
+	MONPROFILE_ERR::CODE result = load();
+	if (result != MONPROFILE_ERR::CODE::SUCCESS)
+	{
+		if (result != MONPROFILE_ERR::CODE::NOT_FOUND) logger::warning("Monitor profile store {} is unreadable, starting it over", this->path);
+		
+		this->contents = {};
+	}
+	
+	return;
+}
+
+MONPROFILE_ERR::CODE MonitorProfileStore::load()
+{
+	int descriptor = open(this->path.c_str(), O_RDONLY | O_CLOEXEC);
+	if (descriptor == -1) return (errno == ENOENT) ? MONPROFILE_ERR::CODE::NOT_FOUND : MONPROFILE_ERR::CODE::OPEN_FAIL;
+	
+	ssize_t got = read(descriptor, &this->contents, sizeof(this->contents));
+	close(descriptor);
+	
+	if (got != sizeof(this->contents)) return MONPROFILE_ERR::CODE::RD_FAIL;
+	
+	//Anything off means a different layout or a torn file. Either way it can't be trusted
+	if (this->contents.magic != MONPROFILE_MAGIC || this->contents.version != MONPROFILE_VERSION) return MONPROFILE_ERR::CODE::BAD_FILE;
+	if (this->contents.count > MONPROFILE_MAX_MONITORS || this->contents.checksum != checksum(this->contents)) return MONPROFILE_ERR::CODE::BAD_FILE;
+	
+	return MONPROFILE_ERR::CODE::SUCCESS;
+}
+
+uint64_t MonitorProfileStore::checksum(const profileFile& file)
+{
+	//FNV-1a over everything before the checksum field
+	const unsigned char* bytes = reinterpret_cast<const unsigned char*>(&file);
+	uint64_t hash = 0xCBF29CE484222325;
+	
+	for (size_t i = 0; i < offsetof(profileFile, checksum); ++i)
+	{
+		hash ^= bytes[i];
+		hash *= 0x100000001B3;
+	}
+	
+	return hash;
+}
+
+bool MonitorProfileStore::isOpen()
+{
+	return !this->errorState;
+}
+
+bool MonitorProfileStore::find(uint64_t edidHash, monitorProfile& profile)
+{
+	for (uint32_t i = 0; i < this->contents.count; ++i)
+	{
+		if (this->contents.profiles[i].edidHash != edidHash) continue;
+		
+		profile = this->contents.profiles[i];
+		return true;
+	}
+	
+	return false;
+}
+
+bool MonitorProfileStore::findLast(monitorProfile& profile)
+{
+	return this->contents.lastEdidHash && find(this->contents.lastEdidHash, profile);
+}
+
+void MonitorProfileStore::update(const monitorProfile& profile)
+{
+	uint32_t slot = 0;
+	while (slot < this->contents.count && this->contents.profiles[slot].edidHash != profile.edidHash) ++slot;
+	
+	if (slot == this->contents.count)
+	{
+		if (this->contents.count < MONPROFILE_MAX_MONITORS) ++this->contents.count;
+		else
+		{
+			//Full. Reuse whichever monitor was seen least recently
+			slot = 0;
+			for (uint32_t i = 1; i < this->contents.count; ++i)
+			{
+				if (this->contents.profiles[i].updatedAt < this->contents.profiles[slot].updatedAt) slot = i;
+			}
+		}
+	}
+	
+	this->contents.profiles[slot] = profile;
+	this->contents.lastEdidHash = profile.edidHash;
+	
+	return;
+}
+
+MONPROFILE_ERR::CODE MonitorProfileStore::save()
+{
+	this->contents.magic = MONPROFILE_MAGIC;
+	this->contents.version = MONPROFILE_VERSION;
+	this->contents.checksum = checksum(this->contents);
+	
+	//Write a temporary and rename over the old one, so a crash leaves one whole store or the other
+	std::string tempPath = this->path + ".tmp";
+	int descriptor = open(tempPath.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+	if (descriptor == -1)
+	{
+		logger::error("Failed to write monitor profile store {}", tempPath);
+		this->errorState = true;
+		return MONPROFILE_ERR::CODE::OPEN_FAIL;
+	}
+	
+	bool written = writeAll(descriptor, reinterpret_cast<const uint8_t*>(&this->contents), sizeof(this->contents)) && fsync(descriptor) == 0;
+	close(descriptor);
+	
+	if (!written || std::rename(tempPath.c_str(), this->path.c_str()))
+	{
+		logger::error("Failed to write monitor profile store {}", this->path);
+		unlink(tempPath.c_str());
+		this->errorState = true;
+		return MONPROFILE_ERR::CODE::WR_FAIL;
+	}
+	
+	this->errorState = false;
+	
+	return MONPROFILE_ERR::CODE::SUCCESS;
+}
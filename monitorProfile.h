@@ -0,0 +1,136 @@
+/******************************************************************************
+/ Pi 4 Sunrise Clock App Monitor Profile Store Spec - lopezk38 2025
+/
+/*****************************************************************************/
+
+#ifndef SUNCLOCK_APP_MONPROFILE
+#define SUNCLOCK_APP_MONPROFILE
+
+/******************************************************************************
+/ Dependencies, namespacing
+/*****************************************************************************/
+
+#include <cstdint>
+#include <cstddef>
+#include <string>
+
+#include "errorcodes.h"
+
+
+/******************************************************************************
+/ Persisted data layout
+/*****************************************************************************/
+
+//Layout is written straight to disk, so bump this whenever a struct below changes
+constexpr uint32_t MONPROFILE_MAGIC = 0x464F5250; //"PROF"
+constexpr uint32_t MONPROFILE_VERSION = 2;
+constexpr unsigned int MONPROFILE_MAX_MONITORS = 8; //Oldest is dropped past this
+
+//ddcutil sleep multipliers, measured on brightness and only used for it. 1.0 is ddcutil's own conservative default
+struct ddcTiming
+{
+	float readMultiplier = 1;
+	float writeMultiplier = 1;
+};
+
+//Parsed from the monitor's MCCS capabilities string. Asking for that string is the slowest thing DDC does, so it happens once per monitor
+struct monitorCapabilities
+{
+	uint8_t vcpCodes[32] = {}; //Bitmap, one bit per VCP code
+	uint8_t inputValues[32] = {}; //Bitmap of values listed under 0x60. All clear if the monitor listed none
+	uint8_t powerValues = 0; //Bitmap of values listed under 0xD6, bit n for value n. 0 if the monitor listed none
+	uint8_t reserved[3] = {};
+	int32_t i2cBus = -1; //Where the monitor was last found, so the next start can open it there directly
+	
+	bool supports(uint8_t vcpCode) const
+	{
+		return this->vcpCodes[vcpCode >> 3] & (1 << (vcpCode & 0x7));
+	}
+	
+	bool accepts(uint8_t vcpCode, uint8_t value) const
+	{
+		if (!supports(vcpCode)) return false;
+		
+		//Only hold a write to the listed values when the monitor bothered to list any
+		if (vcpCode == 0x60 && hasAny(this->inputValues)) return this->inputValues[value >> 3] & (1 << (value & 0x7));
+		if (vcpCode == 0xD6 && this->powerValues) return value < 8 && (this->powerValues & (1 << value));
+		
+		return true;
+	}
+	
+	static bool hasAny(const uint8_t (&bitmap)[32])
+	{
+		for (uint8_t byte : bitmap) if (byte) return true;
+		return false;
+	}
+};
+
+//Everything learned about one monitor, keyed by a hash of its EDID
+struct monitorProfile
+{
+	uint64_t edidHash = 0;
+	int64_t updatedAt = 0; //Wall clock seconds since epoch
+	
+	uint8_t timingCalibrated = 0;
+	uint8_t capabilitiesKnown = 0;
+	uint8_t powerSequence = 0; //POWER_SEQUENCE::CODE learned for this monitor. Was reserved and zero, which reads as nothing learned
+	uint8_t reserved[5] = {};
+	ddcTiming timing;
+	monitorCapabilities capabilities;
+};
+
+struct profileFile
+{
+	uint32_t magic;
+	uint32_t version;
+	uint32_t count;
+	uint32_t reserved;
+	uint64_t lastEdidHash; //Monitor most recently updated, tried first at startup
+	monitorProfile profiles[MONPROFILE_MAX_MONITORS];
+	uint64_t checksum; //Covers everything above
+};
+
+inline uint64_t edidHash(const uint8_t* edid, size_t length)
+{
+	//FNV-1a. Same EDID, same monitor, even across ports and display numbers
+	uint64_t hash = 0xCBF29CE484222325;
+	for (size_t i = 0; i < length; ++i)
+	{
+		hash ^= edid[i];
+		hash *= 0x100000001B3;
+	}
+	
+	return hash;
+}
+
+
+/******************************************************************************
+/ Class specification
+/*****************************************************************************/
+
+class MonitorProfileStore
+{
+	
+private:
+	
+	const std::string path;
+	profileFile contents = {};
+	
+	bool errorState = false;
+	
+	MONPROFILE_ERR::CODE load();
+	static uint64_t checksum(const profileFile& file);
+	
+public:
+
+	MonitorProfileStore(const std::string& path);
+	
+	bool isOpen();
+	
+	bool find(uint64_t edidHash, monitorProfile& profile);
+	bool findLast(monitorProfile& profile);
+	void update(const monitorProfile& profile); //In memory. save() writes it out
+	MONPROFILE_ERR::CODE save();
+};
+
+#endif
@@ -0,0 +1,113 @@
+/******************************************************************************
+/ Pi 4 Sunrise Clock App Monitor Quirk Table - lopezk38 2025
+/
+/ Picks how to power a monitor on and off over DDC. Most monitors take a plain
+/ D6=0x01 to wake, so that is the default. The input select and D6=0x05 toggle
+/ the clock started with is kept as the fallback for the ones that don't
+/
+/*****************************************************************************/
+
+#ifndef SUNCLOCK_APP_MONQUIRKS
+#define SUNCLOCK_APP_MONQUIRKS
+
+/******************************************************************************
+/ Dependencies, namespacing
+/*****************************************************************************/
+
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+
+#include "stateFile.h"
+#include "monitorProfile.h"
+
+
+/******************************************************************************
+/ Power sequences
+/*****************************************************************************/
+
+namespace POWER_SEQUENCE
+{
+	//Persisted in the monitor profile store, so only ever add to the end
+	enum CODE
+	{
+		UNKNOWN = 0, //Nothing learned. Runs like DIRECT but checks every power command and falls back to INPUT_TOGGLE if one is ignored
+		DIRECT = 1, //One D6 write each way, known to work
+		INPUT_TOGGLE = 2, //Select the input to soft wake the monitor, wait, then toggle with D6=0x05
+		COUNT
+	};
+}
+
+struct powerSequenceSteps
+{
+	POWER_SEQUENCE::CODE code;
+	const char* name;
+	uint8_t onValue; //Written to 0xD6
+	uint8_t offValue;
+	bool wakeInput; //Select the input before the power command
+	std::chrono::seconds wakeDelay; //Input select to power command
+	std::chrono::seconds settleDelay; //Power command to the first brightness write
+	std::chrono::seconds verifyDelay; //Power command to the readback that proves it worked. 0 never checks
+};
+
+constexpr powerSequenceSteps POWER_SEQUENCES[POWER_SEQUENCE::CODE::COUNT] =
+{
+	{ POWER_SEQUENCE::CODE::UNKNOWN, "default", 0x01, 0x04, false, std::chrono::seconds(0), std::chrono::seconds(1), std::chrono::seconds(5) },
+	{ POWER_SEQUENCE::CODE::DIRECT, "direct", 0x01, 0x04, false, std::chrono::seconds(0), std::chrono::seconds(1), std::chrono::seconds(0) },
+	{ POWER_SEQUENCE::CODE::INPUT_TOGGLE, "input-toggle", 0x05, 0x05, true, std::chrono::seconds(2), std::chrono::seconds(2), std::chrono::seconds(0) }
+};
+
+
+/******************************************************************************
+/ Quirk table
+/*****************************************************************************/
+
+//Monitors known to need something other than the default, matched on the EDID manufacturer ID and model name. A null model matches
+//every model from that manufacturer. A monitor missing from here that ignores the default is caught by the readback and its fallback
+//is learned into the profile store, so listing it only saves that one failed attempt
+struct monitorQuirk
+{
+	const char* mfgId;
+	const char* modelName;
+	POWER_SEQUENCE::CODE sequence;
+};
+
+constexpr monitorQuirk MONITOR_QUIRKS[] =
+{
+	//{ "ABC", "Model name", POWER_SEQUENCE::CODE::INPUT_TOGGLE },
+	{ nullptr, nullptr, POWER_SEQUENCE::CODE::UNKNOWN } //End of table
+};
+
+inline POWER_SEQUENCE::CODE lookupQuirk(const monitorIdentity& monitor)
+{
+	for (const monitorQuirk* quirk = MONITOR_QUIRKS; quirk->mfgId; ++quirk)
+	{
+		if (std::strncmp(quirk->mfgId, monitor.mfgId, sizeof(monitor.mfgId))) continue;
+		if (quirk->modelName && std::strncmp(quirk->modelName, monitor.modelName, sizeof(monitor.modelName))) continue;
+		
+		return quirk->sequence;
+	}
+	
+	return POWER_SEQUENCE::CODE::UNKNOWN;
+}
+
+inline powerSequenceSteps choosePowerSequence(const monitorIdentity* monitor, const monitorProfile& profile)
+{
+	//What this monitor was seen to need wins, then the table, then the shortest sequence
+	POWER_SEQUENCE::CODE code = (profile.powerSequence < POWER_SEQUENCE::CODE::COUNT) ? static_cast<POWER_SEQUENCE::CODE>(profile.powerSequence) : POWER_SEQUENCE::CODE::UNKNOWN;
+	if (code == POWER_SEQUENCE::CODE::UNKNOWN && monitor) code = lookupQuirk(*monitor);
+	
+	powerSequenceSteps sequence = POWER_SEQUENCES[code];
+	
+	//Don't bother trying a power value the monitor says it won't take
+	if (code == POWER_SEQUENCE::CODE::UNKNOWN && profile.capabilitiesKnown && profile.capabilities.powerValues)
+	{
+		const monitorCapabilities& capabilities = profile.capabilities;
+		if (!capabilities.accepts(0xD6, sequence.onValue)) return POWER_SEQUENCES[POWER_SEQUENCE::CODE::INPUT_TOGGLE];
+		if (!capabilities.accepts(0xD6, sequence.offValue)) sequence.offValue = 0x05;
+	}
+	
+	return sequence;
+}
+
+#endif
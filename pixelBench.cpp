@@ -0,0 +1,133 @@
+/******************************************************************************
+/ Pi 4 Sunrise Clock App Pixel Conversion Benchmark - lopezk38 2025
+/
+/ Converts a synthetic dark sunrise gradient into every supported framebuffer
+/ format at 1080p and 4K, with and without dithering. Checks the SIMD kernels
+/ against the scalar path bit for bit and reports the throughput of both
+/
+/ Usage: pixelbench [--frames N]
+/
+/*****************************************************************************/
+
+/******************************************************************************
+/ Dependencies, namespacing
+/*****************************************************************************/
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <vector>
+
+#include "pixelFormat.h"
+
+
+/******************************************************************************
+/ Constants
+/*****************************************************************************/
+
+struct resolution
+{
+	const char* name;
+	uint32_t width;
+	uint32_t height;
+};
+
+constexpr resolution RESOLUTIONS[] = { { "1080p", 1920, 1080 }, { "4K", 3840, 2160 } };
+constexpr unsigned int DEFAULT_FRAMES = 30;
+
+
+/******************************************************************************
+/ Implementation
+/*****************************************************************************/
+
+void fillGradient(std::vector<uint8_t>& frame, uint32_t width, uint32_t height)
+{
+	//Just before sunrise. Deep blue fading to a dim orange, the kind of ramp that bands worst at 565
+	for (uint32_t y = 0; y < height; ++y)
+	{
+		float t = static_cast<float>(y) / height;
+		for (uint32_t x = 0; x < width; ++x)
+		{
+			uint8_t* pixel = &frame[(static_cast<size_t>(y) * width + x) * 4];
+			pixel[0] = static_cast<uint8_t>(10 + 60 * t);
+			pixel[1] = static_cast<uint8_t>(8 + 24 * t + 4.0f * x / width);
+			pixel[2] = static_cast<uint8_t>(40 - 30 * t);
+			pixel[3] = 0xFF;
+		}
+	}
+	
+	return;
+}
+
+double timeConversion(bool simd, const std::vector<uint8_t>& source, std::vector<uint8_t>& target, const pixel::format& targetFormat,
+					  uint32_t width, uint32_t height, bool dither, unsigned int frames)
+{
+	size_t targetStride = static_cast<size_t>(width) * (targetFormat.bitsPerPixel / 8);
+	
+	auto start = std::chrono::steady_clock::now();
+	for (unsigned int frame = 0; frame < frames; ++frame)
+	{
+		if (simd) pixel::convert(source.data(), width * 4, target.data(), targetStride, targetFormat, width, height, dither);
+		else pixel::convertScalar(source.data(), width * 4, target.data(), targetStride, targetFormat, width, height, dither);
+	}
+	auto elapsed = std::chrono::steady_clock::now() - start;
+	
+	return std::chrono::duration<double, std::milli>(elapsed).count() / frames;
+}
+
+int main(int argc, char* argv[])
+{
+	unsigned int frames = DEFAULT_FRAMES;
+	
+	for (int i = 1; i < argc; ++i)
+	{
+		if (!std::strcmp(argv[i], "--frames") && i + 1 < argc) frames = std::atoi(argv[++i]);
+		else
+		{
+			std::cerr << "Usage: pixelbench [--frames N]" << std::endl;
+			return 1;
+		}
+	}
+	if (frames == 0) frames = 1;
+	
+	std::cout << "Kernels: " << pixel::kernelName() << ", " << frames << " frames per case" << std::endl;
+	std::printf("%-6s %-9s %-6s %12s %12s %12s %8s\n", "res", "format", "dither", "ms/frame", "Mpix/s", "scalar ms", "speedup");
+	
+	bool mismatch = false;
+	
+	for (const resolution& res : RESOLUTIONS)
+	{
+		size_t pixels = static_cast<size_t>(res.width) * res.height;
+		std::vector<uint8_t> source(pixels * 4);
+		std::vector<uint8_t> fast(pixels * 4);
+		std::vector<uint8_t> reference(pixels * 4);
+		fillGradient(source, res.width, res.height);
+		
+		for (int code = pixel::FORMAT::CODE::RGB565; code < pixel::FORMAT::CODE::COUNT; ++code)
+		{
+			pixel::format targetFormat = pixel::fromCode(static_cast<pixel::FORMAT::CODE>(code));
+			size_t targetBytes = pixels * (targetFormat.bitsPerPixel / 8);
+			
+			//Dithering is a no op at 8 bits per channel, so only time it where it does something
+			for (int dither = 0; dither <= (pixel::wantsDither(targetFormat) ? 1 : 0); ++dither)
+			{
+				double simdMs = timeConversion(true, source, fast, targetFormat, res.width, res.height, dither, frames);
+				double scalarMs = timeConversion(false, source, reference, targetFormat, res.width, res.height, dither, frames);
+				
+				if (std::memcmp(fast.data(), reference.data(), targetBytes))
+				{
+					std::cerr << "ERROR: " << pixel::kernelName() << " output differs from scalar for " << pixel::toString(targetFormat.code)
+							  << (dither ? " with" : " without") << " dithering at " << res.name << std::endl;
+					mismatch = true;
+				}
+				
+				std::printf("%-6s %-9s %-6s %12.3f %12.1f %12.3f %7.1fx\n", res.name, pixel::toString(targetFormat.code), dither ? "yes" : "no",
+							simdMs, pixels / simdMs / 1000.0, scalarMs, scalarMs / simdMs);
+			}
+		}
+	}
+	
+	return mismatch ? 1 : 0;
+}
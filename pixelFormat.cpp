@@ -0,0 +1,663 @@
+/******************************************************************************
+/ Pi 4 Sunrise Clock App Pixel Format Conversion Implementation - lopezk38 2025
+/
+/*****************************************************************************/
+
+/******************************************************************************
+/ Dependencies, namespacing
+/*****************************************************************************/
+
+#if defined(__ARM_NEON)
+#include <arm_neon.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+#include <cstring>
+
+#include "pixelFormat.h"
+
+
+/******************************************************************************
+/ Constants
+/*****************************************************************************/
+
+//4x4 Bayer matrix. Thresholds are scaled to the quantization step of each channel
+constexpr uint8_t BAYER[4][4] =
+{
+	{  0,  8,  2, 10 },
+	{ 12,  4, 14,  6 },
+	{  3, 11,  1,  9 },
+	{ 15,  7, 13,  5 }
+};
+
+
+/******************************************************************************
+/ Format description
+/*****************************************************************************/
+
+namespace pixel
+{
+	static bool sameField(const channel& field, uint8_t offset, uint8_t length)
+	{
+		return field.offset == offset && field.length == length;
+	}
+	
+	format fromScreenInfo(const fb_var_screeninfo& screenInfo)
+	{
+		format result;
+		
+		//Grayscale and FOURCC modes don't describe themselves with bitfields, and msb_right panels are rare enough not to bother
+		if (screenInfo.grayscale || screenInfo.red.msb_right || screenInfo.green.msb_right || screenInfo.blue.msb_right) return result;
+		
+		result.bitsPerPixel = screenInfo.bits_per_pixel;
+		result.red = { static_cast<uint8_t>(screenInfo.red.offset), static_cast<uint8_t>(screenInfo.red.length) };
+		result.green = { static_cast<uint8_t>(screenInfo.green.offset), static_cast<uint8_t>(screenInfo.green.length) };
+		result.blue = { static_cast<uint8_t>(screenInfo.blue.offset), static_cast<uint8_t>(screenInfo.blue.length) };
+		result.alpha = { static_cast<uint8_t>(screenInfo.transp.offset), static_cast<uint8_t>(screenInfo.transp.length) };
+		
+		//Name the common layouts so they get the fast kernels
+		for (int code = FORMAT::CODE::RGB565; code < FORMAT::CODE::COUNT; ++code)
+		{
+			format known = fromCode(static_cast<FORMAT::CODE>(code));
+			if (known.bitsPerPixel != result.bitsPerPixel) continue;
+			if (!sameField(result.red, known.red.offset, known.red.length)) continue;
+			if (!sameField(result.green, known.green.offset, known.green.length)) continue;
+			if (!sameField(result.blue, known.blue.offset, known.blue.length)) continue;
+			
+			//The spare byte of a 32 bit pixel is written as opaque alpha either way. Panels that ignore it won't care
+			result.code = known.code;
+			result.alpha = known.alpha;
+			break;
+		}
+		
+		return result;
+	}
+	
+	format fromCode(FORMAT::CODE code)
+	{
+		format result;
+		result.code = code;
+		
+		switch (code)
+		{
+			case FORMAT::CODE::RGB565:
+				result.bitsPerPixel = 16;
+				result.red = { 11, 5 };
+				result.green = { 5, 6 };
+				result.blue = { 0, 5 };
+				break;
+			
+			case FORMAT::CODE::BGR565:
+				result.bitsPerPixel = 16;
+				result.red = { 0, 5 };
+				result.green = { 5, 6 };
+				result.blue = { 11, 5 };
+				break;
+			
+			case FORMAT::CODE::RGB888:
+				result.bitsPerPixel = 24;
+				result.red = { 16, 8 };
+				result.green = { 8, 8 };
+				result.blue = { 0, 8 };
+				break;
+			
+			case FORMAT::CODE::BGR888:
+				result.bitsPerPixel = 24;
+				result.red = { 0, 8 };
+				result.green = { 8, 8 };
+				result.blue = { 16, 8 };
+				break;
+			
+			case FORMAT::CODE::XRGB8888:
+				result.bitsPerPixel = 32;
+				result.red = { 16, 8 };
+				result.green = { 8, 8 };
+				result.blue = { 0, 8 };
+				result.alpha = { 24, 8 };
+				break;
+			
+			case FORMAT::CODE::XBGR8888:
+				result.bitsPerPixel = 32;
+				result.red = { 0, 8 };
+				result.green = { 8, 8 };
+				result.blue = { 16, 8 };
+				result.alpha = { 24, 8 };
+				break;
+			
+			default:
+				result.code = FORMAT::CODE::UNKNOWN;
+				break;
+		}
+		
+		return result;
+	}
+	
+	const char* toString(FORMAT::CODE code)
+	{
+		switch (code)
+		{
+			case FORMAT::CODE::RGB565: return "RGB565";
+			case FORMAT::CODE::BGR565: return "BGR565";
+			case FORMAT::CODE::RGB888: return "RGB888";
+			case FORMAT::CODE::BGR888: return "BGR888";
+			case FORMAT::CODE::XRGB8888: return "XRGB8888";
+			case FORMAT::CODE::XBGR8888: return "XBGR8888";
+			default: return "UNKNOWN";
+		}
+	}
+	
+	static bool fieldFits(const channel& field, uint32_t bitsPerPixel)
+	{
+		return field.length <= 16 && field.offset + field.length <= bitsPerPixel;
+	}
+	
+	bool isConvertible(const format& target)
+	{
+		if (target.bitsPerPixel != 16 && target.bitsPerPixel != 24 && target.bitsPerPixel != 32) return false;
+		if (!target.red.length || !target.green.length || !target.blue.length) return false;
+		
+		return fieldFits(target.red, target.bitsPerPixel) && fieldFits(target.green, target.bitsPerPixel) &&
+			   fieldFits(target.blue, target.bitsPerPixel) && fieldFits(target.alpha, target.bitsPerPixel);
+	}
+	
+	bool wantsDither(const format& target)
+	{
+		return target.red.length < 8 || target.green.length < 8 || target.blue.length < 8;
+	}
+	
+	
+	/******************************************************************************
+	/ Scalar path
+	/*****************************************************************************/
+	
+	//Threshold to add before truncating to the field width. Zero for fields of 8 bits or more
+	static uint8_t ditherBias(const channel& field, uint32_t x, uint32_t y)
+	{
+		if (field.length >= 8) return 0;
+		return (BAYER[y & 0x3][x & 0x3] << (8 - field.length)) >> 4;
+	}
+	
+	static uint32_t packChannel(uint8_t value, const channel& field, uint8_t bias)
+	{
+		if (field.length < 8)
+		{
+			//Saturating add then truncate. The SIMD kernels do exactly this
+			uint32_t biased = value + bias;
+			if (biased > 0xFF) biased = 0xFF;
+			return (biased >> (8 - field.length)) << field.offset;
+		}
+		
+		//Wider than 8 bits. Repeat the top bits so full scale stays full scale
+		uint32_t wide = (static_cast<uint32_t>(value) << (field.length - 8)) | (value >> (16 - field.length));
+		return wide << field.offset;
+	}
+	
+	static void convertRowScalar(const uint8_t* source, uint8_t* target, const format& targetFormat, uint32_t fromX, uint32_t toX, uint32_t y, bool dither)
+	{
+		uint32_t bytesPerPixel = targetFormat.bitsPerPixel / 8;
+		uint32_t alphaBits = targetFormat.alpha.length ? ((1u << targetFormat.alpha.length) - 1) << targetFormat.alpha.offset : 0;
+		
+		for (uint32_t x = fromX; x < toX; ++x)
+		{
+			const uint8_t* in = source + x * 4;
+			
+			uint32_t word = alphaBits;
+			word |= packChannel(in[0], targetFormat.red, dither ? ditherBias(targetFormat.red, x, y) : 0);
+			word |= packChannel(in[1], targetFormat.green, dither ? ditherBias(targetFormat.green, x, y) : 0);
+			word |= packChannel(in[2], targetFormat.blue, dither ? ditherBias(targetFormat.blue, x, y) : 0);
+			
+			//Framebuffers are little endian on everything this runs on
+			uint8_t* out = target + x * bytesPerPixel;
+			for (uint32_t byte = 0; byte < bytesPerPixel; ++byte) out[byte] = word >> (byte * 8);
+		}
+		
+		return;
+	}
+	
+	bool convertScalar(const uint8_t* source, size_t sourceStride, uint8_t* target, size_t targetStride,
+					   const format& targetFormat, uint32_t width, uint32_t height, bool dither)
+	{
+		if (!isConvertible(targetFormat)) return false;
+		
+		for (uint32_t y = 0; y < height; ++y)
+		{
+			convertRowScalar(source + y * sourceStride, target + y * targetStride, targetFormat, 0, width, y, dither);
+		}
+		
+		return true;
+	}
+	
+	static bool isCrossfadeSource(const format& sourceFormat)
+	{
+		return sourceFormat.code == FORMAT::CODE::XBGR8888 || sourceFormat.code == FORMAT::CODE::RGB565;
+	}
+	
+	//Weighted so 0 is all a and 256 all b. Never over 255 * 256, so it fits the 16 bit lanes the SIMD kernels use
+	static inline uint8_t mixChannel(uint32_t a, uint32_t b, uint32_t weight)
+	{
+		return (a * (256 - weight) + b * weight) >> 8;
+	}
+	
+	//Repeat the top bits into the bottom, so full scale 565 comes out as 255
+	static inline uint32_t expand5(uint32_t value)
+	{
+		return (value << 3) | (value >> 2);
+	}
+	
+	static inline uint32_t expand6(uint32_t value)
+	{
+		return (value << 2) | (value >> 4);
+	}
+	
+	static void crossfadeRowScalar(const uint8_t* from, const uint8_t* to, FORMAT::CODE sourceCode, uint8_t* target, uint32_t fromX, uint32_t toX, uint32_t weight)
+	{
+		for (uint32_t x = fromX; x < toX; ++x)
+		{
+			uint8_t* out = target + x * 4;
+			
+			if (sourceCode == FORMAT::CODE::RGB565)
+			{
+				uint32_t a = from[x * 2] | (from[x * 2 + 1] << 8);
+				uint32_t b = to[x * 2] | (to[x * 2 + 1] << 8);
+				out[0] = mixChannel(expand5(a >> 11), expand5(b >> 11), weight);
+				out[1] = mixChannel(expand6((a >> 5) & 0x3F), expand6((b >> 5) & 0x3F), weight);
+				out[2] = mixChannel(expand5(a & 0x1F), expand5(b & 0x1F), weight);
+			}
+			else
+			{
+				out[0] = mixChannel(from[x * 4], to[x * 4], weight);
+				out[1] = mixChannel(from[x * 4 + 1], to[x * 4 + 1], weight);
+				out[2] = mixChannel(from[x * 4 + 2], to[x * 4 + 2], weight);
+			}
+			out[3] = 0xFF;
+		}
+		
+		return;
+	}
+	
+	bool crossfadeScalar(const uint8_t* from, const uint8_t* to, const format& sourceFormat, uint8_t* target, uint32_t width, uint32_t weight)
+	{
+		if (!isCrossfadeSource(sourceFormat) || weight > 256) return false;
+		
+		crossfadeRowScalar(from, to, sourceFormat.code, target, 0, width, weight);
+		
+		return true;
+	}
+	
+	
+	/******************************************************************************
+	/ SIMD kernels
+	/*****************************************************************************/
+	
+	//Each kernel converts as much of a row as fits its vector width and returns how many pixels it did. The scalar path finishes the row
+	
+	#if defined(__ARM_NEON)
+	
+	const char* kernelName()
+	{
+		return "NEON";
+	}
+	
+	static uint32_t convertRowSIMD(const uint8_t* source, uint8_t* target, const format& targetFormat, uint32_t width, uint32_t y, bool dither)
+	{
+		uint32_t x = 0;
+		
+		switch (targetFormat.code)
+		{
+			case FORMAT::CODE::RGB565:
+			case FORMAT::CODE::BGR565:
+			{
+				//Thresholds for the 16 pixels a vector covers. The Bayer row repeats every 4
+				uint8_t redBias[16];
+				uint8_t greenBias[16];
+				uint8_t blueBias[16];
+				for (uint32_t i = 0; i < 16; ++i)
+				{
+					redBias[i] = dither ? ditherBias(targetFormat.red, i, y) : 0;
+					greenBias[i] = dither ? ditherBias(targetFormat.green, i, y) : 0;
+					blueBias[i] = dither ? ditherBias(targetFormat.blue, i, y) : 0;
+				}
+				uint8x16_t redBiasVec = vld1q_u8(redBias);
+				uint8x16_t greenBiasVec = vld1q_u8(greenBias);
+				uint8x16_t blueBiasVec = vld1q_u8(blueBias);
+				
+				bool swapped = targetFormat.code == FORMAT::CODE::BGR565;
+				uint16_t* out = reinterpret_cast<uint16_t*>(target);
+				
+				for (; x + 16 <= width; x += 16)
+				{
+					uint8x16x4_t in = vld4q_u8(source + x * 4);
+					uint8x16_t red = vqaddq_u8(in.val[0], redBiasVec);
+					uint8x16_t green = vqaddq_u8(in.val[1], greenBiasVec);
+					uint8x16_t blue = vqaddq_u8(in.val[2], blueBiasVec);
+					uint8x16_t high = swapped ? blue : red;
+					uint8x16_t low = swapped ? red : blue;
+					
+					//Top channel in the high byte, then shift-insert the others below it
+					uint16x8_t first = vshll_n_u8(vget_low_u8(high), 8);
+					first = vsriq_n_u16(first, vshll_n_u8(vget_low_u8(green), 8), 5);
+					first = vsriq_n_u16(first, vshll_n_u8(vget_low_u8(low), 8), 11);
+					
+					uint16x8_t second = vshll_n_u8(vget_high_u8(high), 8);
+					second = vsriq_n_u16(second, vshll_n_u8(vget_high_u8(green), 8), 5);
+					second = vsriq_n_u16(second, vshll_n_u8(vget_high_u8(low), 8), 11);
+					
+					vst1q_u16(out + x, first);
+					vst1q_u16(out + x + 8, second);
+				}
+				break;
+			}
+			
+			case FORMAT::CODE::RGB888:
+			case FORMAT::CODE::BGR888:
+			{
+				bool swapped = targetFormat.code == FORMAT::CODE::BGR888;
+				
+				for (; x + 16 <= width; x += 16)
+				{
+					uint8x16x4_t in = vld4q_u8(source + x * 4);
+					uint8x16x3_t out;
+					out.val[0] = swapped ? in.val[0] : in.val[2];
+					out.val[1] = in.val[1];
+					out.val[2] = swapped ? in.val[2] : in.val[0];
+					vst3q_u8(target + x * 3, out);
+				}
+				break;
+			}
+			
+			case FORMAT::CODE::XRGB8888:
+			case FORMAT::CODE::XBGR8888:
+			{
+				bool swapped = targetFormat.code == FORMAT::CODE::XBGR8888;
+				uint8x16_t opaque = vdupq_n_u8(0xFF);
+				
+				for (; x + 16 <= width; x += 16)
+				{
+					uint8x16x4_t in = vld4q_u8(source + x * 4);
+					uint8x16x4_t out;
+					out.val[0] = swapped ? in.val[0] : in.val[2];
+					out.val[1] = in.val[1];
+					out.val[2] = swapped ? in.val[2] : in.val[0];
+					out.val[3] = opaque;
+					vst4q_u8(target + x * 4, out);
+				}
+				break;
+			}
+			
+			default:
+				break;
+		}
+		
+		return x;
+	}
+	
+	//Sixteen bit lanes all the way through. 256 doesn't fit the 8 bit multiplies
+	static inline uint16x8_t mixLanes(uint16x8_t a, uint16x8_t b, uint16x8_t inverse, uint16x8_t weight)
+	{
+		return vshrq_n_u16(vmlaq_u16(vmulq_u16(a, inverse), b, weight), 8);
+	}
+	
+	static inline uint16x8_t expandLanes(uint16x8_t value, int bits)
+	{
+		return (bits == 5) ? vorrq_u16(vshlq_n_u16(value, 3), vshrq_n_u16(value, 2)) : vorrq_u16(vshlq_n_u16(value, 2), vshrq_n_u16(value, 4));
+	}
+	
+	static uint32_t crossfadeRowSIMD(const uint8_t* from, const uint8_t* to, FORMAT::CODE sourceCode, uint8_t* target, uint32_t width, uint32_t weight)
+	{
+		uint32_t x = 0;
+		uint16x8_t inverseVec = vdupq_n_u16(256 - weight);
+		uint16x8_t weightVec = vdupq_n_u16(weight);
+		
+		if (sourceCode == FORMAT::CODE::RGB565)
+		{
+			const uint16_t* fromWords = reinterpret_cast<const uint16_t*>(from);
+			const uint16_t* toWords = reinterpret_cast<const uint16_t*>(to);
+			uint16x8_t fiveBits = vdupq_n_u16(0x1F);
+			uint16x8_t sixBits = vdupq_n_u16(0x3F);
+			
+			for (; x + 8 <= width; x += 8)
+			{
+				uint16x8_t a = vld1q_u16(fromWords + x);
+				uint16x8_t b = vld1q_u16(toWords + x);
+				
+				uint16x8_t red = mixLanes(expandLanes(vshrq_n_u16(a, 11), 5), expandLanes(vshrq_n_u16(b, 11), 5), inverseVec, weightVec);
+				uint16x8_t green = mixLanes(expandLanes(vandq_u16(vshrq_n_u16(a, 5), sixBits), 6), expandLanes(vandq_u16(vshrq_n_u16(b, 5), sixBits), 6), inverseVec, weightVec);
+				uint16x8_t blue = mixLanes(expandLanes(vandq_u16(a, fiveBits), 5), expandLanes(vandq_u16(b, fiveBits), 5), inverseVec, weightVec);
+				
+				uint8x8x4_t out;
+				out.val[0] = vmovn_u16(red);
+				out.val[1] = vmovn_u16(green);
+				out.val[2] = vmovn_u16(blue);
+				out.val[3] = vdup_n_u8(0xFF);
+				vst4_u8(target + x * 4, out);
+			}
+		}
+		else
+		{
+			uint8x16_t opaque = vreinterpretq_u8_u32(vdupq_n_u32(0xFF000000));
+			
+			for (; x + 4 <= width; x += 4)
+			{
+				uint8x16_t a = vld1q_u8(from + x * 4);
+				uint8x16_t b = vld1q_u8(to + x * 4);
+				
+				uint16x8_t low = mixLanes(vmovl_u8(vget_low_u8(a)), vmovl_u8(vget_low_u8(b)), inverseVec, weightVec);
+				uint16x8_t high = mixLanes(vmovl_u8(vget_high_u8(a)), vmovl_u8(vget_high_u8(b)), inverseVec, weightVec);
+				vst1q_u8(target + x * 4, vorrq_u8(vcombine_u8(vmovn_u16(low), vmovn_u16(high)), opaque));
+			}
+		}
+		
+		return x;
+	}
+	
+	#elif defined(__SSE2__)
+	
+	const char* kernelName()
+	{
+		return "SSE2";
+	}
+	
+	//Four RGBA pixels sit in the four 32 bit lanes as R | G << 8 | B << 16 | A << 24
+	static inline __m128i pack565(__m128i pixels, bool swapped)
+	{
+		__m128i red = _mm_and_si128(pixels, _mm_set1_epi32(0xF8));
+		__m128i green = _mm_srli_epi32(_mm_and_si128(pixels, _mm_set1_epi32(0xFC00)), 5);
+		__m128i blue = _mm_and_si128(pixels, _mm_set1_epi32(0xF80000));
+		
+		red = swapped ? _mm_srli_epi32(red, 3) : _mm_slli_epi32(red, 8);
+		blue = swapped ? _mm_srli_epi32(blue, 8) : _mm_srli_epi32(blue, 19);
+		
+		return _mm_or_si128(_mm_or_si128(red, green), blue);
+	}
+	
+	static uint32_t convertRowSIMD(const uint8_t* source, uint8_t* target, const format& targetFormat, uint32_t width, uint32_t y, bool dither)
+	{
+		uint32_t x = 0;
+		
+		switch (targetFormat.code)
+		{
+			case FORMAT::CODE::RGB565:
+			case FORMAT::CODE::BGR565:
+			{
+				//Thresholds laid out like the pixels, for the 4 a vector covers. The Bayer row repeats every 4
+				alignas(16) uint8_t bias[16] = {};
+				for (uint32_t i = 0; i < 4 && dither; ++i)
+				{
+					bias[i * 4 + 0] = ditherBias(targetFormat.red, i, y);
+					bias[i * 4 + 1] = ditherBias(targetFormat.green, i, y);
+					bias[i * 4 + 2] = ditherBias(targetFormat.blue, i, y);
+				}
+				__m128i biasVec = _mm_load_si128(reinterpret_cast<const __m128i*>(bias));
+				
+				//packs is signed. Shift the 16 bit results into its range and back out again
+				__m128i signFlip32 = _mm_set1_epi32(0x8000);
+				__m128i signFlip16 = _mm_set1_epi16(static_cast<short>(0x8000));
+				bool swapped = targetFormat.code == FORMAT::CODE::BGR565;
+				
+				for (; x + 8 <= width; x += 8)
+				{
+					__m128i first = _mm_loadu_si128(reinterpret_cast<const __m128i*>(source + x * 4));
+					__m128i second = _mm_loadu_si128(reinterpret_cast<const __m128i*>(source + x * 4 + 16));
+					first = pack565(_mm_adds_epu8(first, biasVec), swapped);
+					second = pack565(_mm_adds_epu8(second, biasVec), swapped);
+					
+					__m128i packed = _mm_packs_epi32(_mm_sub_epi32(first, signFlip32), _mm_sub_epi32(second, signFlip32));
+					_mm_storeu_si128(reinterpret_cast<__m128i*>(target + x * 2), _mm_xor_si128(packed, signFlip16));
+				}
+				break;
+			}
+			
+			case FORMAT::CODE::XRGB8888:
+			case FORMAT::CODE::XBGR8888:
+			{
+				__m128i opaque = _mm_set1_epi32(0xFF000000);
+				__m128i greenMask = _mm_set1_epi32(0xFF00);
+				__m128i byteMask = _mm_set1_epi32(0xFF);
+				bool swapped = targetFormat.code == FORMAT::CODE::XBGR8888;
+				
+				for (; x + 4 <= width; x += 4)
+				{
+					__m128i pixels = _mm_loadu_si128(reinterpret_cast<const __m128i*>(source + x * 4));
+					
+					//XBGR is already the source byte order. XRGB swaps red and blue
+					if (!swapped)
+					{
+						__m128i red = _mm_slli_epi32(_mm_and_si128(pixels, byteMask), 16);
+						__m128i blue = _mm_and_si128(_mm_srli_epi32(pixels, 16), byteMask);
+						pixels = _mm_or_si128(_mm_or_si128(red, blue), _mm_and_si128(pixels, greenMask));
+					}
+					
+					_mm_storeu_si128(reinterpret_cast<__m128i*>(target + x * 4), _mm_or_si128(pixels, opaque));
+				}
+				break;
+			}
+			
+			case FORMAT::CODE::RGB888:
+			case FORMAT::CODE::BGR888:
+			{
+				//No byte shuffle in SSE2. A straight byte copy still beats the generic bitfield path
+				bool swapped = targetFormat.code == FORMAT::CODE::BGR888;
+				
+				for (; x < width; ++x)
+				{
+					const uint8_t* in = source + x * 4;
+					uint8_t* out = target + x * 3;
+					out[0] = swapped ? in[0] : in[2];
+					out[1] = in[1];
+					out[2] = swapped ? in[2] : in[0];
+				}
+				break;
+			}
+			
+			default:
+				break;
+		}
+		
+		return x;
+	}
+	
+	//Sixteen bit lanes all the way through. mullo keeps the low half, which is all of it for products under 65536
+	static inline __m128i mixLanes(__m128i a, __m128i b, __m128i inverse, __m128i weight)
+	{
+		return _mm_srli_epi16(_mm_add_epi16(_mm_mullo_epi16(a, inverse), _mm_mullo_epi16(b, weight)), 8);
+	}
+	
+	static inline __m128i expandLanes(__m128i value, int bits)
+	{
+		return (bits == 5) ? _mm_or_si128(_mm_slli_epi16(value, 3), _mm_srli_epi16(value, 2)) : _mm_or_si128(_mm_slli_epi16(value, 2), _mm_srli_epi16(value, 4));
+	}
+	
+	static uint32_t crossfadeRowSIMD(const uint8_t* from, const uint8_t* to, FORMAT::CODE sourceCode, uint8_t* target, uint32_t width, uint32_t weight)
+	{
+		uint32_t x = 0;
+		__m128i inverseVec = _mm_set1_epi16(static_cast<short>(256 - weight));
+		__m128i weightVec = _mm_set1_epi16(static_cast<short>(weight));
+		
+		if (sourceCode == FORMAT::CODE::RGB565)
+		{
+			__m128i fiveBits = _mm_set1_epi16(0x1F);
+			__m128i sixBits = _mm_set1_epi16(0x3F);
+			__m128i opaque = _mm_set1_epi16(static_cast<short>(0xFF00));
+			
+			for (; x + 8 <= width; x += 8)
+			{
+				__m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(from + x * 2));
+				__m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(to + x * 2));
+				
+				__m128i red = mixLanes(expandLanes(_mm_srli_epi16(a, 11), 5), expandLanes(_mm_srli_epi16(b, 11), 5), inverseVec, weightVec);
+				__m128i green = mixLanes(expandLanes(_mm_and_si128(_mm_srli_epi16(a, 5), sixBits), 6), expandLanes(_mm_and_si128(_mm_srli_epi16(b, 5), sixBits), 6), inverseVec, weightVec);
+				__m128i blue = mixLanes(expandLanes(_mm_and_si128(a, fiveBits), 5), expandLanes(_mm_and_si128(b, fiveBits), 5), inverseVec, weightVec);
+				
+				//R | G << 8 and B | A << 8 per pixel, then interleaved into 32 bit RGBA
+				__m128i redGreen = _mm_or_si128(red, _mm_slli_epi16(green, 8));
+				__m128i blueAlpha = _mm_or_si128(blue, opaque);
+				_mm_storeu_si128(reinterpret_cast<__m128i*>(target + x * 4), _mm_unpacklo_epi16(redGreen, blueAlpha));
+				_mm_storeu_si128(reinterpret_cast<__m128i*>(target + x * 4 + 16), _mm_unpackhi_epi16(redGreen, blueAlpha));
+			}
+		}
+		else
+		{
+			__m128i zero = _mm_setzero_si128();
+			__m128i opaque = _mm_set1_epi32(0xFF000000);
+			
+			for (; x + 4 <= width; x += 4)
+			{
+				__m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(from + x * 4));
+				__m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(to + x * 4));
+				
+				__m128i low = mixLanes(_mm_unpacklo_epi8(a, zero), _mm_unpacklo_epi8(b, zero), inverseVec, weightVec);
+				__m128i high = mixLanes(_mm_unpackhi_epi8(a, zero), _mm_unpackhi_epi8(b, zero), inverseVec, weightVec);
+				_mm_storeu_si128(reinterpret_cast<__m128i*>(target + x * 4), _mm_or_si128(_mm_packus_epi16(low, high), opaque));
+			}
+		}
+		
+		return x;
+	}
+	
+	#else
+	
+	const char* kernelName()
+	{
+		return "scalar";
+	}
+	
+	static uint32_t convertRowSIMD(const uint8_t*, uint8_t*, const format&, uint32_t, uint32_t, bool)
+	{
+		return 0;
+	}
+	
+	static uint32_t crossfadeRowSIMD(const uint8_t*, const uint8_t*, FORMAT::CODE, uint8_t*, uint32_t, uint32_t)
+	{
+		return 0;
+	}
+	
+	#endif
+	
+	bool convert(const uint8_t* source, size_t sourceStride, uint8_t* target, size_t targetStride,
+				 const format& targetFormat, uint32_t width, uint32_t height, bool dither)
+	{
+		if (!isConvertible(targetFormat)) return false;
+		
+		for (uint32_t y = 0; y < height; ++y)
+		{
+			const uint8_t* sourceRow = source + y * sourceStride;
+			uint8_t* targetRow = target + y * targetStride;
+			
+			uint32_t done = convertRowSIMD(sourceRow, targetRow, targetFormat, width, y, dither);
+			convertRowScalar(sourceRow, targetRow, targetFormat, done, width, y, dither);
+		}
+		
+		return true;
+	}
+	
+	bool crossfade(const uint8_t* from, const uint8_t* to, const format& sourceFormat, uint8_t* target, uint32_t width, uint32_t weight)
+	{
+		if (!isCrossfadeSource(sourceFormat) || weight > 256) return false;
+		
+		uint32_t done = crossfadeRowSIMD(from, to, sourceFormat.code, target, width, weight);
+		crossfadeRowScalar(from, to, sourceFormat.code, target, done, width, weight);
+		
+		return true;
+	}
+}
@@ -0,0 +1,86 @@
+/******************************************************************************
+/ Pi 4 Sunrise Clock App Pixel Format Conversion Spec - lopezk38 2025
+/
+/ Converts composed RGBA8888 frames into whatever the framebuffer natively
+/ holds, with optional ordered dithering for the low depth formats. Dark
+/ sunrise gradients band badly at 565 without it
+/
+/*****************************************************************************/
+
+#ifndef SUNCLOCK_APP_PIXFMT
+#define SUNCLOCK_APP_PIXFMT
+
+/******************************************************************************
+/ Dependencies, namespacing
+/*****************************************************************************/
+
+#include <linux/fb.h>
+
+#include <cstdint>
+#include <cstddef>
+
+
+/******************************************************************************
+/ Format description
+/*****************************************************************************/
+
+namespace pixel
+{
+	//Named by the bitfield layout of a little endian pixel word, the way the kernel describes them. RGB565 has red in the top bits
+	namespace FORMAT
+	{
+		enum CODE
+		{
+			UNKNOWN = 0, //Still convertible through the generic path if the bitfields make sense
+			RGB565 = 1,
+			BGR565 = 2,
+			RGB888 = 3,
+			BGR888 = 4,
+			XRGB8888 = 5,
+			XBGR8888 = 6,
+			COUNT
+		};
+	}
+	
+	struct channel
+	{
+		uint8_t offset = 0;
+		uint8_t length = 0;
+	};
+	
+	struct format
+	{
+		FORMAT::CODE code = FORMAT::CODE::UNKNOWN;
+		uint32_t bitsPerPixel = 0;
+		channel red;
+		channel green;
+		channel blue;
+		channel alpha; //Filled with all ones when present
+	};
+	
+	format fromScreenInfo(const fb_var_screeninfo& screenInfo);
+	format fromCode(FORMAT::CODE code);
+	const char* toString(FORMAT::CODE code);
+	
+	bool isConvertible(const format& target);
+	bool wantsDither(const format& target); //True when any color channel is under 8 bits
+	
+	//Which kernels convert() will use, for logs and the benchmark
+	const char* kernelName();
+	
+	//Source is RGBA8888 in memory byte order, the way raylib images hold it. Strides are in bytes
+	//Returns false if the target can't be converted to
+	bool convert(const uint8_t* source, size_t sourceStride, uint8_t* target, size_t targetStride,
+				 const format& targetFormat, uint32_t width, uint32_t height, bool dither);
+	
+	//Plain C++ for every format. The SIMD kernels must match it bit for bit
+	bool convertScalar(const uint8_t* source, size_t sourceStride, uint8_t* target, size_t targetStride,
+					   const format& targetFormat, uint32_t width, uint32_t height, bool dither);
+	
+	//Blends one row of two images into opaque RGBA8888. Weight runs 0-256, from all of the first to all of the second
+	//Sources are XBGR8888 (RGBA8888 in memory order) or RGB565. Returns false for any other source format
+	bool crossfade(const uint8_t* from, const uint8_t* to, const format& sourceFormat, uint8_t* target, uint32_t width, uint32_t weight);
+	bool crossfadeScalar(const uint8_t* from, const uint8_t* to, const format& sourceFormat, uint8_t* target, uint32_t width, uint32_t weight);
+}
+
+#endif
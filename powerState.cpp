@@ -0,0 +1,160 @@
+/******************************************************************************
+/ Pi 4 Sunrise Clock App Display Power State Source Implementation - lopezk38 2025
+/
+/*****************************************************************************/
+
+/******************************************************************************
+/ Dependencies, namespacing
+/*****************************************************************************/
+
+#include <unistd.h>
+#include <fcntl.h>
+#include <dirent.h>
+#include <cstring>
+
+#include "powerState.h"
+#include "metrics.h"
+#include "logger.h"
+
+
+/******************************************************************************
+/ Class implementation
+/*****************************************************************************/
+
+PowerStateSource::PowerStateSource(const std::string& path): path(path)
+{
+	//Optional. Without it every power check goes to DDC like before
+	if (openConnector() != POWERSTATE_ERR::CODE::SUCCESS) errorState = true;
+	
+	return;
+}
+
+PowerStateSource::~PowerStateSource()
+{
+	if (this->dpmsDescriptor != -1) close(this->dpmsDescriptor);
+	if (this->statusDescriptor != -1) close(this->statusDescriptor);
+	
+	return;
+}
+
+POWERSTATE_ERR::CODE PowerStateSource::openConnector()
+{
+	if (this->path.empty()) return POWERSTATE_ERR::CODE::NOT_FOUND;
+	
+	//Kept open for the life of the clock. Each read is a pread per attribute
+	this->dpmsDescriptor = open((this->path + "/dpms").c_str(), O_RDONLY | O_CLOEXEC);
+	this->statusDescriptor = open((this->path + "/status").c_str(), O_RDONLY | O_CLOEXEC);
+	
+	if (this->dpmsDescriptor == -1 || this->statusDescriptor == -1)
+	{
+		logger::error("Failed to open display power state at {}", this->path);
+		return POWERSTATE_ERR::CODE::OPEN_FAIL;
+	}
+	
+	logger::verbose("Reading display power state from {}", this->path);
+	
+	return POWERSTATE_ERR::CODE::SUCCESS;
+}
+
+std::string PowerStateSource::findConnector()
+{
+	DIR* drm = opendir(POWER_STATE_DRM_PATH);
+	if (!drm) return "";
+	
+	std::string found;
+	while (dirent* entry = readdir(drm))
+	{
+		//Connectors are named card<n>-<type>-<index>. Plain card<n> is the device itself
+		if (std::strncmp(entry->d_name, "card", 4) || !std::strchr(entry->d_name, '-')) continue;
+		
+		std::string candidate = std::string(POWER_STATE_DRM_PATH) + "/" + entry->d_name;
+		int descriptor = open((candidate + "/status").c_str(), O_RDONLY | O_CLOEXEC);
+		if (descriptor == -1) continue;
+		
+		char status[16];
+		bool connected = readAttribute(descriptor, status, sizeof(status)) && !std::strcmp(status, "connected");
+		close(descriptor);
+		
+		if (connected)
+		{
+			found = candidate;
+			break;
+		}
+	}
+	closedir(drm);
+	
+	return found;
+}
+
+bool PowerStateSource::readAttribute(int descriptor, char* buf, size_t length)
+{
+	//sysfs attributes regenerate on every read from offset 0, plain files just reread
+	ssize_t got = pread(descriptor, buf, length - 1, 0);
+	if (got <= 0) return false;
+	
+	//Drop the trailing newline
+	while (got > 0 && (buf[got - 1] == '\n' || buf[got - 1] == ' ')) --got;
+	buf[got] = '\0';
+	
+	return true;
+}
+
+bool PowerStateSource::isOpen()
+{
+	return !this->errorState;
+}
+
+POWER_STATE::CODE PowerStateSource::read()
+{
+	if (this->errorState) return POWER_STATE::CODE::UNKNOWN;
+	
+	char status[16];
+	char dpms[16];
+	if (!readAttribute(this->statusDescriptor, status, sizeof(status)) || !readAttribute(this->dpmsDescriptor, dpms, sizeof(dpms))) return POWER_STATE::CODE::UNKNOWN;
+	
+	//A monitor that drops hotplug when it powers down shows up as disconnected
+	if (!std::strcmp(status, "disconnected")) return POWER_STATE::CODE::OFF;
+	if (std::strcmp(status, "connected")) return POWER_STATE::CODE::UNKNOWN;
+	
+	//Standby and Suspend are as good as off for the clock
+	return std::strcmp(dpms, "On") ? POWER_STATE::CODE::OFF : POWER_STATE::CODE::ON;
+}
+
+bool PowerStateSource::canSkipDDC()
+{
+	if (this->contradicted || !this->seenOn || !this->seenOff) return false;
+	
+	return ++this->readsSinceCheck < POWER_STATE_CROSSCHECK_INTERVAL;
+}
+
+void PowerStateSource::crossCheck(POWER_STATE::CODE sourceState, bool ddcOn)
+{
+	if (sourceState == POWER_STATE::CODE::UNKNOWN || this->contradicted) return;
+	
+	this->readsSinceCheck = 0;
+	
+	if ((sourceState == POWER_STATE::CODE::ON) != ddcOn)
+	{
+		logger::warning("{} says the display is {} but DDC disagrees. Using DDC for power state from now on", this->path, (ddcOn ? "off" : "on"));
+		this->contradicted = true;
+		return;
+	}
+	
+	if (ddcOn) this->seenOn = true;
+	else this->seenOff = true;
+	
+	return;
+}
+
+void PowerStateSource::countAvoided(unsigned int reads)
+{
+	this->avoidedReads += reads;
+	metrics::ddcReadsAvoided(reads);
+	
+	return;
+}
+
+uint64_t PowerStateSource::getAvoidedReads()
+{
+	return this->avoidedReads;
+}
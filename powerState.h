@@ -0,0 +1,86 @@
+/******************************************************************************
+/ Pi 4 Sunrise Clock App Display Power State Source Spec - lopezk38 2025
+/
+/*****************************************************************************/
+
+#ifndef SUNCLOCK_APP_POWERSTATE
+#define SUNCLOCK_APP_POWERSTATE
+
+/******************************************************************************
+/ Dependencies, namespacing
+/*****************************************************************************/
+
+#include <cstdint>
+#include <string>
+
+#include "errorcodes.h"
+
+
+/******************************************************************************
+/ Constants
+/*****************************************************************************/
+
+constexpr char POWER_STATE_DRM_PATH[] = "/sys/class/drm";
+constexpr unsigned int POWER_STATE_CROSSCHECK_INTERVAL = 8; //Every this many reads still goes to DDC to make sure the two agree
+
+namespace POWER_STATE
+{
+	enum CODE
+	{
+		UNKNOWN = 0,
+		ON = 1,
+		OFF = 2
+	};
+}
+
+
+/******************************************************************************
+/ Class specification
+/*****************************************************************************/
+
+//Reads a DRM connector's dpms and status attributes through persistent descriptors. Any directory holding
+//files named dpms and status works, so a pair of plain files can stand in for the connector
+class PowerStateSource
+{
+
+private:
+
+	const std::string path;
+	int dpmsDescriptor = -1;
+	int statusDescriptor = -1;
+	
+	//Not every monitor drops hotplug or follows DPMS when DDC powers it down. Only trust the connector once it has
+	//agreed with DDC in both states, and stop trusting it the first time it doesn't
+	bool seenOn = false;
+	bool seenOff = false;
+	bool contradicted = false;
+	unsigned int readsSinceCheck = 0;
+	
+	uint64_t avoidedReads = 0;
+	
+	bool errorState = false;
+	
+	POWERSTATE_ERR::CODE openConnector();
+	static bool readAttribute(int descriptor, char* buf, size_t length);
+
+public:
+
+	PowerStateSource(const std::string& path);
+	~PowerStateSource();
+	
+	//First connected card*-* connector under POWER_STATE_DRM_PATH. Empty if there isn't one
+	static std::string findConnector();
+	
+	bool isOpen();
+	
+	POWER_STATE::CODE read();
+	
+	//True when a read can stand in for DDC. Counts reads, so every POWER_STATE_CROSSCHECK_INTERVAL it says no anyway
+	bool canSkipDDC();
+	void crossCheck(POWER_STATE::CODE sourceState, bool ddcOn);
+	
+	void countAvoided(unsigned int reads);
+	uint64_t getAvoidedReads();
+};
+
+#endif
@@ -0,0 +1,243 @@
+/******************************************************************************
+/ Pi 4 Sunrise Clock App Light Sensor Benchmark - lopezk38 2025
+/
+/ Times one light sensor sample, the pread and the filtering both, against a
+/ plain lux file standing in for the IIO attribute. Then runs the clock's own
+/ tasks through a simulated day twice, once without the sensor and once with
+/ it reading a room that has daylight, passing clouds, noise and an evening
+/ lamp, and counts the DDC writes the monitor would have taken each time
+/
+/ Usage: sensorbench [--samples N] [--seed N] [--lux path]
+/
+/*****************************************************************************/
+
+/******************************************************************************
+/ Dependencies, namespacing
+/*****************************************************************************/
+
+#include <unistd.h>
+#include <fcntl.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <random>
+
+#include "clockConfig.h"
+#include "clockTasks.h"
+#include "dayPlan.h"
+#include "lightSensor.h"
+#include "logger.h"
+#include "metrics.h"
+#include "simulatedDisplay.h"
+#include "taskHeap.h"
+
+
+/******************************************************************************
+/ Constants
+/*****************************************************************************/
+
+constexpr long DEFAULT_SAMPLES = 200000;
+constexpr unsigned int DEFAULT_SEED = 1;
+constexpr long DAY_SECONDS = 24 * 60 * 60;
+
+//The simulated room
+constexpr double DAYLIGHT_PEAK_LUX = 600; //Indoors near a window at midday
+constexpr long SUNRISE_SECOND = 6 * 60 * 60;
+constexpr long SUNSET_SECOND = 20 * 60 * 60;
+constexpr double LAMP_LUX = 120;
+constexpr long LAMP_ON_SECOND = 18 * 60 * 60 + 30 * 60;
+constexpr long LAMP_OFF_SECOND = 23 * 60 * 60;
+constexpr double NIGHT_LUX = 0.5;
+constexpr double NOISE_FRACTION = 0.05; //Reading to reading jitter, as a fraction of the light
+constexpr double SPIKE_CHANCE = 0.001; //Someone walking past, or a reflection. The median should eat these
+constexpr double CLOUD_MIN = 0.3; //Fraction of daylight left under the thickest cloud
+
+
+/******************************************************************************
+/ Implementation
+/*****************************************************************************/
+
+struct dayResult
+{
+	uint64_t brightnessWrites = 0;
+	uint64_t otherWrites = 0;
+	uint64_t samples = 0;
+	uint64_t saves = 0;
+};
+
+//Fixed width, so each write covers the last one and the file never needs truncating
+bool writeLux(int descriptor, double lux)
+{
+	char buf[24];
+	int length = std::snprintf(buf, sizeof(buf), "%14.3f\n", lux);
+	
+	return pwrite(descriptor, buf, length, 0) == length;
+}
+
+class SimulatedRoom
+{
+
+private:
+
+	std::mt19937 rng;
+	std::normal_distribution<double> noise{1.0, NOISE_FRACTION};
+	std::uniform_real_distribution<double> unit{0.0, 1.0};
+	double cloud = 1;
+
+public:
+
+	SimulatedRoom(unsigned int seed): rng(seed) {}
+	
+	double luxAt(long secondOfDay)
+	{
+		//Clouds drift once a minute
+		if (secondOfDay % 60 == 0) this->cloud = std::clamp(this->cloud + (this->unit(this->rng) - 0.5) * 0.2, CLOUD_MIN, 1.0);
+		
+		double daylight = 0;
+		if (secondOfDay > SUNRISE_SECOND && secondOfDay < SUNSET_SECOND)
+		{
+			daylight = DAYLIGHT_PEAK_LUX * std::sin(M_PI * (secondOfDay - SUNRISE_SECOND) / (SUNSET_SECOND - SUNRISE_SECOND)) * this->cloud;
+		}
+		
+		double lamp = (secondOfDay >= LAMP_ON_SECOND && secondOfDay < LAMP_OFF_SECOND) ? LAMP_LUX : 0;
+		double lux = (NIGHT_LUX + daylight + lamp) * std::max(0.0, this->noise(this->rng));
+		if (this->unit(this->rng) < SPIKE_CHANCE) lux *= 3;
+		
+		return lux;
+	}
+};
+
+dayResult simulateDay(LightSensor* lightSensor, int luxDescriptor, SimulatedRoom& room)
+{
+	//Set up the way main.cpp does, with the settings it uses
+	DayPlan dayPlan(BRIGHTNESS_UPDATE_FREQ, PLAN_POWER_ON_LEAD, POWEROFF_ON_ZERO_BRIGHTNESS);
+	dayPlan.compile();
+	
+	SimulatedDisplay display;
+	clockState state;
+	state.display = &display;
+	state.wake.enabled = false;
+	state.lightSensor = lightSensor;
+	state.dayPlan = &dayPlan;
+	
+	tHeap::TaskHeap taskSchedule;
+	taskSchedule.reserve(STATEFILE_MAX_TASKS);
+	taskSchedule.setUniqueKey(tHeap::TASK::CODE::CHECK_SHOULD_TOGGLE_DISPLAY_PWR, true);
+	taskSchedule.setUniqueKey(tHeap::TASK::CODE::SET_BRIGHTNESS, true);
+	taskSchedule.setUniqueKey(tHeap::TASK::CODE::SAMPLE_LIGHT_SENSOR_AND_RESCHEDULE, true);
+	taskSchedule.setUniqueKey(tHeap::TASK::CODE::VERIFY_DISPLAY_PWR, true);
+	
+	long powerCheckPeriod = std::chrono::duration_cast<std::chrono::seconds>(POWERCHECK_UPDATE_FREQ).count();
+	if (POWEROFF_ON_ZERO_BRIGHTNESS) taskSchedule.pushPeriodicTask(powerCheckPeriod, powerCheckPeriod, tHeap::TASK::CODE::CHECK_SHOULD_TOGGLE_DISPLAY_PWR);
+	if (lightSensor) taskSchedule.pushPeriodicTask(0, LIGHT_SENSOR_SAMPLE_FREQ.count(), tHeap::TASK::CODE::SAMPLE_LIGHT_SENSOR_AND_RESCHEDULE);
+	
+	timeStruct midnight = {};
+	executeTask(taskSchedule, state, midnight, 0, tHeap::TASK::CODE::SET_BRIGHTNESS);
+	dayPlan.seek(0);
+	taskSchedule.pushTask(0, tHeap::TASK::CODE::CHECK_SHOULD_TOGGLE_DISPLAY_PWR);
+	
+	uint64_t samplesBefore = metrics::counters.tasksDispatched[tHeap::TASK::CODE::SAMPLE_LIGHT_SENSOR_AND_RESCHEDULE].load(std::memory_order_relaxed);
+	
+	dayResult result;
+	for (long secondOfDay = 0; secondOfDay < DAY_SECONDS; ++secondOfDay)
+	{
+		//The room changes whether or not anyone is looking
+		double lux = room.luxAt(secondOfDay);
+		if (lightSensor) writeLux(luxDescriptor, lux);
+		
+		timeStruct curTime = { secondOfDay / 3600, (secondOfDay / 60) % 60, secondOfDay % 60, 0 };
+		runTasks(taskSchedule, state, curTime, secondOfDay);
+		
+		if (state.stateDirty)
+		{
+			++result.saves;
+			state.stateDirty = false;
+		}
+	}
+	
+	result.brightnessWrites = display.getBrightnessWrites();
+	result.otherWrites = display.getOtherWrites();
+	result.samples = metrics::counters.tasksDispatched[tHeap::TASK::CODE::SAMPLE_LIGHT_SENSOR_AND_RESCHEDULE].load(std::memory_order_relaxed) - samplesBefore;
+	
+	return result;
+}
+
+int main(int argc, char* argv[])
+{
+	long samples = DEFAULT_SAMPLES;
+	unsigned int seed = DEFAULT_SEED;
+	const char* luxPath = "/tmp/sensorbench.lux";
+	
+	for (int i = 1; i < argc; ++i)
+	{
+		if (!std::strcmp(argv[i], "--samples") && i + 1 < argc) samples = std::atol(argv[++i]);
+		else if (!std::strcmp(argv[i], "--seed") && i + 1 < argc) seed = std::strtoul(argv[++i], nullptr, 10);
+		else if (!std::strcmp(argv[i], "--lux") && i + 1 < argc) luxPath = argv[++i];
+		else
+		{
+			std::cerr << "Usage: sensorbench [--samples N] [--seed N] [--lux path]" << std::endl;
+			return 1;
+		}
+	}
+	if (samples <= 0) samples = DEFAULT_SAMPLES;
+	
+	//The tasks log every power on. Only problems are worth seeing here
+	logger::setLevel(logger::LEVEL::CODE::WARNING);
+	
+	int luxDescriptor = open(luxPath, O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+	if (luxDescriptor == -1 || !writeLux(luxDescriptor, 250))
+	{
+		std::cerr << "ERROR: Failed to write the stand in lux file at " << luxPath << std::endl;
+		return 1;
+	}
+	
+	LightSensor lightSensor(luxPath);
+	if (!lightSensor.isOpen()) return 1;
+	
+	//Sampling overhead. The bare pread first, to split what the kernel costs from what the filter does
+	int readDescriptor = open(luxPath, O_RDONLY | O_CLOEXEC);
+	char buf[32];
+	auto start = std::chrono::steady_clock::now();
+	for (long i = 0; i < samples; ++i)
+	{
+		if (pread(readDescriptor, buf, sizeof(buf) - 1, 0) <= 0) return 1;
+	}
+	double preadNs = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / samples;
+	close(readDescriptor);
+	
+	unsigned int checksum = 0; //Keeps the adjustments from being optimized away
+	start = std::chrono::steady_clock::now();
+	for (long i = 0; i < samples; ++i)
+	{
+		if (lightSensor.sample() != SENSOR_ERR::CODE::SUCCESS) return 1;
+		checksum += lightSensor.adjustBrightness(i % 101);
+	}
+	double sampleNs = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / samples;
+	
+	double samplesPerDay = static_cast<double>(DAY_SECONDS) / LIGHT_SENSOR_SAMPLE_FREQ.count();
+	std::printf("%ld samples: %.0f ns each, %.0f ns of it the pread (checksum %u)\n", samples, sampleNs, preadNs, checksum);
+	std::printf("At one sample every %lld s that is %.1f ms of CPU a day\n\n", static_cast<long long>(LIGHT_SENSOR_SAMPLE_FREQ.count()), sampleNs * samplesPerDay / 1e6);
+	
+	//DDC writes over a day. Both runs see the same room, the first just can't
+	SimulatedRoom darkRoom(seed);
+	dayResult off = simulateDay(nullptr, luxDescriptor, darkRoom);
+	
+	SimulatedRoom litRoom(seed);
+	LightSensor daySensor(luxPath); //Fresh filter, so the overhead run doesn't carry in
+	dayResult on = simulateDay(&daySensor, luxDescriptor, litRoom);
+	close(luxDescriptor);
+	
+	std::printf("%-8s %12s %12s %10s %10s\n", "sensor", "brightness", "power/input", "samples", "saves");
+	std::printf("%-8s %12llu %12llu %10llu %10llu\n", "off", static_cast<unsigned long long>(off.brightnessWrites), static_cast<unsigned long long>(off.otherWrites),
+				static_cast<unsigned long long>(off.samples), static_cast<unsigned long long>(off.saves));
+	std::printf("%-8s %12llu %12llu %10llu %10llu\n", "on", static_cast<unsigned long long>(on.brightnessWrites), static_cast<unsigned long long>(on.otherWrites),
+				static_cast<unsigned long long>(on.samples), static_cast<unsigned long long>(on.saves));
+	std::printf("DDC writes per day. Brightness is looked at every %u samples and moves in steps of at least %u\n", LIGHT_SENSOR_BATCH, LIGHT_SENSOR_HYSTERESIS);
+	
+	return 0;
+}
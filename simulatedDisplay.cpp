@@ -0,0 +1,95 @@
+/******************************************************************************
+/ Pi 4 Sunrise Clock App Simulated Display Implementation - lopezk38 2025
+/
+/*****************************************************************************/
+
+/******************************************************************************
+/ Dependencies, namespacing
+/*****************************************************************************/
+
+#include "simulatedDisplay.h"
+
+
+/******************************************************************************
+/ Implementation
+/*****************************************************************************/
+
+bool SimulatedDisplay::isConnected()
+{
+	return true;
+}
+
+bool SimulatedDisplay::setBrightness(unsigned char brightness)
+{
+	this->brightness = brightness;
+	++this->brightnessWrites;
+	
+	return true;
+}
+
+bool SimulatedDisplay::setInput(unsigned char vcpInputCode)
+{
+	this->input = vcpInputCode;
+	++this->otherWrites;
+	
+	return true;
+}
+
+bool SimulatedDisplay::togglePower()
+{
+	this->on = !this->on;
+	++this->otherWrites;
+	
+	return true;
+}
+
+bool SimulatedDisplay::powerOn()
+{
+	//Same as over DDC, a display that is already on takes no write
+	if (this->on) return true;
+	
+	this->on = true;
+	++this->otherWrites;
+	
+	return true;
+}
+
+bool SimulatedDisplay::powerOff()
+{
+	if (!this->on) return true;
+	
+	this->on = false;
+	++this->otherWrites;
+	
+	return true;
+}
+
+bool SimulatedDisplay::isOn()
+{
+	return this->on;
+}
+
+bool SimulatedDisplay::isOnDDC()
+{
+	return this->on;
+}
+
+bool SimulatedDisplay::isReady(WAKE_PROBE::CODE)
+{
+	return true;
+}
+
+unsigned char SimulatedDisplay::getBrightness()
+{
+	return this->brightness;
+}
+
+uint64_t SimulatedDisplay::getBrightnessWrites()
+{
+	return this->brightnessWrites;
+}
+
+uint64_t SimulatedDisplay::getOtherWrites()
+{
+	return this->otherWrites;
+}
@@ -0,0 +1,57 @@
+/******************************************************************************
+/ Pi 4 Sunrise Clock App Simulated Display Spec - lopezk38 2025
+/
+/ A monitor for the headless tools to run the clock's tasks against. Takes
+/ every write, answers every read from what it was last told and counts the
+/ writes the real one would have had to take over DDC
+/
+/*****************************************************************************/
+
+#ifndef SUNCLOCK_APP_SIMULATEDDISPLAY
+#define SUNCLOCK_APP_SIMULATEDDISPLAY
+
+/******************************************************************************
+/ Dependencies, namespacing
+/*****************************************************************************/
+
+#include <cstdint>
+
+#include "clockTasks.h"
+
+
+/******************************************************************************
+/ Class specification
+/*****************************************************************************/
+
+class SimulatedDisplay : public DisplayControl
+{
+
+private:
+
+	bool on = true;
+	unsigned char brightness = 0;
+	unsigned char input = 0;
+	
+	uint64_t brightnessWrites = 0;
+	uint64_t otherWrites = 0; //Power and input
+
+public:
+
+	bool isConnected() override;
+	
+	bool setBrightness(unsigned char brightness) override;
+	bool setInput(unsigned char vcpInputCode) override;
+	bool togglePower() override;
+	bool powerOn() override;
+	bool powerOff() override;
+	
+	bool isOn() override;
+	bool isOnDDC() override;
+	bool isReady(WAKE_PROBE::CODE probe) override; //Always ready, the simulated day has no wake to wait out
+	
+	unsigned char getBrightness();
+	uint64_t getBrightnessWrites();
+	uint64_t getOtherWrites();
+};
+
+#endif
@@ -0,0 +1,236 @@
+/******************************************************************************
+/ Pi 4 Sunrise Clock App Sky Set Benchmark - lopezk38 2025
+/
+/ Packs a synthetic day of sky frames at 1080p and 4K, as RGBA and as 565,
+/ then walks the clock through the day crossfading them the way the layered
+/ face does. Reports how much of the mapped set ended up resident, what one
+/ crossfaded frame costs, and checks the SIMD blend against the scalar path
+/ bit for bit
+/
+/ Usage: skybench [--dir PATH] [--frames N]
+/
+/*****************************************************************************/
+
+/******************************************************************************
+/ Dependencies, namespacing
+/*****************************************************************************/
+
+#include <unistd.h>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "skySet.h"
+#include "pixelFormat.h"
+
+
+/******************************************************************************
+/ Constants
+/*****************************************************************************/
+
+struct resolution
+{
+	const char* name;
+	uint32_t width;
+	uint32_t height;
+};
+
+constexpr resolution RESOLUTIONS[] = { { "1080p", 1920, 1080 }, { "4K", 3840, 2160 } };
+constexpr pixel::FORMAT::CODE FORMATS[] = { pixel::FORMAT::CODE::XBGR8888, pixel::FORMAT::CODE::RGB565 };
+constexpr unsigned int DEFAULT_FRAMES = 6; //Sky frames in the set, evenly through the day
+constexpr long WALK_STEP = 15 * 60; //Seconds the clock moves between blends on the walk through the day
+constexpr uint32_t CHECK_WEIGHTS[] = { 0, 1, 97, 128, 255, 256 };
+constexpr unsigned int WARM_BLENDS = 20;
+
+
+/******************************************************************************
+/ Implementation
+/*****************************************************************************/
+
+size_t residentBytes()
+{
+	std::ifstream statm("/proc/self/statm");
+	size_t pages = 0;
+	size_t resident = 0;
+	statm >> pages >> resident;
+	
+	return resident * sysconf(_SC_PAGESIZE);
+}
+
+double toMB(size_t bytes)
+{
+	return bytes / (1024.0 * 1024.0);
+}
+
+void fillSky(std::vector<uint8_t>& frame, uint32_t width, uint32_t height, unsigned int index, unsigned int count)
+{
+	//A different tint per frame, with a little per pixel texture so no two rows blend the same
+	float phase = static_cast<float>(index) / count;
+	for (uint32_t y = 0; y < height; ++y)
+	{
+		float t = static_cast<float>(y) / height;
+		for (uint32_t x = 0; x < width; ++x)
+		{
+			uint8_t* pixel = &frame[(static_cast<size_t>(y) * width + x) * 4];
+			pixel[0] = static_cast<uint8_t>(20 + 200 * phase * (1 - t) + ((x * 7 + y * 13) & 0xF));
+			pixel[1] = static_cast<uint8_t>(30 + 120 * t + ((x * 11 + y * 3) & 0xF));
+			pixel[2] = static_cast<uint8_t>(220 - 180 * phase * t + ((x * 5 + y * 17) & 0xF));
+			pixel[3] = 0xFF;
+		}
+	}
+	
+	return;
+}
+
+bool packSet(const std::string& path, const resolution& res, pixel::FORMAT::CODE code, unsigned int count)
+{
+	pixel::format format = pixel::fromCode(code);
+	size_t pixels = static_cast<size_t>(res.width) * res.height;
+	std::vector<uint8_t> rgba(pixels * 4);
+	std::vector<std::vector<uint8_t>> packed(count);
+	std::vector<skySourceFrame> frames;
+	
+	//Same conversion skypack does, dithered at 565
+	for (unsigned int i = 0; i < count; ++i)
+	{
+		fillSky(rgba, res.width, res.height, i, count);
+		packed[i].resize(pixels * (format.bitsPerPixel / 8));
+		pixel::convert(rgba.data(), res.width * 4, packed[i].data(), res.width * (format.bitsPerPixel / 8), format, res.width, res.height, pixel::wantsDither(format));
+		frames.push_back({ static_cast<long>(i) * 24 * 3600 / count, packed[i].data() });
+	}
+	
+	return SkySet::write(path, res.width, res.height, code, frames) == SKYSET_ERR::CODE::SUCCESS;
+}
+
+void blendFrame(bool simd, const SkySet& set, uint32_t from, uint32_t to, uint32_t weight, std::vector<uint8_t>& target, uint32_t rowWidth)
+{
+	const uint8_t* fromFrame = set.getFrame(from);
+	const uint8_t* toFrame = set.getFrame(to);
+	
+	for (uint32_t y = 0; y < set.getHeight(); ++y)
+	{
+		size_t offset = y * set.getStride();
+		uint8_t* out = target.data() + static_cast<size_t>(y) * set.getWidth() * 4;
+		
+		if (simd) pixel::crossfade(fromFrame + offset, toFrame + offset, set.getFormat(), out, rowWidth, weight);
+		else pixel::crossfadeScalar(fromFrame + offset, toFrame + offset, set.getFormat(), out, rowWidth, weight);
+	}
+	
+	return;
+}
+
+double timeBlends(bool simd, const SkySet& set, uint32_t from, uint32_t to, std::vector<uint8_t>& target, unsigned int blends)
+{
+	auto start = std::chrono::steady_clock::now();
+	for (unsigned int i = 0; i < blends; ++i) blendFrame(simd, set, from, to, (i * 13) % 257, target, set.getWidth());
+	
+	return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count() / blends;
+}
+
+int main(int argc, char* argv[])
+{
+	std::string directory = "/tmp";
+	unsigned int frameCount = DEFAULT_FRAMES;
+	
+	for (int i = 1; i < argc; ++i)
+	{
+		if (!std::strcmp(argv[i], "--dir") && i + 1 < argc) directory = argv[++i];
+		else if (!std::strcmp(argv[i], "--frames") && i + 1 < argc) frameCount = std::atoi(argv[++i]);
+		else
+		{
+			std::cerr << "Usage: skybench [--dir PATH] [--frames N]" << std::endl;
+			return 1;
+		}
+	}
+	if (frameCount < 2 || frameCount > SKYSET_MAX_FRAMES) frameCount = DEFAULT_FRAMES;
+	
+	std::cout << "Kernels: " << pixel::kernelName() << ", " << frameCount << " frames per set, a blend every " << WALK_STEP / 60 << " minutes through the day" << std::endl;
+	std::printf("%-6s %-9s %9s %9s %10s %10s %10s %10s %8s\n", "res", "format", "set MB", "pair MB", "peak RSS", "walk ms", "blend ms", "scalar ms", "speedup");
+	
+	bool failed = false;
+	
+	for (const resolution& res : RESOLUTIONS)
+	{
+		for (pixel::FORMAT::CODE code : FORMATS)
+		{
+			std::string path = directory + "/skybench-" + res.name + "-" + pixel::toString(code) + ".sky";
+			if (!packSet(path, res, code, frameCount))
+			{
+				std::cerr << "ERROR: Failed to pack " << path << std::endl;
+				return 1;
+			}
+			
+			//Output touched first, so the growth from here on is the mapped frames alone
+			std::vector<uint8_t> target(static_cast<size_t>(res.width) * res.height * 4, 0);
+			std::vector<uint8_t> reference(target.size(), 0);
+			
+			SkySet set(path);
+			if (!set.isOpen())
+			{
+				unlink(path.c_str());
+				return 1;
+			}
+			
+			size_t baseline = residentBytes();
+			size_t peak = 0;
+			uint32_t from;
+			uint32_t to;
+			uint32_t weight;
+			
+			//Walk the day. Blends that start a new pair pay for faulting its frames in
+			auto walkStart = std::chrono::steady_clock::now();
+			unsigned int walkBlends = 0;
+			for (long second = 0; second < 24 * 3600; second += WALK_STEP, ++walkBlends)
+			{
+				set.select(second, from, to, weight);
+				blendFrame(true, set, from, to, weight, target, res.width);
+				
+				size_t resident = residentBytes();
+				if (resident > baseline && resident - baseline > peak) peak = resident - baseline;
+			}
+			double walkMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - walkStart).count() / walkBlends;
+			
+			//Then the steady cost, on a pair already resident
+			set.select(0, from, to, weight);
+			double simdMs = timeBlends(true, set, from, to, target, WARM_BLENDS);
+			double scalarMs = timeBlends(false, set, from, to, reference, WARM_BLENDS);
+			
+			//Full rows and rows cut short, so the scalar tail after the vectors gets checked too
+			for (uint32_t checkWeight : CHECK_WEIGHTS)
+			{
+				for (uint32_t rowWidth : { res.width, res.width - 3 })
+				{
+					blendFrame(true, set, from, to, checkWeight, target, rowWidth);
+					blendFrame(false, set, from, to, checkWeight, reference, rowWidth);
+					
+					if (std::memcmp(target.data(), reference.data(), target.size()))
+					{
+						std::cerr << "ERROR: " << pixel::kernelName() << " blend differs from scalar for " << pixel::toString(code) << " at " << res.name
+								  << ", weight " << checkWeight << ", " << rowWidth << " px rows" << std::endl;
+						failed = true;
+					}
+				}
+			}
+			
+			size_t frameBytes = set.getStride() * set.getHeight();
+			std::printf("%-6s %-9s %9.1f %9.1f %10.1f %10.2f %10.2f %10.2f %7.1fx\n", res.name, pixel::toString(code), toMB(frameBytes * frameCount),
+						toMB(frameBytes * 2), toMB(peak), walkMs, simdMs, scalarMs, scalarMs / simdMs);
+			
+			//Never more than the pair, give or take a page table
+			if (peak > frameBytes * 2 + frameBytes / 8)
+			{
+				std::cerr << "ERROR: " << toMB(peak) << " MB of the " << res.name << " " << pixel::toString(code) << " set stayed resident, more than the two frames in use" << std::endl;
+				failed = true;
+			}
+			
+			unlink(path.c_str());
+		}
+	}
+	
+	return failed ? 1 : 0;
+}
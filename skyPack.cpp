@@ -0,0 +1,110 @@
+/******************************************************************************
+/ Pi 4 Sunrise Clock App Sky Set Packer - lopezk38 2025
+/
+/ Decodes sky photos once, on whatever machine is handy, into the raw frame
+/ file the clock maps. Each photo is tagged with the time of day it shows and
+/ resized to the screen. --565 halves the set with dithering, worth it at 4K
+/
+/ Usage: skypack [--565] --size WxH OUT.sky HH:MM=photo.png [HH:MM=photo.jpg ...]
+/
+/*****************************************************************************/
+
+/******************************************************************************
+/ Dependencies, namespacing
+/*****************************************************************************/
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "raylib.h"
+#include "skySet.h"
+#include "pixelFormat.h"
+
+
+/******************************************************************************
+/ Implementation
+/*****************************************************************************/
+
+void usage()
+{
+	std::cerr << "Usage: skypack [--565] --size WxH OUT.sky HH:MM=photo.png [HH:MM=photo.jpg ...]" << std::endl;
+	
+	return;
+}
+
+int main(int argc, char* argv[])
+{
+	pixel::FORMAT::CODE code = pixel::FORMAT::CODE::XBGR8888;
+	unsigned int width = 0;
+	unsigned int height = 0;
+	const char* outPath = nullptr;
+	std::vector<const char*> photoArgs;
+	
+	for (int i = 1; i < argc; ++i)
+	{
+		if (!std::strcmp(argv[i], "--565")) code = pixel::FORMAT::CODE::RGB565;
+		else if (!std::strcmp(argv[i], "--size") && i + 1 < argc)
+		{
+			if (std::sscanf(argv[++i], "%ux%u", &width, &height) != 2) width = height = 0;
+		}
+		else if (!outPath) outPath = argv[i];
+		else photoArgs.push_back(argv[i]);
+	}
+	
+	if (!outPath || !width || !height || photoArgs.empty() || photoArgs.size() > SKYSET_MAX_FRAMES)
+	{
+		usage();
+		return 1;
+	}
+	
+	pixel::format format = pixel::fromCode(code);
+	size_t frameStride = static_cast<size_t>(width) * (format.bitsPerPixel / 8);
+	std::vector<std::vector<uint8_t>> packed(photoArgs.size());
+	std::vector<skySourceFrame> frames;
+	
+	for (size_t i = 0; i < photoArgs.size(); ++i)
+	{
+		unsigned int hour;
+		unsigned int minute;
+		int nameStart = 0;
+		if (std::sscanf(photoArgs[i], "%u:%u=%n", &hour, &minute, &nameStart) != 2 || !nameStart || hour > 23 || minute > 59)
+		{
+			usage();
+			return 1;
+		}
+		
+		const char* photoPath = photoArgs[i] + nameStart;
+		Image photo = LoadImage(photoPath);
+		if (!photo.data)
+		{
+			std::cerr << "ERROR: Failed to decode " << photoPath << std::endl;
+			return 1;
+		}
+		
+		//Straight to the screen size, so the clock never scales anything
+		ImageFormat(&photo, PIXELFORMAT_UNCOMPRESSED_R8G8B8A8);
+		if (photo.width != static_cast<int>(width) || photo.height != static_cast<int>(height)) ImageResize(&photo, width, height);
+		
+		packed[i].resize(frameStride * height);
+		pixel::convert(static_cast<const uint8_t*>(photo.data), static_cast<size_t>(width) * 4, packed[i].data(), frameStride, format, width, height, pixel::wantsDither(format));
+		UnloadImage(photo);
+		
+		frames.push_back({ static_cast<long>(hour) * 3600 + minute * 60, packed[i].data() });
+		
+		std::cout << "Packed " << photoPath << " at " << hour << ":" << (minute < 10 ? "0" : "") << minute << std::endl;
+	}
+	
+	if (SkySet::write(outPath, width, height, code, frames) != SKYSET_ERR::CODE::SUCCESS)
+	{
+		std::cerr << "ERROR: Failed to write " << outPath << ". Two photos for the same time?" << std::endl;
+		return 1;
+	}
+	
+	std::cout << "Wrote " << frames.size() << " " << width << "x" << height << " " << pixel::toString(code) << " frames to " << outPath << std::endl;
+	
+	return 0;
+}
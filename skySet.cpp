@@ -0,0 +1,274 @@
+/******************************************************************************
+/ Pi 4 Sunrise Clock App Sky Image Set Implementation - lopezk38 2025
+/
+/*****************************************************************************/
+
+/******************************************************************************
+/ Dependencies, namespacing
+/*****************************************************************************/
+
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <algorithm>
+#include <cstdio>
+
+#include "skySet.h"
+#include "logger.h"
+
+
+/******************************************************************************
+/ Helpers
+/*****************************************************************************/
+
+constexpr long SECONDS_PER_DAY = 24 * 60 * 60;
+
+static size_t bytesPerPixel(uint32_t format)
+{
+	switch (format)
+	{
+		case pixel::FORMAT::CODE::XBGR8888: return 4;
+		case pixel::FORMAT::CODE::RGB565: return 2;
+		default: return 0; //Nothing else crossfades
+	}
+}
+
+static size_t alignUp(size_t bytes)
+{
+	return (bytes + SKYSET_FRAME_ALIGN - 1) / SKYSET_FRAME_ALIGN * SKYSET_FRAME_ALIGN;
+}
+
+//A 4K frame is tens of megabytes, more than one write is guaranteed to take
+static bool writeAll(int descriptor, const uint8_t* data, size_t bytes, off_t offset)
+{
+	while (bytes)
+	{
+		ssize_t written = pwrite(descriptor, data, bytes, offset);
+		if (written <= 0) return false;
+		
+		data += written;
+		bytes -= written;
+		offset += written;
+	}
+	
+	return true;
+}
+
+
+/******************************************************************************
+/ Class implementation
+/*****************************************************************************/
+
+SkySet::SkySet(const std::string& path): path(path)
+{
+	//Sky images are optional. Without them the face falls back to the gradient
+	if (openSet() != SKYSET_ERR::CODE::SUCCESS) this->errorState = true;
+	
+	return;
+}
+
+SkySet::~SkySet()
+{
+	if (this->mapping) munmap(this->mapping, this->mappedBytes);
+	if (this->descriptor != -1) close(this->descriptor);
+	
+	return;
+}
+
+SKYSET_ERR::CODE SkySet::openSet()
+{
+	this->descriptor = open(this->path.c_str(), O_RDONLY | O_CLOEXEC);
+	if (this->descriptor == -1)
+	{
+		logger::error("Failed to open sky set {}", this->path);
+		return SKYSET_ERR::CODE::OPEN_FAIL;
+	}
+	
+	struct stat fileInfo;
+	if (fstat(this->descriptor, &fileInfo) || pread(this->descriptor, &this->header, sizeof(this->header), 0) != sizeof(this->header))
+	{
+		logger::error("Failed to read sky set {}", this->path);
+		return SKYSET_ERR::CODE::RD_FAIL;
+	}
+	
+	const skySetHeader& head = this->header;
+	size_t pixelBytes = bytesPerPixel(head.format);
+	bool valid = head.magic == SKYSET_MAGIC && head.version == SKYSET_VERSION && pixelBytes && head.width && head.height &&
+				 head.frameCount && head.frameCount <= SKYSET_MAX_FRAMES && head.frameBytes == static_cast<uint64_t>(head.width) * head.height * pixelBytes;
+	
+	//Every frame has to be whole, aligned, and later in the day than the one before
+	for (uint32_t i = 0; valid && i < head.frameCount; ++i)
+	{
+		const skyFrameEntry& frame = head.frames[i];
+		valid = frame.offset % SKYSET_FRAME_ALIGN == 0 && frame.offset >= SKYSET_FRAME_ALIGN && frame.offset + head.frameBytes <= static_cast<uint64_t>(fileInfo.st_size) &&
+				frame.secondOfDay < SECONDS_PER_DAY && (i == 0 || frame.secondOfDay > head.frames[i - 1].secondOfDay);
+	}
+	
+	if (!valid)
+	{
+		logger::error("{} is not a usable sky set", this->path);
+		return SKYSET_ERR::CODE::BAD_FILE;
+	}
+	
+	void* mapped = mmap(nullptr, fileInfo.st_size, PROT_READ, MAP_SHARED, this->descriptor, 0);
+	if (mapped == MAP_FAILED)
+	{
+		logger::error("Failed to map sky set {}", this->path);
+		return SKYSET_ERR::CODE::MAP_FAIL;
+	}
+	this->mapping = static_cast<uint8_t*>(mapped);
+	this->mappedBytes = fileInfo.st_size;
+	
+	//No readahead. Faulting in one frame would otherwise drag the start of the next one in behind it
+	madvise(this->mapping, this->mappedBytes, MADV_RANDOM);
+	
+	this->frameFormat = pixel::fromCode(static_cast<pixel::FORMAT::CODE>(head.format));
+	
+	logger::verbose("Mapped sky set {}: {} frames of {}x{} {}, {} MB", this->path, head.frameCount, head.width, head.height,
+					pixel::toString(this->frameFormat.code), this->mappedBytes / (1024 * 1024));
+	
+	return SKYSET_ERR::CODE::SUCCESS;
+}
+
+bool SkySet::isOpen() const
+{
+	return !this->errorState;
+}
+
+void SkySet::advise(uint32_t frame, bool wanted)
+{
+	uint8_t* start = this->mapping + this->header.frames[frame].offset;
+	
+	if (wanted)
+	{
+		madvise(start, this->header.frameBytes, MADV_WILLNEED);
+		return;
+	}
+	
+	//Out of this process, then out of the page cache too. Nothing reads a frame again until tomorrow
+	madvise(start, this->header.frameBytes, MADV_DONTNEED);
+	posix_fadvise(this->descriptor, this->header.frames[frame].offset, this->header.frameBytes, POSIX_FADV_DONTNEED);
+	
+	return;
+}
+
+void SkySet::select(long secondOfDay, uint32_t& from, uint32_t& to, uint32_t& weight)
+{
+	if (this->errorState)
+	{
+		from = to = NO_FRAME;
+		weight = 0;
+		return;
+	}
+	
+	const skySetHeader& head = this->header;
+	secondOfDay = ((secondOfDay % SECONDS_PER_DAY) + SECONDS_PER_DAY) % SECONDS_PER_DAY;
+	
+	//Last frame at or before now. Before the day's first frame that's still last night's final one
+	uint32_t current = head.frameCount - 1;
+	for (uint32_t i = 0; i < head.frameCount && head.frames[i].secondOfDay <= secondOfDay; ++i) current = i;
+	uint32_t next = (current + 1) % head.frameCount;
+	
+	long span = (static_cast<long>(head.frames[next].secondOfDay) - head.frames[current].secondOfDay + SECONDS_PER_DAY) % SECONDS_PER_DAY;
+	long elapsed = (secondOfDay - head.frames[current].secondOfDay + SECONDS_PER_DAY) % SECONDS_PER_DAY;
+	
+	from = current;
+	to = next;
+	weight = span ? elapsed * 256 / span : 0; //A single frame set never blends
+	
+	if (from == this->pagedFrom && to == this->pagedTo) return;
+	
+	advise(from, true);
+	if (to != from) advise(to, true);
+	if (this->pagedFrom != NO_FRAME && this->pagedFrom != from && this->pagedFrom != to) advise(this->pagedFrom, false);
+	if (this->pagedTo != NO_FRAME && this->pagedTo != from && this->pagedTo != to && this->pagedTo != this->pagedFrom) advise(this->pagedTo, false);
+	
+	logger::verbose("Sky set now crossfading frame {} into {}", from, to);
+	
+	this->pagedFrom = from;
+	this->pagedTo = to;
+	
+	return;
+}
+
+const uint8_t* SkySet::getFrame(uint32_t index) const
+{
+	if (this->errorState || index >= this->header.frameCount) return nullptr;
+	
+	return this->mapping + this->header.frames[index].offset;
+}
+
+const pixel::format& SkySet::getFormat() const
+{
+	return this->frameFormat;
+}
+
+size_t SkySet::getStride() const
+{
+	return this->header.width * bytesPerPixel(this->header.format);
+}
+
+uint32_t SkySet::getWidth() const
+{
+	return this->header.width;
+}
+
+uint32_t SkySet::getHeight() const
+{
+	return this->header.height;
+}
+
+uint32_t SkySet::getFrameCount() const
+{
+	return this->header.frameCount;
+}
+
+SKYSET_ERR::CODE SkySet::write(const std::string& path, uint32_t width, uint32_t height, pixel::FORMAT::CODE format, std::vector<skySourceFrame> frames)
+{
+	size_t pixelBytes = bytesPerPixel(format);
+	if (!pixelBytes || !width || !height || frames.empty() || frames.size() > SKYSET_MAX_FRAMES) return SKYSET_ERR::CODE::BAD_FILE;
+	
+	for (skySourceFrame& frame : frames) frame.secondOfDay = ((frame.secondOfDay % SECONDS_PER_DAY) + SECONDS_PER_DAY) % SECONDS_PER_DAY;
+	std::sort(frames.begin(), frames.end(), [](const skySourceFrame& a, const skySourceFrame& b) { return a.secondOfDay < b.secondOfDay; });
+	
+	skySetHeader header = {};
+	header.magic = SKYSET_MAGIC;
+	header.version = SKYSET_VERSION;
+	header.width = width;
+	header.height = height;
+	header.format = format;
+	header.frameCount = frames.size();
+	header.frameBytes = static_cast<uint64_t>(width) * height * pixelBytes;
+	
+	for (uint32_t i = 0; i < header.frameCount; ++i)
+	{
+		if (i && frames[i].secondOfDay == frames[i - 1].secondOfDay) return SKYSET_ERR::CODE::BAD_FILE; //Two frames for one moment
+		
+		header.frames[i].secondOfDay = frames[i].secondOfDay;
+		header.frames[i].offset = SKYSET_FRAME_ALIGN + i * alignUp(header.frameBytes);
+	}
+	
+	//Write a temporary and rename over the old one, so a running clock never maps half a set
+	std::string tempPath = path + ".tmp";
+	int descriptor = open(tempPath.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+	if (descriptor == -1)
+	{
+		logger::error("Failed to write sky set {}", tempPath);
+		return SKYSET_ERR::CODE::OPEN_FAIL;
+	}
+	
+	bool written = writeAll(descriptor, reinterpret_cast<const uint8_t*>(&header), sizeof(header), 0);
+	for (uint32_t i = 0; written && i < header.frameCount; ++i) written = writeAll(descriptor, frames[i].pixels, header.frameBytes, header.frames[i].offset);
+	written = written && fsync(descriptor) == 0;
+	close(descriptor);
+	
+	if (!written || std::rename(tempPath.c_str(), path.c_str()))
+	{
+		logger::error("Failed to write sky set {}", path);
+		unlink(tempPath.c_str());
+		return SKYSET_ERR::CODE::WR_FAIL;
+	}
+	
+	return SKYSET_ERR::CODE::SUCCESS;
+}
@@ -0,0 +1,118 @@
+/******************************************************************************
+/ Pi 4 Sunrise Clock App Sky Image Set Spec - lopezk38 2025
+/
+/ A day of sky photos, decoded ahead of time into one file of raw frames that
+/ gets mapped instead of read. Decoding a 4K PNG on the Pi takes longer than
+/ the crossfade it feeds, and would need every frame in memory at once. Only
+/ the two frames either side of the time are ever paged in, the pair before
+/ is handed back to the kernel when the clock moves on
+/
+/*****************************************************************************/
+
+#ifndef SUNCLOCK_APP_SKYSET
+#define SUNCLOCK_APP_SKYSET
+
+/******************************************************************************
+/ Dependencies, namespacing
+/*****************************************************************************/
+
+#include <cstdint>
+#include <cstddef>
+#include <string>
+#include <vector>
+
+#include "pixelFormat.h"
+#include "errorcodes.h"
+
+
+/******************************************************************************
+/ Constants, file layout
+/*****************************************************************************/
+
+constexpr uint32_t SKYSET_MAGIC = 0x53594B53; //"SKYS"
+constexpr uint32_t SKYSET_VERSION = 1;
+constexpr uint32_t SKYSET_MAX_FRAMES = 96; //One every quarter hour
+constexpr size_t SKYSET_FRAME_ALIGN = 65536; //Largest page an arm64 kernel uses, so every frame can be advised on its own
+
+struct skyFrameEntry
+{
+	uint32_t secondOfDay;
+	uint32_t reserved;
+	uint64_t offset; //From the start of the file. A multiple of SKYSET_FRAME_ALIGN
+};
+
+//Fixed size, at the start of the file. Frames follow, sorted by time of day, each padded out to the alignment
+struct skySetHeader
+{
+	uint32_t magic;
+	uint32_t version;
+	uint32_t width;
+	uint32_t height;
+	uint32_t format; //pixel::FORMAT::CODE. XBGR8888 (RGBA in memory order) or RGB565
+	uint32_t frameCount;
+	uint64_t frameBytes; //Rows are packed, no padding
+	skyFrameEntry frames[SKYSET_MAX_FRAMES];
+};
+
+static_assert(sizeof(skySetHeader) <= SKYSET_FRAME_ALIGN, "Sky set header must fit before the first frame");
+
+//One frame to pack. Pixels are already in the set's format, rows packed
+struct skySourceFrame
+{
+	long secondOfDay;
+	const uint8_t* pixels;
+};
+
+
+/******************************************************************************
+/ Class specification
+/*****************************************************************************/
+
+class SkySet
+{
+
+private:
+
+	const std::string path;
+	int descriptor = -1;
+	uint8_t* mapping = nullptr;
+	size_t mappedBytes = 0;
+	skySetHeader header = {};
+	pixel::format frameFormat;
+	
+	uint32_t pagedFrom = NO_FRAME; //The pair select last handed out
+	uint32_t pagedTo = NO_FRAME;
+	
+	bool errorState = false;
+	
+	SKYSET_ERR::CODE openSet();
+	void advise(uint32_t frame, bool wanted);
+
+public:
+
+	static constexpr uint32_t NO_FRAME = UINT32_MAX;
+	
+	SkySet(const std::string& path);
+	~SkySet();
+	
+	SkySet(const SkySet&) = delete;
+	SkySet& operator=(const SkySet&) = delete;
+	
+	bool isOpen() const;
+	
+	//Finds the frames either side of a time of day and how far it is from the first to the second, 0-256
+	//A new pair is paged in ahead of the blend and the frames only the old pair used are dropped
+	void select(long secondOfDay, uint32_t& from, uint32_t& to, uint32_t& weight);
+	
+	const uint8_t* getFrame(uint32_t index) const; //Nullptr past the last frame
+	const pixel::format& getFormat() const;
+	size_t getStride() const;
+	uint32_t getWidth() const;
+	uint32_t getHeight() const;
+	uint32_t getFrameCount() const;
+	
+	//Packs frames into a set at path, replacing whatever was there
+	static SKYSET_ERR::CODE write(const std::string& path, uint32_t width, uint32_t height, pixel::FORMAT::CODE format, std::vector<skySourceFrame> frames);
+};
+
+#endif
@@ -0,0 +1,176 @@
+/******************************************************************************
+/ Pi 4 Sunrise Clock App Persisted State File Implementation - lopezk38 2025
+/
+/*****************************************************************************/
+
+/******************************************************************************
+/ Dependencies, namespacing
+/*****************************************************************************/
+
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <cstring>
+#include <cstddef>
+
+#include "stateFile.h"
+#include "logger.h"
+
+
+/******************************************************************************
+/ Helper implementations
+/*****************************************************************************/
+
+bool monitorIdentity::operator==(const monitorIdentity& rhs) const
+{
+	return !std::memcmp(this->mfgId, rhs.mfgId, sizeof(this->mfgId))
+		&& !std::memcmp(this->modelName, rhs.modelName, sizeof(this->modelName))
+		&& !std::memcmp(this->serial, rhs.serial, sizeof(this->serial))
+		&& this->productCode == rhs.productCode;
+}
+
+uint64_t StateFile::checksum(const persistedSlot& slot)
+{
+	//FNV-1a over everything before the checksum field
+	const unsigned char* bytes = reinterpret_cast<const unsigned char*>(&slot);
+	uint64_t hash = 0xCBF29CE484222325;
+	
+	for (size_t i = 0; i < offsetof(persistedSlot, checksum); ++i)
+	{
+		hash ^= bytes[i];
+		hash *= 0x100000001B3;
+	}
+	
+	return hash;
+}
+
+
+/******************************************************************************
+/ Class implementation
+/*****************************************************************************/
+
+StateFile::StateFile(const std::string& path): path(path)
+{
+	//Persistence is optional. Failing here just means every start is a cold start
+	if (openStateFile() != STATEFILE_ERR::CODE::SUCCESS || mapStateFile() != STATEFILE_ERR::CODE::SUCCESS)
+	{
+		errorState = true;
+		logger::warning("State file is unavailable, warm restarts are disabled");
+	}
+	
+	return;
+}
+
+StateFile::~StateFile()
+{
+	if (this->mapping)
+	{
+		//The one wait for the card, at shutdown where nothing is drawing. Saves only schedule their writeback
+		if (msync(this->mapping, sizeof(persistedFile), MS_SYNC)) logger::error("Failed to flush state file at {}", this->path);
+		munmap(this->mapping, sizeof(persistedFile));
+	}
+	if (this->descriptor != -1) close(this->descriptor);
+	
+	return;
+}
+
+STATEFILE_ERR::CODE StateFile::openStateFile()
+{
+	this->descriptor = open(this->path.c_str(), O_RDWR | O_CREAT, 0644);
+	
+	if (this->descriptor == -1)
+	{
+		logger::error("Failed to open state file at {}", this->path);
+		return STATEFILE_ERR::CODE::OPEN_FAIL;
+	}
+	
+	//Size the file to the layout. A fresh file reads back as zeroes, which fails the magic check
+	struct stat fileInfo;
+	if (fstat(this->descriptor, &fileInfo) || (fileInfo.st_size != sizeof(persistedFile) && ftruncate(this->descriptor, sizeof(persistedFile))))
+	{
+		logger::error("Failed to size state file at {}", this->path);
+		return STATEFILE_ERR::CODE::OPEN_FAIL;
+	}
+	
+	return STATEFILE_ERR::CODE::SUCCESS;
+}
+
+STATEFILE_ERR::CODE StateFile::mapStateFile()
+{
+	void* map = mmap(nullptr, sizeof(persistedFile), PROT_READ | PROT_WRITE, MAP_SHARED, this->descriptor, 0);
+	
+	if (map == MAP_FAILED)
+	{
+		logger::error("Failed to map state file at {}", this->path);
+		return STATEFILE_ERR::CODE::MAP_FAIL;
+	}
+	
+	this->mapping = static_cast<persistedFile*>(map);
+	
+	logger::verbose("Mapped state file at {}", this->path);
+	
+	return STATEFILE_ERR::CODE::SUCCESS;
+}
+
+bool StateFile::isOpen()
+{
+	return !this->errorState;
+}
+
+STATEFILE_ERR::CODE StateFile::load(persistedState& out)
+{
+	if (this->errorState) return STATEFILE_ERR::CODE::OPEN_FAIL;
+	
+	if (this->mapping->magic != STATEFILE_MAGIC || this->mapping->version != STATEFILE_VERSION) return STATEFILE_ERR::CODE::NO_VALID_STATE;
+	
+	//Pick the newest slot that passes its checksum. The other one is the fallback if the last write was torn
+	int newest = -1;
+	for (unsigned int i = 0; i < 2; ++i)
+	{
+		const persistedSlot& slot = this->mapping->slots[i];
+		if (slot.sequence == 0 || slot.checksum != checksum(slot)) continue;
+		if (newest == -1 || slot.sequence > this->mapping->slots[newest].sequence) newest = i;
+	}
+	
+	if (newest == -1) return STATEFILE_ERR::CODE::NO_VALID_STATE;
+	
+	//Keep writing after the slot we loaded from so it stays intact until the next save lands
+	this->lastSlot = newest;
+	this->lastSequence = this->mapping->slots[newest].sequence;
+	
+	out = this->mapping->slots[newest].state;
+	if (out.taskCount > STATEFILE_MAX_TASKS) out.taskCount = STATEFILE_MAX_TASKS;
+	
+	return STATEFILE_ERR::CODE::SUCCESS;
+}
+
+STATEFILE_ERR::CODE StateFile::save(const persistedState& in)
+{
+	if (this->errorState) return STATEFILE_ERR::CODE::OPEN_FAIL;
+	
+	//Always write the slot we did not write last
+	unsigned int slotIndex = this->lastSlot ^ 1;
+	persistedSlot& slot = this->mapping->slots[slotIndex];
+	
+	//A crash or power loss part way through leaves this slot failing its checksum, and load() falls back to the other one
+	slot.state = in;
+	slot.sequence = this->lastSequence + 1;
+	slot.checksum = checksum(slot);
+	
+	//Header last. A fresh file has no valid slots, so it does not matter if this lands before the slot does
+	this->mapping->magic = STATEFILE_MAGIC;
+	this->mapping->version = STATEFILE_VERSION;
+	
+	//Start the writeback without waiting on it. This runs on the render thread, and an SD card can take a long time to finish
+	if (msync(this->mapping, sizeof(persistedFile), MS_ASYNC))
+	{
+		logger::error("Failed to flush state file at {}", this->path);
+		return STATEFILE_ERR::CODE::SYNC_FAIL;
+	}
+	
+	this->lastSlot = slotIndex;
+	this->lastSequence = slot.sequence;
+	
+	return STATEFILE_ERR::CODE::SUCCESS;
+}
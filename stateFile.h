@@ -0,0 +1,109 @@
+/******************************************************************************
+/ Pi 4 Sunrise Clock App Persisted State File Class Spec - lopezk38 2025
+/
+/*****************************************************************************/
+
+#ifndef SUNCLOCK_APP_STATEFILE
+#define SUNCLOCK_APP_STATEFILE
+
+/******************************************************************************
+/ Dependencies, namespacing
+/*****************************************************************************/
+
+#include <cstdint>
+#include <string>
+
+#include "errorcodes.h"
+
+
+/******************************************************************************
+/ Persisted data layout
+/*****************************************************************************/
+
+//Layout is written straight to disk, so bump this whenever a struct below changes
+constexpr uint32_t STATEFILE_MAGIC = 0x534B4C43; //"CLKS"
+constexpr uint32_t STATEFILE_VERSION = 1;
+constexpr unsigned int STATEFILE_MAX_TASKS = 32;
+
+struct monitorIdentity
+{
+	char mfgId[4];
+	char modelName[14];
+	char serial[14];
+	uint16_t productCode;
+	
+	bool operator==(const monitorIdentity& rhs) const;
+};
+
+struct persistedTask
+{
+	int64_t scheduledTime;
+	int32_t task;
+	int32_t reserved;
+};
+
+struct persistedState
+{
+	int64_t savedAt; //Wall clock seconds since epoch
+	
+	monitorIdentity monitor;
+	uint8_t monitorKnown;
+	
+	uint8_t brightness;
+	uint8_t powerOn;
+	uint8_t input;
+	
+	uint32_t taskCount;
+	persistedTask tasks[STATEFILE_MAX_TASKS];
+};
+
+struct persistedSlot
+{
+	uint64_t sequence; //Newest valid slot wins
+	persistedState state;
+	uint64_t checksum; //Covers sequence and state
+};
+
+struct persistedFile
+{
+	uint32_t magic;
+	uint32_t version;
+	persistedSlot slots[2]; //Written alternately so a torn write always leaves the previous slot intact
+};
+
+
+/******************************************************************************
+/ Class specification
+/*****************************************************************************/
+
+class StateFile
+{
+	
+private:
+	
+	const std::string path;
+	int descriptor = -1;
+	persistedFile* mapping = nullptr;
+	
+	uint64_t lastSequence = 0;
+	unsigned int lastSlot = 1;
+	
+	bool errorState = false;
+	
+	STATEFILE_ERR::CODE openStateFile();
+	STATEFILE_ERR::CODE mapStateFile();
+	
+	static uint64_t checksum(const persistedSlot& slot);
+	
+public:
+
+	StateFile(const std::string& path);
+	~StateFile();
+	
+	bool isOpen();
+	
+	STATEFILE_ERR::CODE load(persistedState& out);
+	STATEFILE_ERR::CODE save(const persistedState& in);
+};
+
+#endif
@@ -0,0 +1,259 @@
+/******************************************************************************
+/ Pi 4 Sunrise Clock App Clock Sync Benchmark - lopezk38 2025
+/
+/ Runs a publisher and a few followers over loopback multicast through a whole
+/ simulated day of the real curves and day plan, one second a step, dropping
+/ a share of each follower's packets. Reports what went on the wire against
+/ sending everything every time, and the send to apply latency. Checks every
+/ follower noticed exactly the packets it lost, short of any that sent it back
+/ to its own curves, and matches the publisher after every keyframe it got
+/
+/ Usage: syncbench [--followers N] [--loss PERCENT] [--interface ADDR]
+/
+/*****************************************************************************/
+
+/******************************************************************************
+/ Dependencies, namespacing
+/*****************************************************************************/
+
+#include <sys/socket.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <vector>
+
+#include "clockConfig.h"
+#include "clockSync.h"
+#include "dayPlan.h"
+#include "clockFace.h"
+#include "logger.h"
+
+
+/******************************************************************************
+/ Constants
+/*****************************************************************************/
+
+constexpr unsigned int DEFAULT_FOLLOWERS = 3;
+constexpr double DEFAULT_LOSS_PERCENT = 2;
+constexpr char DEFAULT_INTERFACE[] = "127.0.0.1";
+constexpr unsigned short BENCH_PORT = SYNC_DEFAULT_PORT + 1; //Stays clear of a clock running on the same box
+constexpr long SECONDS_PER_DAY = 24 * 60 * 60;
+
+//What a follower would need each time if it were sent the curves instead of where they are
+constexpr size_t CURVE_TABLE_BYTES = sizeof(SunColor::sunColorLUT) + sizeof(ClockTextColor::TextColorLUT) + sizeof(SunBrightness::sunBrightnessLUT);
+
+
+/******************************************************************************
+/ Implementation
+/*****************************************************************************/
+
+uint32_t packColor(Color color)
+{
+	return color.r | (color.g << 8) | (color.b << 16) | (static_cast<uint32_t>(color.a) << 24);
+}
+
+//What the clock publishes at a second of the day, worked out the same way the main loop does
+void fillState(const DayPlan& plan, long secondOfDay, syncState& state)
+{
+	long hour = secondOfDay / 3600;
+	long minute = secondOfDay / 60 % 60;
+	clockFace face = buildClockFace(hour, minute, minute + (secondOfDay % 60) / 60.0f, true);
+	
+	state.set(SYNC_FIELD::CODE::BACKGROUND, packColor(face.background));
+	state.set(SYNC_FIELD::CODE::TEXT, packColor(face.text));
+	state.set(SYNC_FIELD::CODE::BRIGHTNESS, SunBrightness::interp(hour, minute));
+	state.set(SYNC_FIELD::CODE::DISPLAY_ON, plan.powerOnAt(secondOfDay));
+	
+	planStep step;
+	bool planned = plan.nextPowerStep(secondOfDay, step);
+	state.set(SYNC_FIELD::CODE::POWER_STEP_AT, planned ? step.secondOfDay : 0);
+	state.set(SYNC_FIELD::CODE::POWER_STEP, planned ? (step.action == PLAN_ACTION::CODE::POWER_ON) : SYNC_NO_STEP);
+	
+	state.set(SYNC_FIELD::CODE::CURVE_CHECKSUM, curveChecksum());
+	
+	return;
+}
+
+struct followerResult
+{
+	uint64_t dropped = 0;
+	uint64_t droppedSinceHeard = 0;
+	uint64_t expectedGaps = 0;
+	uint64_t rejoins = 0; //Lost enough in a row to go back to its own curves
+	uint64_t mismatchedKeyframes = 0;
+	long staleSeconds = 0; //Current run of seconds out of step
+	long maxStaleSeconds = 0;
+};
+
+int main(int argc, char* argv[])
+{
+	unsigned int followerCount = DEFAULT_FOLLOWERS;
+	double lossPercent = DEFAULT_LOSS_PERCENT;
+	const char* interfaceAddress = DEFAULT_INTERFACE;
+	
+	for (int i = 1; i < argc; ++i)
+	{
+		if (!std::strcmp(argv[i], "--followers") && i + 1 < argc) followerCount = std::atoi(argv[++i]);
+		else if (!std::strcmp(argv[i], "--loss") && i + 1 < argc) lossPercent = std::atof(argv[++i]);
+		else if (!std::strcmp(argv[i], "--interface") && i + 1 < argc) interfaceAddress = argv[++i];
+		else
+		{
+			std::cerr << "Usage: syncbench [--followers N] [--loss PERCENT] [--interface ADDR]" << std::endl;
+			return 1;
+		}
+	}
+	if (followerCount == 0) followerCount = DEFAULT_FOLLOWERS;
+	
+	//Followers say whenever they lose the publisher. The table below counts it instead
+	logger::setLevel(logger::LEVEL::CODE::ERROR);
+	
+	ClockSync publisher(SYNC_ROLE::CODE::PUBLISHER, SYNC_DEFAULT_GROUP, BENCH_PORT, interfaceAddress);
+	std::vector<std::unique_ptr<ClockSync>> followers;
+	for (unsigned int i = 0; i < followerCount; ++i) followers.push_back(std::make_unique<ClockSync>(SYNC_ROLE::CODE::FOLLOWER, SYNC_DEFAULT_GROUP, BENCH_PORT, interfaceAddress));
+	
+	bool opened = publisher.isOpen();
+	for (const std::unique_ptr<ClockSync>& follower : followers) opened = opened && follower->isOpen();
+	if (!opened)
+	{
+		std::cerr << "ERROR: Couldn't open the sync sockets. Is there a multicast route on " << interfaceAddress << "?" << std::endl;
+		return 1;
+	}
+	
+	DayPlan plan(BRIGHTNESS_UPDATE_FREQ, PLAN_POWER_ON_LEAD, POWEROFF_ON_ZERO_BRIGHTNESS);
+	plan.compile();
+	
+	std::cout << "One simulated day over " << SYNC_DEFAULT_GROUP << ':' << BENCH_PORT << " on " << interfaceAddress << ", " << followerCount << " followers, "
+			  << lossPercent << "% loss, keyframe every " << SYNC_KEYFRAME_INTERVAL.count() << " ms" << std::endl;
+	
+	std::mt19937 random(1);
+	std::uniform_real_distribution<double> roll(0, 100);
+	std::vector<followerResult> results(followerCount);
+	std::vector<double> latenciesUs;
+	latenciesUs.reserve(SECONDS_PER_DAY * followerCount);
+	
+	uint64_t keyframeBytes = 0;
+	uint64_t deltaPackets = 0;
+	uint64_t deltaBytes = 0;
+	uint64_t heartbeats = 0;
+	
+	//Simulated, so a day takes seconds. Latency is still timed on the real clock
+	syncState state;
+	std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+	auto start = now;
+	
+	for (long second = 0; second <= SECONDS_PER_DAY; ++second, now += 1s)
+	{
+		//One last keyframe after the day, with nothing dropped, to check everyone ends up where the publisher is
+		bool settling = (second == SECONDS_PER_DAY);
+		if (settling) now += SYNC_KEYFRAME_INTERVAL;
+		else fillState(plan, second, state);
+		
+		uint64_t bytesBefore = publisher.getBytes();
+		uint64_t keyframesBefore = publisher.getKeyframes();
+		if (!publisher.publish(state, now)) continue;
+		
+		uint64_t length = publisher.getBytes() - bytesBefore;
+		bool keyframe = publisher.getKeyframes() != keyframesBefore;
+		if (keyframe) keyframeBytes += length;
+		else if (length == sizeof(syncHeader)) ++heartbeats;
+		else
+		{
+			++deltaPackets;
+			deltaBytes += length;
+		}
+		
+		for (unsigned int i = 0; i < followerCount; ++i)
+		{
+			ClockSync& follower = *followers[i];
+			followerResult& result = results[i];
+			
+			//Lost on the way. Only once following, a packet missed before that isn't a gap in anything
+			if (!settling && follower.isFollowing() && roll(random) < lossPercent)
+			{
+				uint8_t discard[SYNC_MAX_PACKET];
+				if (recv(follower.getDescriptor(), discard, sizeof(discard), MSG_DONTWAIT) > 0)
+				{
+					++result.dropped;
+					++result.droppedSinceHeard;
+				}
+			}
+			
+			bool wasFollowing = follower.isFollowing();
+			uint64_t keyframesSeen = follower.getKeyframes();
+			uint64_t packetsSeen = follower.getPackets();
+			follower.receive(now);
+			
+			if (follower.getPackets() != packetsSeen)
+			{
+				latenciesUs.push_back(follower.getLastLatencyMicros());
+				
+				//Taking a publisher up again starts the sequence over. Whatever was lost on the way there was never a gap
+				if (wasFollowing) result.expectedGaps += result.droppedSinceHeard;
+				else if (packetsSeen) ++result.rejoins;
+				result.droppedSinceHeard = 0;
+			}
+			
+			bool inStep = follower.isFollowing() && !std::memcmp(follower.getState().fields, state.fields, sizeof(state.fields));
+			if (follower.getKeyframes() != keyframesSeen && !inStep) ++result.mismatchedKeyframes;
+			
+			result.staleSeconds = inStep ? 0 : result.staleSeconds + 1;
+			result.maxStaleSeconds = std::max(result.maxStaleSeconds, result.staleSeconds);
+		}
+	}
+	
+	double wallSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+	
+	uint64_t packets = publisher.getPackets();
+	uint64_t keyframes = publisher.getKeyframes();
+	std::printf("Sent %llu packets, %llu bytes, in %.2f s: %llu keyframes (%llu bytes), %llu deltas (%llu bytes, %.1f avg), %llu heartbeats (%zu bytes each)\n",
+				static_cast<unsigned long long>(packets), static_cast<unsigned long long>(publisher.getBytes()), wallSeconds, static_cast<unsigned long long>(keyframes),
+				static_cast<unsigned long long>(keyframeBytes), static_cast<unsigned long long>(deltaPackets), static_cast<unsigned long long>(deltaBytes),
+				deltaPackets ? static_cast<double>(deltaBytes) / deltaPackets : 0.0, static_cast<unsigned long long>(heartbeats), sizeof(syncHeader));
+	std::printf("Every field every time would be %llu bytes (%.1fx), the curve tables every time %llu bytes (%.1fx)\n",
+				static_cast<unsigned long long>(packets * SYNC_MAX_PACKET), static_cast<double>(packets * SYNC_MAX_PACKET) / publisher.getBytes(),
+				static_cast<unsigned long long>(packets * (sizeof(syncHeader) + CURVE_TABLE_BYTES)), static_cast<double>(packets * (sizeof(syncHeader) + CURVE_TABLE_BYTES)) / publisher.getBytes());
+	
+	if (!latenciesUs.empty())
+	{
+		std::sort(latenciesUs.begin(), latenciesUs.end());
+		double sum = 0;
+		for (double latency : latenciesUs) sum += latency;
+		
+		std::printf("Send to apply latency over %zu packets: min %.0f us, median %.0f us, avg %.1f us, p99 %.0f us, max %.0f us\n", latenciesUs.size(), latenciesUs.front(),
+					latenciesUs[latenciesUs.size() / 2], sum / latenciesUs.size(), latenciesUs[latenciesUs.size() * 99 / 100], latenciesUs.back());
+	}
+	
+	std::printf("%-9s %10s %10s %10s %10s %14s %12s\n", "follower", "packets", "dropped", "gaps", "rejoins", "bad keyframes", "max stale s");
+	
+	bool failed = false;
+	
+	for (unsigned int i = 0; i < followerCount; ++i)
+	{
+		const ClockSync& follower = *followers[i];
+		const followerResult& result = results[i];
+		
+		std::printf("%-9u %10llu %10llu %10llu %10llu %14llu %12ld\n", i, static_cast<unsigned long long>(follower.getPackets()), static_cast<unsigned long long>(result.dropped),
+					static_cast<unsigned long long>(follower.getGaps()), static_cast<unsigned long long>(result.rejoins), static_cast<unsigned long long>(result.mismatchedKeyframes),
+					result.maxStaleSeconds);
+		
+		if (follower.getGaps() != result.expectedGaps)
+		{
+			std::cerr << "ERROR: Follower " << i << " saw " << follower.getGaps() << " gaps for " << result.expectedGaps << " dropped packets" << std::endl;
+			failed = true;
+		}
+		
+		if (result.mismatchedKeyframes || result.staleSeconds)
+		{
+			std::cerr << "ERROR: Follower " << i << " didn't match the publisher after a keyframe" << std::endl;
+			failed = true;
+		}
+	}
+	
+	return failed ? 1 : 0;
+}
@@ -1,183 +1,479 @@
-/******************************************************************************
-/ Pi 4 Sunrise Clock App Task Heap Class Implementation - lopezk38 2025
-/
-/*****************************************************************************/
-
-
-/******************************************************************************
-/ Dependencies
-/*****************************************************************************/
-
-#include <algorithm>
-#include <stdexcept>
-
-#include "taskHeap.h"
-
-#ifdef DEBUG
-#include <iostream>
-#endif
-
-
-/******************************************************************************
-/ Swapping comparison logic for heap
-/*****************************************************************************/
-
-class DoSwap
-{
-    public: bool operator()(tHeap::Task* lhs, tHeap::Task* rhs)
-    {
-        //Do not swap nodes if lhs scheduled time is later than rhs
-        return lhs->scheduledTime > rhs->scheduledTime;
-    }
-};
-
-
-/******************************************************************************
-/ Task Enum Helper Function Implementations
-/*****************************************************************************/
-
-bool tHeap::TASK::isValidTaskCode(TASK::CODE task)
-{
-	return (task >= TASK::CODE::NONE || task <= TASK::CODE::SET_BRIGHTNESS);
-}
-
-std::string tHeap::TASK::toString(TASK::CODE task)
-{
-	switch (task)
-	{
-		case TASK::CODE::NONE: return "TASK::CODE::NONE";
-		break;
-		
-		case TASK::CODE::SET_INPUT: return "TASK::CODE::SET_INPUT";
-		break;
-		
-		case TASK::CODE::CHECK_SHOULD_TOGGLE_DISPLAY_PWR: return "TASK::CODE::CHECK_SHOULD_TOGGLE_DISPLAY_PWR";
-		break;
-		
-		case TASK::CODE::DISPLAY_OFF_AND_RESCHEDULE: return "TASK::CODE::DISPLAY_OFF_AND_RESCHEDULE";
-		case TASK::CODE::DISPLAY_OFF: return "TASK::CODE::DISPLAY_OFF";
-		break;
-		
-		case TASK::CODE::DISPLAY_ON_STEP1_AND_RESCHEDULE: return "TASK::CODE::DISPLAY_ON_STEP1_AND_RESCHEDULE";
-		case TASK::CODE::DISPLAY_ON_STEP1: return "TASK::CODE::DISPLAY_ON_STEP1";
-		break;
-		
-		case TASK::CODE::DISPLAY_ON_STEP2_AND_RESCHEDULE: return "TASK::CODE::DISPLAY_ON_STEP2_AND_RESCHEDULE";
-		case TASK::CODE::DISPLAY_ON_STEP2: return "TASK::CODE::DISPLAY_ON_STEP2";
-		break;
-		
-		case TASK::CODE::DISPLAY_TOGGLE_STEP1: return "TASK::CODE::DISPLAY_TOGGLE_STEP1";
-		break;
-		
-		case TASK::CODE::DISPLAY_TOGGLE_STEP2: return "TASK::CODE::DISPLAY_TOGGLE_STEP2";
-		break;
-		
-		case TASK::CODE::SET_BRIGHTNESS_AND_RESCHEDULE: return "TASK::CODE::SET_BRIGHTNESS_AND_RESCHEDULE";
-		case TASK::CODE::SET_BRIGHTNESS: return "TASK::CODE::SET_BRIGHTNESS";
-		break;
-		
-		default: return "INVALID CODE";
-		break;
-	}
-}
-
-
-/******************************************************************************
-/ Task Heap Function Implementations
-/*****************************************************************************/
-
-tHeap::TaskHeap::~TaskHeap()
-{
-	for (Task* task : taskHeap)
-	{
-		if (task) delete task;
-	}
-	
-	return;
-}
-
-void tHeap::TaskHeap::pushTask(long scheduledTime, TASK::CODE taskCode)
-{
-	if (!TASK::isValidTaskCode(taskCode)) throw std::invalid_argument("Attempted to create task with invalid task type");
-	
-	Task* task = new Task(scheduledTime, taskCode);
-	
-	//Push and percolate through heap vector
-	this->taskHeap.push_back(task);
-	std::push_heap(this->taskHeap.begin(), this->taskHeap.end(), DoSwap());
-	
-	#ifdef DEBUG
-	std::cout << "Pushed task {" << scheduledTime << ", " << TASK::toString(taskCode) << '}' << std::endl;
-	#endif
-	
-	return;
-}
-
-tHeap::Task* tHeap::TaskHeap::popTask()
-{
-	//Empty check
-	if (this->taskHeap.empty()) throw std::underflow_error("ERROR: Heap underflow");
-	
-	//Pop and percolate next task to the head
-	std::pop_heap(this->taskHeap.begin(), this->taskHeap.end(), DoSwap());
-	Task* toReturn = this->taskHeap.back();
-	this->taskHeap.pop_back();
-	
-	#ifdef DEBUG
-	std::cout << "Popped task {" << toReturn->scheduledTime << ", " << TASK::toString(toReturn->task) << '}' << std::endl;
-	#endif
-	
-	return toReturn; //This task object is now the responsibility of the client. It must delete it.
-}
-
-tHeap::Task* tHeap::TaskHeap::peekTask()
-{
-	//Empty check
-	if (this->taskHeap.empty()) throw std::underflow_error("ERROR: Heap underflow");
-	
-	#ifdef DEBUG
-	std::cout << "Peeked task {" << this->taskHeap.front()->scheduledTime << ", " << TASK::toString(this->taskHeap.front()->task) << '}' << std::endl;
-	#endif
-	
-	return this->taskHeap.front();
-}
-
-bool tHeap::TaskHeap::isEmpty()
-{
-	return this->taskHeap.empty();
-}
-
-
-
-
-
-
-
-
-
-
-
-
-
-
-
-
-
-
-
-
-
-
-
-
-
-
-
-
-
-
-
-
-
-
-
+/******************************************************************************
+/ Pi 4 Sunrise Clock App Task Heap Class Implementation - lopezk38 2025
+/
+/*****************************************************************************/
+
+
+/******************************************************************************
+/ Dependencies
+/*****************************************************************************/
+
+#include <algorithm>
+#include <stdexcept>
+
+#include "taskHeap.h"
+#include "logger.h"
+
+
+/******************************************************************************
+/ Swapping comparison logic for heap
+/*****************************************************************************/
+
+class DoSwap
+{
+    public: bool operator()(const tHeap::Task* lhs, const tHeap::Task* rhs)
+    {
+        //Do not swap nodes if lhs scheduled time is later than rhs
+        return lhs->scheduledTime > rhs->scheduledTime;
+    }
+};
+
+
+/******************************************************************************
+/ Task Enum Helper Function Implementations
+/*****************************************************************************/
+
+bool tHeap::TASK::isValidTaskCode(TASK::CODE task)
+{
+	return (task >= TASK::CODE::NONE && task <= TASK::CODE::VERIFY_DISPLAY_PWR);
+}
+
+const char* tHeap::TASK::toString(TASK::CODE task)
+{
+	switch (task)
+	{
+		case TASK::CODE::NONE: return "TASK::CODE::NONE";
+		break;
+		
+		case TASK::CODE::SET_INPUT: return "TASK::CODE::SET_INPUT";
+		break;
+		
+		case TASK::CODE::CHECK_SHOULD_TOGGLE_DISPLAY_PWR: return "TASK::CODE::CHECK_SHOULD_TOGGLE_DISPLAY_PWR";
+		break;
+		
+		case TASK::CODE::DISPLAY_OFF_AND_RESCHEDULE: return "TASK::CODE::DISPLAY_OFF_AND_RESCHEDULE";
+		case TASK::CODE::DISPLAY_OFF: return "TASK::CODE::DISPLAY_OFF";
+		break;
+		
+		case TASK::CODE::DISPLAY_ON_STEP1_AND_RESCHEDULE: return "TASK::CODE::DISPLAY_ON_STEP1_AND_RESCHEDULE";
+		case TASK::CODE::DISPLAY_ON_STEP1: return "TASK::CODE::DISPLAY_ON_STEP1";
+		break;
+		
+		case TASK::CODE::DISPLAY_ON_STEP2_AND_RESCHEDULE: return "TASK::CODE::DISPLAY_ON_STEP2_AND_RESCHEDULE";
+		case TASK::CODE::DISPLAY_ON_STEP2: return "TASK::CODE::DISPLAY_ON_STEP2";
+		break;
+		
+		case TASK::CODE::DISPLAY_TOGGLE_STEP1: return "TASK::CODE::DISPLAY_TOGGLE_STEP1";
+		break;
+		
+		case TASK::CODE::DISPLAY_TOGGLE_STEP2: return "TASK::CODE::DISPLAY_TOGGLE_STEP2";
+		break;
+		
+		case TASK::CODE::SET_BRIGHTNESS_AND_RESCHEDULE: return "TASK::CODE::SET_BRIGHTNESS_AND_RESCHEDULE";
+		case TASK::CODE::SET_BRIGHTNESS: return "TASK::CODE::SET_BRIGHTNESS";
+		break;
+		
+		case TASK::CODE::SAMPLE_LIGHT_SENSOR_AND_RESCHEDULE: return "TASK::CODE::SAMPLE_LIGHT_SENSOR_AND_RESCHEDULE";
+		break;
+		
+		case TASK::CODE::VERIFY_DISPLAY_PWR: return "TASK::CODE::VERIFY_DISPLAY_PWR";
+		break;
+		
+		default: return "INVALID CODE";
+		break;
+	}
+}
+
+
+/******************************************************************************
+/ Task Heap Function Implementations
+/*****************************************************************************/
+
+tHeap::TaskHeap::~TaskHeap()
+{
+	for (Task* task : taskHeap)
+	{
+		if (task) delete task;
+	}
+	
+	for (Task* task : freeTasks) delete task;
+	
+	return;
+}
+
+void tHeap::TaskHeap::reserve(size_t count)
+{
+	this->taskHeap.reserve(count);
+	this->handleSlots.reserve(count);
+	this->freeSlots.reserve(count);
+	this->freeTasks.reserve(count);
+	
+	//Every task is either pending or free, so topping the free list up to count covers count pending at once
+	while (this->taskHeap.size() + this->freeTasks.size() < count) this->freeTasks.push_back(new Task());
+	
+	return;
+}
+
+tHeap::Task* tHeap::TaskHeap::allocTask(long scheduledTime, TASK::CODE taskCode)
+{
+	//Only allocates when more tasks are pending than ever before
+	if (this->freeTasks.empty()) return new Task(scheduledTime, taskCode);
+	
+	Task* task = this->freeTasks.back();
+	this->freeTasks.pop_back();
+	*task = Task(scheduledTime, taskCode);
+	
+	return task;
+}
+
+void tHeap::TaskHeap::recycleTask(Task* task)
+{
+	this->freeTasks.push_back(task);
+	
+	return;
+}
+
+void tHeap::TaskHeap::setUniqueKey(TASK::CODE task, bool unique)
+{
+	if (!TASK::isValidTaskCode(task)) throw std::invalid_argument("Attempted to set unique key mode on invalid task type");
+	
+	this->uniqueKey[task] = unique;
+	
+	return;
+}
+
+tHeap::taskHandle tHeap::TaskHeap::pushTask(long scheduledTime, TASK::CODE taskCode)
+{
+	if (!TASK::isValidTaskCode(taskCode)) throw std::invalid_argument("Attempted to create task with invalid task type");
+	
+	//Unique codes fold into the pending instance. Decrease key only, a later push never delays it
+	if (this->uniqueKey[taskCode])
+	{
+		Task* pending = this->findTask(this->uniqueHandle[taskCode]);
+		if (pending)
+		{
+			if (scheduledTime < pending->scheduledTime) this->reschedule(pending->handle, scheduledTime);
+			
+			logger::verbose("Merged task {{}, {}} into pending one at {}", scheduledTime, TASK::toString(taskCode), pending->scheduledTime);
+			
+			return pending->handle;
+		}
+	}
+	
+	Task* task = this->allocTask(scheduledTime, taskCode);
+	task->handle = this->allocHandle(task);
+	if (this->uniqueKey[taskCode]) this->uniqueHandle[taskCode] = task->handle;
+	
+	//Push and percolate through heap vector
+	this->taskHeap.push_back(task);
+	task->heapIndex = this->taskHeap.size() - 1;
+	this->siftUp(task->heapIndex);
+	
+	logger::verbose("Pushed task {{}, {}}", scheduledTime, TASK::toString(taskCode));
+	
+	return task->handle;
+}
+
+tHeap::taskHandle tHeap::TaskHeap::pushPeriodicTask(long firstRun, long period, TASK::CODE taskCode, bool wallAligned)
+{
+	if (period <= 0) throw std::invalid_argument("Attempted to create periodic task without a period");
+	
+	//Goes through the normal push so a unique code folds into whatever is pending, then takes on the period
+	taskHandle handle = this->pushTask(firstRun, taskCode);
+	
+	Task* task = this->findTask(handle);
+	task->period = period;
+	task->wallAligned = wallAligned;
+	
+	return handle;
+}
+
+tHeap::Task tHeap::TaskHeap::popTask()
+{
+	//Empty check
+	if (this->taskHeap.empty()) throw std::underflow_error("ERROR: Heap underflow");
+	
+	return this->takeFront(this->taskHeap.front()->scheduledTime);
+}
+
+bool tHeap::TaskHeap::popDueTask(long now, Task& task)
+{
+	if (this->taskHeap.empty() || this->taskHeap.front()->scheduledTime > now) return false;
+	
+	task = this->takeFront(now);
+	
+	return true;
+}
+
+tHeap::Task tHeap::TaskHeap::takeFront(long now)
+{
+	//The client always gets a copy. The heap keeps its own task objects for reuse
+	Task* front = this->taskHeap.front();
+	Task toReturn = *front;
+	
+	if (front->period)
+	{
+		//Periodic tasks stay put and keep their handle		
+		//Next run is off the last deadline, not the time it actually ran, so execution time never accumulates as drift
+		front->scheduledTime += front->period;
+		
+		//If the loop stalled past whole periods, skip them rather than firing them back to back
+		if (front->scheduledTime <= now) front->scheduledTime += ((now - front->scheduledTime) / front->period + 1) * front->period;
+		
+		this->siftDown(0);
+	}
+	else
+	{
+		//Pop and percolate next task to the head
+		this->removeAt(0);
+		this->recycleTask(front);
+	}
+	
+	logger::verbose("Popped task {{}, {}}", toReturn.scheduledTime, TASK::toString(toReturn.task));
+	
+	return toReturn;
+}
+
+tHeap::Task* tHeap::TaskHeap::peekTask()
+{
+	//Empty check
+	if (this->taskHeap.empty()) throw std::underflow_error("ERROR: Heap underflow");
+	
+	logger::verbose("Peeked task {{}, {}}", this->taskHeap.front()->scheduledTime, TASK::toString(this->taskHeap.front()->task));
+	
+	return this->taskHeap.front();
+}
+
+bool tHeap::TaskHeap::cancel(taskHandle handle)
+{
+	Task* task = this->findTask(handle);
+	if (!task) return false; //Already ran or already cancelled
+	
+	this->removeAt(task->heapIndex);
+	
+	logger::verbose("Cancelled task {{}, {}}", task->scheduledTime, TASK::toString(task->task));
+	
+	this->recycleTask(task);
+	
+	return true;
+}
+
+bool tHeap::TaskHeap::reschedule(taskHandle handle, long newTime)
+{
+	Task* task = this->findTask(handle);
+	if (!task) return false;
+	
+	long oldTime = task->scheduledTime;
+	task->scheduledTime = newTime;
+	
+	//Only one direction can be out of order
+	if (newTime < oldTime) this->siftUp(task->heapIndex);
+	else this->siftDown(task->heapIndex);
+	
+	logger::verbose("Rescheduled task {} from {} to {}", TASK::toString(task->task), oldTime, newTime);
+	
+	return true;
+}
+
+void tHeap::TaskHeap::reanchorWallAligned(long now, long wallNow)
+{
+	bool moved = false;
+	
+	for (Task* task : this->taskHeap)
+	{
+		if (!task->wallAligned) continue;
+		
+		//One run at the next boundary, however far the clock moved. Never a catch up burst
+		task->scheduledTime = nextWallBoundary(now, wallNow, task->period);
+		moved = true;
+	}
+	
+	if (!moved) return;
+	
+	//Several tasks may have moved either way, so settle the whole heap
+	for (size_t i = this->taskHeap.size() / 2; i-- > 0;) this->siftDown(i);
+	
+	logger::verbose("Re-anchored wall aligned tasks");
+	
+	return;
+}
+
+long tHeap::TaskHeap::nextWallBoundary(long now, long wallNow, long period)
+{
+	//Wall clock seconds until the next multiple of period, added onto the schedule clock
+	return now + (period - wallNow % period);
+}
+
+bool tHeap::TaskHeap::isPending(taskHandle handle) const
+{
+	return this->findTask(handle) != nullptr;
+}
+
+const tHeap::Task* tHeap::TaskHeap::getTask(taskHandle handle) const
+{
+	return this->findTask(handle);
+}
+
+bool tHeap::TaskHeap::isEmpty()
+{
+	return this->taskHeap.empty();
+}
+
+size_t tHeap::TaskHeap::size() const
+{
+	return this->taskHeap.size();
+}
+
+const tHeap::Task* tHeap::TaskHeap::getTaskAt(size_t index) const
+{
+	//Bounds check
+	if (index >= this->taskHeap.size()) throw std::out_of_range("ERROR: Task index out of range");
+	
+	return this->taskHeap[index];
+}
+
+tHeap::Task* tHeap::TaskHeap::findTask(taskHandle handle) const
+{
+	//Low half is the slot, high half the generation it was issued under
+	uint32_t slot = static_cast<uint32_t>(handle);
+	uint32_t generation = static_cast<uint32_t>(handle >> 32);
+	
+	if (handle == INVALID_HANDLE || slot >= this->handleSlots.size()) return nullptr;
+	if (this->handleSlots[slot].generation != generation) return nullptr;
+	
+	return this->handleSlots[slot].task;
+}
+
+tHeap::taskHandle tHeap::TaskHeap::allocHandle(Task* task)
+{
+	uint32_t slot;
+	if (!this->freeSlots.empty())
+	{
+		slot = this->freeSlots.back();
+		this->freeSlots.pop_back();
+	}
+	else
+	{
+		slot = this->handleSlots.size();
+		this->handleSlots.emplace_back();
+	}
+	
+	this->handleSlots[slot].task = task;
+	
+	return (static_cast<taskHandle>(this->handleSlots[slot].generation) << 32) | slot;
+}
+
+void tHeap::TaskHeap::releaseHandle(Task* task)
+{
+	uint32_t slot = static_cast<uint32_t>(task->handle);
+	
+	if (this->uniqueHandle[task->task] == task->handle) this->uniqueHandle[task->task] = INVALID_HANDLE;
+	
+	//Bump the generation so the old handle goes stale, then recycle the slot
+	this->handleSlots[slot].task = nullptr;
+	++this->handleSlots[slot].generation;
+	this->freeSlots.push_back(slot);
+	
+	return;
+}
+
+void tHeap::TaskHeap::placeAt(size_t index, Task* task)
+{
+	this->taskHeap[index] = task;
+	task->heapIndex = index;
+	
+	return;
+}
+
+void tHeap::TaskHeap::siftUp(size_t index)
+{
+	Task* task = this->taskHeap[index];
+	
+	while (index > 0)
+	{
+		size_t parent = (index - 1) / 2;
+		if (!DoSwap()(this->taskHeap[parent], task)) break;
+		
+		this->placeAt(index, this->taskHeap[parent]);
+		index = parent;
+	}
+	this->placeAt(index, task);
+	
+	return;
+}
+
+void tHeap::TaskHeap::siftDown(size_t index)
+{
+	Task* task = this->taskHeap[index];
+	size_t count = this->taskHeap.size();
+	
+	while (true)
+	{
+		size_t child = index * 2 + 1;
+		if (child >= count) break;
+		
+		//Follow the earlier of the two children
+		if (child + 1 < count && DoSwap()(this->taskHeap[child], this->taskHeap[child + 1])) ++child;
+		if (!DoSwap()(task, this->taskHeap[child])) break;
+		
+		this->placeAt(index, this->taskHeap[child]);
+		index = child;
+	}
+	this->placeAt(index, task);
+	
+	return;
+}
+
+void tHeap::TaskHeap::removeAt(size_t index)
+{
+	Task* removed = this->taskHeap[index];
+	this->releaseHandle(removed);
+	
+	//Fill the hole with the last task and let it settle whichever way it needs to
+	Task* last = this->taskHeap.back();
+	this->taskHeap.pop_back();
+	
+	if (last != removed)
+	{
+		this->placeAt(index, last);
+		this->siftUp(index);
+		this->siftDown(last->heapIndex);
+	}
+	
+	return;
+}
+
+
+
+
+
+
+
+
+
+
+
+
+
+
+
+
+
+
+
+
+
+
+
+
+
+
+
+
+
+
+
+
+
+
+
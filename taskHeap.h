@@ -1,117 +1,178 @@
-/******************************************************************************
-/ Pi 4 Sunrise Clock App Task Heap Class Spec - lopezk38 2025
-/
-/*****************************************************************************/
-
-#ifndef SUNCLOCK_THEAP
-#define SUNCLOCK_THEAP
-
-//#define DEBUG
-
-/******************************************************************************
-/ Dependencies, namespace
-/*****************************************************************************/
-
-#include <vector>
-#include <string>
-
-namespace tHeap {
-
-
-/******************************************************************************
-/ TASK enum and helpers
-/*****************************************************************************/
-
-namespace TASK
-{
-	enum CODE
-	{
-		NONE,
-		SET_INPUT,
-		CHECK_SHOULD_TOGGLE_DISPLAY_PWR,
-		DISPLAY_OFF_AND_RESCHEDULE,
-		DISPLAY_OFF,
-		DISPLAY_ON_STEP1_AND_RESCHEDULE,
-		DISPLAY_ON_STEP1,
-		DISPLAY_ON_STEP2_AND_RESCHEDULE,
-		DISPLAY_ON_STEP2,
-		DISPLAY_TOGGLE_STEP1,
-		DISPLAY_TOGGLE_STEP2,
-		SET_BRIGHTNESS_AND_RESCHEDULE,
-		SET_BRIGHTNESS
-	};
-	
-	bool isValidTaskCode(TASK::CODE task);
-
-	std::string toString(TASK::CODE task);
-}
-
-
-struct Task
-{
-	long scheduledTime;
-	TASK::CODE task;
-	
-	Task() : scheduledTime(-1), task(TASK::CODE::NONE) {};
-	Task(long scheduledTime, TASK::CODE task) : scheduledTime(scheduledTime), task(task) {};
-};
-
-class TaskHeap
-{
-private:
-
-	std::vector<Task*> taskHeap;
-	
-public:
-
-	~TaskHeap();
-	
-	void pushTask(long scheduledTime, TASK::CODE task);
-	Task* popTask();
-	Task* peekTask();
-	
-	bool isEmpty();
-};
-}
-
-#endif
-
-
-
-
-
-
-
-
-
-
-
-
-
-
-
-
-
-
-
-
-
-
-
-
-
-
-
-
-
-
-
-
-
-
-
-
-
-
-
-
+/******************************************************************************
+/ Pi 4 Sunrise Clock App Task Heap Class Spec - lopezk38 2025
+/
+/*****************************************************************************/
+
+#ifndef SUNCLOCK_THEAP
+#define SUNCLOCK_THEAP
+
+//#define DEBUG
+
+/******************************************************************************
+/ Dependencies, namespace
+/*****************************************************************************/
+
+#include <vector>
+#include <string>
+#include <cstdint>
+#include <cstddef>
+
+namespace tHeap {
+
+
+/******************************************************************************
+/ TASK enum and helpers
+/*****************************************************************************/
+
+namespace TASK
+{
+	enum CODE
+	{
+		NONE,
+		SET_INPUT,
+		CHECK_SHOULD_TOGGLE_DISPLAY_PWR,
+		DISPLAY_OFF_AND_RESCHEDULE,
+		DISPLAY_OFF,
+		DISPLAY_ON_STEP1_AND_RESCHEDULE,
+		DISPLAY_ON_STEP1,
+		DISPLAY_ON_STEP2_AND_RESCHEDULE,
+		DISPLAY_ON_STEP2,
+		DISPLAY_TOGGLE_STEP1,
+		DISPLAY_TOGGLE_STEP2,
+		SET_BRIGHTNESS_AND_RESCHEDULE,
+		SET_BRIGHTNESS,
+		SAMPLE_LIGHT_SENSOR_AND_RESCHEDULE,
+		VERIFY_DISPLAY_PWR
+	};
+	
+	constexpr unsigned int CODE_COUNT = CODE::VERIFY_DISPLAY_PWR + 1; //Keep in sync with the last code
+	
+	bool isValidTaskCode(TASK::CODE task);
+
+	const char* toString(TASK::CODE task);
+}
+
+
+//Refers to one pending task. Goes stale once the task is popped or cancelled, and a stale handle is never reused
+typedef uint64_t taskHandle;
+constexpr taskHandle INVALID_HANDLE = 0;
+
+struct Task
+{
+	long scheduledTime;
+	TASK::CODE task;
+	
+	taskHandle handle = INVALID_HANDLE;
+	size_t heapIndex = 0; //Where this task sits in the heap vector, kept current by the heap
+	
+	long period = 0; //Seconds. 0 runs once
+	bool wallAligned = false; //Runs on wall clock multiples of period, re-anchored when the wall clock is stepped
+	
+	Task() : scheduledTime(-1), task(TASK::CODE::NONE) {};
+	Task(long scheduledTime, TASK::CODE task) : scheduledTime(scheduledTime), task(task) {};
+};
+
+class TaskHeap
+{
+private:
+
+	//Handle lookup. A handle is the slot number plus the slot's generation, so a recycled slot never answers for an old handle
+	struct handleSlot
+	{
+		Task* task = nullptr;
+		uint32_t generation = 1;
+	};
+
+	std::vector<Task*> taskHeap;
+	std::vector<handleSlot> handleSlots;
+	std::vector<uint32_t> freeSlots;
+	std::vector<Task*> freeTasks; //Finished tasks kept for reuse, so a warmed up heap never allocates
+	
+	//Unique key mode. Codes flagged here have at most one pending instance
+	bool uniqueKey[TASK::CODE_COUNT] = {};
+	taskHandle uniqueHandle[TASK::CODE_COUNT] = {};
+	
+	Task* findTask(taskHandle handle) const;
+	Task* allocTask(long scheduledTime, TASK::CODE task);
+	void recycleTask(Task* task);
+	Task takeFront(long now);
+	taskHandle allocHandle(Task* task);
+	void releaseHandle(Task* task);
+	
+	void placeAt(size_t index, Task* task);
+	void siftUp(size_t index);
+	void siftDown(size_t index);
+	void removeAt(size_t index);
+	
+public:
+
+	~TaskHeap();
+	
+	void reserve(size_t count); //Preallocates for this many pending tasks. Pushes within it never touch the allocator
+	
+	void setUniqueKey(TASK::CODE task, bool unique); //Pushing a unique code that is already pending only ever moves it earlier
+	
+	taskHandle pushTask(long scheduledTime, TASK::CODE task);
+	taskHandle pushPeriodicTask(long firstRun, long period, TASK::CODE task, bool wallAligned = false);
+	Task popTask();
+	bool popDueTask(long now, Task& task); //False if nothing is due yet
+	Task* peekTask();
+	
+	//Moves every wall aligned task to its next wall clock boundary. Call after the wall clock is stepped
+	void reanchorWallAligned(long now, long wallNow);
+	static long nextWallBoundary(long now, long wallNow, long period);
+	
+	bool cancel(taskHandle handle);
+	bool reschedule(taskHandle handle, long newTime);
+	
+	bool isPending(taskHandle handle) const;
+	const Task* getTask(taskHandle handle) const; //nullptr if the handle is stale
+	
+	bool isEmpty();
+	
+	size_t size() const;
+	const Task* getTaskAt(size_t index) const; //Tasks are in heap order, not schedule order
+};
+}
+
+#endif
+
+
+
+
+
+
+
+
+
+
+
+
+
+
+
+
+
+
+
+
+
+
+
+
+
+
+
+
+
+
+
+
+
+
+
+
+
+
+
+
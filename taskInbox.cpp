@@ -0,0 +1,170 @@
+/******************************************************************************
+/ Pi 4 Sunrise Clock App Task Inbox Class Implementation - lopezk38 2025
+/
+/*****************************************************************************/
+
+/******************************************************************************
+/ Dependencies, namespacing
+/*****************************************************************************/
+
+#include <unistd.h>
+#include <sys/eventfd.h>
+#include <cstdint>
+
+#include "taskInbox.h"
+#include "logger.h"
+
+
+/******************************************************************************
+/ Class implementation
+/*****************************************************************************/
+
+tHeap::TaskInbox::TaskInbox(size_t capacity): mask(roundCapacity(capacity) - 1)
+{
+	//Each slot starts out ready to be written at its own index
+	this->slots = new slot[this->mask + 1];
+	for (size_t i = 0; i <= this->mask; ++i) this->slots[i].sequence.store(i, std::memory_order_relaxed);
+	
+	//Without the descriptor pushed tasks still arrive, just on the loop's next idle poll instead of right away
+	this->eventDescriptor = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+	if (this->eventDescriptor == -1)
+	{
+		errorState = true;
+		logger::warning("Unable to create the task inbox wakeup descriptor");
+	}
+	
+	return;
+}
+
+tHeap::TaskInbox::~TaskInbox()
+{
+	if (this->eventDescriptor != -1) close(this->eventDescriptor);
+	delete[] this->slots;
+	
+	return;
+}
+
+size_t tHeap::TaskInbox::roundCapacity(size_t capacity)
+{
+	size_t rounded = 2;
+	while (rounded < capacity) rounded <<= 1;
+	
+	return rounded;
+}
+
+void tHeap::TaskInbox::signal()
+{
+	//Can only fail if the counter would overflow, and then the consumer is being woken anyway
+	uint64_t one = 1;
+	if (write(this->eventDescriptor, &one, sizeof(one)) != sizeof(one)) return;
+	
+	return;
+}
+
+bool tHeap::TaskInbox::isOpen()
+{
+	return !this->errorState;
+}
+
+bool tHeap::TaskInbox::push(long scheduledTime, TASK::CODE task)
+{
+	uint64_t position = this->tail.load(std::memory_order_relaxed);
+	slot* claimed;
+	
+	while (true)
+	{
+		claimed = &this->slots[position & this->mask];
+		int64_t lag = static_cast<int64_t>(claimed->sequence.load(std::memory_order_acquire) - position);
+		
+		//Ready for this position. Try to claim it, and on losing the race the failed swap hands back the new tail to try
+		if (lag == 0)
+		{
+			if (this->tail.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) break;
+		}
+		else if (lag < 0)
+		{
+			//Still holds a task from a lap ago the consumer hasn't taken. Full
+			this->rejected.fetch_add(1, std::memory_order_relaxed);
+			return false;
+		}
+		else position = this->tail.load(std::memory_order_relaxed); //Another producer got here first
+	}
+	
+	claimed->scheduledTime = scheduledTime;
+	claimed->task = task;
+	claimed->sequence.store(position + 1, std::memory_order_release); //Publishes the task to the consumer
+	
+	//Pairs with prepareToWait. Either this sees the consumer waiting or the consumer sees this task, never neither
+	std::atomic_thread_fence(std::memory_order_seq_cst);
+	
+	//Only the first producer after the consumer went to sleep pays for the syscall
+	if (this->eventDescriptor != -1 && this->consumerWaiting.load(std::memory_order_relaxed) && this->consumerWaiting.exchange(false, std::memory_order_relaxed)) signal();
+	
+	return true;
+}
+
+bool tHeap::TaskInbox::pop(Task& task)
+{
+	slot& next = this->slots[this->head & this->mask];
+	if (next.sequence.load(std::memory_order_acquire) != this->head + 1) return false; //Empty, or the producer that claimed it hasn't finished writing
+	
+	task = Task(next.scheduledTime, next.task);
+	next.sequence.store(this->head + this->mask + 1, std::memory_order_release); //Ready for the producer one lap on
+	++this->head;
+	
+	return true;
+}
+
+size_t tHeap::TaskInbox::drainInto(TaskHeap& taskSchedule)
+{
+	//Awake now. Clear any pending wakeup so the next sleep isn't cut short by a stale one
+	this->consumerWaiting.store(false, std::memory_order_relaxed);
+	if (this->eventDescriptor != -1)
+	{
+		//Nonblocking. Nothing to read just means nobody woke us
+		uint64_t wakeups;
+		if (read(this->eventDescriptor, &wakeups, sizeof(wakeups)) != sizeof(wakeups)) wakeups = 0;
+	}
+	
+	size_t moved = 0;
+	Task task;
+	while (pop(task))
+	{
+		//Anything a producer got wrong is dropped here, not thrown out of the main loop
+		if (!TASK::isValidTaskCode(task.task))
+		{
+			logger::error("Dropped an invalid task from the task inbox");
+			continue;
+		}
+		
+		taskSchedule.pushTask(task.scheduledTime, task.task);
+		++moved;
+	}
+	
+	return moved;
+}
+
+void tHeap::TaskInbox::prepareToWait()
+{
+	this->consumerWaiting.store(true, std::memory_order_seq_cst);
+	
+	//A push that finished before the flag went up never saw it. Don't sleep through that one
+	if (this->eventDescriptor != -1 && this->slots[this->head & this->mask].sequence.load(std::memory_order_seq_cst) == this->head + 1) signal();
+	
+	return;
+}
+
+int tHeap::TaskInbox::getDescriptor()
+{
+	return this->eventDescriptor;
+}
+
+size_t tHeap::TaskInbox::capacity() const
+{
+	return this->mask + 1;
+}
+
+uint64_t tHeap::TaskInbox::getRejected() const
+{
+	return this->rejected.load(std::memory_order_relaxed);
+}
@@ -0,0 +1,84 @@
+/******************************************************************************
+/ Pi 4 Sunrise Clock App Task Inbox Class Spec - lopezk38 2025
+/
+/ Lets other threads hand tasks to the main loop. The task heap is only ever
+/ touched from the main loop, so anything scheduled from elsewhere is queued
+/ here and drained into the heap once per loop iteration
+/
+/*****************************************************************************/
+
+#ifndef SUNCLOCK_TINBOX
+#define SUNCLOCK_TINBOX
+
+/******************************************************************************
+/ Dependencies, namespace
+/*****************************************************************************/
+
+#include <atomic>
+#include <cstdint>
+#include <cstddef>
+
+#include "taskHeap.h"
+
+namespace tHeap {
+
+
+/******************************************************************************
+/ Class specification
+/*****************************************************************************/
+
+//Bounded multi producer, single consumer queue. Producers claim a slot with one compare and swap, the consumer never writes
+//anything a producer reads except the slot sequence numbers, and nobody ever takes a lock. Full means the push fails, it never blocks
+class TaskInbox
+{
+
+private:
+
+	struct slot
+	{
+		std::atomic<uint64_t> sequence; //Position this slot is ready to be written at, or that plus one once it holds a task
+		long scheduledTime;
+		TASK::CODE task;
+	};
+	
+	slot* slots = nullptr;
+	const size_t mask;
+	
+	//Producers all hammer the tail and only the consumer touches the head. Keep them on separate cache lines
+	alignas(64) std::atomic<uint64_t> tail{0};
+	alignas(64) uint64_t head = 0;
+	
+	alignas(64) std::atomic<bool> consumerWaiting{false}; //Set while the consumer might be asleep, so producers only pay for a wakeup then
+	std::atomic<uint64_t> rejected{0};
+	int eventDescriptor = -1;
+	
+	bool errorState = false;
+	
+	static size_t roundCapacity(size_t capacity);
+	void signal();
+
+public:
+
+	TaskInbox(size_t capacity); //Rounded up to a power of two
+	~TaskInbox();
+	
+	TaskInbox(const TaskInbox&) = delete;
+	TaskInbox& operator=(const TaskInbox&) = delete;
+	
+	bool isOpen(); //False if there is no wakeup descriptor. Tasks still get through, they just wait for the loop's own poll
+	
+	//Any thread. False if the inbox was full, and the task is dropped and counted
+	bool push(long scheduledTime, TASK::CODE task);
+	
+	//Main loop only
+	bool pop(Task& task);
+	size_t drainInto(TaskHeap& taskSchedule); //Returns how many tasks moved
+	void prepareToWait(); //Call before sleeping on the descriptor. A push after this wakes it
+	
+	int getDescriptor(); //Turns readable when a task is pushed while the consumer is waiting
+	size_t capacity() const;
+	uint64_t getRejected() const;
+};
+}
+
+#endif
@@ -0,0 +1,112 @@
+/******************************************************************************
+/ Pi 4 Sunrise Clock App Trace Ring Buffer Implementation - lopezk38 2025
+/
+/*****************************************************************************/
+
+/******************************************************************************
+/ Dependencies, namespacing
+/*****************************************************************************/
+
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <fcntl.h>
+#include <ctime>
+
+#include "trace.h"
+#include "logger.h"
+
+bool trace::enabled = false;
+
+static trace::ring* traceRing = nullptr;
+
+
+/******************************************************************************
+/ Implementation
+/*****************************************************************************/
+
+bool trace::init()
+{
+	//Create fresh each run so a reader never sees events from a previous process
+	shm_unlink(TRACE_SHM_NAME);
+	
+	int descriptor = shm_open(TRACE_SHM_NAME, O_RDWR | O_CREAT | O_EXCL, 0644);
+	if (descriptor == -1)
+	{
+		logger::error("Failed to create trace shared memory segment {}", TRACE_SHM_NAME);
+		return false;
+	}
+	
+	if (ftruncate(descriptor, sizeof(ring)))
+	{
+		logger::error("Failed to size trace shared memory segment");
+		close(descriptor);
+		shm_unlink(TRACE_SHM_NAME);
+		return false;
+	}
+	
+	void* map = mmap(nullptr, sizeof(ring), PROT_READ | PROT_WRITE, MAP_SHARED, descriptor, 0);
+	close(descriptor); //The mapping keeps the segment alive
+	
+	if (map == MAP_FAILED)
+	{
+		logger::error("Failed to map trace shared memory segment");
+		shm_unlink(TRACE_SHM_NAME);
+		return false;
+	}
+	
+	//Fresh segment is zeroed, so every slot starts out as "never written"
+	traceRing = static_cast<ring*>(map);
+	traceRing->header.capacity = TRACE_CAPACITY;
+	traceRing->header.pid = getpid();
+	traceRing->header.version = TRACE_VERSION;
+	traceRing->header.head.store(0, std::memory_order_relaxed);
+	
+	//Magic last, a reader ignores the segment until it shows up
+	std::atomic_thread_fence(std::memory_order_release);
+	traceRing->header.magic = TRACE_MAGIC;
+	
+	enabled = true;
+	
+	logger::info("Tracing to shared memory segment {}. Use tracedump to export it", TRACE_SHM_NAME);
+	
+	return true;
+}
+
+void trace::shutdown()
+{
+	if (!traceRing) return;
+	
+	enabled = false;
+	munmap(traceRing, sizeof(ring));
+	traceRing = nullptr;
+	
+	//Leave the segment in place so the last run can still be dumped after exit
+	
+	return;
+}
+
+void trace::record(EVENT::CODE code, PHASE::CODE phase, int64_t arg)
+{
+	static thread_local uint32_t threadId = syscall(SYS_gettid);
+	
+	timespec now;
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	
+	//Claim a slot. Many writers are fine, each gets its own index
+	uint64_t index = traceRing->header.head.fetch_add(1, std::memory_order_relaxed);
+	event& slot = traceRing->events[index & (TRACE_CAPACITY - 1)];
+	
+	slot.sequence.store(2 * index + 1, std::memory_order_relaxed);
+	std::atomic_thread_fence(std::memory_order_release);
+	
+	slot.timestampNs = static_cast<uint64_t>(now.tv_sec) * 1000000000 + now.tv_nsec;
+	slot.arg = arg;
+	slot.threadId = threadId;
+	slot.code = code;
+	slot.phase = phase;
+	
+	slot.sequence.store(2 * (index + 1), std::memory_order_release);
+	
+	return;
+}
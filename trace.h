@@ -0,0 +1,128 @@
+/******************************************************************************
+/ Pi 4 Sunrise Clock App Trace Ring Buffer Spec - lopezk38 2025
+/
+/*****************************************************************************/
+
+#ifndef SUNCLOCK_APP_TRACE
+#define SUNCLOCK_APP_TRACE
+
+/******************************************************************************
+/ Dependencies, namespacing
+/*****************************************************************************/
+
+#include <atomic>
+#include <cstdint>
+
+namespace trace {
+
+
+/******************************************************************************
+/ Shared memory layout. Shared with the tracedump tool, so bump TRACE_VERSION on any change
+/*****************************************************************************/
+
+constexpr char TRACE_SHM_NAME[] = "/sunclock_trace";
+constexpr uint32_t TRACE_MAGIC = 0x43525453; //"STRC"
+constexpr uint32_t TRACE_VERSION = 1;
+constexpr uint64_t TRACE_CAPACITY = 1 << 16; //Events. Must be a power of two
+
+namespace EVENT
+{
+	enum CODE : uint16_t
+	{
+		FRAME,
+		TASK, //arg is the TASK::CODE
+		DDC_INIT,
+		DDC_READ, //arg is the VCP code
+		DDC_WRITE, //arg is the VCP code
+		COUNT
+	};
+	
+	constexpr const char* NAMES[COUNT] = { "frame", "task", "ddcInit", "ddcRead", "ddcWrite" };
+	constexpr const char* CATEGORIES[COUNT] = { "render", "scheduler", "ddc", "ddc", "ddc" };
+}
+
+namespace PHASE
+{
+	enum CODE : uint8_t
+	{
+		BEGIN = 'B',
+		END = 'E'
+	};
+}
+
+struct event
+{
+	//Per slot seqlock. Odd while the writer is filling it in, 2 * (index + 1) once it is complete
+	std::atomic<uint64_t> sequence;
+	
+	uint64_t timestampNs; //CLOCK_MONOTONIC
+	int64_t arg;
+	uint32_t threadId;
+	uint16_t code;
+	uint8_t phase;
+	uint8_t reserved;
+};
+
+struct ringHeader
+{
+	uint32_t magic;
+	uint32_t version;
+	uint64_t capacity;
+	int32_t pid;
+	
+	alignas(64) std::atomic<uint64_t> head; //Next event index. Slots wrap at capacity
+};
+
+struct ring
+{
+	ringHeader header;
+	event events[TRACE_CAPACITY];
+};
+
+
+/******************************************************************************
+/ Recording
+/*****************************************************************************/
+
+extern bool enabled; //Only written by init(), before any other threads look at it
+
+bool init(); //Maps the shared memory segment. Leaves tracing off if it fails
+void shutdown();
+
+void record(EVENT::CODE code, PHASE::CODE phase, int64_t arg);
+
+//Disabled tracing costs exactly this predicted branch
+inline void begin(EVENT::CODE code, int64_t arg = 0)
+{
+	if (__builtin_expect(enabled, 0)) record(code, PHASE::BEGIN, arg);
+}
+
+inline void end(EVENT::CODE code, int64_t arg = 0)
+{
+	if (__builtin_expect(enabled, 0)) record(code, PHASE::END, arg);
+}
+
+//Begin/end pair for a block
+class scope
+{
+	
+private:
+
+	const EVENT::CODE code;
+	const int64_t arg;
+	
+public:
+
+	scope(EVENT::CODE code, int64_t arg = 0): code(code), arg(arg)
+	{
+		begin(code, arg);
+	}
+	
+	~scope()
+	{
+		end(code, arg);
+	}
+};
+}
+
+#endif
@@ -0,0 +1,132 @@
+/******************************************************************************
+/ Pi 4 Sunrise Clock App Trace Dump Tool - lopezk38 2025
+/
+/ Attaches to a running (or exited) clock's trace ring and writes the events out
+/ as Chrome trace_event JSON, which loads in Perfetto or chrome://tracing
+/
+/ Usage: tracedump [output.json]
+/
+/*****************************************************************************/
+
+/******************************************************************************
+/ Dependencies, namespacing
+/*****************************************************************************/
+
+#include <unistd.h>
+#include <sys/mman.h>
+#include <fcntl.h>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <vector>
+
+#include "trace.h"
+#include "taskHeap.h"
+
+
+/******************************************************************************
+/ Implementation
+/*****************************************************************************/
+
+struct copiedEvent
+{
+	uint64_t timestampNs;
+	int64_t arg;
+	uint32_t threadId;
+	uint16_t code;
+	uint8_t phase;
+};
+
+int main(int argc, char* argv[])
+{
+	int descriptor = shm_open(trace::TRACE_SHM_NAME, O_RDONLY, 0);
+	if (descriptor == -1)
+	{
+		std::cerr << "ERROR: No trace segment at " << trace::TRACE_SHM_NAME << ". Is the clock running with SUNCLOCK_TRACE=1?" << std::endl;
+		return 1;
+	}
+	
+	void* map = mmap(nullptr, sizeof(trace::ring), PROT_READ, MAP_SHARED, descriptor, 0);
+	close(descriptor);
+	
+	if (map == MAP_FAILED)
+	{
+		std::cerr << "ERROR: Failed to map trace segment" << std::endl;
+		return 1;
+	}
+	
+	const trace::ring* ring = static_cast<const trace::ring*>(map);
+	if (ring->header.magic != trace::TRACE_MAGIC || ring->header.version != trace::TRACE_VERSION || ring->header.capacity != trace::TRACE_CAPACITY)
+	{
+		std::cerr << "ERROR: Trace segment is not a compatible sunclock trace" << std::endl;
+		return 1;
+	}
+	
+	//Snapshot the last capacity worth of events. The writer keeps going while we copy, so every slot is checked against its seqlock
+	uint64_t head = ring->header.head.load(std::memory_order_acquire);
+	uint64_t first = (head > trace::TRACE_CAPACITY) ? head - trace::TRACE_CAPACITY : 0;
+	
+	std::vector<copiedEvent> events;
+	events.reserve(head - first);
+	uint64_t torn = 0;
+	
+	for (uint64_t index = first; index < head; ++index)
+	{
+		const trace::event& slot = ring->events[index & (trace::TRACE_CAPACITY - 1)];
+		
+		uint64_t before = slot.sequence.load(std::memory_order_acquire);
+		copiedEvent copy = { slot.timestampNs, slot.arg, slot.threadId, slot.code, slot.phase };
+		std::atomic_thread_fence(std::memory_order_acquire);
+		uint64_t after = slot.sequence.load(std::memory_order_relaxed);
+		
+		//Skip anything half written or already overwritten by a newer lap
+		if (before != after || before != 2 * (index + 1) || copy.code >= trace::EVENT::COUNT)
+		{
+			++torn;
+			continue;
+		}
+		
+		events.push_back(copy);
+	}
+	
+	//Write it out
+	std::ofstream fileOut;
+	if (argc > 1)
+	{
+		fileOut.open(argv[1]);
+		if (!fileOut)
+		{
+			std::cerr << "ERROR: Could not open " << argv[1] << " for writing" << std::endl;
+			return 1;
+		}
+	}
+	std::ostream& out = (argc > 1) ? fileOut : std::cout;
+	
+	out << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+	for (size_t i = 0; i < events.size(); ++i)
+	{
+		const copiedEvent& ev = events[i];
+		
+		//Chrome wants microseconds. Keep the nanoseconds as the fraction
+		out << "{\"name\":\"";
+		if (ev.code == trace::EVENT::TASK) out << tHeap::TASK::toString(static_cast<tHeap::TASK::CODE>(ev.arg));
+		else out << trace::EVENT::NAMES[ev.code];
+		
+		out << "\",\"cat\":\"" << trace::EVENT::CATEGORIES[ev.code]
+			<< "\",\"ph\":\"" << static_cast<char>(ev.phase)
+			<< "\",\"ts\":" << ev.timestampNs / 1000 << '.' << std::string(3 - std::to_string(ev.timestampNs % 1000).size(), '0') << ev.timestampNs % 1000
+			<< ",\"pid\":" << ring->header.pid
+			<< ",\"tid\":" << ev.threadId
+			<< ",\"args\":{\"arg\":" << ev.arg << "}}"
+			<< (i + 1 < events.size() ? ",\n" : "\n");
+	}
+	out << "]}\n";
+	
+	std::cerr << "Exported " << events.size() << " events";
+	if (torn) std::cerr << " (skipped " << torn << " being overwritten)";
+	std::cerr << std::endl;
+	
+	munmap(map, sizeof(trace::ring));
+	
+	return 0;
+}